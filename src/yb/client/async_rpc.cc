@@ -127,6 +127,11 @@ const YBTable* AsyncRpc::table() const {
 void AsyncRpc::SendRpcCb(const Status& status) {
   Status new_status = status;
   if (tablet_invoker_.Done(&new_status)) {
+    if (ErrorCode(response_error()) == tserver::TabletServerErrorPB::TABLET_SPLIT) {
+      batcher_->RouteOpsAfterTabletSplit(ops_);
+      delete this;
+      return;
+    }
     ProcessResponseFromTserver(new_status);
     batcher_->RemoveInFlightOpsAfterFlushing(ops_, new_status);
     batcher_->CheckForFinishedFlush();
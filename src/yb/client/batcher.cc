@@ -517,6 +517,31 @@ void Batcher::RemoveInFlightOpsAfterFlushing(const InFlightOps& ops, const Statu
   }
 }
 
+void Batcher::RouteOpsAfterTabletSplit(const InFlightOps& ops) {
+  for (const auto& op : ops) {
+    if (op->yb_op->tablet()) {
+      // The op was addressed to the split tablet by the user, it cannot be routed again.
+      MarkInFlightOpFailed(op, STATUS_FORMAT(IllegalState, "Tablet $0 has been split",
+                                             op->yb_op->tablet()->tablet_id()));
+      continue;
+    }
+    {
+      std::lock_guard<simple_spinlock> l(lock_);
+      ++outstanding_lookups_;
+    }
+    {
+      std::lock_guard<simple_spinlock> l(op->lock_);
+      op->state = InFlightOpState::kLookingUpTablet;
+      op->tablet = nullptr;
+    }
+    VLOG(3) << "Looking up tablet again after split for " << op->yb_op->ToString();
+    client_->data_->meta_cache_->LookupTabletByKey(
+        op->yb_op->table(), op->partition_key, deadline_, &op->tablet,
+        Bind(&Batcher::TabletLookupFinished, this, op));
+  }
+  CheckForFinishedFlush();
+}
+
 void Batcher::ProcessRpcStatus(const AsyncRpc &rpc, const Status &s) {
   // TODO: there is a potential race here -- if the Batcher gets destructed while
   // RPCs are in-flight, then accessing state_ will crash. We probably need to keep
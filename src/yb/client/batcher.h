@@ -157,6 +157,10 @@ class Batcher : public RefCountedThreadSafe<Batcher> {
 
   void RemoveInFlightOpsAfterFlushing(const InFlightOps& ops, const Status& status);
 
+  // Looks up the tablets of ops that were sent to a tablet which has been split, and sends them
+  // to the tablets that replaced it.
+  void RouteOpsAfterTabletSplit(const InFlightOps& ops);
+
     // Return true if the batch has been aborted, and any in-flight ops should stop
   // processing wherever they are.
   bool IsAbortedUnlocked() const;
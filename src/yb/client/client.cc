@@ -1270,6 +1270,10 @@ const PartitionSchema& YBTable::partition_schema() const {
   return data_->partition_schema_;
 }
 
+const std::vector<std::string>& YBTable::GetPartitions() const {
+  return data_->partitions_;
+}
+
 YBPredicate* YBTable::NewComparisonPredicate(const Slice& col_name,
                                              YBPredicate::ComparisonOp op,
                                              YBValue* value) {
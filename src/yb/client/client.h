@@ -675,6 +675,10 @@ class YBTable : public std::enable_shared_from_this<YBTable> {
 
   const PartitionSchema& partition_schema() const;
 
+  // Returns the sorted partition start keys of the table's tablets. The list is a snapshot taken
+  // when the table was opened and may be stale if tablets have been added since.
+  const std::vector<std::string>& GetPartitions() const;
+
  private:
   class Data;
 
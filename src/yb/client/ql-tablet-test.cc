@@ -29,13 +29,26 @@
 
 #include "yb/ql/util/statement_result.h"
 
+#include "yb/rocksdb/db.h"
+
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/tablet_server.h"
+#include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tserver_service.proxy.h"
 
 using namespace std::literals; // NOLINT
 
 DECLARE_uint64(initial_seqno);
+DECLARE_int32(max_stale_read_bound_time_ms);
+DECLARE_int32(parallel_read_batch_min_size);
+DECLARE_bool(schedule_rocksdb_compactions);
+DECLARE_int32(maintenance_manager_num_threads);
+DECLARE_int32(rocksdb_max_scheduled_compactions);
+DECLARE_int32(rocksdb_level0_file_num_compaction_trigger);
+DECLARE_int32(rocksdb_universal_compaction_min_merge_width);
 
 namespace yb {
 namespace client {
@@ -412,5 +425,239 @@ TEST_F(QLTabletTest, GCLogWithRestartWithoutWrites) {
   VerifyLogIndicies(cluster_.get());
 }
 
+TEST_F(QLTabletTest, StaleFollowerRead) {
+  TableHandle table;
+  CreateTable(kTable1Name, &table);
+
+  FillTable(0, kTotalKeys, &table);
+
+  google::FlagSaver saver;
+  // Followers hear from the leader once per heartbeat interval, so with such a tight bound they
+  // are stale most of the time.
+  FLAGS_max_stale_read_bound_time_ms = 1;
+
+  for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+    auto* server = cluster_->mini_tablet_server(i)->server();
+    auto endpoint = server->rpc_server()->GetBoundAddresses().front();
+    tserver::TabletServerServiceProxy proxy(server->messenger(), endpoint);
+    std::vector<tablet::TabletPeerPtr> peers;
+    server->tablet_manager()->GetTabletPeers(&peers);
+
+    for (const auto& peer : peers) {
+      const bool leader = peer->consensus()->role() == consensus::RaftPeerPB::LEADER;
+      auto read = [&proxy, &peer](tserver::ReadResponsePB* resp) {
+        tserver::ReadRequestPB req;
+        rpc::RpcController controller;
+        controller.set_timeout(MonoDelta::FromSeconds(1));
+        req.set_tablet_id(peer->tablet_id());
+        req.set_consistency_level(YBConsistencyLevel::CONSISTENT_PREFIX);
+        return proxy.Read(req, resp, &controller);
+      };
+
+      tserver::ReadResponsePB resp;
+      if (leader) {
+        ASSERT_OK(read(&resp));
+        ASSERT_FALSE(resp.has_error()) << resp.error().ShortDebugString();
+        continue;
+      }
+      ASSERT_OK(WaitFor([&read, &resp]() -> Result<bool> {
+        resp.Clear();
+        RETURN_NOT_OK(read(&resp));
+        return resp.has_error() &&
+               resp.error().code() == tserver::TabletServerErrorPB::STALE_FOLLOWER;
+      }, 10s, "Follower rejects stale read"));
+    }
+  }
+
+  // Reads that are rejected by stale followers are retried on the other replicas, and eventually
+  // served by the leader.
+  auto session = client_->NewSession(true /* read_only */);
+  for (int i = 0; i != kTotalKeys; ++i) {
+    const auto op = CreateReadOp(i, &table);
+    op->set_yb_consistency_level(YBConsistencyLevel::CONSISTENT_PREFIX);
+    ASSERT_OK(session->Apply(op));
+    auto rowblock = RowsResult(op.get()).GetRowBlock();
+    ASSERT_EQ(1, rowblock->row_count()) << "i: " << i;
+    ASSERT_EQ(ValueForKey(i), rowblock->row(0).column(0).int32_value()) << "i: " << i;
+  }
+}
+
+TEST_F(QLTabletTest, ParallelBatchRead) {
+  TableHandle table;
+  CreateTable(kTable1Name, &table);
+
+  FillTable(0, kTotalKeys, &table);
+
+  master::GetTableLocationsRequestPB req;
+  master::GetTableLocationsResponsePB resp;
+  req.set_max_returned_locations(std::numeric_limits<uint32_t>::max());
+  table.name().SetIntoTableIdentifierPB(req.mutable_table());
+  ASSERT_OK(cluster_->mini_master()->master()->catalog_manager()->GetTableLocations(&req, &resp));
+
+  // Reads every key from every tablet in a single batch, and returns the value found for each key.
+  auto read_all_keys = [this, &table, &resp]() -> std::vector<boost::optional<int32_t>> {
+    std::vector<boost::optional<int32_t>> result(kTotalKeys);
+    for (const auto& tablet : resp.tablet_locations()) {
+      auto tserver = cluster_->find_tablet_server(tablet.replicas(0).ts_info().permanent_uuid());
+      EXPECT_NE(nullptr, tserver);
+      if (!tserver) {
+        continue;
+      }
+      auto endpoint = tserver->server()->rpc_server()->GetBoundAddresses().front();
+      tserver::TabletServerServiceProxy proxy(tserver->server()->messenger(), endpoint);
+
+      tserver::ReadRequestPB read_req;
+      tserver::ReadResponsePB read_resp;
+      rpc::RpcController controller;
+      controller.set_timeout(MonoDelta::FromSeconds(10));
+      read_req.set_tablet_id(tablet.tablet_id());
+      read_req.set_consistency_level(YBConsistencyLevel::CONSISTENT_PREFIX);
+      for (int i = 0; i != kTotalKeys; ++i) {
+        std::string partition_key;
+        auto op = CreateReadOp(i, &table);
+        EXPECT_OK(op->GetPartitionKey(&partition_key));
+        auto* ql_batch = read_req.add_ql_batch();
+        *ql_batch = op->request();
+        ql_batch->set_hash_code(PartitionSchema::DecodeMultiColumnHashValue(partition_key));
+      }
+      EXPECT_OK(proxy.Read(read_req, &read_resp, &controller));
+      EXPECT_FALSE(read_resp.has_error()) << read_resp.error().ShortDebugString();
+      EXPECT_EQ(kTotalKeys, read_resp.ql_batch_size());
+      if (read_resp.ql_batch_size() != kTotalKeys) {
+        continue;
+      }
+
+      auto columns = std::make_shared<std::vector<ColumnSchema>>(table.schema().columns());
+      for (int i = 0; i != kTotalKeys; ++i) {
+        const auto& ql_resp = read_resp.ql_batch(i);
+        EXPECT_EQ(QLResponsePB::YQL_STATUS_OK, ql_resp.status());
+        Slice data;
+        EXPECT_OK(controller.GetSidecar(ql_resp.rows_data_sidecar(), &data));
+        RowsResult rows(table.name(), columns, data.ToBuffer());
+        auto row_block = rows.GetRowBlock();
+        if (row_block->row_count() == 1) {
+          EXPECT_FALSE(result[i].is_initialized()) << "Key found twice: " << i;
+          result[i] = row_block->row(0).column(0).int32_value();
+        }
+      }
+    }
+    return result;
+  };
+
+  google::FlagSaver saver;
+  FLAGS_parallel_read_batch_min_size = 0;
+  const auto sequential = read_all_keys();
+  FLAGS_parallel_read_batch_min_size = 2;
+  const auto parallel = read_all_keys();
+
+  // Responses of a batch executed in parallel keep the order of the requests.
+  for (int i = 0; i != kTotalKeys; ++i) {
+    ASSERT_TRUE(sequential[i].is_initialized()) << "i: " << i;
+    ASSERT_EQ(ValueForKey(i), *sequential[i]) << "i: " << i;
+    ASSERT_TRUE(parallel[i].is_initialized()) << "i: " << i;
+    ASSERT_EQ(ValueForKey(i), *parallel[i]) << "i: " << i;
+  }
+}
+
+TEST_F(QLTabletTest, SplitTablet) {
+  CreateTable(kTable1Name, &table1_);
+  FillTable(0, kTotalKeys, &table1_);
+
+  auto tablets = GetTabletInfos(kTable1Name);
+  ASSERT_FALSE(tablets.empty());
+  const size_t num_tablets = tablets.size();
+  const auto split_tablet = tablets[0];
+
+  master::SplitTabletRequestPB req;
+  master::SplitTabletResponsePB resp;
+  req.set_tablet_id(split_tablet->tablet_id());
+  auto* catalog_manager = cluster_->leader_mini_master()->master()->catalog_manager();
+  ASSERT_OK(catalog_manager->SplitTablet(&req, &resp));
+  ASSERT_FALSE(resp.has_error()) << resp.ShortDebugString();
+  std::vector<TabletId> new_tablet_ids;
+  {
+    auto l = split_tablet->LockForRead();
+    const auto& split_tablet_ids = l->data().pb.split_tablet_ids();
+    new_tablet_ids.assign(split_tablet_ids.begin(), split_tablet_ids.end());
+  }
+  ASSERT_EQ(2, new_tablet_ids.size());
+
+  // The split is committed once both new tablets are running on a majority of the replicas.
+  ASSERT_OK(WaitFor([&split_tablet]() -> Result<bool> {
+    auto l = split_tablet->LockForRead();
+    return l->data().is_deleted();
+  }, 30s, "Commit split"));
+  ASSERT_EQ(num_tablets + 1, GetTabletInfos(kTable1Name).size());
+  for (const auto& new_tablet_id : new_tablet_ids) {
+    int running_replicas = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      scoped_refptr<tablet::TabletPeer> peer;
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      if (tablet_manager->LookupTablet(new_tablet_id, &peer) &&
+          peer->state() == tablet::RUNNING) {
+        ++running_replicas;
+      }
+    }
+    ASSERT_GE(running_replicas * 2, cluster_->num_tablet_servers() + 1) << new_tablet_id;
+  }
+
+  // The client still has the locations of the split tablet. Its reads and writes are rejected with
+  // TABLET_SPLIT, and sent again to the new tablets.
+  VerifyTable(0, kTotalKeys, &table1_);
+  FillTable(kTotalKeys, 2 * kTotalKeys, &table1_);
+  VerifyTable(0, 2 * kTotalKeys, &table1_);
+}
+
+// RocksDB compactions started by the maintenance manager do not hold its thread while they run,
+// so the compactions of all tablets complete with a single maintenance thread.
+TEST_F(QLTabletTest, ScheduledRocksDBCompactions) {
+  google::FlagSaver flag_saver;
+  FLAGS_schedule_rocksdb_compactions = true;
+  FLAGS_maintenance_manager_num_threads = 1;
+  FLAGS_rocksdb_max_scheduled_compactions = 100;
+  FLAGS_rocksdb_level0_file_num_compaction_trigger = 2;
+  FLAGS_rocksdb_universal_compaction_min_merge_width = 2;
+  // Applies the flags to the tablet managers and maintenance managers.
+  ASSERT_OK(cluster_->RestartSync());
+
+  TableHandle table;
+  CreateTable(kTable1Name, &table);
+  constexpr int kNumFlushes = 4;
+  for (int i = 0; i != kNumFlushes; ++i) {
+    FillTable(i * kTotalKeys, (i + 1) * kTotalKeys, &table);
+    cluster_->FlushTablets();
+  }
+
+  ASSERT_OK(WaitFor([this]() -> Result<bool> {
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      std::vector<tablet::TabletPeerPtr> peers;
+      cluster_->mini_tablet_server(i)->server()->tablet_manager()->GetTabletPeers(&peers);
+      for (const auto& peer : peers) {
+        auto* db = peer->tablet()->RegularDBForTest();
+        if (db == nullptr) {
+          continue;
+        }
+        uint64_t pending = 0;
+        uint64_t running = 0;
+        std::string num_files;
+        if (!db->GetIntProperty(rocksdb::DB::Properties::kCompactionPending, &pending) ||
+            !db->GetIntProperty(rocksdb::DB::Properties::kNumRunningCompactions, &running) ||
+            !db->GetProperty(rocksdb::DB::Properties::kNumFilesAtLevelPrefix + "0",
+                             &num_files)) {
+          return STATUS(IllegalState, "Unable to get RocksDB compaction properties");
+        }
+        // Compactions are disabled again once they are done.
+        if (pending != 0 || running != 0 || !db->GetOptions().disable_auto_compactions ||
+            std::stoi(num_files) >= kNumFlushes) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }, 60s, "Scheduled compactions"));
+
+  VerifyTable(0, kNumFlushes * kTotalKeys, &table);
+}
+
 } // namespace client
 } // namespace yb
@@ -21,14 +21,22 @@
 #include "yb/client/transaction_manager.h"
 #include "yb/client/ql-dml-test-base.h"
 
+#include "yb/docdb/docdb_rocksdb_util.h"
+
 #include "yb/ql/util/statement_result.h"
 
+#include "yb/rocksdb/db.h"
+
 #include "yb/tablet/transaction_coordinator.h"
+#include "yb/tablet/transaction_participant.h"
 
 #include "yb/tserver/mini_tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tablet_server.h"
 
+#include "yb/util/mem_tracker.h"
+#include "yb/util/uuid.h"
+
 using namespace std::literals; // NOLINT
 
 DECLARE_uint64(transaction_timeout_usec);
@@ -39,6 +47,8 @@ DECLARE_int32(log_min_seconds_to_retain);
 DECLARE_bool(transaction_disable_heartbeat_in_tests);
 DECLARE_double(transaction_ignore_appying_probability_in_tests);
 DECLARE_uint64(transaction_check_interval_usec);
+DECLARE_uint64(transaction_intents_buffer_max_bytes);
+DECLARE_bool(flush_rocksdb_on_shutdown);
 
 namespace yb {
 namespace client {
@@ -152,6 +162,35 @@ class QLTransactionTest : public QLDmlTestBase {
     return result;
   }
 
+  // Returns the peers of the tablets that have a separate intents DB, on all tablet servers.
+  std::vector<tablet::TabletPeerPtr> TabletPeersWithIntentsDB() {
+    std::vector<tablet::TabletPeerPtr> result;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      auto* tablet_manager = cluster_->mini_tablet_server(i)->server()->tablet_manager();
+      std::vector<tablet::TabletPeerPtr> peers;
+      tablet_manager->GetTabletPeers(&peers);
+      for (auto& peer : peers) {
+        if (peer->tablet()->IntentsDBForTest() != nullptr) {
+          result.push_back(std::move(peer));
+        }
+      }
+    }
+    return result;
+  }
+
+  static uint64_t NumEntriesInActiveMemTable(rocksdb::DB* db) {
+    uint64_t result = 0;
+    EXPECT_TRUE(db->GetIntProperty(rocksdb::DB::Properties::kNumEntriesActiveMemTable, &result));
+    return result;
+  }
+
+  static bool HasKey(rocksdb::DB* db, const std::string& key) {
+    auto iter = docdb::CreateRocksDBIterator(
+        db, docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER, boost::none, rocksdb::kDefaultQueryId);
+    iter->Seek(key);
+    return iter->Valid() && iter->key() == rocksdb::Slice(key);
+  }
+
   TableHandle table_;
   boost::optional<TransactionManager> transaction_manager_;
 };
@@ -162,6 +201,16 @@ TEST_F(QLTransactionTest, Simple) {
   CHECK_OK(cluster_->RestartSync());
 }
 
+// Intents that do not fit the in-memory buffer of the participant are read from RocksDB when the
+// transaction is applied.
+TEST_F(QLTransactionTest, SpilledIntents) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_intents_buffer_max_bytes = 0;
+  WriteData();
+  VerifyData();
+  CHECK_OK(cluster_->RestartSync());
+}
+
 TEST_F(QLTransactionTest, Cleanup) {
   WriteData();
   std::this_thread::sleep_for(1s); // TODO(dtxn)
@@ -235,6 +284,189 @@ TEST_F(QLTransactionTest, PreserveLogs) {
   VerifyData(kTransactions);
 }
 
+// The intents DB is flushed only up to the operations whose changes are flushed to the regular DB,
+// and operations after the op id flushed to the intents DB are replayed until intents are flushed.
+TEST_F(QLTransactionTest, IntentsFlushWaitsForRegularFlush) {
+  WriteData();
+  VerifyData();
+  cluster_->FlushTablets();
+
+  auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+  auto session = std::make_shared<YBSession>(client_, false /* read_only */, tc);
+  session->SetTimeout(5s);
+  InsertRows(session, 1);
+  std::this_thread::sleep_for(1s); // Wait for followers to apply the writes.
+
+  size_t tablets_with_intents = 0;
+  for (const auto& peer : TabletPeersWithIntentsDB()) {
+    auto* tablet = peer->tablet();
+    auto* intents_db = tablet->IntentsDBForTest();
+    if (NumEntriesInActiveMemTable(intents_db) == 0) {
+      continue;
+    }
+    ++tablets_with_intents;
+    const auto regular_flushed_op_id = tablet->RegularDBForTest()->GetFlushedOpId();
+
+    // The intents were written after the last flush of the regular DB.
+    ASSERT_TRUE(intents_db->Flush(rocksdb::FlushOptions()).IsIncomplete());
+    const auto intents_flushed_op_id = intents_db->GetFlushedOpId();
+    ASSERT_LE(intents_flushed_op_id.index, regular_flushed_op_id.index);
+    ASSERT_EQ(intents_flushed_op_id.index, tablet->MaxPersistentOpId().index);
+
+    // A tablet flush lets the intents DB flush everything written before it.
+    ASSERT_OK(tablet->Flush(tablet::FlushMode::kSync));
+    ASSERT_GT(intents_db->GetFlushedOpId().index, regular_flushed_op_id.index);
+    ASSERT_EQ(tablet->RegularDBForTest()->GetFlushedOpId().index,
+              tablet->MaxPersistentOpId().index);
+  }
+  ASSERT_GT(tablets_with_intents, 0);
+
+  CountDownLatch latch(1);
+  tc->Commit([&latch](const Status& status) {
+    EXPECT_OK(status);
+    latch.CountDown();
+  });
+  latch.Wait();
+  VerifyData(2);
+}
+
+// Operations replayed on restart are not written again to a DB that already flushed them, and
+// the log is kept for the intents that are not flushed yet.
+TEST_F(QLTransactionTest, RestartWithRegularDBFlushedAhead) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_disable_heartbeat_in_tests = true;
+  FLAGS_transaction_timeout_usec = std::chrono::microseconds(60s).count();
+  // Keeps the intents unflushed over the restart.
+  FLAGS_flush_rocksdb_on_shutdown = false;
+
+  auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+  auto session = std::make_shared<YBSession>(client_, false /* read_only */, tc);
+  session->SetTimeout(5s);
+  InsertRows(session, 0);
+
+  auto non_transactional_session = client_->NewSession();
+  non_transactional_session->SetTimeout(5s);
+  InsertRows(non_transactional_session, 1);
+  std::this_thread::sleep_for(1s); // Wait for followers to apply the writes.
+
+  for (const auto& peer : TabletPeersWithIntentsDB()) {
+    ASSERT_OK(peer->tablet()->RegularDBForTest()->Flush(rocksdb::FlushOptions()));
+  }
+  cluster_->CleanTabletLogs();
+  ASSERT_OK(cluster_->RestartSync());
+
+  size_t tablets_with_intents = 0;
+  for (const auto& peer : TabletPeersWithIntentsDB()) {
+    // Replayed non-transactional writes were flushed to the regular DB before the restart.
+    ASSERT_EQ(0U, NumEntriesInActiveMemTable(peer->tablet()->RegularDBForTest()));
+    if (NumEntriesInActiveMemTable(peer->tablet()->IntentsDBForTest()) != 0) {
+      ++tablets_with_intents;
+    }
+  }
+  ASSERT_GT(tablets_with_intents, 0);
+
+  CountDownLatch latch(1);
+  tc->Commit([&latch](const Status& status) {
+    EXPECT_OK(status);
+    latch.CountDown();
+  });
+  latch.Wait();
+  VerifyData(2);
+}
+
+// Intents kept in the regular DB by tablets created before the intents DB are moved to the
+// intents DB when the tablet is opened.
+TEST_F(QLTransactionTest, MigrateIntentsFromRegularDB) {
+  WriteData();
+
+  docdb::KeyBytes intent_key;
+  tablet::AppendTransactionKeyPrefix(Uuid::Generate(), &intent_key);
+  size_t num_tablets = 0;
+  for (const auto& peer : TabletPeersWithIntentsDB()) {
+    auto* db = peer->tablet()->RegularDBForTest();
+    ASSERT_OK(db->Put(rocksdb::WriteOptions(), intent_key.data(), "intent"));
+    ASSERT_OK(db->Flush(rocksdb::FlushOptions()));
+    ++num_tablets;
+  }
+  ASSERT_GT(num_tablets, 0);
+
+  ASSERT_OK(cluster_->RestartSync());
+
+  for (const auto& peer : TabletPeersWithIntentsDB()) {
+    ASSERT_FALSE(HasKey(peer->tablet()->RegularDBForTest(), intent_key.data()));
+    ASSERT_TRUE(HasKey(peer->tablet()->IntentsDBForTest(), intent_key.data()));
+  }
+  VerifyData();
+}
+
+// Intents of a transaction that were flushed before a restart are applied together with the
+// intents that are replayed from the log after it.
+TEST_F(QLTransactionTest, RestartWithIntentsStraddlingFlush) {
+  google::FlagSaver flag_saver;
+  FLAGS_transaction_disable_heartbeat_in_tests = true;
+  FLAGS_transaction_timeout_usec = std::chrono::microseconds(60s).count();
+  // Keeps the intents written after the flush unflushed over the restart.
+  FLAGS_flush_rocksdb_on_shutdown = false;
+
+  auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+  auto session = std::make_shared<YBSession>(client_, false /* read_only */, tc);
+  session->SetTimeout(5s);
+  constexpr size_t kRowsBeforeFlush = kNumRows / 2;
+  for (size_t r = 0; r != kRowsBeforeFlush; ++r) {
+    InsertRow(session, KeyForTransactionAndIndex(0, r), ValueForTransactionAndIndex(0, r));
+  }
+  std::this_thread::sleep_for(1s); // Wait for followers to apply the writes.
+  cluster_->FlushTablets();
+
+  for (size_t r = kRowsBeforeFlush; r != kNumRows; ++r) {
+    InsertRow(session, KeyForTransactionAndIndex(0, r), ValueForTransactionAndIndex(0, r));
+  }
+  std::this_thread::sleep_for(1s); // Wait for followers to apply the writes.
+  cluster_->CleanTabletLogs();
+  ASSERT_OK(cluster_->RestartSync());
+
+  CountDownLatch latch(1);
+  tc->Commit([&latch](const Status& status) {
+    EXPECT_OK(status);
+    latch.CountDown();
+  });
+  latch.Wait();
+  VerifyData();
+}
+
+// The intents buffered by all tablets of a tablet server are tracked together, and released once
+// the transaction is applied.
+TEST_F(QLTransactionTest, IntentsBufferMemTracker) {
+  auto buffered_intents_size = [this] {
+    int64_t result = 0;
+    for (int i = 0; i != cluster_->num_tablet_servers(); ++i) {
+      std::shared_ptr<MemTracker> tracker;
+      const auto& server_tracker = cluster_->mini_tablet_server(i)->server()->mem_tracker();
+      CHECK(MemTracker::FindTracker("IntentsBuffer", &tracker, server_tracker));
+      result += tracker->consumption();
+    }
+    return result;
+  };
+
+  auto tc = std::make_shared<YBTransaction>(transaction_manager_.get_ptr(), SNAPSHOT_ISOLATION);
+  auto session = std::make_shared<YBSession>(client_, false /* read_only */, tc);
+  session->SetTimeout(5s);
+  InsertRows(session);
+  std::this_thread::sleep_for(1s); // Wait for followers to apply the writes.
+  ASSERT_GT(buffered_intents_size(), 0);
+
+  CountDownLatch latch(1);
+  tc->Commit([&latch](const Status& status) {
+    EXPECT_OK(status);
+    latch.CountDown();
+  });
+  latch.Wait();
+  VerifyData();
+  ASSERT_OK(WaitFor([&buffered_intents_size]() -> Result<bool> {
+    return buffered_intents_size() == 0;
+  }, 10s, "Release buffered intents"));
+}
+
 TEST_F(QLTransactionTest, ResendApplying) {
   google::FlagSaver flag_saver;
   std::atomic<double>& atomic_flag = *pointer_cast<std::atomic<double>*>(
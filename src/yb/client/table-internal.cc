@@ -32,6 +32,8 @@
 
 #include "yb/client/table-internal.h"
 
+#include <algorithm>
+#include <limits>
 #include <string>
 
 #include "yb/client/client-internal.h"
@@ -101,6 +103,7 @@ Status YBTable::Data::Open() {
   deadline.AddDelta(client_->default_admin_operation_timeout());
 
   req.mutable_table()->set_table_id(id_);
+  req.set_max_returned_locations(std::numeric_limits<int32_t>::max());
   Status s;
   // TODO: replace this with Async RPC-retrier based RPC in the next revision,
   // adding exponential backoff and allowing this to be used safely in a
@@ -186,6 +189,13 @@ Status YBTable::Data::Open() {
   RETURN_NOT_OK_PREPEND(PBToClientTableType(resp.table_type(), &table_type_),
     strings::Substitute("Invalid table type for table '$0'", name_.ToString()));
 
+  partitions_.clear();
+  partitions_.reserve(resp.tablet_locations_size());
+  for (const auto& location : resp.tablet_locations()) {
+    partitions_.push_back(location.partition().partition_key_start());
+  }
+  std::sort(partitions_.begin(), partitions_.end());
+
   VLOG(1) << "Open Table " << name_.ToString() << ", found "
           << resp.tablet_locations_size() << " tablets";
   return Status::OK();
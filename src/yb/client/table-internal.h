@@ -33,6 +33,7 @@
 #define YB_CLIENT_TABLE_INTERNAL_H_
 
 #include <string>
+#include <vector>
 
 #include "yb/common/partition.h"
 #include "yb/client/client.h"
@@ -64,6 +65,9 @@ class YBTable::Data {
   const YBSchema schema_;
   const PartitionSchema partition_schema_;
 
+  // Sorted partition start keys of the table's tablets as of the time the table was opened.
+  std::vector<std::string> partitions_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Data);
 };
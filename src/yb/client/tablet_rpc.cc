@@ -27,11 +27,23 @@ namespace client {
 namespace internal {
 
 void TabletInvoker::SelectTabletServerWithConsistentPrefix() {
+  // Replicas that rejected this read (e.g. because they are too stale) are skipped. Once every
+  // replica has been excluded, fall back to the leader, which can always serve the read.
+  std::set<std::string> blacklist;
+  for (RemoteTabletServer* ts : followers_) {
+    blacklist.insert(ts->permanent_uuid());
+  }
   std::vector<RemoteTabletServer*> candidates;
   current_ts_ = client_->data_->SelectTServer(tablet_.get(),
-                                              YBClient::ReplicaSelection::CLOSEST_REPLICA, {},
-                                              &candidates);
-  VLOG(1) << "Using tserver: " << current_ts_->ToString();
+                                              YBClient::ReplicaSelection::CLOSEST_REPLICA,
+                                              blacklist, &candidates);
+  if (!current_ts_) {
+    followers_.clear();
+    current_ts_ = tablet_->LeaderTServer();
+  }
+  if (current_ts_) {
+    VLOG(1) << "Using tserver: " << current_ts_->ToString();
+  }
 }
 
 void TabletInvoker::SelectTabletServer()  {
@@ -104,9 +116,6 @@ void TabletInvoker::Execute() {
   //    updates the looked-up tablet.
   // Put another way, we don't care about the lookup results at all; we're
   // just using it to fetch the latest consensus configuration information.
-  //
-  // TODO: When we support tablet splits, we should let the lookup shift
-  // the write to another tablet (i.e. if it's since been split).
   if (!current_ts_) {
     client_->LookupTabletById(tablet_->tablet_id(),
                               retrier_->deadline(),
@@ -173,6 +182,16 @@ bool TabletInvoker::Done(Status* status) {
     *status = resp_error_status;
   }
 
+  // The tablet has been split. Forget about it, so that the next lookup of its keys fetches the
+  // tablets that replaced it from the master. Callers that can route their operations by key
+  // check for this error code and send them again.
+  if (ErrorCode(rpc_->response_error()) == tserver::TabletServerErrorPB::TABLET_SPLIT) {
+    VLOG(1) << "Tablet " << tablet_->tablet_id() << " has been split: " << status->ToString();
+    tablet_->MarkStale();
+    rpc_->Failed(*status);
+    return true;
+  }
+
   // Oops, we failed over to a replica that wasn't a LEADER. Unlikely as
   // we're using consensus configuration information from the master, but still possible
   // (e.g. leader restarted and became a FOLLOWER). Try again.
@@ -3,6 +3,9 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/common/ql_expr.h"
+
+#include <type_traits>
+
 #include "yb/common/ql_bfunc.h"
 
 namespace yb {
@@ -296,4 +299,123 @@ CHECKED_STATUS QLExprExecutor::EvalCondition(const QLConditionPB& condition,
 #undef QL_EVALUATE_BETWEEN
 }
 
+//--------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Integer sums wrap around on overflow like the Cassandra ones do.
+template <typename T>
+T WrappingAdd(T lhs, T rhs) {
+  typedef typename std::make_unsigned<T>::type UnsignedT;
+  return static_cast<T>(static_cast<UnsignedT>(lhs) + static_cast<UnsignedT>(rhs));
+}
+
+CHECKED_STATUS AddNumericValue(const QLValuePB& value, QLValuePB *result) {
+  if (value.value_case() != result->value_case()) {
+    return STATUS(RuntimeError, "Cannot add values of different datatypes");
+  }
+  switch (value.value_case()) {
+    case QLValuePB::kInt8Value:
+      result->set_int8_value(WrappingAdd<int8_t>(result->int8_value(), value.int8_value()));
+      return Status::OK();
+    case QLValuePB::kInt16Value:
+      result->set_int16_value(WrappingAdd<int16_t>(result->int16_value(), value.int16_value()));
+      return Status::OK();
+    case QLValuePB::kInt32Value:
+      result->set_int32_value(WrappingAdd<int32_t>(result->int32_value(), value.int32_value()));
+      return Status::OK();
+    case QLValuePB::kInt64Value:
+      result->set_int64_value(WrappingAdd<int64_t>(result->int64_value(), value.int64_value()));
+      return Status::OK();
+    case QLValuePB::kFloatValue:
+      result->set_float_value(result->float_value() + value.float_value());
+      return Status::OK();
+    case QLValuePB::kDoubleValue:
+      result->set_double_value(result->double_value() + value.double_value());
+      return Status::OK();
+    default:
+      break;
+  }
+  return STATUS(NotSupported, "Adding values of this datatype is not yet supported");
+}
+
+} // namespace
+
+CHECKED_STATUS CombineAggregate(const bfql::TSOpcode tsopcode,
+                                const QLValuePB& value,
+                                QLValuePB *result) {
+  if (QLValue::IsNull(value)) {
+    return Status::OK();
+  }
+  if (QLValue::IsNull(*result)) {
+    *result = value;
+    return Status::OK();
+  }
+
+  switch (tsopcode) {
+    case bfql::TSOpcode::kCount: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kSum:
+      return AddNumericValue(value, result);
+
+    case bfql::TSOpcode::kMin:
+      if (value < *result) {
+        *result = value;
+      }
+      return Status::OK();
+
+    case bfql::TSOpcode::kMax:
+      if (value > *result) {
+        *result = value;
+      }
+      return Status::OK();
+
+    default:
+      break;
+  }
+  return STATUS_SUBSTITUTE(RuntimeError, "Unexpected aggregate function opcode $0",
+                           static_cast<int32_t>(tsopcode));
+}
+
+DataType AverageSumDataType(const DataType datatype) {
+  switch (datatype) {
+    case DataType::INT8: FALLTHROUGH_INTENDED;
+    case DataType::INT16: FALLTHROUGH_INTENDED;
+    case DataType::INT32: FALLTHROUGH_INTENDED;
+    case DataType::INT64:
+      return DataType::INT64;
+    case DataType::FLOAT: FALLTHROUGH_INTENDED;
+    case DataType::DOUBLE:
+      return DataType::DOUBLE;
+    default:
+      break;
+  }
+  return datatype;
+}
+
+CHECKED_STATUS AverageSumValue(const QLValuePB& value, QLValuePB *result) {
+  switch (value.value_case()) {
+    case QLValuePB::kInt8Value:
+      result->set_int64_value(value.int8_value());
+      return Status::OK();
+    case QLValuePB::kInt16Value:
+      result->set_int64_value(value.int16_value());
+      return Status::OK();
+    case QLValuePB::kInt32Value:
+      result->set_int64_value(value.int32_value());
+      return Status::OK();
+    case QLValuePB::kInt64Value:
+      result->set_int64_value(value.int64_value());
+      return Status::OK();
+    case QLValuePB::kFloatValue:
+      result->set_double_value(value.float_value());
+      return Status::OK();
+    case QLValuePB::kDoubleValue:
+      result->set_double_value(value.double_value());
+      return Status::OK();
+    default:
+      break;
+  }
+  return STATUS(NotSupported, "Averaging values of this datatype is not yet supported");
+}
+
 } // namespace yb
@@ -10,6 +10,7 @@
 #include "yb/common/ql_value.h"
 #include "yb/common/ql_rowblock.h"
 #include "yb/common/schema.h"
+#include "yb/util/bfql/tserver_opcodes.h"
 
 namespace yb {
 
@@ -59,6 +60,20 @@ class QLExprExecutor {
                                        QLValueWithPB *result);
 };
 
+// Combine a value of COUNT, SUM, MIN or MAX with the running result of the same function. The
+// value is either the argument of the function for one row, or the partial result of the function
+// over a set of rows. Null values are ignored. COUNT and SUM add up the values.
+CHECKED_STATUS CombineAggregate(bfql::TSOpcode tsopcode,
+                                const QLValuePB& value,
+                                QLValuePB *result);
+
+// AVG sums its argument in a wider datatype than the one of the argument, so that the sum of an
+// integer column does not wrap around before it is divided: INT64 for integers, DOUBLE for floating
+// point numbers. AverageSumDataType returns that datatype and AverageSumValue converts a value of
+// the argument to it.
+DataType AverageSumDataType(DataType datatype);
+CHECKED_STATUS AverageSumValue(const QLValuePB& value, QLValuePB *result);
+
 } // namespace yb
 
 #endif // YB_COMMON_QL_EXPR_H_
@@ -344,6 +344,11 @@ class Consensus : public RefCountedThreadSafe<Consensus> {
 
   virtual Status CheckIsActiveLeaderAndHasLease() const = 0;
 
+  // Returns the time elapsed since this replica last accepted an update from a leader, or
+  // MonoDelta::kMax if it has not heard from any leader since start. Used to bound the staleness
+  // of reads served by followers.
+  virtual MonoDelta TimeSinceLastMessageFromLeader() const = 0;
+
  protected:
   friend class RefCountedThreadSafe<Consensus>;
   friend class tablet::TabletPeer;
@@ -493,6 +498,11 @@ class ReplicaOperationFactory {
  public:
   virtual CHECKED_STATUS StartReplicaOperation(const ConsensusRoundPtr& context) = 0;
 
+  // Called before and after consensus notifies the rounds of a run of newly committed operations,
+  // so that the changes of these operations could be applied together.
+  virtual void StartApplyGroup() {}
+  virtual void FinishApplyGroup() {}
+
   virtual ~ReplicaOperationFactory() {}
 };
 
@@ -50,6 +50,8 @@
 
 DECLARE_bool(enable_data_block_fsync);
 DECLARE_int32(consensus_max_batch_size_bytes);
+DECLARE_string(consensus_ops_compression_codec);
+DECLARE_int32(rpc_max_message_size);
 
 METRIC_DECLARE_entity(tablet);
 
@@ -332,6 +334,69 @@ TEST_F(ConsensusQueueTest, TestGetPagedMessages) {
   request.mutable_ops()->ExtractSubrange(0, request.ops_size(), nullptr);
 }
 
+// Tests that operations are sent compressed to peers that support it and can be uncompressed back.
+TEST_F(ConsensusQueueTest, TestCompressedOps) {
+  google::FlagSaver saver;
+  FLAGS_consensus_ops_compression_codec = "lz4";
+  CloseAndReopenQueue();
+
+  queue_->Init(MinimumOpId());
+  queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(2));
+
+  ConsensusRequestPB request;
+  ConsensusResponsePB response;
+  response.set_responder_uuid(kPeerUuid);
+  response.set_supports_compressed_ops(true);
+  bool more_pending = false;
+
+  UpdatePeerWatermarkToOp(&request, &response, MinimumOpId(), MinimumOpId(), &more_pending);
+  ASSERT_TRUE(more_pending);
+
+  AppendReplicateMessagesToQueue(queue_.get(), clock_, 1, 100, 100);
+
+  ReplicateMsgs refs;
+  std::shared_ptr<std::string> compressed_ops_ref;
+  bool needs_remote_bootstrap;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &request, &refs, &needs_remote_bootstrap,
+                                   nullptr /* member_type */,
+                                   nullptr /* last_exchange_successful */,
+                                   &compressed_ops_ref));
+  ASSERT_FALSE(needs_remote_bootstrap);
+  ASSERT_EQ(0, request.ops_size());
+  ASSERT_TRUE(request.has_compressed_ops());
+  ASSERT_LT(request.compressed_ops().size(), request.ops_uncompressed_size());
+  ASSERT_EQ(compressed_ops_ref.get(), &request.compressed_ops());
+
+  // Another request for the same range of operations shares the compressed buffer.
+  ConsensusRequestPB other_request;
+  ReplicateMsgs other_refs;
+  std::shared_ptr<std::string> other_compressed_ops_ref;
+  ASSERT_OK(queue_->RequestForPeer(kPeerUuid, &other_request, &other_refs, &needs_remote_bootstrap,
+                                   nullptr /* member_type */,
+                                   nullptr /* last_exchange_successful */,
+                                   &other_compressed_ops_ref));
+  ASSERT_EQ(compressed_ops_ref, other_compressed_ops_ref);
+  other_request.release_compressed_ops();
+
+  ConsensusRequestPB received(request);
+  ASSERT_OK(UncompressReplicateOps(&received));
+  ASSERT_FALSE(received.has_compressed_ops());
+  ASSERT_EQ(100, received.ops_size());
+  for (int i = 0; i < received.ops_size(); ++i) {
+    ASSERT_EQ(i + 1, received.ops(i).id().index());
+  }
+
+  // The uncompressed size is not trusted beyond the maximum size of a message.
+  ConsensusRequestPB too_large(request);
+  too_large.set_ops_uncompressed_size(FLAGS_rpc_max_message_size + 1);
+  ASSERT_TRUE(UncompressReplicateOps(&too_large).IsInvalidArgument());
+
+  request.release_compressed_ops();
+  SetLastReceivedAndLastCommitted(&response, received.ops(99).id());
+  queue_->ResponseFromPeer(response.responder_uuid(), response, &more_pending);
+  ASSERT_FALSE(more_pending);
+}
+
 TEST_F(ConsensusQueueTest, TestPeersDontAckBeyondWatermarks) {
   queue_->Init(MinimumOpId());
   queue_->SetLeaderMode(MinimumOpId(), MinimumOpId().term(), BuildRaftConfigPBForTests(3));
@@ -42,6 +42,7 @@
 
 #include <gflags/gflags.h>
 
+#include "yb/cfile/compression_codec.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_reader.h"
@@ -57,6 +58,7 @@
 #include "yb/gutil/strings/strcat.h"
 #include "yb/gutil/strings/human_readable.h"
 #include "yb/util/fault_injection.h"
+#include "yb/util/faststring.h"
 #include "yb/util/flag_tags.h"
 #include "yb/util/locks.h"
 #include "yb/util/logging.h"
@@ -90,6 +92,12 @@ DEFINE_int32(consensus_inject_latency_ms_in_notifications, 0,
 TAG_FLAG(consensus_inject_latency_ms_in_notifications, hidden);
 TAG_FLAG(consensus_inject_latency_ms_in_notifications, unsafe);
 
+DEFINE_string(consensus_ops_compression_codec, "none",
+              "Codec used to compress batches of operations sent to followers that support "
+              "compressed operations. One of: none, snappy, lz4, zlib.");
+TAG_FLAG(consensus_ops_compression_codec, advanced);
+TAG_FLAG(consensus_ops_compression_codec, evolving);
+
 DECLARE_int32(rpc_max_message_size);
 
 namespace yb {
@@ -109,6 +117,46 @@ METRIC_DEFINE_gauge_int64(tablet, in_progress_ops, "Leader Operations in Progres
                           MetricUnit::kOperations,
                           "Number of operations in the leader queue ack'd by a minority of "
                           "peers.");
+METRIC_DEFINE_counter(tablet, consensus_ops_uncompressed_bytes,
+                      "Consensus Operations Uncompressed Bytes",
+                      MetricUnit::kBytes,
+                      "Size of the operations sent to followers in compressed form, measured "
+                      "before compression.");
+METRIC_DEFINE_counter(tablet, consensus_ops_compressed_bytes,
+                      "Consensus Operations Compressed Bytes",
+                      MetricUnit::kBytes,
+                      "Size of the operations sent to followers in compressed form, measured "
+                      "after compression.");
+
+Status UncompressReplicateOps(ConsensusRequestPB* request) {
+  if (!request->has_ops_compression_codec()) {
+    return Status::OK();
+  }
+  const cfile::CompressionCodec* codec = nullptr;
+  RETURN_NOT_OK(cfile::GetCompressionCodec(request->ops_compression_codec(), &codec));
+  if (codec == nullptr) {
+    return STATUS(InvalidArgument, "Compressed operations without a compression codec");
+  }
+  // The size comes from the wire, so do not allocate more than a message could legitimately carry.
+  if (request->ops_uncompressed_size() > static_cast<uint32_t>(FLAGS_rpc_max_message_size)) {
+    return STATUS_FORMAT(InvalidArgument, "Uncompressed operations too large: $0, max: $1",
+                         request->ops_uncompressed_size(), FLAGS_rpc_max_message_size);
+  }
+  faststring uncompressed;
+  uncompressed.resize(request->ops_uncompressed_size());
+  RETURN_NOT_OK_PREPEND(
+      codec->Uncompress(request->compressed_ops(), uncompressed.data(), uncompressed.size()),
+      "Could not uncompress operations");
+  ReplicateBatchPB batch;
+  if (!batch.ParseFromArray(uncompressed.data(), uncompressed.size())) {
+    return STATUS(Corruption, "Could not parse uncompressed operations");
+  }
+  request->mutable_ops()->Swap(batch.mutable_ops());
+  request->clear_ops_compression_codec();
+  request->clear_compressed_ops();
+  request->clear_ops_uncompressed_size();
+  return Status::OK();
+}
 
 std::string PeerMessageQueue::TrackedPeer::ToString() const {
   return Substitute("Peer: $0, Is new: $1, Last received: $2, Next index: $3, "
@@ -124,7 +172,9 @@ std::string PeerMessageQueue::TrackedPeer::ToString() const {
   x.Instantiate(metric_entity, 0)
 PeerMessageQueue::Metrics::Metrics(const scoped_refptr<MetricEntity>& metric_entity)
   : num_majority_done_ops(INSTANTIATE_METRIC(METRIC_majority_done_ops)),
-    num_in_progress_ops(INSTANTIATE_METRIC(METRIC_in_progress_ops)) {
+    num_in_progress_ops(INSTANTIATE_METRIC(METRIC_in_progress_ops)),
+    ops_uncompressed_bytes(METRIC_consensus_ops_uncompressed_bytes.Instantiate(metric_entity)),
+    ops_compressed_bytes(METRIC_consensus_ops_compressed_bytes.Instantiate(metric_entity)) {
 }
 #undef INSTANTIATE_METRIC
 
@@ -140,6 +190,8 @@ PeerMessageQueue::PeerMessageQueue(const scoped_refptr<MetricEntity>& metric_ent
   DCHECK(local_peer_pb_.has_last_known_addr());
   CHECK_OK(ThreadPoolBuilder("queue-observers-pool").set_min_threads(1)
            .set_max_threads(1).Build(&observers_pool_));
+  ops_codec_type_ = cfile::GetCompressionCodecType(FLAGS_consensus_ops_compression_codec);
+  CHECK_OK(cfile::GetCompressionCodec(ops_codec_type_, &ops_codec_));
 }
 
 void PeerMessageQueue::Init(const OpId& last_locally_replicated) {
@@ -300,7 +352,8 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
                                         ReplicateMsgs* msg_refs,
                                         bool* needs_remote_bootstrap,
                                         RaftPeerPB::MemberType* member_type,
-                                        bool* last_exchange_successful) {
+                                        bool* last_exchange_successful,
+                                        std::shared_ptr<std::string>* compressed_ops_ref) {
   TrackedPeer* peer = nullptr;
   OpId preceding_id;
   MonoDelta unreachable_time = MonoDelta::kMin;
@@ -322,6 +375,14 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
 
     // Clear the requests without deleting the entries, as they may be in use by other peers.
     request->mutable_ops()->ExtractSubrange(0, request->ops_size(), nullptr);
+    request->clear_ops_compression_codec();
+    // The compressed operations are shared with other peers too, and kept alive by
+    // compressed_ops_ref.
+    request->release_compressed_ops();
+    request->clear_ops_uncompressed_size();
+    if (compressed_ops_ref) {
+      compressed_ops_ref->reset();
+    }
 
     // This is initialized to the queue's last appended op but gets set to the id of the
     // log entry preceding the first one in 'messages' if messages are found for the peer.
@@ -396,8 +457,13 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
     // "all replicated" point. At some point we may want to allow partially loading
     // (and not pinning) earlier messages. At that point we'll need to do something
     // smarter here, like copy or ref-count.
-    for (const auto& msg : messages) {
-      request->mutable_ops()->AddAllocated(msg.get());
+    if (ops_codec_ != nullptr && compressed_ops_ref && peer->supports_compressed_ops &&
+        !messages.empty()) {
+      AddCompressedOps(messages, request, compressed_ops_ref);
+    } else {
+      for (const auto& msg : messages) {
+        request->mutable_ops()->AddAllocated(msg.get());
+      }
     }
     msg_refs->swap(messages);
     DCHECK_LE(request->ByteSize(), FLAGS_consensus_max_batch_size_bytes);
@@ -407,7 +473,12 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   request->mutable_preceding_id()->CopyFrom(preceding_id);
 
   if (PREDICT_FALSE(VLOG_IS_ON(2))) {
-    if (request->ops_size() > 0) {
+    if (request->has_compressed_ops()) {
+      VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending request with compressed operations to Peer: "
+          << uuid << ". Size: " << msg_refs->size()
+          << ". From: " << msg_refs->front()->id().ShortDebugString() << ". To: "
+          << msg_refs->back()->id().ShortDebugString();
+    } else if (request->ops_size() > 0) {
       VLOG_WITH_PREFIX_UNLOCKED(2) << "Sending request with operations to Peer: " << uuid
           << ". Size: " << request->ops_size()
           << ". From: " << request->ops(0).id().ShortDebugString() << ". To: "
@@ -421,6 +492,86 @@ Status PeerMessageQueue::RequestForPeer(const string& uuid,
   return Status::OK();
 }
 
+void PeerMessageQueue::AddCompressedOps(const ReplicateMsgs& messages,
+                                        ConsensusRequestPB* request,
+                                        std::shared_ptr<std::string>* compressed_ops_ref) {
+  const OpId& first = messages.front()->id();
+  const OpId& last = messages.back()->id();
+
+  // Peers at the same position request the same range of operations, so every range is compressed
+  // once, and the buffer is shared by all the requests that carry it.
+  std::shared_ptr<std::string> data;
+  size_t uncompressed_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(compressed_ops_mutex_);
+    CompressedOps* entry = nullptr;
+    for (auto& cached : compressed_ops_cache_) {
+      if (OpIdEquals(cached.first, first) && OpIdEquals(cached.last, last)) {
+        entry = &cached;
+        break;
+      }
+    }
+    if (entry == nullptr) {
+      if (compressed_ops_cache_.size() < kMaxCompressedOpsCacheSize) {
+        compressed_ops_cache_.emplace_back();
+        entry = &compressed_ops_cache_.back();
+      } else {
+        entry = &compressed_ops_cache_[next_compressed_ops_to_replace_];
+        next_compressed_ops_to_replace_ =
+            (next_compressed_ops_to_replace_ + 1) % kMaxCompressedOpsCacheSize;
+      }
+      CompressOps(messages, entry);
+    }
+    data = entry->data;
+    uncompressed_size = entry->uncompressed_size;
+  }
+
+  // No data means that compression did not pay off and the operations are sent as is.
+  if (!data) {
+    for (const auto& msg : messages) {
+      request->mutable_ops()->AddAllocated(msg.get());
+    }
+    return;
+  }
+
+  request->set_ops_compression_codec(ops_codec_type_);
+  request->set_allocated_compressed_ops(data.get());
+  request->set_ops_uncompressed_size(uncompressed_size);
+  metrics_.ops_uncompressed_bytes->IncrementBy(uncompressed_size);
+  metrics_.ops_compressed_bytes->IncrementBy(data->size());
+  *compressed_ops_ref = std::move(data);
+}
+
+void PeerMessageQueue::CompressOps(const ReplicateMsgs& messages, CompressedOps* out) {
+  ReplicateBatchPB batch;
+  for (const auto& msg : messages) {
+    batch.mutable_ops()->AddAllocated(msg.get());
+  }
+  std::string serialized;
+  batch.SerializeToString(&serialized);
+  batch.mutable_ops()->ExtractSubrange(0, batch.ops_size(), nullptr);
+
+  out->first = messages.front()->id();
+  out->last = messages.back()->id();
+  out->uncompressed_size = serialized.size();
+  out->data.reset();
+
+  auto data = std::make_shared<std::string>();
+  data->resize(ops_codec_->MaxCompressedLength(serialized.size()));
+  size_t compressed_length = 0;
+  Status s = ops_codec_->Compress(
+      serialized, reinterpret_cast<uint8_t*>(&(*data)[0]), &compressed_length);
+  if (PREDICT_FALSE(!s.ok())) {
+    LOG_WITH_PREFIX_UNLOCKED(DFATAL) << "Failed to compress operations: " << s.ToString();
+    return;
+  }
+  if (compressed_length >= serialized.size()) {
+    return;
+  }
+  data->resize(compressed_length);
+  out->data = std::move(data);
+}
+
 Status PeerMessageQueue::GetRemoteBootstrapRequestForPeer(const string& uuid,
                                                           StartRemoteBootstrapRequestPB* req) {
   TrackedPeer* peer = nullptr;
@@ -600,6 +751,8 @@ void PeerMessageQueue::ResponseFromPeer(const std::string& peer_uuid,
       peer->member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
     }
 
+    peer->supports_compressed_ops = response.supports_compressed_ops();
+
     // Sanity checks.
     // Some of these can be eventually removed, but they are handy for now.
     DCHECK(response.status().IsInitialized()) << "Error: Uninitialized: "
@@ -35,6 +35,8 @@
 
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -54,10 +56,15 @@
 namespace yb {
 template<class T>
 class AtomicGauge;
+class Counter;
 class MemTracker;
 class MetricEntity;
 class ThreadPool;
 
+namespace cfile {
+class CompressionCodec;
+}
+
 namespace log {
 class Log;
 class AsyncLogReader;
@@ -69,6 +76,9 @@ class PeerMessageQueueObserver;
 // The id for the server-wide consensus queue MemTracker.
 extern const char kConsensusQueueParentTrackerId[];
 
+// Replaces the compressed operations carried by 'request', if any, with their uncompressed form.
+CHECKED_STATUS UncompressReplicateOps(ConsensusRequestPB* request);
+
 // Tracks the state of the peers and which transactions they have replicated.  Owns the LogCache
 // which actually holds the replicate messages which are en route to the various peers.
 //
@@ -138,6 +148,9 @@ class PeerMessageQueue {
     // Member type of this peer in the config.
     RaftPeerPB::MemberType member_type = RaftPeerPB::UNKNOWN_MEMBER_TYPE;
 
+    // Whether the peer reported that it accepts operations in compressed form.
+    bool supports_compressed_ops = false;
+
    private:
     // The last term we saw from a given peer.
     // This is only used for sanity checking that a peer doesn't
@@ -215,13 +228,20 @@ class PeerMessageQueue {
   // not delete the entries. The simplest way is to pass the same instance of ConsensusRequestPB to
   // RequestForPeer(): the buffer will replace the old entries with new ones without de-allocating
   // the old ones if they are still required.
+  //
+  // If --consensus_ops_compression_codec is set, the peer supports it and 'compressed_ops_ref' is
+  // not null, the entries are instead sent compressed in 'compressed_ops'. The compressed buffer is
+  // shared by all peers that request the same range of operations: it is added to 'request' via
+  // set_allocated_compressed_ops() and kept alive by 'compressed_ops_ref', so the same rules as for
+  // the entries apply to it.
   virtual CHECKED_STATUS RequestForPeer(
       const std::string& uuid,
       ConsensusRequestPB* request,
       ReplicateMsgs* msg_refs,
       bool* needs_remote_bootstrap,
       RaftPeerPB::MemberType* member_type = nullptr,
-      bool* last_exchange_successful = nullptr);
+      bool* last_exchange_successful = nullptr,
+      std::shared_ptr<std::string>* compressed_ops_ref = nullptr);
 
   // Fill in a StartRemoteBootstrapRequest for the specified peer.  If that peer should not remotely
   // bootstrap, returns a non-OK status.  On success, also internally resets
@@ -272,6 +292,9 @@ class PeerMessageQueue {
     scoped_refptr<AtomicGauge<int64_t> > num_majority_done_ops;
     // Keeps track of the number of ops. that are still in progress (IsDone() returns false).
     scoped_refptr<AtomicGauge<int64_t> > num_in_progress_ops;
+    // Size of the operations sent to peers before and after compression.
+    scoped_refptr<Counter> ops_uncompressed_bytes;
+    scoped_refptr<Counter> ops_compressed_bytes;
 
     explicit Metrics(const scoped_refptr<MetricEntity>& metric_entity);
   };
@@ -402,6 +425,23 @@ class PeerMessageQueue {
 
   MonoTime LeaderLeaseExpirationWatermark();
 
+  // A range of operations in compressed form.
+  struct CompressedOps {
+    OpId first;
+    OpId last;
+    // Null if compression did not reduce the size of the operations.
+    std::shared_ptr<std::string> data;
+    size_t uncompressed_size = 0;
+  };
+
+  // Adds 'messages' to 'request', compressed if possible.
+  void AddCompressedOps(const ReplicateMsgs& messages,
+                        ConsensusRequestPB* request,
+                        std::shared_ptr<std::string>* compressed_ops_ref);
+
+  // Compresses 'messages' into 'out'.
+  void CompressOps(const ReplicateMsgs& messages, CompressedOps* out);
+
   std::vector<PeerMessageQueueObserver*> observers_;
 
   // The pool which executes observer notifications.
@@ -429,6 +469,18 @@ class PeerMessageQueue {
   LogCache log_cache_;
 
   Metrics metrics_;
+
+  // Codec used to compress operations sent to peers, nullptr if compression is disabled.
+  const cfile::CompressionCodec* ops_codec_ = nullptr;
+  CompressionType ops_codec_type_ = NO_COMPRESSION;
+
+  // The most recently compressed ranges of operations, reused while peers request the same ranges.
+  // Followers at different positions request different ranges, so a few of them are kept.
+  static constexpr size_t kMaxCompressedOpsCacheSize = 4;
+
+  std::mutex compressed_ops_mutex_;
+  std::vector<CompressedOps> compressed_ops_cache_;
+  size_t next_compressed_ops_to_replace_ = 0;
 };
 
 inline std::ostream& operator <<(std::ostream& out, PeerMessageQueue::Mode mode) {
@@ -202,6 +202,37 @@ TEST_F(LogTest, TestMultipleEntriesInABatch) {
   ASSERT_OK(log_->Close());
 }
 
+// Entries written to a segment with a compression codec should be readable back.
+TEST_F(LogTest, TestCompressedEntries) {
+  options_.compression_codec = LZ4;
+  BuildLog();
+
+  OpId opid;
+  opid.set_term(1);
+  opid.set_index(1);
+
+  const int kNumEntries = 100;
+  ASSERT_OK(AppendNoOpsToLogSync(clock_, log_.get(), &opid, kNumEntries));
+  ASSERT_OK(log_->AllocateSegmentAndRollOver());
+
+  SegmentSequence segments;
+  ASSERT_OK(log_->GetLogReader()->GetSegmentsSnapshot(&segments));
+  ASSERT_EQ(LZ4, segments[0]->header().compression_codec());
+
+  LogEntries entries;
+  ASSERT_OK(segments[0]->ReadEntries(&entries));
+  ASSERT_EQ(kNumEntries, entries.size());
+  for (int i = 0; i < kNumEntries; ++i) {
+    ASSERT_EQ(i + 1, entries[i]->replicate().id().index());
+  }
+
+  // A batch of similar no-op entries is compressible.
+  auto* metrics = log_->metrics_.get();
+  ASSERT_LT(metrics->bytes_written->value(), metrics->bytes_logged->value());
+
+  ASSERT_OK(log_->Close());
+}
+
 // Tests that everything works properly with fsync enabled:
 // This also tests SyncDir() (see KUDU-261), which is called whenever
 // a new log segment is initialized.
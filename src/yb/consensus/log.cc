@@ -135,6 +135,9 @@ using strings::Substitute;
 
 // This class is responsible for managing the thread that appends to
 // the log file.
+// TODO(perf) Each tablet still has its own append thread. It could run as a task on a server-wide
+// pool, scheduled only when the queue is not empty, like tablet::PrepareThread does. The task would
+// block a pool thread for the duration of the fsync, so the pool would have to be sized for that.
 class Log::AppendThread {
  public:
   explicit AppendThread(Log* log);
@@ -537,6 +540,13 @@ Status Log::DoAppend(LogEntryBatch* entry_batch, bool caller_owns_operation) {
 
   if (metrics_) {
     metrics_->bytes_logged->IncrementBy(entry_batch_bytes);
+    const int64_t stored_bytes =
+        active_segment_->written_offset() - start_offset - kEntryHeaderSize;
+    metrics_->bytes_written->IncrementBy(stored_bytes);
+    if (entry_batch_bytes > 0) {
+      metrics_->entry_batch_compression_percent->Increment(
+          stored_bytes * 100 / entry_batch_bytes);
+    }
   }
 
   CHECK_OK(UpdateIndexForBatch(*entry_batch, start_offset));
@@ -909,6 +919,10 @@ Status Log::SwitchToAllocatedSegment() {
   header.set_minor_version(kLogMinorVersion);
   header.set_sequence_number(active_segment_sequence_number_);
   header.set_tablet_id(tablet_id_);
+  if (options_.compression_codec != NO_COMPRESSION &&
+      options_.compression_codec != DEFAULT_COMPRESSION) {
+    header.set_compression_codec(options_.compression_codec);
+  }
 
   // Set up the new footer. This will be maintained as the segment is written.
   footer_builder_.Clear();
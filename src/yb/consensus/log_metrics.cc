@@ -38,6 +38,11 @@ METRIC_DEFINE_counter(tablet, log_bytes_logged, "Bytes Written to WAL",
                       yb::MetricUnit::kBytes,
                       "Number of bytes logged since service start");
 
+METRIC_DEFINE_counter(tablet, log_bytes_written, "Bytes Stored in WAL",
+                      yb::MetricUnit::kBytes,
+                      "Number of bytes written to WAL segments since service start, after "
+                      "compression");
+
 METRIC_DEFINE_histogram(tablet, log_sync_latency, "Log Sync Latency",
                         yb::MetricUnit::kMicroseconds,
                         "Microseconds spent on synchronizing the log segment file",
@@ -63,17 +68,26 @@ METRIC_DEFINE_histogram(tablet, log_entry_batches_per_group, "Log Group Commit B
                         "Number of log entry batches in a group commit group",
                         1024, 2);
 
+METRIC_DEFINE_histogram(tablet, log_entry_batch_compression_percent,
+                        "Log Entry Batch Compression Ratio",
+                        yb::MetricUnit::kUnits,
+                        "Size of a WAL entry batch after compression, as a percentage of its "
+                        "uncompressed size",
+                        1000, 2);
+
 namespace yb {
 namespace log {
 
 #define MINIT(x) x(METRIC_log_##x.Instantiate(metric_entity))
 LogMetrics::LogMetrics(const scoped_refptr<MetricEntity>& metric_entity)
     : MINIT(bytes_logged),
+      MINIT(bytes_written),
       MINIT(sync_latency),
       MINIT(append_latency),
       MINIT(group_commit_latency),
       MINIT(roll_latency),
-      MINIT(entry_batches_per_group) {
+      MINIT(entry_batches_per_group),
+      MINIT(entry_batch_compression_percent) {
 }
 #undef MINIT
 
@@ -49,6 +49,8 @@ struct LogMetrics {
 
   // Global stats
   scoped_refptr<Counter> bytes_logged;
+  // Bytes actually written to the log segments, i.e. after compression.
+  scoped_refptr<Counter> bytes_written;
 
   // Per-group group commit stats
   scoped_refptr<Histogram> sync_latency;
@@ -56,6 +58,9 @@ struct LogMetrics {
   scoped_refptr<Histogram> group_commit_latency;
   scoped_refptr<Histogram> roll_latency;
   scoped_refptr<Histogram> entry_batches_per_group;
+
+  // Size of every written entry batch as a percentage of its uncompressed size.
+  scoped_refptr<Histogram> entry_batch_compression_percent;
 };
 
 // TODO extract and generalize this for all histogram metrics
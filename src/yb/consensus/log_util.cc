@@ -40,6 +40,7 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/cfile/compression_codec.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/ref_counted_replicate.h"
 #include "yb/fs/fs_manager.h"
@@ -78,6 +79,12 @@ DEFINE_bool(log_async_preallocate_segments, true,
             "Whether the WAL segments preallocation should happen asynchronously");
 TAG_FLAG(log_async_preallocate_segments, advanced);
 
+DEFINE_string(log_compression_codec, "none",
+              "Codec used to compress WAL entry batches of new log segments. "
+              "One of: none, snappy, lz4, zlib.");
+TAG_FLAG(log_compression_codec, advanced);
+TAG_FLAG(log_compression_codec, evolving);
+
 namespace yb {
 namespace log {
 
@@ -115,7 +122,8 @@ LogOptions::LogOptions()
                                                            : FLAGS_log_segment_size_bytes),
       durable_wal_write(FLAGS_durable_wal_write),
       preallocate_segments(FLAGS_log_preallocate_segments),
-      async_preallocate_segments(FLAGS_log_async_preallocate_segments) {
+      async_preallocate_segments(FLAGS_log_async_preallocate_segments),
+      compression_codec(cfile::GetCompressionCodecType(FLAGS_log_compression_codec)) {
 }
 
 Status ReadableLogSegment::Open(Env* env,
@@ -692,10 +700,18 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   }
 
 
+  // Decompress the batch if this segment was written with compression.
+  Slice batch_data = entry_batch_slice;
+  faststring uncompressed_buf;
+  if (header_.has_compression_codec()) {
+    RETURN_NOT_OK(UncompressEntryBatch(entry_batch_slice, &uncompressed_buf));
+    batch_data = Slice(uncompressed_buf.data(), uncompressed_buf.size());
+  }
+
   LogEntryBatchPB read_entry_batch;
   s = pb_util::ParseFromArray(&read_entry_batch,
-                              entry_batch_slice.data(),
-                              header.msg_length);
+                              batch_data.data(),
+                              batch_data.size());
 
   if (!s.ok()) return STATUS(Corruption, Substitute("Could parse PB. Cause: $0",
                                                     s.ToString()));
@@ -705,6 +721,26 @@ Status ReadableLogSegment::ReadEntryBatch(int64_t *offset,
   return Status::OK();
 }
 
+Status ReadableLogSegment::UncompressEntryBatch(const Slice& data, faststring* uncompressed) {
+  const cfile::CompressionCodec* codec = nullptr;
+  RETURN_NOT_OK_PREPEND(cfile::GetCompressionCodec(header_.compression_codec(), &codec),
+                        Substitute("Unsupported compression codec in $0", path_));
+  if (codec == nullptr) {
+    uncompressed->assign_copy(data.data(), data.size());
+    return Status::OK();
+  }
+  if (PREDICT_FALSE(data.size() < sizeof(uint32_t))) {
+    return STATUS(Corruption, Substitute("Compressed entry is too short: $0 bytes", data.size()));
+  }
+  const uint32_t uncompressed_length = DecodeFixed32(data.data());
+  uncompressed->resize(uncompressed_length);
+  RETURN_NOT_OK_PREPEND(
+      codec->Uncompress(Slice(data.data() + sizeof(uint32_t), data.size() - sizeof(uint32_t)),
+                        uncompressed->data(), uncompressed_length),
+      Substitute("Could not uncompress entry in $0", path_));
+  return Status::OK();
+}
+
 WritableLogSegment::WritableLogSegment(string path,
                                        shared_ptr<WritableFile> writable_file)
     : path_(std::move(path)),
@@ -717,6 +753,10 @@ Status WritableLogSegment::WriteHeaderAndOpen(const LogSegmentHeaderPB& new_head
   DCHECK(!IsHeaderWritten()) << "Can only call WriteHeader() once";
   DCHECK(new_header.IsInitialized())
       << "Log segment header must be initialized" << new_header.InitializationErrorString();
+  if (new_header.has_compression_codec()) {
+    RETURN_NOT_OK(cfile::GetCompressionCodec(new_header.compression_codec(), &codec_));
+  }
+
   faststring buf;
 
   // First the magic.
@@ -766,11 +806,23 @@ Status WritableLogSegment::WriteFooterAndClose(const LogSegmentFooterPB& footer)
 }
 
 
-Status WritableLogSegment::WriteEntryBatch(const Slice& data) {
+Status WritableLogSegment::WriteEntryBatch(const Slice& entry_batch_data) {
   DCHECK(is_header_written_);
   DCHECK(!is_footer_written_);
   uint8_t header_buf[kEntryHeaderSize];
 
+  Slice data = entry_batch_data;
+  if (codec_ != nullptr) {
+    // Compressed entries are prefixed with their uncompressed length.
+    compressed_buf_.resize(
+        sizeof(uint32_t) + codec_->MaxCompressedLength(entry_batch_data.size()));
+    InlineEncodeFixed32(compressed_buf_.data(), entry_batch_data.size());
+    size_t compressed_length = 0;
+    RETURN_NOT_OK(codec_->Compress(
+        entry_batch_data, compressed_buf_.data() + sizeof(uint32_t), &compressed_length));
+    data = Slice(compressed_buf_.data(), sizeof(uint32_t) + compressed_length);
+  }
+
   // First encode the length of the message.
   uint32_t len = data.size();
   InlineEncodeFixed32(&header_buf[0], len);
@@ -48,12 +48,17 @@
 #include "yb/gutil/ref_counted.h"
 #include "yb/util/atomic.h"
 #include "yb/util/env.h"
+#include "yb/util/faststring.h"
 
 // Used by other classes, now part of the API.
 DECLARE_bool(durable_wal_write);
 
 namespace yb {
 
+namespace cfile {
+class CompressionCodec;
+} // namespace cfile
+
 namespace consensus {
 class ReplicateMsg;
 struct OpIdBiggerThanFunctor;
@@ -89,6 +94,9 @@ struct LogOptions {
   // Whether the allocation should happen asynchronously.
   bool async_preallocate_segments;
 
+  // Codec used to compress entry batches of newly created segments.
+  CompressionType compression_codec;
+
   LogOptions();
 };
 
@@ -265,6 +273,9 @@ class ReadableLogSegment : public RefCountedThreadSafe<ReadableLogSegment> {
   bool DecodeEntryHeader(const Slice& data, EntryHeader* header);
 
 
+  // Uncompresses an entry batch read from a segment written with a compression codec.
+  CHECKED_STATUS UncompressEntryBatch(const Slice& data, faststring* uncompressed);
+
   // Reads a log entry batch from the provided readable segment, which gets decoded
   // into 'entry_batch' and increments 'offset' by the batch's length.
   CHECKED_STATUS ReadEntryBatch(int64_t *offset,
@@ -330,7 +341,7 @@ class WritableLogSegment {
   }
 
   // Appends the provided batch of data, including a header
-  // and checksum.
+  // and checksum. The data is compressed if the segment header specifies a compression codec.
   // Makes sure that the log segment has not been closed.
   CHECKED_STATUS WriteEntryBatch(const Slice& entry_batch_data);
 
@@ -397,6 +408,12 @@ class WritableLogSegment {
   // The offset where the last written entry ends.
   int64_t written_offset_;
 
+  // Codec used to compress entry batches, or nullptr if they are written uncompressed.
+  const cfile::CompressionCodec* codec_ = nullptr;
+
+  // Buffer reused to hold compressed entry batches.
+  faststring compressed_buf_;
+
   DISALLOW_COPY_AND_ASSIGN(WritableLogSegment);
 };
 
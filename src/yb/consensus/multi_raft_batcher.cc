@@ -0,0 +1,208 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/consensus/multi_raft_batcher.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+
+#include "yb/common/wire_protocol.h"
+#include "yb/consensus/consensus.proxy.h"
+#include "yb/gutil/strings/substitute.h"
+#include "yb/rpc/messenger.h"
+#include "yb/rpc/rpc_header.pb.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/monotime.h"
+
+DEFINE_int32(multi_raft_heartbeat_window_ms, 10,
+             "Maximum time in milliseconds a heartbeat is held back so that it can be sent "
+             "together with heartbeats of other tablets to the same server. 0 disables "
+             "heartbeat batching.");
+TAG_FLAG(multi_raft_heartbeat_window_ms, advanced);
+TAG_FLAG(multi_raft_heartbeat_window_ms, evolving);
+TAG_FLAG(multi_raft_heartbeat_window_ms, runtime);
+
+DEFINE_int32(multi_raft_batch_size, 256,
+             "Maximum number of heartbeats sent in a single batched RPC.");
+TAG_FLAG(multi_raft_batch_size, advanced);
+TAG_FLAG(multi_raft_batch_size, evolving);
+TAG_FLAG(multi_raft_batch_size, runtime);
+
+DECLARE_int32(consensus_rpc_timeout_ms);
+
+namespace yb {
+namespace consensus {
+
+using strings::Substitute;
+
+MultiRaftHeartbeatBatcher::MultiRaftHeartbeatBatcher(
+    std::shared_ptr<rpc::Messenger> messenger, std::unique_ptr<ConsensusServiceProxy> proxy)
+    : messenger_(std::move(messenger)),
+      proxy_(std::move(proxy)) {
+}
+
+MultiRaftHeartbeatBatcher::~MultiRaftHeartbeatBatcher() {
+}
+
+void MultiRaftHeartbeatBatcher::AddRequestToBatch(const ConsensusRequestPB* request,
+                                                  ConsensusResponsePB* response,
+                                                  rpc::RpcController* controller,
+                                                  const rpc::ResponseCallback& callback) {
+  ResponseCallbackData data = {request, response, controller, callback};
+  const int window_ms = FLAGS_multi_raft_heartbeat_window_ms;
+  if (window_ms <= 0 || !batching_supported_.load(std::memory_order_acquire)) {
+    SendRequest(data);
+    return;
+  }
+
+  BatchDataPtr full_batch;
+  bool schedule_flush = false;
+  BatchDataPtr batch;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_batch_) {
+      current_batch_ = std::make_shared<BatchData>();
+      schedule_flush = true;
+    }
+    batch = current_batch_;
+    batch->request.add_consensus_request()->CopyFrom(*request);
+    batch->callbacks.push_back(std::move(data));
+    if (batch->callbacks.size() >= static_cast<size_t>(std::max(FLAGS_multi_raft_batch_size, 1))) {
+      full_batch.swap(current_batch_);
+    }
+  }
+
+  if (full_batch) {
+    SendBatch(full_batch);
+  } else if (schedule_flush) {
+    auto self = shared_from_this();
+    messenger_->ScheduleOnReactor(
+        [self, batch](const Status& status) {
+          if (!status.ok()) {
+            // The reactor is shutting down and aborted the task, so do not send the batch.
+            self->AbortBatch(batch, status);
+            return;
+          }
+          self->FlushBatch(batch);
+        },
+        MonoDelta::FromMilliseconds(window_ms));
+  }
+}
+
+void MultiRaftHeartbeatBatcher::FlushBatch(const BatchDataPtr& batch) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_batch_ != batch) {
+      // The batch filled up and was already sent.
+      return;
+    }
+    current_batch_.reset();
+  }
+  SendBatch(batch);
+}
+
+void MultiRaftHeartbeatBatcher::AbortBatch(const BatchDataPtr& batch, const Status& status) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_batch_ != batch) {
+      // The batch filled up and was already sent.
+      return;
+    }
+    current_batch_.reset();
+  }
+  VLOG(1) << "Aborting " << batch->callbacks.size() << " batched heartbeats: " << status.ToString();
+  for (const auto& data : batch->callbacks) {
+    data.response->Clear();
+    StatusToPB(status, data.response->mutable_error()->mutable_status());
+    data.response->mutable_error()->set_code(tserver::TabletServerErrorPB::UNKNOWN_ERROR);
+    data.callback();
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendBatch(const BatchDataPtr& batch) {
+  VLOG(3) << "Sending " << batch->callbacks.size() << " batched heartbeats";
+  batch->controller.set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  proxy_->MultiRaftUpdateConsensusAsync(
+      batch->request, &batch->response, &batch->controller,
+      std::bind(&MultiRaftHeartbeatBatcher::BatchResponseReceived, shared_from_this(), batch));
+}
+
+void MultiRaftHeartbeatBatcher::BatchResponseReceived(const BatchDataPtr& batch) {
+  Status s = batch->controller.status();
+  if (!s.ok()) {
+    const rpc::ErrorStatusPB* error = batch->controller.error_response();
+    if (error != nullptr && error->code() == rpc::ErrorStatusPB::ERROR_NO_SUCH_METHOD) {
+      LOG(INFO) << "Remote server does not support batched heartbeats, sending them separately";
+      batching_supported_.store(false, std::memory_order_release);
+    }
+  } else if (batch->response.consensus_response_size() !=
+                 static_cast<int>(batch->callbacks.size())) {
+    s = STATUS(IllegalState, Substitute("Expected $0 responses in batch, got $1",
+                                        batch->callbacks.size(),
+                                        batch->response.consensus_response_size()));
+  }
+
+  if (!s.ok()) {
+    // Resend the requests separately, so that each caller observes the status of its own RPC.
+    VLOG(1) << "Batched heartbeat failed: " << s.ToString();
+    for (const auto& data : batch->callbacks) {
+      SendRequest(data);
+    }
+    return;
+  }
+
+  for (size_t i = 0; i != batch->callbacks.size(); ++i) {
+    const auto& data = batch->callbacks[i];
+    data.response->Swap(batch->response.mutable_consensus_response(i));
+    data.callback();
+  }
+}
+
+void MultiRaftHeartbeatBatcher::SendRequest(const ResponseCallbackData& data) {
+  data.controller->set_timeout(MonoDelta::FromMilliseconds(FLAGS_consensus_rpc_timeout_ms));
+  proxy_->UpdateConsensusAsync(*data.request, data.response, data.controller, data.callback);
+}
+
+MultiRaftManager::MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger)
+    : messenger_(std::move(messenger)) {
+}
+
+MultiRaftManager::~MultiRaftManager() {
+}
+
+Status MultiRaftManager::AddOrGetBatcher(const HostPort& hostport,
+                                         std::shared_ptr<MultiRaftHeartbeatBatcher>* batcher) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = batchers_.find(hostport);
+  if (it != batchers_.end()) {
+    *batcher = it->second.lock();
+    if (*batcher) {
+      return Status::OK();
+    }
+  }
+
+  std::vector<Endpoint> addrs;
+  RETURN_NOT_OK(hostport.ResolveAddresses(&addrs));
+  if (addrs.empty()) {
+    return STATUS_FORMAT(NetworkError, "Unable to resolve address $0", hostport.ToString());
+  }
+  std::unique_ptr<ConsensusServiceProxy> proxy(new ConsensusServiceProxy(messenger_, addrs[0]));
+  *batcher = std::make_shared<MultiRaftHeartbeatBatcher>(messenger_, std::move(proxy));
+  batchers_[hostport] = *batcher;
+  return Status::OK();
+}
+
+} // namespace consensus
+} // namespace yb
@@ -0,0 +1,125 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#ifndef YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+#define YB_CONSENSUS_MULTI_RAFT_BATCHER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "yb/consensus/consensus.pb.h"
+#include "yb/rpc/response_callback.h"
+#include "yb/rpc/rpc_controller.h"
+#include "yb/util/net/net_util.h"
+#include "yb/util/status.h"
+
+namespace yb {
+
+namespace rpc {
+class Messenger;
+}
+
+namespace consensus {
+
+class ConsensusServiceProxy;
+
+// Coalesces status-only consensus requests (heartbeats and leader lease renewals) that the tablets
+// of this server send to the same remote server into a single MultiRaftUpdateConsensus RPC.
+//
+// The first request added to an empty batch schedules the batch to be sent after
+// --multi_raft_heartbeat_window_ms, and a batch that reaches --multi_raft_batch_size requests is
+// sent right away. Each caller gets its own response and callback, as if it had sent the request
+// itself. If the batched RPC fails, the requests are resent separately so that every caller
+// observes the status of its own RPC.
+class MultiRaftHeartbeatBatcher : public std::enable_shared_from_this<MultiRaftHeartbeatBatcher> {
+ public:
+  MultiRaftHeartbeatBatcher(std::shared_ptr<rpc::Messenger> messenger,
+                            std::unique_ptr<ConsensusServiceProxy> proxy);
+
+  ~MultiRaftHeartbeatBatcher();
+
+  // Sends 'request' as part of the next batch. 'request', 'response' and 'controller' must stay
+  // valid until 'callback' is invoked.
+  void AddRequestToBatch(const ConsensusRequestPB* request,
+                         ConsensusResponsePB* response,
+                         rpc::RpcController* controller,
+                         const rpc::ResponseCallback& callback);
+
+ private:
+  struct ResponseCallbackData {
+    const ConsensusRequestPB* request;
+    ConsensusResponsePB* response;
+    rpc::RpcController* controller;
+    rpc::ResponseCallback callback;
+  };
+
+  struct BatchData {
+    MultiRaftConsensusRequestPB request;
+    MultiRaftConsensusResponsePB response;
+    rpc::RpcController controller;
+    std::vector<ResponseCallbackData> callbacks;
+  };
+
+  typedef std::shared_ptr<BatchData> BatchDataPtr;
+
+  // Sends 'batch' unless it was already sent because it filled up.
+  void FlushBatch(const BatchDataPtr& batch);
+
+  // Fails the requests of 'batch' with 'status' in their responses, without sending them, unless
+  // the batch was already sent because it filled up.
+  void AbortBatch(const BatchDataPtr& batch, const Status& status);
+
+  void SendBatch(const BatchDataPtr& batch);
+
+  void BatchResponseReceived(const BatchDataPtr& batch);
+
+  // Sends a single request without batching.
+  void SendRequest(const ResponseCallbackData& data);
+
+  std::shared_ptr<rpc::Messenger> messenger_;
+  std::unique_ptr<ConsensusServiceProxy> proxy_;
+
+  // Cleared if the remote server does not implement MultiRaftUpdateConsensus.
+  std::atomic<bool> batching_supported_{true};
+
+  std::mutex mutex_;
+  BatchDataPtr current_batch_;
+};
+
+// Keeps one MultiRaftHeartbeatBatcher per remote server, shared by all tablets of this server.
+class MultiRaftManager {
+ public:
+  explicit MultiRaftManager(std::shared_ptr<rpc::Messenger> messenger);
+
+  ~MultiRaftManager();
+
+  // Returns the batcher for requests sent to 'hostport', creating it if needed.
+  CHECKED_STATUS AddOrGetBatcher(const HostPort& hostport,
+                                 std::shared_ptr<MultiRaftHeartbeatBatcher>* batcher);
+
+ private:
+  std::shared_ptr<rpc::Messenger> messenger_;
+
+  std::mutex mutex_;
+
+  // Batchers are owned by the peer proxies using them and dropped once no proxy refers to them.
+  std::unordered_map<HostPort, std::weak_ptr<MultiRaftHeartbeatBatcher>, HostPortHash> batchers_;
+};
+
+} // namespace consensus
+} // namespace yb
+
+#endif // YB_CONSENSUS_MULTI_RAFT_BATCHER_H
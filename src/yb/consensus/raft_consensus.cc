@@ -225,8 +225,10 @@ scoped_refptr<RaftConsensus> RaftConsensus::Create(
     const scoped_refptr<log::Log>& log,
     const shared_ptr<MemTracker>& parent_mem_tracker,
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
-    TableType table_type) {
-  gscoped_ptr<PeerProxyFactory> rpc_factory(new RpcPeerProxyFactory(messenger));
+    TableType table_type,
+    MultiRaftManager* multi_raft_manager) {
+  gscoped_ptr<PeerProxyFactory> rpc_factory(
+      new RpcPeerProxyFactory(messenger, multi_raft_manager));
 
   // The message queue that keeps track of which operations need to be replicated
   // where.
@@ -1081,6 +1083,9 @@ Status RaftConsensus::Update(ConsensusRequestPB* request,
 
   RETURN_NOT_OK(ExecuteHook(PRE_UPDATE));
   response->set_responder_uuid(state_->GetPeerUuid());
+  response->set_supports_compressed_ops(true);
+
+  RETURN_NOT_OK(UncompressReplicateOps(request));
 
   VLOG_WITH_PREFIX(2) << "Replica received request: " << request->ShortDebugString();
 
@@ -1475,6 +1480,8 @@ Status RaftConsensus::UpdateReplica(ConsensusRequestPB* request,
     // sanity check.
     RETURN_NOT_OK(SnoozeFailureDetectorUnlocked());
 
+    last_received_from_leader_.store(MonoTime::FineNow().ToUint64(), std::memory_order_release);
+
     // Update the expiration time of the current leader's lease, so that when this follower becomes
     // a leader, it can wait out the time interval while the old leader might still be active.
     if (FLAGS_use_leader_leases && request->has_leader_lease_duration_ms()) {
@@ -2186,6 +2193,14 @@ Status RaftConsensus::CheckIsActiveLeaderAndHasLease() const {
   return state_->CheckIsActiveLeaderAndHasLease();
 }
 
+MonoDelta RaftConsensus::TimeSinceLastMessageFromLeader() const {
+  auto last = MonoTime::FromUint64(last_received_from_leader_.load(std::memory_order_acquire));
+  if (last == MonoTime::kMin) {
+    return MonoDelta::kMax;
+  }
+  return MonoTime::FineNow().GetDeltaSince(last);
+}
+
 std::string RaftConsensus::GetRequestVoteLogPrefixUnlocked() const {
   return state_->LogPrefixUnlocked() + "Leader election vote request";
 }
@@ -69,6 +69,7 @@ class Clock;
 
 namespace consensus {
 class ConsensusMetadata;
+class MultiRaftManager;
 class Peer;
 class PeerProxyFactory;
 class PeerManager;
@@ -91,7 +92,8 @@ class RaftConsensus : public Consensus,
     const scoped_refptr<log::Log>& log,
     const std::shared_ptr<MemTracker>& parent_mem_tracker,
     const Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk,
-    TableType table_type);
+    TableType table_type,
+    MultiRaftManager* multi_raft_manager = nullptr);
 
   RaftConsensus(const ConsensusOptions& options,
     gscoped_ptr<ConsensusMetadata> cmeta,
@@ -238,6 +240,8 @@ class RaftConsensus : public Consensus,
 
   Status CheckIsActiveLeaderAndHasLease() const override;
 
+  MonoDelta TimeSinceLastMessageFromLeader() const override;
+
  private:
   friend class ReplicaState;
   friend class RaftConsensusQuorumTest;
@@ -564,6 +568,9 @@ class RaftConsensus : public Consensus,
   // on this peer.
   std::atomic<uint64_t> withhold_election_start_until_;
 
+  // The last time (in the MonoTime's uint64 representation) we accepted an update from the leader.
+  std::atomic<uint64_t> last_received_from_leader_{MonoTime::kMin.ToUint64()};
+
   // We record the moment at which we discover that an election has been lost by our "protege"
   // during leader stepdown. Then, when the master asks us to step down again in favor of the same
   // server, we'll reply with the amount of time that has passed to avoid leader stepdown loops.s
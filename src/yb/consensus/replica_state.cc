@@ -751,6 +751,10 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
 
   OpId prev_id = last_committed_index_;
 
+  if (operation_factory_ != nullptr) {
+    operation_factory_->StartApplyGroup();
+  }
+
   while (iter != end_iter) {
     scoped_refptr<ConsensusRound> round = (*iter).second; // Make a copy.
     DCHECK(round);
@@ -805,6 +809,10 @@ Status ReplicaState::ApplyPendingOperationsUnlocked(IndexToRoundMap::iterator it
     round->NotifyReplicationFinished(Status::OK());
   }
 
+  if (operation_factory_ != nullptr) {
+    operation_factory_->FinishApplyGroup();
+  }
+
   SetLastCommittedIndexUnlocked(committed_index);
 
   return Status::OK();
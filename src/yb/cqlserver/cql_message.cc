@@ -13,6 +13,9 @@
 
 #include <regex>
 
+#include <lz4.h>
+#include <snappy.h>
+
 #include "yb/client/client.h"
 #include "yb/common/ql_protocol.pb.h"
 #include "yb/cqlserver/cql_message.h"
@@ -27,6 +30,10 @@ namespace cqlserver {
 constexpr const char* const kCassandraPasswordAuthenticator =
     "org.apache.cassandra.auth.PasswordAuthenticator";
 
+constexpr const char* const kCompressionOption = "COMPRESSION";
+constexpr const char* const kLZ4Compression = "lz4";
+constexpr const char* const kSnappyCompression = "snappy";
+
 using std::shared_ptr;
 using std::unique_ptr;
 using std::string;
@@ -215,6 +222,16 @@ bool CQLRequest::ParseRequest(
       (mesg.size() == kMessageHeaderLength) ?
       Slice() : Slice(&mesg[kMessageHeaderLength], mesg.size() - kMessageHeaderLength);
 
+  // Compressed messages should have been decompressed already, so a compression flag left means
+  // that compression has not been negotiated for this connection.
+  if (header.flags & kCompressionFlag) {
+    error_response->reset(
+        new ErrorResponse(
+            header.stream_id, ErrorResponse::Code::PROTOCOL_ERROR,
+            "Compressed message received while compression is not enabled"));
+    return false;
+  }
+
   // Construct the skeleton request by the opcode
   switch (header.opcode) {
     case Opcode::STARTUP:
@@ -290,6 +307,59 @@ bool CQLRequest::ParseRequest(
   return true;
 }
 
+Status CQLRequest::DecompressMessage(
+    const CompressionScheme compression_scheme, const Slice& mesg, faststring* output) {
+  if (mesg.size() < kMessageHeaderLength) {
+    return STATUS(NetworkError, "Incomplete header");
+  }
+  const Slice body(mesg.data() + kMessageHeaderLength, mesg.size() - kMessageHeaderLength);
+  output->clear();
+  output->append(mesg.data(), kMessageHeaderLength);
+  output->data()[kHeaderPosFlags] &= ~kCompressionFlag;
+
+  switch (compression_scheme) {
+    case CompressionScheme::LZ4: {
+      // The LZ4 compressed body is preceded by the 4-byte length of the uncompressed body.
+      if (body.size() < kIntSize) {
+        return STATUS(NetworkError, "Truncated LZ4 compressed CQL message");
+      }
+      const size_t length = NetworkByteOrder::Load32(body.data());
+      if (length > static_cast<size_t>(kMaxMessageLength)) {
+        return STATUS_SUBSTITUTE(NetworkError, "Decompressed CQL message too long: $0", length);
+      }
+      output->resize(kMessageHeaderLength + length);
+      const int n = LZ4_decompress_safe(
+          to_char_ptr(body.data() + kIntSize), to_char_ptr(output->data() + kMessageHeaderLength),
+          body.size() - kIntSize, length);
+      if (n < 0 || static_cast<size_t>(n) != length) {
+        return STATUS(NetworkError, "Corrupted LZ4 compressed CQL message");
+      }
+      break;
+    }
+    case CompressionScheme::SNAPPY: {
+      size_t length = 0;
+      if (!snappy::GetUncompressedLength(to_char_ptr(body.data()), body.size(), &length)) {
+        return STATUS(NetworkError, "Corrupted Snappy compressed CQL message");
+      }
+      if (length > static_cast<size_t>(kMaxMessageLength)) {
+        return STATUS_SUBSTITUTE(NetworkError, "Decompressed CQL message too long: $0", length);
+      }
+      output->resize(kMessageHeaderLength + length);
+      if (!snappy::RawUncompress(to_char_ptr(body.data()), body.size(),
+                                 to_char_ptr(output->data() + kMessageHeaderLength))) {
+        return STATUS(NetworkError, "Corrupted Snappy compressed CQL message");
+      }
+      break;
+    }
+    case CompressionScheme::NONE:
+      return STATUS(NetworkError, "Compressed CQL message while compression is not enabled");
+  }
+
+  NetworkByteOrder::Store32(output->data() + kHeaderPosLength,
+                            static_cast<uint32_t>(output->size() - kMessageHeaderLength));
+  return Status::OK();
+}
+
 CQLRequest::CQLRequest(const Header& header, const Slice& body) : CQLMessage(header), body_(body) {
 }
 
@@ -492,6 +562,23 @@ CQLResponse* StartupRequest::Execute() const {
   }
 }
 
+Status StartupRequest::GetCompressionScheme(CompressionScheme* compression_scheme) const {
+  const auto it = options_.find(kCompressionOption);
+  if (it == options_.end()) {
+    *compression_scheme = CompressionScheme::NONE;
+    return Status::OK();
+  }
+  if (it->second == kLZ4Compression) {
+    *compression_scheme = CompressionScheme::LZ4;
+    return Status::OK();
+  }
+  if (it->second == kSnappyCompression) {
+    *compression_scheme = CompressionScheme::SNAPPY;
+    return Status::OK();
+  }
+  return STATUS_SUBSTITUTE(InvalidArgument, "Unsupported compression $0", it->second);
+}
+
 //----------------------------------------------------------------------------------------
 AuthResponseRequest::AuthResponseRequest(const Header& header, const Slice& body)
     : CQLRequest(header, body) {
@@ -702,8 +789,8 @@ CQLResponse* RegisterRequest::Execute() const {
 CQLResponse::CQLResponse(const CQLRequest& request, const Opcode opcode)
     : CQLMessage(
           Header(
-              request.version() | kResponseVersion, request.flags(), request.stream_id(),
-              opcode)) {
+              request.version() | kResponseVersion, request.flags() & ~kCompressionFlag,
+              request.stream_id(), opcode)) {
 }
 
 CQLResponse::CQLResponse(const StreamId stream_id, const Opcode opcode)
@@ -731,6 +818,62 @@ void CQLResponse::Serialize(faststring* mesg) const {
       mesg->data(), start_pos + kHeaderPosLength, mesg->size() - start_pos - kMessageHeaderLength);
 }
 
+void CQLResponse::CompressMessages(
+    const CompressionScheme compression_scheme, faststring* mesg) {
+  if (compression_scheme == CompressionScheme::NONE) {
+    return;
+  }
+
+  // A response may consist of several messages, e.g. a SCHEMA_CHANGE result is followed by a
+  // SCHEMA_CHANGE event. Compress the body of each of them.
+  faststring output;
+  faststring compressed;
+  size_t pos = 0;
+  while (pos + kMessageHeaderLength <= mesg->size()) {
+    const uint8_t* header = mesg->data() + pos;
+    const size_t length = NetworkByteOrder::Load32(header + kHeaderPosLength);
+    const Slice body(header + kMessageHeaderLength, length);
+    pos += kMessageHeaderLength + length;
+    DCHECK_LE(pos, mesg->size());
+
+    compressed.clear();
+    if (!body.empty()) {
+      switch (compression_scheme) {
+        case CompressionScheme::LZ4: {
+          compressed.resize(kIntSize + LZ4_compressBound(body.size()));
+          NetworkByteOrder::Store32(compressed.data(), static_cast<uint32_t>(body.size()));
+          const int n = LZ4_compress(to_char_ptr(body.data()),
+                                     to_char_ptr(compressed.data() + kIntSize), body.size());
+          compressed.resize(n > 0 ? kIntSize + n : 0);
+          break;
+        }
+        case CompressionScheme::SNAPPY: {
+          compressed.resize(snappy::MaxCompressedLength(body.size()));
+          size_t n = 0;
+          snappy::RawCompress(to_char_ptr(body.data()), body.size(),
+                              to_char_ptr(compressed.data()), &n);
+          compressed.resize(n);
+          break;
+        }
+        case CompressionScheme::NONE:
+          break;
+      }
+    }
+
+    const size_t header_pos = output.size();
+    output.append(header, kMessageHeaderLength);
+    if (!compressed.empty() && compressed.size() < body.size()) {
+      output.data()[header_pos + kHeaderPosFlags] |= kCompressionFlag;
+      NetworkByteOrder::Store32(output.data() + header_pos + kHeaderPosLength,
+                                static_cast<uint32_t>(compressed.size()));
+      output.append(compressed.data(), compressed.size());
+    } else {
+      output.append(body.data(), body.size());
+    }
+  }
+  mesg->assign_copy(output.data(), output.size());
+}
+
 void CQLResponse::SerializeHeader(faststring* mesg) const {
   uint8_t buffer[kMessageHeaderLength];
   SERIALIZE_BYTE(buffer, kHeaderPosVersion, version());
@@ -973,7 +1116,7 @@ void AuthenticateResponse::SerializeBody(faststring* mesg) const {
 
 //----------------------------------------------------------------------------------------
 const unordered_map<string, vector<string>> SupportedResponse::options_ = {
-  {"COMPRESSION", { } },
+  {kCompressionOption, {kLZ4Compression, kSnappyCompression} },
   {"CQL_VERSION", {"3.0.0" /* minimum */, "3.4.2" /* current */} }
 };
 
@@ -1657,7 +1800,7 @@ CQLServerEvent::CQLServerEvent(std::unique_ptr<EventResponse> event_response)
   CHECK_NOTNULL(event_response_.get());
   faststring temp;
   event_response_->Serialize(&temp);
-  serialized_response_ = RefCntBuffer(temp);
+  serialized_response_ = RefCntBuffer(std::move(temp));
 }
 
 void CQLServerEvent::Serialize(std::deque<RefCntBuffer>* output) const {
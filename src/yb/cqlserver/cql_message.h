@@ -79,6 +79,13 @@ class CQLMessage {
   static constexpr Flags kCustomPayloadFlag = 0x04; // Since V4
   static constexpr Flags kWarningFlag       = 0x08; // Since V4
 
+  // Compression of message bodies negotiated by the COMPRESSION option of the STARTUP request.
+  enum class CompressionScheme : uint8_t {
+    NONE   = 0x00,
+    LZ4    = 0x01,
+    SNAPPY = 0x02
+  };
+
   using StreamId = uint16_t;
   static constexpr StreamId kEventStreamId = 0xffff; // Special stream id for events.
 
@@ -225,6 +232,15 @@ class CQLRequest : public CQLMessage {
     return static_cast<StreamId>(NetworkByteOrder::Load16(mesg.data() + kHeaderPosStreamId));
   }
 
+  static bool IsCompressed(const Slice& mesg) {
+    return mesg.size() >= kMessageHeaderLength && (mesg[kHeaderPosFlags] & kCompressionFlag) != 0;
+  }
+
+  // Decompress the body of the serialized request message 'mesg' that is compressed using
+  // 'compression_scheme'. The message with the decompressed body is returned in 'output'.
+  static CHECKED_STATUS DecompressMessage(
+      CompressionScheme compression_scheme, const Slice& mesg, faststring* output);
+
   virtual ~CQLRequest();
 
   virtual CQLResponse* Execute() const = 0;
@@ -313,6 +329,10 @@ class StartupRequest : public CQLRequest {
   virtual ~StartupRequest() override;
   virtual CQLResponse* Execute() const override;
 
+  // Returns in 'compression_scheme' the compression of message bodies requested by the client, or
+  // an InvalidArgument error if the requested compression is not supported.
+  CHECKED_STATUS GetCompressionScheme(CompressionScheme* compression_scheme) const;
+
  protected:
   virtual CHECKED_STATUS ParseBody() override;
 
@@ -466,6 +486,10 @@ class CQLResponse : public CQLMessage {
  public:
   virtual void Serialize(faststring* mesg) const;
   virtual ~CQLResponse();
+
+  // Compress the bodies of the serialized response messages in 'mesg' using 'compression_scheme'.
+  // Bodies that do not get smaller are left uncompressed.
+  static void CompressMessages(CompressionScheme compression_scheme, faststring* mesg);
  protected:
   CQLResponse(const CQLRequest& request, Opcode opcode);
   CQLResponse(StreamId stream_id, Opcode opcode);
@@ -49,6 +49,14 @@ METRIC_DEFINE_histogram(
 METRIC_DEFINE_counter(
     server, yb_cqlserver_CQLServerService_ParsingErrors, "Errors encountered when parsing ",
     yb::MetricUnit::kRequests, "Errors encountered when parsing ");
+METRIC_DEFINE_counter(
+    server, yb_cqlserver_CQLServerService_RequestBytesSavedByCompression,
+    "Bytes saved by compression of CQL requests", yb::MetricUnit::kBytes,
+    "Number of bytes by which compression reduced the size of CQL requests received.");
+METRIC_DEFINE_counter(
+    server, yb_cqlserver_CQLServerService_ResponseBytesSavedByCompression,
+    "Bytes saved by compression of CQL responses", yb::MetricUnit::kBytes,
+    "Number of bytes by which compression reduced the size of CQL responses sent.");
 METRIC_DEFINE_histogram(
     server, handler_latency_yb_cqlserver_CQLServerService_Any,
     "yb.cqlserver.CQLServerService.AnyMethod RPC Time", yb::MetricUnit::kMicroseconds,
@@ -99,6 +107,12 @@ CQLMetrics::CQLMetrics(const scoped_refptr<yb::MetricEntity>& metric_entity)
       METRIC_handler_latency_yb_cqlserver_CQLServerService_Any.Instantiate(metric_entity);
   num_errors_parsing_cql_ =
       METRIC_yb_cqlserver_CQLServerService_ParsingErrors.Instantiate(metric_entity);
+  request_bytes_saved_by_compression_ =
+      METRIC_yb_cqlserver_CQLServerService_RequestBytesSavedByCompression.Instantiate(
+          metric_entity);
+  response_bytes_saved_by_compression_ =
+      METRIC_yb_cqlserver_CQLServerService_ResponseBytesSavedByCompression.Instantiate(
+          metric_entity);
 }
 
 //------------------------------------------------------------------------------------------------
@@ -126,7 +140,31 @@ void CQLProcessor::ProcessCall(rpc::InboundCallPtr call) {
 
   // Parse the CQL request. If the parser failed, it sets the error message in response.
   parse_begin_ = MonoTime::Now(MonoTime::FINE);
-  if (!CQLRequest::ParseRequest(call_->serialized_request(), &request, &response)) {
+  Slice mesg = call_->serialized_request();
+
+  // Decompress the request body if compressed.
+  faststring decompressed_mesg;
+  auto& context = down_cast<CQLInboundCall*>(call_.get())->connection_context();
+  const auto compression_scheme = context.compression_scheme();
+  if (CQLRequest::IsCompressed(mesg) && compression_scheme != CQLMessage::CompressionScheme::NONE) {
+    const Status s = CQLRequest::DecompressMessage(compression_scheme, mesg, &decompressed_mesg);
+    if (!s.ok()) {
+      cql_metrics_->num_errors_parsing_cql_->Increment();
+      SendResponse(ErrorResponse(
+          CQLRequest::ParseStreamId(mesg), ErrorResponse::Code::PROTOCOL_ERROR,
+          s.message().ToString()));
+      return;
+    }
+    const size_t compressed_size = mesg.size();
+    mesg = Slice(decompressed_mesg.data(), decompressed_mesg.size());
+    context.RecordReceivedBytes(mesg.size(), compressed_size);
+    if (mesg.size() > compressed_size) {
+      cql_metrics_->request_bytes_saved_by_compression_->IncrementBy(
+          mesg.size() - compressed_size);
+    }
+  }
+
+  if (!CQLRequest::ParseRequest(mesg, &request, &response)) {
     cql_metrics_->num_errors_parsing_cql_->Increment();
     SendResponse(*response);
     service_impl_->ReturnProcessor(pos_);
@@ -155,7 +193,16 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
   faststring msg;
   response.Serialize(&msg);
   auto* cql_call = down_cast<CQLInboundCall*>(call_.get());
-  cql_call->RespondSuccess(RefCntBuffer(msg), cql_metrics_->rpc_method_metrics_);
+  auto& context = cql_call->connection_context();
+  const auto compression_scheme = context.compression_scheme();
+  if (compression_scheme != CQLMessage::CompressionScheme::NONE) {
+    const size_t uncompressed_size = msg.size();
+    CQLResponse::CompressMessages(compression_scheme, &msg);
+    context.RecordSentBytes(uncompressed_size, msg.size());
+    cql_metrics_->response_bytes_saved_by_compression_->IncrementBy(
+        uncompressed_size - msg.size());
+  }
+  cql_call->RespondSuccess(RefCntBuffer(std::move(msg)), cql_metrics_->rpc_method_metrics_);
 
   MonoTime response_done = MonoTime::Now(MonoTime::FINE);
   cql_metrics_->time_to_process_request_->Increment(
@@ -178,6 +225,8 @@ void CQLProcessor::SendResponse(const CQLResponse& response) {
 
 CQLResponse* CQLProcessor::ProcessRequest(const CQLRequest& req) {
   switch (req.opcode()) {
+    case CQLMessage::Opcode::STARTUP:
+      return ProcessStartup(static_cast<const StartupRequest&>(req));
     case CQLMessage::Opcode::PREPARE:
       return ProcessPrepare(static_cast<const PrepareRequest&>(req));
     case CQLMessage::Opcode::EXECUTE:
@@ -193,6 +242,21 @@ CQLResponse* CQLProcessor::ProcessRequest(const CQLRequest& req) {
   }
 }
 
+CQLResponse* CQLProcessor::ProcessStartup(const StartupRequest& req) {
+  CQLMessage::CompressionScheme compression_scheme = CQLMessage::CompressionScheme::NONE;
+  const Status s = req.GetCompressionScheme(&compression_scheme);
+  if (!s.ok()) {
+    return new ErrorResponse(req, ErrorResponse::Code::PROTOCOL_ERROR, s.message().ToString());
+  }
+  CQLResponse* response = req.Execute();
+  if (response->opcode() != CQLMessage::Opcode::ERROR) {
+    // Compression applies to all messages following the STARTUP request, including the response.
+    down_cast<CQLInboundCall*>(call_.get())->connection_context().set_compression_scheme(
+        compression_scheme);
+  }
+  return response;
+}
+
 CQLResponse* CQLProcessor::ProcessPrepare(const PrepareRequest& req) {
   VLOG(1) << "PREPARE " << req.query();
   const CQLMessage::QueryId query_id = CQLStatement::GetQueryId(
@@ -45,6 +45,8 @@ class CQLMetrics : public ql::QLMetrics {
 
   scoped_refptr<yb::Histogram> time_to_queue_cql_response_;
   scoped_refptr<yb::Counter> num_errors_parsing_cql_;
+  scoped_refptr<yb::Counter> request_bytes_saved_by_compression_;
+  scoped_refptr<yb::Counter> response_bytes_saved_by_compression_;
   // Rpc level metrics
   yb::rpc::RpcMethodMetrics rpc_method_metrics_;
 };
@@ -68,7 +70,8 @@ class CQLProcessor : public ql::QLProcessor {
   // Process a CQL request.
   CQLResponse* ProcessRequest(const CQLRequest& req);
 
-  // Process a PREPARE, EXECUTE, QUERY, BATCH or AUTH_RESPONSE request.
+  // Process a STARTUP, PREPARE, EXECUTE, QUERY, BATCH or AUTH_RESPONSE request.
+  CQLResponse* ProcessStartup(const StartupRequest& req);
   CQLResponse* ProcessPrepare(const PrepareRequest& req);
   CQLResponse* ProcessExecute(const ExecuteRequest& req);
   CQLResponse* ProcessQuery(const QueryRequest& req);
@@ -74,6 +74,38 @@ Status CQLConnectionContext::ProcessCalls(const rpc::ConnectionPtr& connection,
   return Status::OK();
 }
 
+void CQLConnectionContext::RecordReceivedBytes(size_t uncompressed, size_t compressed) {
+  received_bytes_uncompressed_.fetch_add(uncompressed, std::memory_order_relaxed);
+  received_bytes_compressed_.fetch_add(compressed, std::memory_order_relaxed);
+}
+
+void CQLConnectionContext::RecordSentBytes(size_t uncompressed, size_t compressed) {
+  sent_bytes_uncompressed_.fetch_add(uncompressed, std::memory_order_relaxed);
+  sent_bytes_compressed_.fetch_add(compressed, std::memory_order_relaxed);
+}
+
+void CQLConnectionContext::DumpPB(const rpc::DumpRunningRpcsRequestPB& req,
+                                  rpc::RpcConnectionPB* resp) {
+  ConnectionContextWithCallId::DumpPB(req, resp);
+  auto* details = resp->mutable_cql_connection_details();
+  switch (compression_scheme()) {
+    case CQLMessage::CompressionScheme::NONE:
+      break;
+    case CQLMessage::CompressionScheme::LZ4:
+      details->set_compression("lz4");
+      break;
+    case CQLMessage::CompressionScheme::SNAPPY:
+      details->set_compression("snappy");
+      break;
+  }
+  details->set_received_bytes_uncompressed(
+      received_bytes_uncompressed_.load(std::memory_order_relaxed));
+  details->set_received_bytes_compressed(
+      received_bytes_compressed_.load(std::memory_order_relaxed));
+  details->set_sent_bytes_uncompressed(sent_bytes_uncompressed_.load(std::memory_order_relaxed));
+  details->set_sent_bytes_compressed(sent_bytes_compressed_.load(std::memory_order_relaxed));
+}
+
 size_t CQLConnectionContext::BufferLimit() {
   return CQLMessage::kMaxMessageLength;
 }
@@ -113,6 +145,10 @@ CQLInboundCall::CQLInboundCall(rpc::ConnectionPtr conn,
       ql_session_(std::move(ql_session)) {
 }
 
+CQLConnectionContext& CQLInboundCall::connection_context() const {
+  return static_cast<CQLConnectionContext&>(connection()->context());
+}
+
 Status CQLInboundCall::ParseFrom(Slice source) {
   TRACE_EVENT_FLOW_BEGIN0("rpc", "CQLInboundCall", this);
   TRACE_EVENT0("rpc", "CQLInboundCall::ParseFrom");
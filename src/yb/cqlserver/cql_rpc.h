@@ -15,6 +15,8 @@
 #ifndef YB_CQLSERVER_CQL_RPC_H
 #define YB_CQLSERVER_CQL_RPC_H
 
+#include <atomic>
+
 #include "yb/cqlserver/cql_message.h"
 
 #include "yb/rpc/connection.h"
@@ -30,6 +32,22 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
  public:
   CQLConnectionContext();
 
+  // Compression of message bodies negotiated by the STARTUP request of this connection.
+  CQLMessage::CompressionScheme compression_scheme() const {
+    return compression_scheme_.load(std::memory_order_acquire);
+  }
+
+  void set_compression_scheme(CQLMessage::CompressionScheme compression_scheme) {
+    compression_scheme_.store(compression_scheme, std::memory_order_release);
+  }
+
+  // Account for a message received or sent with a body of 'uncompressed' bytes, which was
+  // 'compressed' bytes on the wire.
+  void RecordReceivedBytes(size_t uncompressed, size_t compressed);
+  void RecordSentBytes(size_t uncompressed, size_t compressed);
+
+  void DumpPB(const rpc::DumpRunningRpcsRequestPB& req, rpc::RpcConnectionPB* resp) override;
+
  private:
   uint64_t ExtractCallId(rpc::InboundCall* call) override;
   void RunNegotiation(rpc::ConnectionPtr connection, const MonoTime& deadline) override;
@@ -47,6 +65,15 @@ class CQLConnectionContext : public rpc::ConnectionContextWithCallId {
   // Cassandra ROLE), consider adding a CreateNewConnection method in rpc::ServiceIf so that
   // CQLConnection can be created and returned from CQLServiceImpl.CreateNewConnection().
   ql::QLSession::SharedPtr ql_session_;
+
+  std::atomic<CQLMessage::CompressionScheme> compression_scheme_{
+      CQLMessage::CompressionScheme::NONE};
+
+  // Message bytes received and sent on this connection while compression is enabled.
+  std::atomic<uint64_t> received_bytes_uncompressed_{0};
+  std::atomic<uint64_t> received_bytes_compressed_{0};
+  std::atomic<uint64_t> sent_bytes_uncompressed_{0};
+  std::atomic<uint64_t> sent_bytes_compressed_{0};
 };
 
 class CQLInboundCall : public rpc::InboundCall {
@@ -72,6 +99,9 @@ class CQLInboundCall : public rpc::InboundCall {
     return response_msg_buf_;
   }
 
+  // Return the context of the connection this call was received on.
+  CQLConnectionContext& connection_context() const;
+
   // Return the SQL session of this CQL call.
   const ql::QLSession::SharedPtr& ql_session() const {
     return ql_session_;
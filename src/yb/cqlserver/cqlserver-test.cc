@@ -44,6 +44,14 @@ class TestCQLService : public YBTableTestBase {
 
   void SendRequestAndExpectResponse(const string& cmd, const string& resp);
 
+  // Expect a response with the body compressed using 'compression_scheme', which decompresses to
+  // 'resp'.
+  void SendRequestAndExpectCompressedResponse(
+      const string& cmd, CQLMessage::CompressionScheme compression_scheme, const string& resp);
+
+  void TestCompression(const string& compression, CQLMessage::CompressionScheme compression_scheme,
+                       const string& compressed_empty_body);
+
   int server_port() { return cql_server_port_; }
  private:
   Status SendRequestAndGetResponse(
@@ -124,6 +132,64 @@ void TestCQLService::SendRequestAndExpectResponse(const string& cmd, const strin
   CHECK_EQ(resp, string(reinterpret_cast<char*>(resp_), resp.length()));
 }
 
+void TestCQLService::SendRequestAndExpectCompressedResponse(
+    const string& cmd, CQLMessage::CompressionScheme compression_scheme, const string& resp) {
+  CHECK_OK(SendRequestAndGetResponse(cmd, CQLMessage::kMessageHeaderLength));
+  ASSERT_TRUE(CQLRequest::IsCompressed(Slice(resp_, CQLMessage::kMessageHeaderLength)));
+
+  // Receive the compressed body.
+  const size_t body_length = NetworkByteOrder::Load32(resp_ + CQLMessage::kHeaderPosLength);
+  ASSERT_LE(CQLMessage::kMessageHeaderLength + body_length, kBufLen);
+  MonoTime deadline = MonoTime::Now(MonoTime::FINE);
+  deadline.AddDelta(MonoDelta::FromMilliseconds(1000));
+  size_t bytes_read = 0;
+  CHECK_OK(client_sock_.BlockingRecv(
+      resp_ + CQLMessage::kMessageHeaderLength, body_length, &bytes_read, deadline));
+  ASSERT_EQ(body_length, bytes_read);
+
+  faststring decompressed;
+  CHECK_OK(CQLRequest::DecompressMessage(
+      compression_scheme, Slice(resp_, CQLMessage::kMessageHeaderLength + body_length),
+      &decompressed));
+  CHECK_EQ(resp, decompressed.ToString());
+}
+
+void TestCQLService::TestCompression(
+    const string& compression, CQLMessage::CompressionScheme compression_scheme,
+    const string& compressed_empty_body) {
+  // Send STARTUP request with compression.
+  const string startup_body = BINARY_STRING("\x00\x02" "\x00\x0b" "CQL_VERSION" "\x00\x05" "3.0.0"
+                                            "\x00\x0b" "COMPRESSION") +
+                              string(1, '\0') + string(1, static_cast<char>(compression.size())) +
+                              compression;
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00") +
+          string(1, static_cast<char>(startup_body.size())) + startup_body,
+      BINARY_STRING("\x84\x00\x00\x00\x02" "\x00\x00\x00\x00"));
+
+  // Send compressed OPTIONS request. The SUPPORTED response does not get smaller by compression
+  // and so is sent uncompressed.
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x01\x00\x00\x05" "\x00\x00\x00") +
+          string(1, static_cast<char>(compressed_empty_body.size())) + compressed_empty_body,
+      BINARY_STRING("\x84\x00\x00\x00\x06" "\x00\x00\x00\x3b"
+                    "\x00\x02" "\x00\x0b" "CQL_VERSION"
+                               "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
+                               "\x00\x0b" "COMPRESSION"
+                               "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy"));
+
+  // Send STARTUP request with an unsupported option of a long name. The error response that
+  // repeats the name is compressed.
+  const string option(100, 'x');
+  const string message = "Unsupported option " + option;
+  SendRequestAndExpectCompressedResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x6f" "\x00\x01" "\x00\x64") +
+          option + BINARY_STRING("\x00\x05" "3.0.0"),
+      compression_scheme,
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x7d" "\x00\x00\x00\x0a" "\x00\x77") +
+          message);
+}
+
 // The following test cases test the CQL protocol marshalling/unmarshalling with hand-coded
 // request messages and expected responses. They are good as basic and error-handling tests.
 // These are expected to be few.
@@ -154,6 +220,15 @@ TEST_F(TestCQLService, StartupRequest) {
       BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x4f"
                     "\x00\x00\x00\x0a" "\x00\x49"
                     "Protocol version 5 not supported. Supported versions are between 3 and 4."));
+
+  // Send STARTUP request with an unsupported compression
+  SendRequestAndExpectResponse(
+      BINARY_STRING("\x04\x00\x00\x00\x01" "\x00\x00\x00\x15"
+                    "\x00\x01" "\x00\x0b" "COMPRESSION"
+                               "\x00\x04" "zstd"),
+      BINARY_STRING("\x84\x00\x00\x00\x00" "\x00\x00\x00\x22"
+                    "\x00\x00\x00\x0a" "\x00\x1c"
+                    "Unsupported compression zstd"));
 }
 
 TEST_F(TestCQLService, OptionsRequest) {
@@ -161,11 +236,24 @@ TEST_F(TestCQLService, OptionsRequest) {
   // Send OPTIONS request using version V4
   SendRequestAndExpectResponse(
       BINARY_STRING("\x04\x00\x00\x00\x05" "\x00\x00\x00\x00"),
-      BINARY_STRING("\x84\x00\x00\x00\x06" "\x00\x00\x00\x2e"
+      BINARY_STRING("\x84\x00\x00\x00\x06" "\x00\x00\x00\x3b"
                     "\x00\x02" "\x00\x0b" "CQL_VERSION"
                                "\x00\x02" "\x00\x05" "3.0.0" "\x00\x05" "3.4.2"
                                "\x00\x0b" "COMPRESSION"
-                               "\x00\x00"));
+                               "\x00\x02" "\x00\x03" "lz4" "\x00\x06" "snappy"));
+}
+
+TEST_F(TestCQLService, LZ4Compression) {
+  LOG(INFO) << "Test CQL LZ4 compression";
+  // An LZ4 compressed empty body is the 4-byte length 0 followed by an empty literal token.
+  TestCompression("lz4", CQLMessage::CompressionScheme::LZ4,
+                  BINARY_STRING("\x00\x00\x00\x00" "\x00"));
+}
+
+TEST_F(TestCQLService, SnappyCompression) {
+  LOG(INFO) << "Test CQL Snappy compression";
+  // A Snappy compressed empty body is just the varint length 0.
+  TestCompression("snappy", CQLMessage::CompressionScheme::SNAPPY, BINARY_STRING("\x00"));
 }
 
 TEST_F(TestCQLService, InvalidRequest) {
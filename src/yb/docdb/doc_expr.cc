@@ -47,15 +47,62 @@ CHECKED_STATUS DocExprExecutor::EvalTSCall(const QLBCallPB& tscall,
     case bfql::TSOpcode::kAvg: FALLTHROUGH_INTENDED;
     case bfql::TSOpcode::kMin: FALLTHROUGH_INTENDED;
     case bfql::TSOpcode::kMax:
-      // TODO(neil) Call DocDB to execute aggregate functions.
-      // These functions operate across many rows, so some state variables must be kept beyond the
-      // scope of one row. The variable "table_row" is not enough for these operators.
-      LOG(ERROR) << "Failed to execute aggregate function";
+      // These functions operate across many rows and are evaluated by EvalAggregate().
+      LOG(ERROR) << "Aggregate function evaluated for a single row";
   }
 
   result->SetNull();
   return STATUS(RuntimeError, "Only tablet server can execute this operator");
 }
 
+CHECKED_STATUS DocExprExecutor::EvalAggregate(const QLExpressionPB& ql_expr,
+                                              const QLTableRow& table_row,
+                                              QLValueWithPB *aggr_value) {
+  if (ql_expr.expr_case() != QLExpressionPB::ExprCase::kTscall) {
+    return STATUS(RuntimeError,
+                  "Only aggregate functions can be selected with aggregate functions");
+  }
+  const QLBCallPB& tscall = ql_expr.tscall();
+  const bfql::TSOpcode tsopcode = static_cast<bfql::TSOpcode>(tscall.opcode());
+
+  // COUNT(*) has no argument and counts every row. Otherwise, null arguments are skipped.
+  QLValueWithPB value;
+  if (tscall.operands().empty()) {
+    value.set_int64_value(1);
+  } else {
+    DCHECK_EQ(tscall.operands().size(), 1) << "Aggregate functions take only one argument";
+    RETURN_NOT_OK(EvalExpr(tscall.operands(0), table_row, &value));
+  }
+  if (value.IsNull()) {
+    return Status::OK();
+  }
+
+  switch (tsopcode) {
+    case bfql::TSOpcode::kCount: {
+      QLValueWithPB one;
+      one.set_int64_value(1);
+      return CombineAggregate(tsopcode, one.value(), aggr_value->mutable_value());
+    }
+
+    case bfql::TSOpcode::kSum: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kMin: FALLTHROUGH_INTENDED;
+    case bfql::TSOpcode::kMax:
+      return CombineAggregate(tsopcode, value.value(), aggr_value->mutable_value());
+
+    case bfql::TSOpcode::kAvg: {
+      // AVG is computed by the client from the SUM and COUNT of its argument. Only the SUM, in the
+      // wider datatype of AverageSumDataType(), is evaluated here.
+      QLValueWithPB sum;
+      RETURN_NOT_OK(AverageSumValue(value.value(), sum.mutable_value()));
+      return CombineAggregate(bfql::TSOpcode::kSum, sum.value(), aggr_value->mutable_value());
+    }
+
+    default:
+      break;
+  }
+  return STATUS_SUBSTITUTE(RuntimeError, "Aggregate function opcode $0 cannot be evaluated",
+                           tscall.opcode());
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -26,6 +26,12 @@ class DocExprExecutor : public QLExprExecutor {
   virtual CHECKED_STATUS EvalTSCall(const QLBCallPB& ql_expr,
                                     const QLTableRow& column_map,
                                     QLValueWithPB *result) override;
+
+  // Evaluate a call to an aggregate function for one more row, accumulating the argument in the
+  // running result of the function.
+  CHECKED_STATUS EvalAggregate(const QLExpressionPB& ql_expr,
+                               const QLTableRow& column_map,
+                               QLValueWithPB *aggr_value);
 };
 
 } // namespace docdb
@@ -34,6 +34,7 @@
 DECLARE_uint64(rocksdb_max_file_size_for_compaction);
 DECLARE_int32(rocksdb_level0_slowdown_writes_trigger);
 DECLARE_int32(rocksdb_level0_stop_writes_trigger);
+DECLARE_bool(redis_maintain_collection_cardinality);
 
 using namespace std::literals; // NOLINT
 
@@ -223,6 +224,72 @@ SubDocKey(DocKey(0x0000, [1], []), [ColumnId(3); HT(Max, w=2)]) -> 4
     }
     return row_block;
   }
+
+  static constexpr uint32_t kRedisHashCode = 123;
+
+  // Applies HSET of the given fields of the Redis hash 'key' to 'doc_write_batch', reading the
+  // existing hash at 'read_time'. A 'ttl_ms' of 0 writes the fields without a TTL.
+  void ApplyRedisHSet(const string& key, const vector<string>& fields, HybridTime read_time,
+                      DocWriteBatch* doc_write_batch, int64_t ttl_ms = 0,
+                      bool key_shared_in_batch = false) {
+    RedisWriteRequestPB request;
+    auto* set_request = request.mutable_set_request();
+    if (ttl_ms != 0) {
+      set_request->set_ttl(ttl_ms);
+    }
+    auto* kv = request.mutable_key_value();
+    kv->set_key(key);
+    kv->set_hash_code(kRedisHashCode);
+    kv->set_type(REDIS_TYPE_HASH);
+    for (const auto& field : fields) {
+      kv->add_subkey(field);
+      kv->add_value("v_" + field);
+    }
+    RedisWriteOperation op(&request);
+    if (key_shared_in_batch) {
+      op.set_key_shared_in_batch();
+    }
+    ASSERT_OK(op.Apply(doc_write_batch, rocksdb(), read_time));
+  }
+
+  void WriteRedisHSet(const string& key, const vector<string>& fields, HybridTime write_time,
+                      int64_t ttl_ms = 0) {
+    DocWriteBatch doc_write_batch(rocksdb());
+    ApplyRedisHSet(key, fields, write_time, &doc_write_batch, ttl_ms);
+    ASSERT_OK(WriteToRocksDB(doc_write_batch, write_time));
+  }
+
+  // Returns the HLEN of the Redis hash 'key' at 'read_time'.
+  int64_t RedisHLen(const string& key, HybridTime read_time) {
+    RedisReadRequestPB request;
+    request.mutable_get_request()->set_request_type(RedisGetRequestPB_GetRequestType_HLEN);
+    auto* kv = request.mutable_key_value();
+    kv->set_key(key);
+    kv->set_hash_code(kRedisHashCode);
+    kv->set_type(REDIS_TYPE_HASH);
+    RedisReadOperation op(request);
+    EXPECT_OK(op.Execute(rocksdb(), read_time));
+    EXPECT_EQ(RedisResponsePB_RedisStatusCode_OK, op.response().code());
+    return op.response().int_response();
+  }
+
+  // Reads the element count stored for the Redis hash 'key' at 'read_time'.
+  void ReadStoredRedisCardinality(const string& key, HybridTime read_time,
+                                  SubDocument* result, bool* found) {
+    SubDocKey subdoc_key(DocKey::FromRedisKey(kRedisHashCode, key),
+                         PrimitiveValue::SystemColumnId(SystemColumnIds::kRedisCardinality));
+    ASSERT_OK(GetSubDocument(
+        rocksdb(), subdoc_key, result, found, rocksdb::kDefaultQueryId, read_time));
+  }
+
+  void AssertStoredRedisCardinality(const string& key, HybridTime read_time, int64_t expected) {
+    SubDocument count;
+    bool found = false;
+    ReadStoredRedisCardinality(key, read_time, &count, &found);
+    ASSERT_TRUE(found);
+    ASSERT_EQ(ValueType::kInt64, count.value_type());
+    ASSERT_EQ(expected, count.GetInt64());
+  }
 };
 
 TEST_F(DocOperationTest, TestRedisSetKVWithTTL) {
@@ -234,9 +301,9 @@ TEST_F(DocOperationTest, TestRedisSetKVWithTTL) {
   redis_write_operation_pb.mutable_key_value()->set_key("abc");
   redis_write_operation_pb.mutable_key_value()->set_hash_code(123);
   redis_write_operation_pb.mutable_key_value()->add_value("xyz");
-  RedisWriteOperation redis_write_operation(&redis_write_operation_pb, HybridTime::kMax);
+  RedisWriteOperation redis_write_operation(&redis_write_operation_pb);
   DocWriteBatch doc_write_batch(db);
-  ASSERT_OK(redis_write_operation.Apply(&doc_write_batch, db, HybridTime()));
+  ASSERT_OK(redis_write_operation.Apply(&doc_write_batch, db, HybridTime::kMax));
 
   ASSERT_OK(WriteToRocksDB(doc_write_batch, HybridTime::FromMicros(1000)));
 
@@ -254,6 +321,147 @@ TEST_F(DocOperationTest, TestRedisSetKVWithTTL) {
   EXPECT_EQ(2000, ttl.ToMilliseconds());
 }
 
+TEST_F(DocOperationTest, TestRedisHashCardinality) {
+  WriteRedisHSet("h", {"a", "b"}, HybridTime::FromMicros(1000));
+  // One new field and one that exists already.
+  WriteRedisHSet("h", {"b", "c"}, HybridTime::FromMicros(2000));
+  ASSERT_NO_FATALS(AssertStoredRedisCardinality("h", HybridTime::FromMicros(2000), 3));
+  ASSERT_EQ(3, RedisHLen("h", HybridTime::FromMicros(2000)));
+  ASSERT_EQ(2, RedisHLen("h", HybridTime::FromMicros(1500)));
+}
+
+TEST_F(DocOperationTest, TestRedisHashCardinalitySameKeyInBatch) {
+  WriteRedisHSet("h", {"a"}, HybridTime::FromMicros(1000));
+
+  // Both operations read the hash as of before the batch, so they drop the count instead of each
+  // adding its own fields to it.
+  DocWriteBatch doc_write_batch(rocksdb());
+  const HybridTime write_time = HybridTime::FromMicros(2000);
+  ApplyRedisHSet("h", {"b"}, write_time, &doc_write_batch, 0, true /* key_shared_in_batch */);
+  ApplyRedisHSet("h", {"c"}, write_time, &doc_write_batch, 0, true /* key_shared_in_batch */);
+  ASSERT_OK(WriteToRocksDB(doc_write_batch, write_time));
+
+  SubDocument count;
+  bool found = true;
+  ReadStoredRedisCardinality("h", write_time, &count, &found);
+  ASSERT_FALSE(found);
+  ASSERT_EQ(3, RedisHLen("h", write_time));
+
+  // The next write counts the elements again.
+  WriteRedisHSet("h", {"d"}, HybridTime::FromMicros(3000));
+  ASSERT_NO_FATALS(AssertStoredRedisCardinality("h", HybridTime::FromMicros(3000), 4));
+  ASSERT_EQ(4, RedisHLen("h", HybridTime::FromMicros(3000)));
+}
+
+TEST_F(DocOperationTest, TestRedisHashCardinalityWithTTL) {
+  // Fields written at 1ms with a TTL of 1s expire at 1.001s.
+  WriteRedisHSet("h", {"a", "b"}, HybridTime::FromMicros(1000), 1000 /* ttl_ms */);
+  WriteRedisHSet("h", {"c"}, HybridTime::FromMicros(2000));
+
+  // The hash opted out of the count, and fields written without a TTL later do not bring it back.
+  SubDocument count;
+  bool found = false;
+  ReadStoredRedisCardinality("h", HybridTime::FromMicros(2000), &count, &found);
+  ASSERT_TRUE(found);
+  ASSERT_EQ(ValueType::kNull, count.value_type());
+
+  ASSERT_EQ(3, RedisHLen("h", HybridTime::FromMicros(2000)));
+  ASSERT_EQ(1, RedisHLen("h", HybridTime::FromMicros(2000000)));
+}
+
+TEST_F(DocOperationTest, TestRedisHashCardinalityLegacyRecount) {
+  // A hash written before element counts were maintained has no count.
+  {
+    DocWriteBatch doc_write_batch(rocksdb());
+    SubDocument hash;
+    hash.SetChild(PrimitiveValue("a"), SubDocument(PrimitiveValue("v_a")));
+    hash.SetChild(PrimitiveValue("b"), SubDocument(PrimitiveValue("v_b")));
+    ASSERT_OK(doc_write_batch.InsertSubDocument(
+        DocPath::DocPathFromRedisKey(kRedisHashCode, "h"), hash, InitMarkerBehavior::REQUIRED));
+    ASSERT_OK(WriteToRocksDB(doc_write_batch, HybridTime::FromMicros(1000)));
+  }
+  ASSERT_EQ(2, RedisHLen("h", HybridTime::FromMicros(1000)));
+
+  // The first write counts the existing elements once.
+  WriteRedisHSet("h", {"b", "c"}, HybridTime::FromMicros(2000));
+  ASSERT_NO_FATALS(AssertStoredRedisCardinality("h", HybridTime::FromMicros(2000), 3));
+  ASSERT_EQ(3, RedisHLen("h", HybridTime::FromMicros(2000)));
+
+  // Writes done while counts are not maintained make the hash count its elements on read.
+  FLAGS_redis_maintain_collection_cardinality = false;
+  WriteRedisHSet("h", {"d"}, HybridTime::FromMicros(3000));
+  FLAGS_redis_maintain_collection_cardinality = true;
+  WriteRedisHSet("h", {"e"}, HybridTime::FromMicros(4000));
+  ASSERT_EQ(5, RedisHLen("h", HybridTime::FromMicros(4000)));
+}
+
+TEST_F(DocOperationTest, TestRedisGetsInBatch) {
+  const HybridTime write_time = HybridTime::FromMicros(1000);
+  {
+    DocWriteBatch doc_write_batch(rocksdb());
+    for (const string& key : {"a", "b"}) {
+      RedisWriteRequestPB request;
+      request.mutable_set_request();
+      auto* kv = request.mutable_key_value();
+      kv->set_key(key);
+      kv->set_hash_code(kRedisHashCode);
+      kv->set_type(REDIS_TYPE_STRING);
+      kv->add_value("v_" + key);
+      RedisWriteOperation op(&request);
+      ASSERT_OK(op.Apply(&doc_write_batch, rocksdb(), write_time));
+    }
+    ASSERT_OK(WriteToRocksDB(doc_write_batch, write_time));
+  }
+  WriteRedisHSet("h", {"f"}, write_time);
+
+  // GETs of a string, a missing key and a hash, HGETs of a present and a missing field, in an
+  // order that differs from the one of the keys.
+  const vector<std::pair<string, string>> keys = {
+      {"b", ""}, {"x", ""}, {"h", "f"}, {"a", ""}, {"h", ""}, {"h", "g"}, {"b", ""}};
+  vector<RedisReadRequestPB> requests(keys.size());
+  vector<const RedisReadRequestPB*> request_ptrs;
+  for (size_t i = 0; i != keys.size(); ++i) {
+    auto& request = requests[i];
+    auto* kv = request.mutable_key_value();
+    kv->set_key(keys[i].first);
+    kv->set_hash_code(kRedisHashCode);
+    if (keys[i].second.empty()) {
+      request.mutable_get_request()->set_request_type(RedisGetRequestPB_GetRequestType_GET);
+    } else {
+      request.mutable_get_request()->set_request_type(RedisGetRequestPB_GetRequestType_HGET);
+      kv->add_subkey(keys[i].second);
+    }
+    ASSERT_TRUE(RedisReadOperation::IsBatchableGet(request));
+    request_ptrs.push_back(&request);
+  }
+
+  vector<RedisResponsePB> responses;
+  ASSERT_OK(RedisReadOperation::ExecuteGets(rocksdb(), write_time, request_ptrs, &responses));
+  ASSERT_EQ(keys.size(), responses.size());
+
+  // Responses must match the ones of executing every request separately.
+  for (size_t i = 0; i != keys.size(); ++i) {
+    RedisReadOperation op(requests[i]);
+    ASSERT_OK(op.Execute(rocksdb(), write_time));
+    ASSERT_EQ(op.response().ShortDebugString(), responses[i].ShortDebugString()) << "Request " << i;
+  }
+
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_OK, responses[0].code());
+  ASSERT_EQ("v_b", responses[0].string_response());
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_NOT_FOUND, responses[1].code());
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_OK, responses[2].code());
+  ASSERT_EQ("v_f", responses[2].string_response());
+  ASSERT_EQ("v_a", responses[3].string_response());
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_WRONG_TYPE, responses[4].code());
+  ASSERT_EQ(RedisResponsePB_RedisStatusCode_NOT_FOUND, responses[5].code());
+  ASSERT_EQ("v_b", responses[6].string_response());
+
+  RedisReadRequestPB hgetall;
+  hgetall.mutable_get_request()->set_request_type(RedisGetRequestPB_GetRequestType_HGETALL);
+  hgetall.mutable_key_value()->set_key("h");
+  ASSERT_FALSE(RedisReadOperation::IsBatchableGet(hgetall));
+}
+
 TEST_F(DocOperationTest, TestQLInsertWithTTL) {
   RunTestQLInsertUpdate(QLWriteRequestPB_QLStmtType_QL_STMT_INSERT, 2000);
 }
@@ -26,6 +26,7 @@
 #include "yb/docdb/subdocument.h"
 #include "yb/server/hybrid_clock.h"
 #include "yb/gutil/strings/substitute.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/trace.h"
 
 DECLARE_bool(trace_docdb_calls);
@@ -39,6 +40,14 @@ DEFINE_bool(emulate_redis_responses,
     "and HDEL. If emulate_redis_responses is true, we read the required records to compute the "
     "response as specified by the official Redis API documentation. https://redis.io/commands");
 
+DEFINE_bool(redis_maintain_collection_cardinality,
+    true,
+    "Maintain the number of elements of Redis hashes and sets on every write, so that HLEN and "
+    "SCARD are served by a single point read. Writes done while this is false make the "
+    "collections they modify fall back to counting their elements on HLEN and SCARD.");
+TAG_FLAG(redis_maintain_collection_cardinality, advanced);
+TAG_FLAG(redis_maintain_collection_cardinality, runtime);
+
 namespace yb {
 namespace docdb {
 
@@ -112,6 +121,23 @@ Status GetRedisValueType(
   }
 }
 
+void RedisValueFromSubDocument(
+    const SubDocument& doc, bool doc_found, RedisDataType *type, string *value) {
+  if (!doc_found) {
+    *type = REDIS_TYPE_NONE;
+    *value = "";
+    return;
+  }
+
+  if (!doc.IsPrimitive()) {
+    *type = REDIS_TYPE_HASH;
+    return;
+  }
+
+  *type = REDIS_TYPE_STRING;
+  *value = doc.GetString();
+}
+
 Status GetRedisValue(
     rocksdb::DB *rocksdb,
     HybridTime hybrid_time,
@@ -139,22 +165,76 @@ Status GetRedisValue(
   RETURN_NOT_OK(GetSubDocument(rocksdb, doc_key, &doc, &doc_found,
                                rocksdb::kDefaultQueryId, hybrid_time));
 
-  if (!doc_found) {
-    *type = REDIS_TYPE_NONE;
-    *value = "";
-    return Status::OK();
-  }
+  RedisValueFromSubDocument(doc, doc_found, type, value);
+  return Status::OK();
+}
 
-  if (!doc.IsPrimitive()) {
-    *type = REDIS_TYPE_HASH;
-    return Status::OK();
+// Element count of a Redis hash or set is stored as a system column of the collection, so that it
+// is removed together with the collection.
+PrimitiveValue RedisCardinalitySubKey() {
+  return PrimitiveValue::SystemColumnId(SystemColumnIds::kRedisCardinality);
+}
+
+// Number of elements of a Redis hash or set read by GetSubDocument.
+int64_t RedisCollectionSize(const SubDocument& doc) {
+  int64_t result = 0;
+  for (const auto& entry : doc.object_container()) {
+    if (entry.first.value_type() != ValueType::kSystemColumnId) {
+      ++result;
+    }
   }
+  return result;
+}
 
-  *type = REDIS_TYPE_STRING;
-  *value = doc.GetString();
+// Counts the elements of the Redis hash or set 'key_value_pb' refers to by reading all of them.
+Status CountRedisCollectionElements(
+    rocksdb::DB *rocksdb,
+    const HybridTime& hybrid_time,
+    const RedisKeyValuePB &key_value_pb,
+    int64_t* cardinality) {
+  SubDocKey doc_key(DocKey::FromRedisKey(key_value_pb.hash_code(), key_value_pb.key()));
+  SubDocument doc;
+  bool doc_found = false;
+  RETURN_NOT_OK(GetSubDocument(
+      rocksdb, doc_key, &doc, &doc_found, rocksdb::kDefaultQueryId, hybrid_time));
+  *cardinality = doc_found ? RedisCollectionSize(doc) : 0;
+  return Status::OK();
+}
+
+// Reads the element count maintained for the Redis hash or set 'key_value_pb' refers to.
+// 'value_type' is set to kInt64 if the count is maintained, kNull if the collection has opted out
+// of it and kInvalidValueType if the collection was written before counts were maintained.
+Status GetRedisCardinality(
+    rocksdb::DB *rocksdb,
+    const HybridTime& hybrid_time,
+    const RedisKeyValuePB &key_value_pb,
+    ValueType* value_type,
+    int64_t* cardinality) {
+  SubDocKey subdoc_key(DocKey::FromRedisKey(key_value_pb.hash_code(), key_value_pb.key()),
+                       RedisCardinalitySubKey());
+  SubDocument doc;
+  bool doc_found = false;
+  RETURN_NOT_OK(GetSubDocument(
+      rocksdb, subdoc_key, &doc, &doc_found, rocksdb::kDefaultQueryId, hybrid_time));
+  *value_type = ValueType::kInvalidValueType;
+  if (doc_found) {
+    if (doc.value_type() == ValueType::kInt64) {
+      *value_type = ValueType::kInt64;
+      *cardinality = doc.GetInt64();
+    } else if (doc.value_type() == ValueType::kNull) {
+      *value_type = ValueType::kNull;
+    }
+  }
   return Status::OK();
 }
 
+// Whether writing collection elements with the given TTL keeps the element count of the collection
+// maintained. Expired elements are removed without a write, so collections with elements that
+// expire count their elements on read.
+bool MaintainsRedisCardinality(const MonoDelta& ttl) {
+  return FLAGS_redis_maintain_collection_cardinality && ttl.Equals(Value::kMaxTtl);
+}
+
 // Set response based on the type match. Return whether the type matches what's expected.
 bool VerifyTypeAndSetCode(
     const RedisDataType expected_type,
@@ -191,6 +271,7 @@ bool VerifyTypeAndSetCode(
 
 Status RedisWriteOperation::Apply(
     DocWriteBatch* doc_write_batch, rocksdb::DB *rocksdb, const HybridTime& hybrid_time) {
+  read_hybrid_time_ = hybrid_time;
   switch (request_.request_case()) {
     case RedisWriteRequestPB::RequestCase::kSetRequest:
       return ApplySet(doc_write_batch);
@@ -240,16 +321,27 @@ Status RedisWriteOperation::ApplySet(DocWriteBatch* doc_write_batch) {
           hash_set_entries.SetChild(
               PrimitiveValue(kv.subkey(i)), SubDocument(PrimitiveValue(kv.value(i))));
         }
-        if (kv.subkey_size() == 1 && FLAGS_emulate_redis_responses) {
-          RedisDataType type;
-          RETURN_NOT_OK(GetRedisValueType(
-              doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, 0));
+        const bool emulate_response = kv.subkey_size() == 1 && FLAGS_emulate_redis_responses;
+        int num_new_keys = kv.subkey_size();
+        if (data_type != REDIS_TYPE_NONE &&
+            (emulate_response || MaintainsRedisCardinality(ttl))) {
+          for (int i = 0; i < kv.subkey_size(); i++) {
+            RedisDataType type;
+            RETURN_NOT_OK(GetRedisValueType(
+                doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, i));
+            if (type != REDIS_TYPE_NONE) {
+              num_new_keys--;
+            }
+          }
+        }
+        if (emulate_response) {
           // For HSET, we return 0 or 1 depending on if the key already existed.
           // If flag is false, no int response is returned.
-          response_.set_int_response(type == REDIS_TYPE_NONE ? 1 : 0);
+          response_.set_int_response(num_new_keys);
         }
         RETURN_NOT_OK(doc_write_batch->ExtendSubDocument(
             doc_path, hash_set_entries, InitMarkerBehavior::REQUIRED, ttl));
+        RETURN_NOT_OK(UpdateCardinality(doc_write_batch, data_type, num_new_keys, ttl));
         break;
       }
       case REDIS_TYPE_STRING: {
@@ -352,7 +444,7 @@ Status RedisWriteOperation::ApplyDel(DocWriteBatch* doc_write_batch) {
     num_keys = data_type == REDIS_TYPE_NONE ? 0 : 1;
   } else {
     num_keys = kv.subkey_size(); // We know the subkeys are distinct.
-    if (FLAGS_emulate_redis_responses) {
+    if (FLAGS_emulate_redis_responses || MaintainsRedisCardinality(Value::kMaxTtl)) {
       for (int i = 0; i < kv.subkey_size(); i++) {
         RedisDataType type;
         RETURN_NOT_OK(GetRedisValueType(
@@ -372,6 +464,10 @@ Status RedisWriteOperation::ApplyDel(DocWriteBatch* doc_write_batch) {
   }
   DocPath doc_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
   RETURN_NOT_OK(doc_write_batch->ExtendSubDocument(doc_path, values, InitMarkerBehavior::REQUIRED));
+  if ((kv.type() == REDIS_TYPE_HASH || kv.type() == REDIS_TYPE_SET) &&
+      data_type != REDIS_TYPE_NONE) {
+    RETURN_NOT_OK(UpdateCardinality(doc_write_batch, data_type, -num_keys, Value::kMaxTtl));
+  }
   response_.set_code(RedisResponsePB_RedisStatusCode_OK);
   if (FLAGS_emulate_redis_responses) {
     // If the flag is true, we respond with the number of keys actually being deleted.
@@ -479,10 +575,11 @@ Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
 
   SubDocument set_entries = SubDocument();
 
+  const bool check_keys = data_type != REDIS_TYPE_NONE &&
+      (FLAGS_emulate_redis_responses || MaintainsRedisCardinality(Value::kMaxTtl));
   for (int i = 0 ; i < kv.subkey_size(); i++) { // We know that each subkey is distinct.
-    if (FLAGS_emulate_redis_responses) {
+    if (check_keys) {
       RedisDataType type;
-      string value;
       RETURN_NOT_OK(GetRedisValueType(doc_write_batch->rocksdb(), read_hybrid_time_, kv, &type, i));
       if (type != REDIS_TYPE_NONE) {
         num_keys_found++;
@@ -504,6 +601,8 @@ Status RedisWriteOperation::ApplyAdd(DocWriteBatch* doc_write_batch) {
     RETURN_NOT_OK(
         doc_write_batch->ExtendSubDocument(doc_path, set_entries, InitMarkerBehavior::REQUIRED));
   }
+  RETURN_NOT_OK(UpdateCardinality(
+      doc_write_batch, data_type, kv.subkey_size() - num_keys_found, Value::kMaxTtl));
 
   response_.set_code(RedisResponsePB_RedisStatusCode_OK);
   if (FLAGS_emulate_redis_responses) {
@@ -517,6 +616,39 @@ Status RedisWriteOperation::ApplyRemove(DocWriteBatch* doc_write_batch) {
   return STATUS(NotSupported, "Redis operation has not been implemented");
 }
 
+Status RedisWriteOperation::UpdateCardinality(
+    DocWriteBatch* doc_write_batch, RedisDataType data_type, int64_t delta, const MonoDelta& ttl) {
+  const RedisKeyValuePB& kv = request_.key_value();
+  DocPath cardinality_path = DocPath::DocPathFromRedisKey(kv.hash_code(), kv.key());
+  cardinality_path.AddSubKey(RedisCardinalitySubKey());
+  if (!MaintainsRedisCardinality(ttl)) {
+    return doc_write_batch->SetPrimitive(
+        cardinality_path, PrimitiveValue(ValueType::kNull), InitMarkerBehavior::OPTIONAL);
+  }
+
+  int64_t cardinality = 0;
+  ValueType value_type = ValueType::kInt64;
+  if (data_type != REDIS_TYPE_NONE) {
+    RETURN_NOT_OK(GetRedisCardinality(
+        doc_write_batch->rocksdb(), read_hybrid_time_, kv, &value_type, &cardinality));
+    if (value_type == ValueType::kNull) {
+      return Status::OK();
+    }
+  }
+  if (key_shared_in_batch_) {
+    return doc_write_batch->SetPrimitive(
+        cardinality_path, PrimitiveValue(ValueType::kTombstone), InitMarkerBehavior::OPTIONAL);
+  }
+  if (value_type == ValueType::kInvalidValueType) {
+    // The collection was written before its element count was maintained, so count its elements
+    // once. The changes of this operation are not applied yet, so they are not counted.
+    RETURN_NOT_OK(CountRedisCollectionElements(
+        doc_write_batch->rocksdb(), read_hybrid_time_, kv, &cardinality));
+  }
+  return doc_write_batch->SetPrimitive(
+      cardinality_path, PrimitiveValue(cardinality + delta), InitMarkerBehavior::OPTIONAL);
+}
+
 const RedisResponsePB& RedisWriteOperation::response() { return response_; }
 
 Status RedisReadOperation::Execute(rocksdb::DB *rocksdb, const HybridTime& hybrid_time) {
@@ -549,6 +681,10 @@ void PopulateResponseFrom(const SubDocument::ObjectContainer &key_values,
   for (auto iter = key_values.begin(); iter != key_values.end(); iter++) {
     const PrimitiveValue& first = iter->first;
     const PrimitiveValue& second = iter->second;
+    if (first.value_type() == ValueType::kSystemColumnId) {
+      // Skip the element count maintained for the collection.
+      continue;
+    }
     if (add_keys) response->mutable_array_response()->add_elements(first.GetString());
     if (add_values) response->mutable_array_response()->add_elements(second.GetString());
   }
@@ -576,12 +712,38 @@ Status RedisReadOperation::ExecuteHGetAllLikeCommands(rocksdb::DB *rocksdb,
     if (add_keys || add_values) {
       PopulateResponseFrom(doc.object_container(), &response_, add_keys, add_values);
     } else {
-      response_.set_int_response(doc.object_container().size());
+      response_.set_int_response(RedisCollectionSize(doc));
     }
   }
   return Status::OK();
 }
 
+Status RedisReadOperation::ExecuteCardinality(rocksdb::DB *rocksdb,
+                                              HybridTime hybrid_time,
+                                              RedisDataType data_type) {
+  RedisDataType type;
+  RETURN_NOT_OK(GetRedisValueType(rocksdb, hybrid_time, request_.key_value(), &type));
+  if (!VerifyTypeAndSetCode(data_type, type, &response_, true)) {
+    // We've already set the error code in the response.
+    return Status::OK();
+  }
+  if (type == REDIS_TYPE_NONE) {
+    response_.set_int_response(0);
+    return Status::OK();
+  }
+
+  ValueType value_type;
+  int64_t cardinality = 0;
+  RETURN_NOT_OK(GetRedisCardinality(
+      rocksdb, hybrid_time, request_.key_value(), &value_type, &cardinality));
+  if (value_type != ValueType::kInt64) {
+    RETURN_NOT_OK(CountRedisCollectionElements(
+        rocksdb, hybrid_time, request_.key_value(), &cardinality));
+  }
+  response_.set_int_response(cardinality);
+  return Status::OK();
+}
+
 Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
 
   RedisDataType type;
@@ -630,14 +792,23 @@ Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_ti
           return Status::OK();
       }
 
+      // Read all the fields with a single iterator instead of creating a new one per subkey.
+      const auto& key_value = request_.key_value();
+      const DocKey doc_key = DocKey::FromRedisKey(key_value.hash_code(), key_value.key());
+      std::vector<SubDocKey> subdoc_keys;
+      subdoc_keys.reserve(key_value.subkey_size());
+      for (const auto& subkey : key_value.subkey()) {
+        subdoc_keys.emplace_back(doc_key, PrimitiveValue(subkey));
+      }
+      std::vector<SubDocument> docs;
+      std::vector<bool> docs_found;
+      RETURN_NOT_OK(GetSubDocuments(
+          rocksdb, subdoc_keys, &docs, &docs_found, rocksdb::kDefaultQueryId, hybrid_time));
+
       response_.set_allocated_array_response(new RedisArrayPB());
-      for (int i = 0; i < request_.key_value().subkey_size(); i++) {
-        // TODO: ENG-1803: It is inefficient to create a new iterator for each subkey causing a
-        // new seek. Consider reusing the same iterator.
-        string value;
-        RETURN_NOT_OK(GetRedisValue(rocksdb, hybrid_time, request_.key_value(), &type, &value, i));
-        if (type == REDIS_TYPE_STRING) {
-          response_.mutable_array_response()->add_elements(value);
+      for (size_t i = 0; i != docs.size(); ++i) {
+        if (docs_found[i] && docs[i].IsPrimitive()) {
+          response_.mutable_array_response()->add_elements(docs[i].GetString());
         } else {
           response_.mutable_array_response()->add_elements(""); // Empty is nil response.
         }
@@ -652,11 +823,11 @@ Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_ti
     case RedisGetRequestPB_GetRequestType_HVALS:
       return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kObject, false, true);
     case RedisGetRequestPB_GetRequestType_HLEN:
-      return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kObject, false, false);
+      return ExecuteCardinality(rocksdb, hybrid_time, REDIS_TYPE_HASH);
     case RedisGetRequestPB_GetRequestType_SMEMBERS:
       return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kRedisSet, true, false);
     case RedisGetRequestPB_GetRequestType_SCARD:
-      return ExecuteHGetAllLikeCommands(rocksdb, hybrid_time, ValueType::kRedisSet, false, false);
+      return ExecuteCardinality(rocksdb, hybrid_time, REDIS_TYPE_SET);
     case RedisGetRequestPB_GetRequestType_UNKNOWN: {
       return STATUS(InvalidCommand, "Unknown Get Request not supported");
     }
@@ -664,6 +835,54 @@ Status RedisReadOperation::ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_ti
   return Status::OK();
 }
 
+bool RedisReadOperation::IsBatchableGet(const RedisReadRequestPB& request) {
+  if (request.request_case() != RedisReadRequestPB::RequestCase::kGetRequest ||
+      !request.key_value().has_key()) {
+    return false;
+  }
+  switch (request.get_request().request_type()) {
+    case RedisGetRequestPB_GetRequestType_GET: FALLTHROUGH_INTENDED;
+    case RedisGetRequestPB_GetRequestType_HGET:
+      return request.key_value().subkey_size() <= 1;
+    default:
+      return false;
+  }
+}
+
+Status RedisReadOperation::ExecuteGets(rocksdb::DB *rocksdb,
+                                       HybridTime hybrid_time,
+                                       const std::vector<const RedisReadRequestPB*>& requests,
+                                       std::vector<RedisResponsePB>* responses) {
+  std::vector<SubDocKey> subdoc_keys;
+  subdoc_keys.reserve(requests.size());
+  for (const auto* request : requests) {
+    DCHECK(IsBatchableGet(*request)) << request->ShortDebugString();
+    const auto& key_value = request->key_value();
+    subdoc_keys.emplace_back(DocKey::FromRedisKey(key_value.hash_code(), key_value.key()));
+    if (!key_value.subkey().empty()) {
+      subdoc_keys.back().AppendSubKeysAndMaybeHybridTime(PrimitiveValue(key_value.subkey(0)));
+    }
+  }
+
+  std::vector<SubDocument> docs;
+  std::vector<bool> docs_found;
+  RETURN_NOT_OK(GetSubDocuments(
+      rocksdb, subdoc_keys, &docs, &docs_found, rocksdb::kDefaultQueryId, hybrid_time));
+
+  responses->clear();
+  responses->resize(requests.size());
+  for (size_t i = 0; i != requests.size(); ++i) {
+    RedisDataType type;
+    string value;
+    RedisValueFromSubDocument(docs[i], docs_found[i], &type, &value);
+    // If wrong type, we set the error code in the response.
+    if (VerifyTypeAndSetCode(RedisDataType::REDIS_TYPE_STRING, type, &(*responses)[i])) {
+      (*responses)[i].set_string_response(value);
+    }
+  }
+  return Status::OK();
+}
+
 Status RedisReadOperation::ExecuteStrLen(rocksdb::DB *rocksdb, HybridTime hybrid_time) {
   RedisDataType type;
   string value;
@@ -1200,6 +1419,12 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
   QLTableRow static_row, non_static_row;
   QLTableRow& selected_row = read_distinct_columns ? static_row : non_static_row;
 
+  // Aggregate functions are evaluated over all rows read into one row of partial results.
+  QLRSRow* aggr_row = nullptr;
+  if (request_.is_aggregate()) {
+    aggr_row = resultset->AllocateRSRow(request_.selected_exprs().size());
+  }
+
   // In case when we are continuing a select with a paging state, the static columns for the next
   // row to fetch are not included in the first iterator and we need to fetch them with a separate
   // spec and iterator before beginning the normal fetch below.
@@ -1264,7 +1489,11 @@ Status QLReadOperation::Execute(const common::QLStorageIf& ql_storage,
     bool match = false;
     RETURN_NOT_OK(spec->Match(selected_row, &match));
     if (match) {
-      RETURN_NOT_OK(PopulateResultSet(selected_row, resultset));
+      if (aggr_row != nullptr) {
+        RETURN_NOT_OK(EvalAggregate(selected_row, aggr_row));
+      } else {
+        RETURN_NOT_OK(PopulateResultSet(selected_row, resultset));
+      }
     }
   }
   if (FLAGS_trace_docdb_calls) {
@@ -1293,6 +1522,17 @@ CHECKED_STATUS QLReadOperation::PopulateResultSet(const QLTableRow& table_row,
   return Status::OK();
 }
 
+CHECKED_STATUS QLReadOperation::EvalAggregate(const QLTableRow& table_row, QLRSRow *aggr_row) {
+  DocExprExecutor executor;
+  int rscol_index = 0;
+  for (const QLExpressionPB& expr : request_.selected_exprs()) {
+    RETURN_NOT_OK(executor.EvalAggregate(expr, table_row, aggr_row->rscol(rscol_index)));
+    rscol_index++;
+  }
+
+  return Status::OK();
+}
+
 const QLResponsePB& QLReadOperation::response() const { return response_; }
 
 }  // namespace docdb
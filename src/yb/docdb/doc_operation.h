@@ -66,8 +66,9 @@ class KuduWriteOperation: public DocOperation {
 class RedisWriteOperation: public DocOperation {
  public:
   // Construct a RedisWriteOperation. Content of request will be swapped out by the constructor.
-  RedisWriteOperation(RedisWriteRequestPB* request, HybridTime read_hybrid_time)
-      : response_(), read_hybrid_time_(read_hybrid_time) { request_.Swap(request); }
+  explicit RedisWriteOperation(RedisWriteRequestPB* request) : response_() {
+    request_.Swap(request);
+  }
 
   bool RequireReadSnapshot() const override { return false; }
 
@@ -78,6 +79,11 @@ class RedisWriteOperation: public DocOperation {
 
   const RedisResponsePB &response();
 
+  // Marks that other operations of the same write batch modify the key of this operation. They do
+  // not see the writes of each other, so this operation drops the element count of the collection
+  // instead of updating it, and the next write recomputes it.
+  void set_key_shared_in_batch() { key_shared_in_batch_ = true; }
+
  private:
   Status ApplySet(DocWriteBatch *doc_write_batch);
   Status ApplyGetSet(DocWriteBatch *doc_write_batch);
@@ -91,9 +97,20 @@ class RedisWriteOperation: public DocOperation {
   Status ApplyAdd(DocWriteBatch *doc_write_batch);
   Status ApplyRemove(DocWriteBatch *doc_write_batch);
 
+  // Updates the element count of the hash or set written by this operation. 'data_type' is the type
+  // of the collection before the operation, 'delta' is the number of elements added (negative if
+  // removed) and 'ttl' is the TTL of the written elements.
+  Status UpdateCardinality(DocWriteBatch *doc_write_batch,
+                           RedisDataType data_type,
+                           int64_t delta,
+                           const MonoDelta& ttl);
+
   RedisWriteRequestPB request_;
   RedisResponsePB response_;
+  // Time the existing value of the key is read at. It is the hybrid_time passed to Apply, which the
+  // tablet takes after the locks of the operation are acquired.
   HybridTime read_hybrid_time_;
+  bool key_shared_in_batch_ = false;
 };
 
 class RedisReadOperation {
@@ -104,15 +121,28 @@ class RedisReadOperation {
 
   const RedisResponsePB &response();
 
+  // Whether the request is a GET or HGET of a single value, so that it could be executed by
+  // ExecuteGets together with other such requests.
+  static bool IsBatchableGet(const RedisReadRequestPB& request);
+
+  // Executes batchable GET and HGET requests with a single RocksDB iterator, instead of creating a
+  // new one for every key. Responses are filled in the order of requests.
+  static CHECKED_STATUS ExecuteGets(rocksdb::DB *rocksdb,
+                                    HybridTime hybrid_time,
+                                    const std::vector<const RedisReadRequestPB*>& requests,
+                                    std::vector<RedisResponsePB>* responses);
+
  private:
   int ApplyIndex(int32_t index, const int32_t len);
   Status ExecuteGet(rocksdb::DB *rocksdb, HybridTime hybrid_time);
-  // Used to implement HGETALL, HKEYS, HVALS, SMEMBERS, HLEN, SCARD
+  // Used to implement HGETALL, HKEYS, HVALS, SMEMBERS
   Status ExecuteHGetAllLikeCommands(rocksdb::DB *rocksdb,
                                     HybridTime hybrid_time,
                                     ValueType value_type,
                                     bool add_keys,
                                     bool add_values);
+  // Used to implement HLEN, SCARD
+  Status ExecuteCardinality(rocksdb::DB *rocksdb, HybridTime hybrid_time, RedisDataType data_type);
   Status ExecuteStrLen(rocksdb::DB *rocksdb, HybridTime hybrid_time);
   Status ExecuteExists(rocksdb::DB *rocksdb, HybridTime hybrid_time);
   Status ExecuteGetRange(rocksdb::DB *rocksdb, HybridTime hybrid_time);
@@ -192,6 +222,8 @@ class QLReadOperation {
 
   CHECKED_STATUS PopulateResultSet(const QLTableRow& table_row, QLResultSet *result_set);
 
+  CHECKED_STATUS EvalAggregate(const QLTableRow& table_row, QLRSRow *aggr_row);
+
   const QLResponsePB& response() const;
 
  private:
@@ -1020,6 +1020,43 @@ SubDocKey(DocKey([], ["k1"]), ["s3"; HT(p=2000)]) -> "v3"; ttl: 0.000s
       )#");
 }
 
+TEST_F(DocDBTest, KeyHashRangeCompactionFilter) {
+  // A tablet split from another one covers the hashes [0x4000, 0x8000) of its parent.
+  const KeyHashRange key_hash_range{0x4000, 0x8000};
+  const DocKey below_range(0x3fff, PrimitiveValues("a"));
+  const DocKey range_begin(0x4000, PrimitiveValues("b"));
+  const DocKey range_last(0x7fff, PrimitiveValues("c"));
+  const DocKey range_end(0x8000, PrimitiveValues("d"));
+  const DocKey without_hash(PrimitiveValues("e"));
+
+  ASSERT_TRUE(KeyHashRange().IsFull());
+  ASSERT_FALSE(key_hash_range.IsFull());
+  ASSERT_FALSE(key_hash_range.Contains(below_range.Encode().AsSlice()));
+  ASSERT_TRUE(key_hash_range.Contains(range_begin.Encode().AsSlice()));
+  ASSERT_TRUE(key_hash_range.Contains(range_last.Encode().AsSlice()));
+  ASSERT_FALSE(key_hash_range.Contains(range_end.Encode().AsSlice()));
+  ASSERT_TRUE(key_hash_range.Contains(without_hash.Encode().AsSlice()));
+
+  // Keys hashing outside of the range are dropped by any compaction, even when they are newer
+  // than the history cutoff.
+  const string value = Value(PrimitiveValue("v")).Encode();
+  for (bool is_full_compaction : {false, true}) {
+    DocDBCompactionFilter filter(HybridTime::FromMicros(1000), nullptr, is_full_compaction,
+                                 MonoDelta::kMax, key_hash_range);
+    auto filter_key = [&filter, &value](const DocKey& doc_key) {
+      const KeyBytes key = SubDocKey(doc_key, HybridTime::FromMicros(2000)).Encode();
+      string new_value;
+      bool value_changed = false;
+      return filter.Filter(0 /* level */, key.AsSlice(), value, &new_value, &value_changed);
+    };
+    ASSERT_TRUE(filter_key(below_range));
+    ASSERT_FALSE(filter_key(range_begin));
+    ASSERT_FALSE(filter_key(range_last));
+    ASSERT_TRUE(filter_key(range_end));
+    ASSERT_FALSE(filter_key(without_hash));
+  }
+}
+
 TEST_F(DocDBTest, BasicTest) {
   // A few points to make it easier to understand the expected binary representations here:
   // - Initial bytes such as '$' (kString), 'I' (kInt64) correspond to members of the enum
@@ -2272,5 +2309,73 @@ SubDocKey(DocKey(0x0000, ["h1"], ["r2"]), ["c8"; HT(p=1000)]) -> "v82"
       )#");
 }
 
+TEST_F(DocDBTest, GetSubDocumentsTest) {
+  DocWriteBatch dwb(rocksdb());
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue(ColumnId(10))),
+      PrimitiveValue("value1"), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1, PrimitiveValue(ColumnId(11))),
+      PrimitiveValue("value11"), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey2, PrimitiveValue(ColumnId(10))),
+      PrimitiveValue("value2"), InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(1000)));
+  ASSERT_OK(dwb.SetPrimitive(
+      DocPath(kEncodedDocKey1), PrimitiveValue(ValueType::kTombstone),
+      InitMarkerBehavior::OPTIONAL));
+  ASSERT_OK(WriteToRocksDBAndClear(&dwb, HybridTime::FromMicros(2000)));
+
+  // Keys are intentionally unsorted and contain duplicates and several subkeys of the same doc.
+  const std::vector<SubDocKey> keys = {
+      SubDocKey(kDocKey2, PrimitiveValue(ColumnId(10))),
+      SubDocKey(kDocKey1, PrimitiveValue(ColumnId(11))),
+      SubDocKey(kDocKey1, PrimitiveValue(ColumnId(12))),
+      SubDocKey(kDocKey1, PrimitiveValue(ColumnId(10))),
+      SubDocKey(kDocKey2, PrimitiveValue(ColumnId(10))),
+  };
+
+  for (int read_time : {1500, 2500}) {
+    std::vector<SubDocument> docs;
+    std::vector<bool> docs_found;
+    ASSERT_OK(GetSubDocuments(rocksdb(), keys, &docs, &docs_found, rocksdb::kDefaultQueryId,
+                              HybridTime::FromMicros(read_time)));
+    ASSERT_EQ(keys.size(), docs.size());
+    ASSERT_EQ(keys.size(), docs_found.size());
+
+    // Results must match the ones produced by reading every key separately.
+    for (size_t i = 0; i != keys.size(); ++i) {
+      SubDocument doc;
+      bool doc_found = false;
+      ASSERT_OK(GetSubDocument(rocksdb(), keys[i], &doc, &doc_found, rocksdb::kDefaultQueryId,
+                               HybridTime::FromMicros(read_time)));
+      ASSERT_EQ(doc_found, docs_found[i]) << "Key: " << keys[i].ToString();
+      if (doc_found) {
+        ASSERT_EQ(doc.ToString(), docs[i].ToString());
+      }
+    }
+  }
+
+  std::vector<SubDocument> docs;
+  std::vector<bool> docs_found;
+  ASSERT_OK(GetSubDocuments(rocksdb(), keys, &docs, &docs_found, rocksdb::kDefaultQueryId,
+                            HybridTime::FromMicros(1500)));
+  ASSERT_TRUE(docs_found[0]);
+  ASSERT_EQ("value2", docs[0].GetString());
+  ASSERT_TRUE(docs_found[1]);
+  ASSERT_EQ("value11", docs[1].GetString());
+  ASSERT_FALSE(docs_found[2]);
+  ASSERT_TRUE(docs_found[3]);
+  ASSERT_EQ("value1", docs[3].GetString());
+
+  ASSERT_OK(GetSubDocuments(rocksdb(), keys, &docs, &docs_found, rocksdb::kDefaultQueryId,
+                            HybridTime::FromMicros(2500)));
+  ASSERT_TRUE(docs_found[0]);
+  ASSERT_FALSE(docs_found[1]);
+  ASSERT_FALSE(docs_found[2]);
+  ASSERT_FALSE(docs_found[3]);
+  ASSERT_TRUE(docs_found[4]);
+}
+
 }  // namespace docdb
 }  // namespace yb
@@ -843,6 +843,62 @@ yb::Status GetSubDocument(rocksdb::DB *db,
       nullptr, return_type_only, false);
 }
 
+yb::Status GetSubDocuments(rocksdb::DB *db,
+    const vector<SubDocKey>& subdocument_keys,
+    vector<SubDocument>* results,
+    vector<bool>* docs_found,
+    const rocksdb::QueryId query_id,
+    HybridTime scan_ht,
+    MonoDelta table_ttl) {
+  const size_t num_keys = subdocument_keys.size();
+  results->clear();
+  results->resize(num_keys);
+  docs_found->assign(num_keys, false);
+  if (num_keys == 0) {
+    return Status::OK();
+  }
+
+  // Sort the keys by their encoded representation, so that we can move the iterator forward.
+  vector<KeyBytes> encoded_keys;
+  encoded_keys.reserve(num_keys);
+  for (const auto& subdocument_key : subdocument_keys) {
+    encoded_keys.push_back(subdocument_key.Encode(/* include_hybrid_time = */ false));
+  }
+  vector<size_t> order(num_keys);
+  for (size_t i = 0; i != num_keys; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&encoded_keys](size_t lhs, size_t rhs) {
+    return encoded_keys[lhs].CompareTo(encoded_keys[rhs]) < 0;
+  });
+
+  // Bloom filters are built on DocKeys, so only distinct DocKeys are checked against them.
+  vector<KeyBytes> doc_keys;
+  for (size_t index : order) {
+    auto doc_key = subdocument_keys[index].doc_key().Encode();
+    if (doc_keys.empty() || doc_keys.back().CompareTo(doc_key) != 0) {
+      doc_keys.push_back(std::move(doc_key));
+    }
+  }
+  auto iter = CreateRocksDBMultiKeyIterator(db, doc_keys, query_id);
+
+  bool first = true;
+  for (size_t index : order) {
+    const SubDocKey& subdocument_key = subdocument_keys[index];
+    // We could only seek forward if the iterator has not entered the document we are about to
+    // read yet. Otherwise its ancestor init markers and tombstones could have been skipped already.
+    const bool can_seek_forward = !first && iter->Valid() &&
+        !iter->key().starts_with(subdocument_key.doc_key().Encode().AsSlice());
+    first = false;
+    bool doc_found = false;
+    RETURN_NOT_OK(GetSubDocument(iter.get(), subdocument_key, &(*results)[index], &doc_found,
+        scan_ht, table_ttl, nullptr /* projection */, false /* return_type_only */,
+        can_seek_forward));
+    (*docs_found)[index] = doc_found;
+  }
+  return Status::OK();
+}
+
 yb::Status GetSubDocument(
     rocksdb::Iterator *rocksdb_iter,
     const SubDocKey& subdocument_key,
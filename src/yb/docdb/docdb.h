@@ -291,6 +291,21 @@ yb::Status GetSubDocument(rocksdb::DB *db,
     MonoDelta table_ttl = Value::kMaxTtl,
     bool return_type_only = false);
 
+// Reads a batch of subdocuments using a single RocksDB iterator, which is cheaper than calling the
+// above version of GetSubDocument for every key. Keys are visited in the order of their encoding
+// and bloom filters are consulted once per SST file for the whole batch. The iterator only moves
+// forward without a full seek when it goes from one DocKey to the next. Subdocuments of the same
+// DocKey, e.g. the fields read by HMGET, each need a full seek, since their ancestors' init markers
+// and tombstones have to be read again. results and docs_found are filled in the order of
+// subdocument_keys.
+yb::Status GetSubDocuments(rocksdb::DB *db,
+    const std::vector<SubDocKey>& subdocument_keys,
+    std::vector<SubDocument>* results,
+    std::vector<bool>* docs_found,
+    const rocksdb::QueryId query_id,
+    HybridTime scan_ts = HybridTime::kMax,
+    MonoDelta table_ttl = Value::kMaxTtl);
+
 // Create a debug dump of the document database. Tries to decode all keys/values despite failures.
 // Reports all errors to the output stream and returns the status of the first failed operation,
 // if any.
@@ -23,6 +23,7 @@
 #include "yb/docdb/doc_key.h"
 #include "yb/docdb/docdb-internal.h"
 #include "yb/docdb/value.h"
+#include "yb/gutil/endian.h"
 #include "yb/rocksutil/yb_rocksdb.h"
 
 using std::shared_ptr;
@@ -36,16 +37,29 @@ namespace docdb {
 
 // ------------------------------------------------------------------------------------------------
 
+bool KeyHashRange::Contains(const rocksdb::Slice& key) const {
+  if (key.size() < sizeof(DocKeyHash) + 1 ||
+      static_cast<ValueType>(key[0]) != ValueType::kUInt16Hash) {
+    return true;
+  }
+  const uint32_t hash = BigEndian::Load16(key.data() + 1);
+  return begin <= hash && hash < end;
+}
+
+// ------------------------------------------------------------------------------------------------
+
 DocDBCompactionFilter::DocDBCompactionFilter(HybridTime history_cutoff,
                                              ColumnIdsPtr deleted_cols,
                                              bool is_full_compaction,
-                                             MonoDelta table_ttl)
+                                             MonoDelta table_ttl,
+                                             KeyHashRange key_hash_range)
     : history_cutoff_(history_cutoff),
       is_full_compaction_(is_full_compaction),
       is_first_key_value_(true),
       filter_usage_logged_(false),
       table_ttl_(table_ttl),
-      deleted_cols_(deleted_cols) {
+      deleted_cols_(deleted_cols),
+      key_hash_range_(key_hash_range) {
 }
 
 DocDBCompactionFilter::~DocDBCompactionFilter() {
@@ -56,6 +70,13 @@ bool DocDBCompactionFilter::Filter(int level,
                                    const rocksdb::Slice& existing_value,
                                    std::string* new_value,
                                    bool* value_changed) const {
+  // Keys left over from the tablet this one was split from are never read, so they are dropped by
+  // any compaction. Since whole documents are dropped, this does not affect the overwrite state
+  // tracked below for the remaining keys.
+  if (!key_hash_range_.IsFull() && !key_hash_range_.Contains(key)) {
+    return true;
+  }
+
   if (!is_full_compaction_) {
     // By default, we only perform history garbage collection on full compactions
     // (or major compactions, in the HBase terminology).
@@ -209,9 +230,10 @@ const char* DocDBCompactionFilter::Name() const {
 // ------------------------------------------------------------------------------------------------
 
 DocDBCompactionFilterFactory::DocDBCompactionFilterFactory(
-    shared_ptr<HistoryRetentionPolicy> retention_policy)
+    shared_ptr<HistoryRetentionPolicy> retention_policy, KeyHashRange key_hash_range)
     :
-    retention_policy_(retention_policy) {
+    retention_policy_(retention_policy),
+    key_hash_range_(key_hash_range) {
 }
 
 DocDBCompactionFilterFactory::~DocDBCompactionFilterFactory() {
@@ -222,7 +244,8 @@ unique_ptr<CompactionFilter> DocDBCompactionFilterFactory::CreateCompactionFilte
   return unique_ptr<DocDBCompactionFilter>(
       new DocDBCompactionFilter(retention_policy_->GetHistoryCutoff(),
                                 retention_policy_->GetDeletedColumns(),
-                                context.is_full_compaction, retention_policy_->GetTableTTL()));
+                                context.is_full_compaction, retention_policy_->GetTableTTL(),
+                                key_hash_range_));
 }
 
 const char* DocDBCompactionFilterFactory::Name() const {
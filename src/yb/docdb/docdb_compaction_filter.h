@@ -27,12 +27,26 @@
 namespace yb {
 namespace docdb {
 
+// The range [begin, end) of the 16-bit hashes of the document keys stored in a tablet. A tablet
+// created by splitting another one starts with all the keys of its parent, and compactions drop
+// those that hash outside of its range.
+struct KeyHashRange {
+  uint32_t begin = 0;
+  uint32_t end = 0x10000;
+
+  bool IsFull() const { return begin == 0 && end == 0x10000; }
+
+  // Whether the given RocksDB key belongs to the range. Keys without a hash always do.
+  bool Contains(const rocksdb::Slice& key) const;
+};
+
 class DocDBCompactionFilter : public rocksdb::CompactionFilter {
  public:
   DocDBCompactionFilter(HybridTime history_cutoff,
                         ColumnIdsPtr deleted_cols,
                         bool is_full_compaction,
-                        MonoDelta table_ttl);
+                        MonoDelta table_ttl,
+                        KeyHashRange key_hash_range = KeyHashRange());
 
   ~DocDBCompactionFilter() override;
   bool Filter(int level,
@@ -100,6 +114,9 @@ class DocDBCompactionFilter : public rocksdb::CompactionFilter {
   MonoDelta table_ttl_;
 
   ColumnIdsPtr deleted_cols_;
+
+  // Keys hashing outside of this range are dropped.
+  const KeyHashRange key_hash_range_;
 };
 
 // A strategy for deciding the history cutoff. We may implement this differently in production and
@@ -139,7 +156,8 @@ class FixedHybridTimeRetentionPolicy : public HistoryRetentionPolicy {
 
 class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy);
+  explicit DocDBCompactionFilterFactory(std::shared_ptr<HistoryRetentionPolicy> retention_policy,
+                                        KeyHashRange key_hash_range = KeyHashRange());
   ~DocDBCompactionFilterFactory() override;
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override;
@@ -147,6 +165,7 @@ class DocDBCompactionFilterFactory : public rocksdb::CompactionFilterFactory {
 
  private:
   std::shared_ptr<HistoryRetentionPolicy> retention_policy_;
+  const KeyHashRange key_hash_range_;
 };
 
 }  // namespace docdb
@@ -13,6 +13,7 @@
 
 #include "yb/docdb/docdb_rocksdb_util.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "yb/rocksdb/rate_limiter.h"
@@ -25,6 +26,7 @@
 #include "yb/rocksutil/yb_rocksdb.h"
 #include "yb/rocksutil/yb_rocksdb_logger.h"
 #include "yb/server/hybrid_clock.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/trace.h"
 #include "yb/util/logging.h"
 
@@ -65,6 +67,17 @@ DEFINE_bool(trace_docdb_calls, false, "Whether we should trace calls into the do
 
 DEFINE_uint64(initial_seqno, 1ULL << 50, "Initial seqno for new RocksDB instances.");
 
+DEFINE_int64(intents_db_write_buffer_size_bytes, 16 * 1024 * 1024,
+             "Size of the memtable of the RocksDB that holds the transaction intents of a tablet. "
+             "Once it is reached, the regular RocksDB of the tablet is flushed, followed by the "
+             "intents RocksDB.");
+TAG_FLAG(intents_db_write_buffer_size_bytes, advanced);
+
+DEFINE_int32(intents_db_level0_file_num_compaction_trigger, 2,
+             "Number of files to trigger compaction of the RocksDB that holds the transaction "
+             "intents of a tablet.");
+TAG_FLAG(intents_db_level0_file_num_compaction_trigger, advanced);
+
 using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
@@ -273,6 +286,49 @@ unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
   return unique_ptr<rocksdb::Iterator>(rocksdb->NewIterator(read_opts));
 }
 
+namespace {
+
+// Accepts an SST file if any of the underlying filters accepts it.
+class AnyOfTableAwareReadFileFilter : public rocksdb::TableAwareReadFileFilter {
+ public:
+  explicit AnyOfTableAwareReadFileFilter(
+      std::vector<shared_ptr<rocksdb::TableAwareReadFileFilter>> filters)
+      : filters_(std::move(filters)) {}
+
+  bool Filter(rocksdb::TableReader* reader) const override {
+    for (const auto& filter : filters_) {
+      if (filter->Filter(reader)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<shared_ptr<rocksdb::TableAwareReadFileFilter>> filters_;
+};
+
+} // namespace
+
+unique_ptr<rocksdb::Iterator> CreateRocksDBMultiKeyIterator(
+    rocksdb::DB* rocksdb,
+    const std::vector<KeyBytes>& user_keys_for_filter,
+    const rocksdb::QueryId query_id) {
+  rocksdb::ReadOptions read_opts;
+  read_opts.query_id = query_id;
+  if (FLAGS_use_docdb_aware_bloom_filter && !user_keys_for_filter.empty()) {
+    const auto& table_factory = rocksdb->GetOptions().table_factory;
+    std::vector<shared_ptr<rocksdb::TableAwareReadFileFilter>> filters;
+    filters.reserve(user_keys_for_filter.size());
+    for (const auto& key : user_keys_for_filter) {
+      filters.push_back(table_factory->NewTableAwareReadFileFilter(read_opts, key.AsSlice()));
+    }
+    read_opts.table_aware_file_filter =
+        std::make_shared<AnyOfTableAwareReadFileFilter>(std::move(filters));
+  }
+  return unique_ptr<rocksdb::Iterator>(rocksdb->NewIterator(read_opts));
+}
+
 void InitRocksDBOptions(
     rocksdb::Options* options, const string& tablet_id,
     const shared_ptr<rocksdb::Statistics>& statistics,
@@ -299,6 +355,7 @@ void InitRocksDBOptions(
     table_options.no_block_cache = true;
     table_options.cache_index_and_filter_blocks = false;
   }
+  table_options.persistent_cache = tablet_options.persistent_cache;
   table_options.block_size = FLAGS_db_block_size_bytes;
 
   // Set our custom bloom filter that is docdb aware.
@@ -335,10 +392,15 @@ void InitRocksDBOptions(
     options->compaction_options_universal.min_merge_width =
         FLAGS_rocksdb_universal_compaction_min_merge_width;
     options->compaction_size_threshold_bytes = FLAGS_rocksdb_compaction_size_threshold_bytes;
-    if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
+    if (tablet_options.rate_limiter) {
+      options->rate_limiter = tablet_options.rate_limiter;
+    } else if (FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec > 0) {
       options->rate_limiter.reset(
           rocksdb::NewGenericRateLimiter(FLAGS_rocksdb_compact_flush_rate_limit_bytes_per_sec));
     }
+    // Compactions are then enabled for a while by CompactRocksDBOp, when the maintenance manager
+    // picks the tablet.
+    options->disable_auto_compactions = tablet_options.schedule_compactions;
   }
 
   uint64_t max_file_size_for_compaction = FLAGS_rocksdb_max_file_size_for_compaction;
@@ -347,5 +409,21 @@ void InitRocksDBOptions(
   }
 }
 
+void SetIntentsRocksDBOptions(rocksdb::Options* options) {
+  // The tablet flushes the intents RocksDB once its memtable reaches the configured size, right
+  // after the regular RocksDB. RocksDB only flushes it by itself if the memtable grows far beyond
+  // that.
+  options->write_buffer_size = static_cast<size_t>(4 * FLAGS_intents_db_write_buffer_size_bytes);
+  // Memtables of the intents RocksDB wait for the regular RocksDB to be flushed, so more of them
+  // are kept before writes stall.
+  options->max_write_buffer_number = std::max(options->max_write_buffer_number, 4);
+  if (options->compaction_style == rocksdb::CompactionStyle::kCompactionStyleUniversal) {
+    options->level0_file_num_compaction_trigger =
+        FLAGS_intents_db_level0_file_num_compaction_trigger;
+    options->compaction_options_universal.min_merge_width =
+        FLAGS_intents_db_level0_file_num_compaction_trigger;
+  }
+}
+
 }  // namespace docdb
 }  // namespace yb
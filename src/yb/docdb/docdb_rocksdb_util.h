@@ -81,6 +81,15 @@ std::unique_ptr<rocksdb::Iterator> CreateRocksDBIterator(
     const rocksdb::QueryId query_id,
     std::shared_ptr<rocksdb::ReadFileFilter> file_filter = nullptr);
 
+// Creates an iterator used to read a batch of keys that may have different hashed components, e.g.
+// for batched point reads. When bloom filters are enabled, an SST file is skipped only if its bloom
+// filter excludes every key in user_keys_for_filter, so each file's filter is consulted once per
+// key when the iterator is created.
+std::unique_ptr<rocksdb::Iterator> CreateRocksDBMultiKeyIterator(
+    rocksdb::DB* rocksdb,
+    const std::vector<KeyBytes>& user_keys_for_filter,
+    const rocksdb::QueryId query_id);
+
 // Initialize the RocksDB 'options' object for tablet identified by 'tablet_id'. The
 // 'statistics' object provided by the caller will be used by RocksDB to maintain
 // the stats for the tablet specified by 'tablet_id'.
@@ -89,6 +98,11 @@ void InitRocksDBOptions(
     const std::shared_ptr<rocksdb::Statistics>& statistics,
     const tablet::TabletOptions& tablet_options);
 
+// Adjusts the options initialized by InitRocksDBOptions for the RocksDB that holds the transaction
+// intents of the tablet. Intents are short-lived, so this RocksDB has its own memtable size and
+// compacts as soon as a few files are flushed, which purges the intents of applied transactions.
+void SetIntentsRocksDBOptions(rocksdb::Options* options);
+
 }  // namespace docdb
 }  // namespace yb
 
@@ -40,7 +40,8 @@ namespace docdb {
 class SubDocument;
 
 enum class SystemColumnIds : ColumnIdRep {
-  kLivenessColumn = 0  // Stores the TTL for QL rows inserted using an INSERT statement.
+  kLivenessColumn = 0,  // Stores the TTL for QL rows inserted using an INSERT statement.
+  kRedisCardinality = 1  // Stores the number of elements of a Redis hash or set.
 };
 
 enum class SortOrder : int8_t {
@@ -491,6 +491,69 @@ bool AsyncAlterTable::SendRequest(int attempt) {
   return true;
 }
 
+// ============================================================================
+//  Class AsyncSplitTablet.
+// ============================================================================
+AsyncSplitTablet::AsyncSplitTablet(Master *master,
+                                   ThreadPool* callback_pool,
+                                   const scoped_refptr<TabletInfo>& tablet)
+  : RetryingTSRpcTask(master,
+                      callback_pool,
+                      gscoped_ptr<TSPicker>(new PickLeaderReplica(tablet)),
+                      tablet->table().get()),
+    tablet_(tablet) {
+  deadline_ = MonoTime::Max();  // Never time out.
+}
+
+string AsyncSplitTablet::description() const {
+  return tablet_->ToString() + " Split Tablet RPC";
+}
+
+string AsyncSplitTablet::tablet_id() const {
+  return tablet_->tablet_id();
+}
+
+string AsyncSplitTablet::permanent_uuid() const {
+  return target_ts_desc_ != nullptr ? target_ts_desc_->permanent_uuid() : "";
+}
+
+void AsyncSplitTablet::HandleResponse(int attempt) {
+  if (resp_.has_error()) {
+    Status status = StatusFromPB(resp_.error().status());
+    LOG(WARNING) << "TS " << permanent_uuid() << ": split failed for tablet "
+                 << tablet_->ToString() << ": " << status.ToString();
+    return;
+  }
+
+  // The split is committed once the new tablets report that they are running.
+  PerformStateTransition(kStateRunning, kStateComplete);
+  VLOG(1) << "TS " << permanent_uuid() << ": split applied on tablet " << tablet_->ToString();
+}
+
+bool AsyncSplitTablet::SendRequest(int attempt) {
+  tserver::SplitTabletRequestPB req;
+  {
+    auto l = tablet_->LockForRead();
+    const auto& pb = l->data().pb;
+    if (l->data().is_deleted() || pb.split_tablet_ids_size() != 2) {
+      LOG(WARNING) << "Tablet " << tablet_->ToString() << " is not being split";
+      PerformStateTransition(kStateRunning, kStateComplete);
+      return false;
+    }
+    req.set_dest_uuid(permanent_uuid());
+    req.set_tablet_id(tablet_->tablet_id());
+    req.set_new_tablet1_id(pb.split_tablet_ids(0));
+    req.set_new_tablet2_id(pb.split_tablet_ids(1));
+    req.set_split_partition_key(pb.split_partition_key());
+  }
+
+  ts_proxy_->SplitTabletAsync(req, &resp_, &rpc_, BindRpcCallback());
+  VLOG(1) << "Send split tablet request to " << permanent_uuid()
+          << " (attempt " << attempt << "):\n"
+          << req.DebugString();
+  return true;
+}
+
 // ============================================================================
 //  Class CommonInfoForRaftTask.
 // ============================================================================
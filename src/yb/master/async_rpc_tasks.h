@@ -324,6 +324,34 @@ class AsyncAlterTable : public RetryingTSRpcTask {
   tserver::AlterSchemaResponsePB resp_;
 };
 
+// Send the "Split Tablet" request to the leader replica of the tablet, with the ids of the new
+// tablets and the partition key at which it is split.
+// Keeps retrying until the leader responds that the split created the new tablets. The split is
+// committed once the new tablets report that they are running.
+class AsyncSplitTablet : public RetryingTSRpcTask {
+ public:
+  AsyncSplitTablet(Master *master,
+                   ThreadPool* callback_pool,
+                   const scoped_refptr<TabletInfo>& tablet);
+
+  Type type() const override { return ASYNC_SPLIT_TABLET; }
+
+  std::string type_name() const override { return "Split Tablet"; }
+
+  std::string description() const override;
+
+ private:
+  std::string tablet_id() const override;
+
+  std::string permanent_uuid() const;
+
+  void HandleResponse(int attempt) override;
+  bool SendRequest(int attempt) override;
+
+  scoped_refptr<TabletInfo> tablet_;
+  tserver::SplitTabletResponsePB resp_;
+};
+
 class CommonInfoForRaftTask : public RetryingTSRpcTask {
  public:
   CommonInfoForRaftTask(
@@ -148,6 +148,9 @@ class TestLoadBalancer : public ClusterLoadBalancer {
     PrepareTestState(ts_descs);
     TestBalancingLeaders();
 
+    PrepareTestState(ts_descs);
+    TestBalancingByTabletLoad();
+
     gflags::SetCommandLineOption("leader_balance_threshold", "2");
     PrepareTestState(ts_descs);
     TestBalancingLeadersWithThreshold();
@@ -686,6 +689,38 @@ class TestLoadBalancer : public ClusterLoadBalancer {
     ASSERT_FALSE(HandleLeaderMoves(&placeholder, &placeholder, &placeholder));
   }
 
+  void TestBalancingByTabletLoad() {
+    LOG(INFO) << "Testing moving tablets by their reported load";
+    cluster_placement_.set_num_replicas(kNumReplicas);
+
+    // Report the last tablet as holding all the data of the table.
+    google::protobuf::RepeatedPtrField<TabletLoadPB> tablet_loads;
+    TabletLoadPB* tablet_load = tablet_loads.Add();
+    tablet_load->set_tablet_id(tablets_[3]->tablet_id());
+    tablet_load->set_sst_files_size(100);
+    for (const auto& ts_desc : ts_descs_) {
+      ts_desc->UpdateTabletLoads(tablet_loads);
+    }
+
+    // Add an empty TS.
+    ts_descs_.push_back(SetupTS("3333", "a"));
+    AnalyzeTablets();
+
+    // By tablet count, the first tablet would be moved. By load, moving the large tablet from ts2
+    // to the new TS evens out their loads.
+    string placeholder;
+    string expected_tablet_id = tablets_[3]->tablet_id();
+    string expected_from_ts = ts_descs_[2]->permanent_uuid();
+    string expected_to_ts = ts_descs_[3]->permanent_uuid();
+    TestAddLoad(expected_tablet_id, expected_from_ts, expected_to_ts);
+
+    // Clear the reported loads.
+    tablet_loads.Clear();
+    for (const auto& ts_desc : ts_descs_) {
+      ts_desc->UpdateTabletLoads(tablet_loads);
+    }
+  }
+
   // Methods to prepare the state of the current test.
   void PrepareTestState(const TSDescriptorVector& ts_descs) {
     // Clear old state.
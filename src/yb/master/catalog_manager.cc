@@ -113,6 +113,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/math_util.h"
+#include "yb/util/metrics.h"
 #include "yb/util/monotime.h"
 #include "yb/util/random_util.h"
 #include "yb/util/rw_mutex.h"
@@ -176,6 +177,33 @@ METRIC_DEFINE_gauge_uint32(cluster, num_tablet_servers_live,
                            "in the time interval defined by the gflag "
                            "FLAGS_tserver_unresponsive_timeout_ms.");
 
+DEFINE_int32(catalog_manager_report_batch_size, 500,
+             "The maximum number of tablets of a tablet report that are looked up under a single "
+             "acquisition of the catalog manager lock and persisted in a single sys catalog "
+             "write.");
+TAG_FLAG(catalog_manager_report_batch_size, advanced);
+TAG_FLAG(catalog_manager_report_batch_size, runtime);
+
+METRIC_DEFINE_histogram(server, tablet_report_processing_time, "Tablet Report Processing Time",
+                        yb::MetricUnit::kMicroseconds,
+                        "Time spent by the master processing a tablet report from a tablet "
+                        "server.",
+                        60000000LU, 2);
+
+METRIC_DEFINE_histogram(server, tablet_report_num_tablets, "Tablets Per Tablet Report",
+                        yb::MetricUnit::kEntries,
+                        "Number of tablets in the tablet reports received from tablet servers. "
+                        "Incremental reports only contain the tablets that changed since the "
+                        "previous report.",
+                        100000, 2);
+
+DEFINE_int64(tablet_split_size_threshold_bytes, 0,
+             "The size of the data of a tablet of a hash-partitioned YCQL table, as reported by "
+             "its leader, above which the master splits the tablet in two. 0 disables automatic "
+             "splitting. At most one tablet is split at a time.");
+TAG_FLAG(tablet_split_size_threshold_bytes, advanced);
+TAG_FLAG(tablet_split_size_threshold_bytes, runtime);
+
 DEFINE_uint64(inject_latency_during_remote_bootstrap_secs, 0,
               "Number of seconds to sleep during a remote bootstrap. (For testing only!)");
 TAG_FLAG(inject_latency_during_remote_bootstrap_secs, unsafe);
@@ -317,6 +345,9 @@ class TabletLoader : public Visitor<PersistentTabletInfo> {
     // Add the tablet to the Table
     if (!l->mutable_data()->is_deleted()) {
       table->AddTablet(tablet);
+      for (const auto& split_tablet_id : l->data().pb.split_tablet_ids()) {
+        catalog_manager_->split_tablet_map_[split_tablet_id] = tablet;
+      }
     }
     l->Commit();
 
@@ -577,6 +608,7 @@ void CatalogManagerBgTasks::Run() {
         }
       } else {
         catalog_manager_->load_balance_policy_->RunLoadBalancer();
+        catalog_manager_->ProcessTabletSplits();
       }
     }
 
@@ -655,6 +687,10 @@ Status CatalogManager::Init(bool is_first_run) {
   // Initialize the metrics emitted by the catalog manager.
   metric_num_tablet_servers_live_ =
     METRIC_num_tablet_servers_live.Instantiate(master_->metric_entity_cluster(), 0);
+  metric_tablet_report_processing_time_ =
+    METRIC_tablet_report_processing_time.Instantiate(master_->metric_entity());
+  metric_tablet_report_num_tablets_ =
+    METRIC_tablet_report_num_tablets.Instantiate(master_->metric_entity());
 
   RETURN_NOT_OK_PREPEND(InitSysCatalogAsync(is_first_run),
                         "Failed to initialize sys tables async");
@@ -789,6 +825,9 @@ Status CatalogManager::RunLoaders() {
   table_names_map_.clear();
   table_ids_map_.clear();
   tablet_map_.clear();
+  split_tablet_map_.clear();
+  split_tasks_.clear();
+  split_tablet_replicas_.clear();
 
   // Clear the namespace mappings.
   namespace_ids_map_.clear();
@@ -2331,27 +2370,56 @@ Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
   TRACE_EVENT2("master", "ProcessTabletReport",
                "requestor", rpc->requestor_string(),
                "num_tablets", report.updated_tablets_size());
+  ScopedLatencyMetric processing_time(metric_tablet_report_processing_time_.get());
+  metric_tablet_report_num_tablets_->Increment(report.updated_tablets_size());
 
   if (VLOG_IS_ON(2)) {
     VLOG(2) << "Received tablet report from " <<
       RequestorString(rpc) << ": " << report.DebugString();
   }
-  if (!ts_desc->has_tablet_report() && report.is_incremental()) {
-    string msg = "Received an incremental tablet report when a full one was needed";
-    LOG(WARNING) << "Invalid tablet report from " << RequestorString(rpc) << ": "
-                 << msg;
-    return STATUS(IllegalState, msg);
+  if (!ts_desc->UpdateTabletReportSeqno(report)) {
+    // The heartbeat response asks the TS for a full tablet report instead. The tablets of an
+    // incremental report stay dirty on the TS until a report containing them is acknowledged, so
+    // nothing is lost by dropping this one.
+    LOG(WARNING) << "Ignoring incremental tablet report #" << report.sequence_number()
+                 << " from " << RequestorString(rpc) << ": a full tablet report is needed";
+    return Status::OK();
   }
 
   // TODO: on a full tablet report, we may want to iterate over the tablets we think
   // the server should have, compare vs the ones being reported, and somehow mark
   // any that have been "lost" (eg somehow the tablet metadata got corrupted or something).
 
+  // Handle the tablets in the order of their ids, so that the write locks of a batch are always
+  // acquired in the same order.
+  std::vector<const ReportedTabletPB*> reports;
+  reports.reserve(report.updated_tablets_size());
   for (const ReportedTabletPB& reported : report.updated_tablets()) {
-    ReportedTabletUpdatesPB *tablet_report = report_update->add_tablets();
-    tablet_report->set_tablet_id(reported.tablet_id());
-    RETURN_NOT_OK_PREPEND(HandleReportedTablet(ts_desc, reported, tablet_report),
-                          Substitute("Error handling $0", reported.ShortDebugString()));
+    reports.push_back(&reported);
+  }
+  std::sort(reports.begin(), reports.end(),
+            [](const ReportedTabletPB* lhs, const ReportedTabletPB* rhs) {
+              return lhs->tablet_id() < rhs->tablet_id();
+            });
+  // A tablet must not be locked twice in the same batch.
+  reports.erase(std::unique(reports.begin(), reports.end(),
+                            [](const ReportedTabletPB* lhs, const ReportedTabletPB* rhs) {
+                              return lhs->tablet_id() == rhs->tablet_id();
+                            }),
+                reports.end());
+
+  const size_t batch_size = std::max(FLAGS_catalog_manager_report_batch_size, 1);
+  for (size_t begin = 0; begin < reports.size(); begin += batch_size) {
+    const size_t end = std::min(begin + batch_size, reports.size());
+    Status s = HandleReportedTablets(
+        ts_desc, std::vector<const ReportedTabletPB*>(reports.begin() + begin,
+                                                      reports.begin() + end),
+        report_update);
+    if (!s.ok()) {
+      // Have the TS report all its tablets again, including the ones not handled yet.
+      ts_desc->set_has_tablet_report(false);
+      return s;
+    }
   }
 
   ts_desc->set_has_tablet_report(true);
@@ -2363,6 +2431,87 @@ Status CatalogManager::ProcessTabletReport(TSDescriptor* ts_desc,
   return Status::OK();
 }
 
+// A tablet handled as part of a batch of a tablet report.
+struct ReportedTablet {
+  scoped_refptr<TabletInfo> tablet;
+  const ReportedTabletPB* report;
+
+  // The write lock of the tablet, held until its modified metadata is persisted. Null if the
+  // report did not modify the metadata.
+  std::unique_ptr<TabletInfo::lock_type> tablet_lock;
+
+  // Whether the tablet does not have the latest schema and needs an AlterTable request.
+  bool needs_alter;
+};
+
+Status CatalogManager::HandleReportedTablets(TSDescriptor* ts_desc,
+                                             const std::vector<const ReportedTabletPB*>& reports,
+                                             TabletReportUpdatesPB *report_update) {
+  RETURN_NOT_OK_PREPEND(CheckIsLeaderAndReady(),
+      "This master is no longer the leader, unable to handle tablet report");
+
+  std::vector<scoped_refptr<TabletInfo>> tablets;
+  tablets.reserve(reports.size());
+  {
+    boost::shared_lock<LockType> l(lock_);
+    for (const ReportedTabletPB* report : reports) {
+      tablets.push_back(FindPtrOrNull(tablet_map_, report->tablet_id()));
+    }
+  }
+
+  std::vector<ReportedTablet> reported_tablets;
+  reported_tablets.reserve(reports.size());
+  for (size_t i = 0; i < reports.size(); ++i) {
+    const ReportedTabletPB& reported = *reports[i];
+    ReportedTabletUpdatesPB *tablet_report = report_update->add_tablets();
+    tablet_report->set_tablet_id(reported.tablet_id());
+    RETURN_NOT_OK_PREPEND(
+        HandleReportedTablet(ts_desc, reported, tablets[i], tablet_report, &reported_tablets),
+        Substitute("Error handling $0", reported.ShortDebugString()));
+  }
+
+  return CommitReportedTablets(&reported_tablets);
+}
+
+Status CatalogManager::CommitReportedTablets(std::vector<ReportedTablet>* reported_tablets) {
+  vector<TabletInfo*> tablets_to_update;
+  for (const ReportedTablet& reported_tablet : *reported_tablets) {
+    if (reported_tablet.tablet_lock) {
+      tablets_to_update.push_back(reported_tablet.tablet.get());
+    }
+  }
+
+  if (!tablets_to_update.empty()) {
+    Status s = sys_catalog_->UpdateItems(tablets_to_update);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error updating " << tablets_to_update.size() << " reported tablets: "
+                   << s.ToString();
+      return s;
+    }
+    for (ReportedTablet& reported_tablet : *reported_tablets) {
+      if (reported_tablet.tablet_lock) {
+        reported_tablet.tablet_lock->Commit();
+      }
+    }
+    TRACE("Persisted $0 reported tablets", tablets_to_update.size());
+  }
+
+  // Need to defer the AlterTable command to after we've committed the new tablet data,
+  // since the tablet report may also be updating the raft config, and the Alter Table
+  // request needs to know who the most recent leader is.
+  for (const ReportedTablet& reported_tablet : *reported_tablets) {
+    if (reported_tablet.needs_alter) {
+      SendAlterTabletRequest(reported_tablet.tablet);
+    } else if (reported_tablet.report->has_schema_version()) {
+      RETURN_NOT_OK(HandleTabletSchemaVersionReport(reported_tablet.tablet.get(),
+                                                    reported_tablet.report->schema_version()));
+    }
+  }
+
+  reported_tablets->clear();
+  return Status::OK();
+}
+
 namespace {
 // Return true if receiving 'report' for a tablet in CREATING state should
 // transition it to the RUNNING state.
@@ -2383,18 +2532,23 @@ bool ShouldTransitionTabletToRunning(const ReportedTabletPB& report) {
 
 Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
                                             const ReportedTabletPB& report,
-                                            ReportedTabletUpdatesPB *report_updates) {
+                                            const scoped_refptr<TabletInfo>& tablet,
+                                            ReportedTabletUpdatesPB *report_updates,
+                                            std::vector<ReportedTablet>* reported_tablets) {
   TRACE_EVENT1("master", "HandleReportedTablet",
                "tablet_id", report.tablet_id());
-  scoped_refptr<TabletInfo> tablet;
-  {
-    boost::shared_lock<LockType> l(lock_);
-    tablet = FindPtrOrNull(tablet_map_, report.tablet_id());
-  }
-  RETURN_NOT_OK_PREPEND(CheckIsLeaderAndReady(),
-      Substitute("This master is no longer the leader, unable to handle report for tablet $0",
-                 report.tablet_id()));
   if (!tablet) {
+    scoped_refptr<TabletInfo> split_tablet;
+    {
+      boost::shared_lock<LockType> l(lock_);
+      split_tablet = FindPtrOrNull(split_tablet_map_, report.tablet_id());
+    }
+    if (split_tablet != nullptr) {
+      // The tablet is one of the tablets of a split that is not committed yet.
+      VLOG(1) << "Got report from tablet " << report.tablet_id() << " split from "
+              << split_tablet->tablet_id();
+      return HandleReportedSplitTablet(ts_desc, report, split_tablet);
+    }
     LOG(INFO) << "Got report from unknown tablet " << report.tablet_id()
               << ": Sending delete request for this orphan tablet";
     SendDeleteTabletRequest(report.tablet_id(), TABLET_DATA_DELETED, boost::none, nullptr, ts_desc,
@@ -2475,6 +2629,7 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
 
   // The report will not have a committed_consensus_state if it is in the
   // middle of starting up, such as during tablet bootstrap.
+  bool tablet_modified = false;
   if (report.has_committed_consensus_state()) {
     const ConsensusStatePB& prev_cstate = tablet_lock->data().pb.committed_consensus_state();
     ConsensusStatePB cstate = report.committed_consensus_state();
@@ -2513,6 +2668,7 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
       VLOG(1) << "Tablet " << tablet->ToString() << " is now online";
       tablet_lock->mutable_data()->set_state(SysTabletsEntryPB::RUNNING,
                                             "Tablet reported with an active leader");
+      tablet_modified = true;
     }
 
     // The Master only accepts committed consensus configurations since it needs the committed index
@@ -2575,6 +2731,7 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
 
       RETURN_NOT_OK(ResetTabletReplicasFromReportedConfig(*final_report, tablet,
                                                           tablet_lock.get(), table_lock.get()));
+      tablet_modified = true;
 
     } else {
       // Report opid_index is equal to the previous opid_index. If some
@@ -2588,24 +2745,13 @@ Status CatalogManager::HandleReportedTablet(TSDescriptor* ts_desc,
   }
 
   table_lock->Unlock();
-  // We update the tablets each time that someone reports it.
-  // This shouldn't be very frequent and should only happen when something in fact changed.
-  Status s = sys_catalog_->UpdateItem(tablet.get());
-  if (!s.ok()) {
-    LOG(WARNING) << "Error updating tablets: " << s.ToString() << ". Tablet report was: "
-                 << report.ShortDebugString();
-    return s;
-  }
-  tablet_lock->Commit();
-
-  // Need to defer the AlterTable command to after we've committed the new tablet data,
-  // since the tablet report may also be updating the raft config, and the Alter Table
-  // request needs to know who the most recent leader is.
-  if (tablet_needs_alter) {
-    SendAlterTabletRequest(tablet);
-  } else if (report.has_schema_version()) {
-    RETURN_NOT_OK(HandleTabletSchemaVersionReport(tablet.get(), report.schema_version()));
+  // The modified tablet metadata is persisted, and the tablet keeps being write-locked until then,
+  // along with the other tablets of the batch in CommitReportedTablets().
+  if (!tablet_modified) {
+    tablet_lock.reset();
   }
+  reported_tablets->push_back(ReportedTablet{
+      tablet, &report, std::move(tablet_lock), tablet_needs_alter});
 
   return Status::OK();
 }
@@ -3332,6 +3478,260 @@ void CatalogManager::SendAlterTabletRequest(const scoped_refptr<TabletInfo>& tab
   WARN_NOT_OK(call->Run(), "Failed to send alter table request");
 }
 
+Status CatalogManager::StartTabletSplit(const scoped_refptr<TabletInfo>& tablet) {
+  const scoped_refptr<TableInfo>& table = tablet->table();
+  if (table == nullptr || IsSystemTable(*table)) {
+    return STATUS_FORMAT(NotSupported, "Tablet $0 of a system table cannot be split",
+                         tablet->tablet_id());
+  }
+  {
+    auto table_lock = table->LockForRead();
+    const SysTablesEntryPB& table_pb = table_lock->data().pb;
+    if (!table_lock->data().is_running()) {
+      return STATUS_FORMAT(IllegalState, "Table $0 is not running", table->ToString());
+    }
+    // Tablets of other tables are not split by hash: tablets of transactional tables are also
+    // not split, as the intents of pending transactions would have to follow their keys.
+    if (table_pb.table_type() != YQL_TABLE_TYPE ||
+        table_pb.partition_schema().hash_schema() != PartitionSchemaPB::MULTI_COLUMN_HASH_SCHEMA ||
+        table_pb.schema().table_properties().is_transactional()) {
+      return STATUS_FORMAT(NotSupported,
+                           "Only tablets of non-transactional hash-partitioned YCQL tables can be "
+                           "split, table: $0", table->ToString());
+    }
+  }
+
+  auto tablet_lock = tablet->LockForWrite();
+  SysTabletsEntryPB* tablet_pb = &tablet_lock->mutable_data()->pb;
+  if (!tablet_lock->data().is_running()) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 is not running", tablet->tablet_id());
+  }
+  if (tablet_pb->split_tablet_ids_size() > 0) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 is already being split", tablet->tablet_id());
+  }
+
+  // Split the tablet at the middle of its hash range.
+  const PartitionPB& partition = tablet_pb->partition();
+  const uint32_t begin = partition.partition_key_start().empty() ? 0 :
+      PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_start());
+  const uint32_t end = partition.partition_key_end().empty() ? 0x10000 :
+      PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_end());
+  if (end < begin + 2) {
+    return STATUS_FORMAT(InvalidArgument, "Hash range of tablet $0 is too small to be split",
+                         tablet->tablet_id());
+  }
+  tablet_pb->add_split_tablet_ids(GenerateId());
+  tablet_pb->add_split_tablet_ids(GenerateId());
+  tablet_pb->set_split_partition_key(
+      PartitionSchema::EncodeMultiColumnHashValue((begin + end) / 2));
+
+  RETURN_NOT_OK(sys_catalog_->UpdateItem(tablet.get()));
+  LOG(INFO) << "Splitting tablet " << tablet->ToString() << " into "
+            << tablet_pb->split_tablet_ids(0) << " and " << tablet_pb->split_tablet_ids(1)
+            << " at hash " << (begin + end) / 2;
+  {
+    std::lock_guard<LockType> l(lock_);
+    for (const auto& split_tablet_id : tablet_pb->split_tablet_ids()) {
+      split_tablet_map_[split_tablet_id] = tablet;
+    }
+  }
+  tablet_lock->Commit();
+
+  SendSplitTabletRequest(tablet);
+  return Status::OK();
+}
+
+void CatalogManager::SendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet) {
+  {
+    std::lock_guard<LockType> l(lock_);
+    if (!split_tasks_.insert(tablet->tablet_id()).second) {
+      return;
+    }
+  }
+  auto call = std::make_shared<AsyncSplitTablet>(master_, worker_pool_.get(), tablet);
+  tablet->table()->AddTask(call);
+  WARN_NOT_OK(call->Run(), "Failed to send split tablet request");
+}
+
+Status CatalogManager::CommitTabletSplit(const scoped_refptr<TabletInfo>& tablet) {
+  const scoped_refptr<TableInfo>& table = tablet->table();
+  auto tablet_lock = tablet->LockForWrite();
+  const SysTabletsEntryPB& tablet_pb = tablet_lock->data().pb;
+  if (tablet_lock->data().is_deleted()) {
+    return Status::OK();
+  }
+  if (tablet_pb.split_tablet_ids_size() != 2) {
+    return STATUS_FORMAT(IllegalState, "Tablet $0 is not being split", tablet->tablet_id());
+  }
+
+  // The new tablets are running from the start, on the replicas of the split tablet.
+  TabletInfo::ReplicaMap replica_locations;
+  tablet->GetReplicaLocations(&replica_locations);
+  vector<TabletInfo*> new_tablets;
+  vector<scoped_refptr<TabletInfo>> new_tablet_refs;
+  for (int i = 0; i < tablet_pb.split_tablet_ids_size(); ++i) {
+    TabletInfo* new_tablet = new TabletInfo(table, tablet_pb.split_tablet_ids(i));
+    new_tablet_refs.emplace_back(new_tablet);
+    new_tablets.push_back(new_tablet);
+
+    new_tablet->mutable_metadata()->StartMutation();
+    auto* metadata = new_tablet->mutable_metadata()->mutable_dirty();
+    metadata->pb.set_table_id(table->id());
+    metadata->pb.mutable_partition()->CopyFrom(tablet_pb.partition());
+    if (i == 0) {
+      metadata->pb.mutable_partition()->set_partition_key_end(tablet_pb.split_partition_key());
+    } else {
+      metadata->pb.mutable_partition()->set_partition_key_start(tablet_pb.split_partition_key());
+    }
+    metadata->pb.mutable_committed_consensus_state()->CopyFrom(
+        tablet_pb.committed_consensus_state());
+    metadata->set_state(SysTabletsEntryPB::RUNNING,
+                        Substitute("Split from $0", tablet->tablet_id()));
+    new_tablet->SetReplicaLocations(replica_locations);
+  }
+
+  const string deletion_msg = Substitute("Split into $0 and $1 at $2",
+                                         tablet_pb.split_tablet_ids(0),
+                                         tablet_pb.split_tablet_ids(1), LocalTimeAsString());
+  tablet_lock->mutable_data()->set_state(SysTabletsEntryPB::DELETED, deletion_msg);
+
+  vector<TabletInfo*> updated_tablets = { tablet.get() };
+  Status s = sys_catalog_->AddAndUpdateItems(new_tablets, updated_tablets);
+  if (!s.ok()) {
+    for (TabletInfo* new_tablet : new_tablets) {
+      new_tablet->mutable_metadata()->AbortMutation();
+    }
+    return s.CloneAndPrepend("An error occurred while persisting the split tablets");
+  }
+
+  for (TabletInfo* new_tablet : new_tablets) {
+    new_tablet->mutable_metadata()->CommitMutation();
+  }
+  tablet_lock->Commit();
+
+  // The first new tablet replaces the split tablet in the table, as it starts at the same key.
+  table->AddTablets(new_tablets);
+  {
+    std::lock_guard<LockType> l(lock_);
+    for (TabletInfo* new_tablet : new_tablets) {
+      tablet_map_[new_tablet->tablet_id()] = new_tablet;
+      split_tablet_map_.erase(new_tablet->tablet_id());
+      split_tablet_replicas_.erase(new_tablet->tablet_id());
+    }
+    split_tasks_.erase(tablet->tablet_id());
+  }
+  LOG(INFO) << "Tablet " << tablet->ToString() << ": " << deletion_msg;
+
+  DeleteTabletReplicas(tablet.get(), deletion_msg);
+  return Status::OK();
+}
+
+Status CatalogManager::HandleReportedSplitTablet(TSDescriptor* ts_desc,
+                                                 const ReportedTabletPB& report,
+                                                 const scoped_refptr<TabletInfo>& split_tablet) {
+  if (report.state() != tablet::RUNNING) {
+    return Status::OK();
+  }
+
+  vector<TabletId> new_tablet_ids;
+  int majority_size;
+  {
+    auto l = split_tablet->LockForRead();
+    const SysTabletsEntryPB& pb = l->data().pb;
+    new_tablet_ids.assign(pb.split_tablet_ids().begin(), pb.split_tablet_ids().end());
+    majority_size = consensus::MajoritySize(
+        consensus::CountVoters(pb.committed_consensus_state().config()));
+  }
+
+  // The split is committed once each new tablet runs on a majority of the replicas of the split
+  // tablet, as only then the new tablets can serve the data that the split tablet stops serving.
+  {
+    std::lock_guard<LockType> l(lock_);
+    if (split_tablet_map_.count(report.tablet_id()) == 0) {
+      return Status::OK();
+    }
+    split_tablet_replicas_[report.tablet_id()].insert(ts_desc->permanent_uuid());
+    for (const auto& new_tablet_id : new_tablet_ids) {
+      auto* replicas = FindOrNull(split_tablet_replicas_, new_tablet_id);
+      if (replicas == nullptr || replicas->size() < static_cast<size_t>(majority_size)) {
+        return Status::OK();
+      }
+    }
+  }
+
+  // The write lock of the split tablet may be held until the rest of the report is committed, so
+  // the split is committed by a worker thread.
+  return worker_pool_->SubmitFunc([this, split_tablet] {
+    WARN_NOT_OK(CommitTabletSplit(split_tablet),
+                Substitute("Failed to commit split of tablet $0", split_tablet->tablet_id()));
+  });
+}
+
+void CatalogManager::ProcessTabletSplits() {
+  vector<scoped_refptr<TabletInfo>> to_resume;
+  bool split_in_progress;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    split_in_progress = !split_tablet_map_.empty();
+    for (const auto& entry : split_tablet_map_) {
+      if (split_tasks_.count(entry.second->tablet_id()) == 0) {
+        to_resume.push_back(entry.second);
+      }
+    }
+  }
+  for (const auto& tablet : to_resume) {
+    SendSplitTabletRequest(tablet);
+  }
+  if (split_in_progress || FLAGS_tablet_split_size_threshold_bytes <= 0) {
+    return;
+  }
+
+  // Find the largest tablet, by the size of the data reported by its leader.
+  scoped_refptr<TabletInfo> largest_tablet;
+  uint64_t largest_size = FLAGS_tablet_split_size_threshold_bytes;
+  vector<scoped_refptr<TableInfo>> tables;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    for (const auto& entry : table_ids_map_) {
+      tables.push_back(entry.second);
+    }
+  }
+  for (const auto& table : tables) {
+    {
+      auto table_lock = table->LockForRead();
+      const SysTablesEntryPB& table_pb = table_lock->data().pb;
+      if (!table_lock->data().is_running() || table_pb.table_type() != YQL_TABLE_TYPE ||
+          table_pb.partition_schema().hash_schema() !=
+              PartitionSchemaPB::MULTI_COLUMN_HASH_SCHEMA ||
+          table_pb.schema().table_properties().is_transactional() || IsSystemTable(*table)) {
+        continue;
+      }
+    }
+    vector<scoped_refptr<TabletInfo>> tablets;
+    table->GetAllTablets(&tablets);
+    for (const auto& tablet : tablets) {
+      TabletInfo::ReplicaMap replica_locations;
+      tablet->GetReplicaLocations(&replica_locations);
+      for (const auto& replica : replica_locations) {
+        TabletLoad load;
+        if (replica.second.role == RaftPeerPB::LEADER &&
+            replica.second.ts_desc->GetTabletLoad(tablet->tablet_id(), &load) &&
+            load.sst_files_size > largest_size) {
+          largest_tablet = tablet;
+          largest_size = load.sst_files_size;
+        }
+      }
+    }
+  }
+  if (largest_tablet != nullptr) {
+    LOG(INFO) << "Tablet " << largest_tablet->ToString() << " has " << largest_size
+              << " bytes of data, above the split threshold of "
+              << FLAGS_tablet_split_size_threshold_bytes;
+    WARN_NOT_OK(StartTabletSplit(largest_tablet),
+                Substitute("Failed to split tablet $0", largest_tablet->tablet_id()));
+  }
+}
+
 void CatalogManager::DeleteTabletReplicas(
     const TabletInfo* tablet,
     const std::string& msg) {
@@ -3499,6 +3899,13 @@ void CatalogManager::ExtractTabletsToProcess(
     // Tablets not yet assigned or with a report just received
     tablets_to_process->push_back(tablet);
   }
+
+  // Tablets are write-locked together by ProcessPendingAssignments(), and a batch of a tablet
+  // report is locked in the same order.
+  std::sort(tablets_to_process->begin(), tablets_to_process->end(),
+            [](const scoped_refptr<TabletInfo>& lhs, const scoped_refptr<TabletInfo>& rhs) {
+              return lhs->tablet_id() < rhs->tablet_id();
+            });
 }
 
 struct DeferredAssignmentActions {
@@ -4457,6 +4864,29 @@ Status CatalogManager::IsLoadBalanced(const IsLoadBalancedRequestPB* req,
   return Status::OK();
 }
 
+Status CatalogManager::SplitTablet(const SplitTabletRequestPB* req,
+                                   SplitTabletResponsePB* resp) {
+  RETURN_NOT_OK(CheckOnline());
+
+  scoped_refptr<TabletInfo> tablet;
+  {
+    boost::shared_lock<LockType> l(lock_);
+    tablet = FindPtrOrNull(tablet_map_, req->tablet_id());
+  }
+  if (tablet == nullptr) {
+    Status s = STATUS(NotFound, "The tablet does not exist", req->tablet_id());
+    SetupError(resp->mutable_error(), MasterErrorPB::TABLET_NOT_FOUND, s);
+    return s;
+  }
+
+  Status s = StartTabletSplit(tablet);
+  if (!s.ok()) {
+    SetupError(resp->mutable_error(), MasterErrorPB::TABLET_CANNOT_BE_SPLIT, s);
+    return s;
+  }
+  return Status::OK();
+}
+
 void BlacklistState::Reset() {
   tservers_.clear();
   initial_load_ = 0;
@@ -4670,6 +5100,7 @@ INITTED_AND_LEADER_OR_RESPOND(ChangeMasterClusterConfigResponsePB);
 INITTED_AND_LEADER_OR_RESPOND(GetLoadMovePercentResponsePB);
 INITTED_AND_LEADER_OR_RESPOND(IsMasterLeaderReadyResponsePB);
 INITTED_AND_LEADER_OR_RESPOND(IsLoadBalancedResponsePB);
+INITTED_AND_LEADER_OR_RESPOND(SplitTabletResponsePB);
 
 // TServer variants.
 INITTED_AND_LEADER_OR_RESPOND_TSERVER(tserver::ReadResponsePB);
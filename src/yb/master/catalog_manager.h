@@ -74,6 +74,7 @@ class ThreadPool;
 
 template<class T>
 class AtomicGauge;
+class Histogram;
 
 namespace master {
 
@@ -85,6 +86,7 @@ class TableInfo;
 class TSDescriptor;
 
 struct DeferredAssignmentActions;
+struct ReportedTablet;
 
 static const char* const kDefaultSysEntryUnusedId = "";
 
@@ -919,6 +921,14 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS IsLoadBalanced(const IsLoadBalancedRequestPB* req,
                                 IsLoadBalancedResponsePB* resp);
 
+  // Split a tablet of a hash-partitioned table into two tablets at the middle of its hash range.
+  // The split completes asynchronously.
+  CHECKED_STATUS SplitTablet(const SplitTabletRequestPB* req, SplitTabletResponsePB* resp);
+
+  // Replace the tablet with the two tablets it was split into, once both of them are running on a
+  // majority of its replicas.
+  CHECKED_STATUS CommitTabletSplit(const scoped_refptr<TabletInfo>& tablet);
+
   // Clears out the existing metadata ('table_names_map_', 'table_ids_map_',
   // and 'tablet_map_'), loads tables metadata into memory and if successful
   // loads the tablets metadata.
@@ -1041,11 +1051,30 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   CHECKED_STATUS FindTable(const TableIdentifierPB& table_identifier,
                    scoped_refptr<TableInfo>* table_info);
 
-  // Handle one of the tablets in a tablet reported.
-  // Requires that the lock is already held.
+  // Handle a batch of the tablets in a tablet report. The tablets are looked up under a single
+  // acquisition of the catalog manager lock, and the metadata of all the tablets modified by the
+  // reports is persisted to the sys catalog in a single write.
+  CHECKED_STATUS HandleReportedTablets(TSDescriptor* ts_desc,
+                                       const std::vector<const ReportedTabletPB*>& reports,
+                                       TabletReportUpdatesPB *report_update);
+
+  // Handle one of the tablets in a tablet report. If the tablet metadata has to be persisted or
+  // further actions are needed once it is, the tablet is added to 'reported_tablets' to be
+  // committed by CommitReportedTablets().
   CHECKED_STATUS HandleReportedTablet(TSDescriptor* ts_desc,
-                              const ReportedTabletPB& report,
-                              ReportedTabletUpdatesPB *report_updates);
+                                      const ReportedTabletPB& report,
+                                      const scoped_refptr<TabletInfo>& tablet,
+                                      ReportedTabletUpdatesPB *report_updates,
+                                      std::vector<ReportedTablet>* reported_tablets);
+
+  // Handle the report of a new tablet of a split that is not committed yet. Once both new tablets
+  // are running on a majority of the replicas of the split tablet, the split is committed.
+  CHECKED_STATUS HandleReportedSplitTablet(TSDescriptor* ts_desc,
+                                           const ReportedTabletPB& report,
+                                           const scoped_refptr<TabletInfo>& split_tablet);
+
+  // Persist the tablets modified by a batch of tablet reports and commit their metadata.
+  CHECKED_STATUS CommitReportedTablets(std::vector<ReportedTablet>* reported_tablets);
 
   CHECKED_STATUS ResetTabletReplicasFromReportedConfig(const ReportedTabletPB& report,
                                                const scoped_refptr<TabletInfo>& tablet,
@@ -1134,6 +1163,18 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // Request tablet servers to delete all replicas of the tablet.
   void DeleteTabletReplicas(const TabletInfo* tablet, const std::string& msg);
 
+  // Persist the ids of the new tablets and the partition key of the split of the tablet, and start
+  // the background task that sends the split to the leader of the tablet.
+  CHECKED_STATUS StartTabletSplit(const scoped_refptr<TabletInfo>& tablet);
+
+  // Start the background task to send the SplitTablet() RPC to the leader for this tablet.
+  void SendSplitTabletRequest(const scoped_refptr<TabletInfo>& tablet);
+
+  // Resume the tablet splits that have no running task, such as the ones started by a previous
+  // leader master. If no split is in progress, start the split of the largest tablet whose data
+  // exceeds FLAGS_tablet_split_size_threshold_bytes.
+  void ProcessTabletSplits();
+
   // Marks each of the tablets in the given table as deleted and triggers requests
   // to the tablet servers to delete them.
   void DeleteTabletsAndSendRequests(const scoped_refptr<TableInfo>& table);
@@ -1243,6 +1284,16 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // Tablet maps: tablet-id -> TabletInfo
   TabletInfoMap tablet_map_;
 
+  // Tablets being split: new tablet-id -> TabletInfo of the tablet being split.
+  TabletInfoMap split_tablet_map_;
+
+  // Ids of the tablets being split that have a running split task.
+  std::unordered_set<TabletId> split_tasks_;
+
+  // Tablet servers that reported a new tablet of an uncommitted split as running:
+  // new tablet-id -> tablet server uuids.
+  std::unordered_map<TabletId, std::unordered_set<TabletServerId>> split_tablet_replicas_;
+
   // Namespace maps: namespace-id -> NamespaceInfo and namespace-name -> NamespaceInfo
   typedef std::unordered_map<NamespaceName, scoped_refptr<NamespaceInfo> > NamespaceInfoMap;
   NamespaceInfoMap namespace_ids_map_;
@@ -1327,6 +1378,10 @@ class CatalogManager : public tserver::TabletPeerLookupIf {
   // Number of live tservers metric.
   scoped_refptr<AtomicGauge<uint32_t>> metric_num_tablet_servers_live_;
 
+  // Tablet report processing metrics.
+  scoped_refptr<Histogram> metric_tablet_report_processing_time_;
+  scoped_refptr<Histogram> metric_tablet_report_num_tablets_;
+
   friend class ClusterLoadBalancer;
 
   // Policy for load balancing tablets on tablet servers.
@@ -14,6 +14,7 @@
 #include "yb/master/cluster_balance.h"
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include <boost/thread/locks.hpp>
@@ -57,6 +58,22 @@ DEFINE_int32(load_balancer_max_concurrent_moves,
              1,
              "Maximum number of concurrent LeaderMoves/Adds/Removals.");
 
+DEFINE_double(load_balancer_tablet_size_weight,
+              1.0,
+              "Weight of the on-disk and in-memory size of a tablet, relative to the other tablets "
+              "of its table, in the load the tablet puts on its tablet servers. If this and "
+              "load_balancer_tablet_ops_weight are 0, every tablet counts the same.");
+TAG_FLAG(load_balancer_tablet_size_weight, advanced);
+TAG_FLAG(load_balancer_tablet_size_weight, runtime);
+
+DEFINE_double(load_balancer_tablet_ops_weight,
+              1.0,
+              "Weight of the read and write rate of a tablet, relative to the other tablets of its "
+              "table, in the load the tablet puts on its tablet servers. Only the rate of the "
+              "leader is considered for the load of leaders.");
+TAG_FLAG(load_balancer_tablet_ops_weight, advanced);
+TAG_FLAG(load_balancer_tablet_ops_weight, runtime);
+
 struct TabletMetadata {
   bool is_missing_replicas() {
     return is_under_replicated || !under_replicated_placements.empty();
@@ -107,6 +124,17 @@ struct TabletMetadata {
 
   // Leader stepdown failures. We use this to prevent retrying the same leader stepdown too soon.
   LeaderStepDownFailureTimes leader_stepdown_failures;
+
+  // Largest size and operation rate reported by the replicas of this tablet, and the operation
+  // rate reported by its leader.
+  uint64_t size = 0;
+  double ops_per_sec = 0;
+  double leader_ops_per_sec = 0;
+
+  // Load this tablet puts on a tablet server hosting one of its replicas, and on the one hosting
+  // its leader. Both are 1 for a tablet with the average size and operation rate of its table.
+  double weight = 1.0;
+  double leader_weight = 1.0;
 };
 
 class TabletServerMetadata {
@@ -122,6 +150,12 @@ class TabletServerMetadata {
 
   // The set of tablet leader ids that this tablet server is currently running.
   set<TabletId> leaders;
+
+  // Sum of the weights of the running and starting tablets, and of the leader weights of the
+  // leaders. Computed once the tablet weights are known and kept up to date as tablets and leaders
+  // are moved, so that sorting by load does not sum the weights for every comparison.
+  double load = 0;
+  double leader_load = 0;
 };
 
 class ClusterLoadBalancer::ClusterLoadState {
@@ -132,8 +166,8 @@ class ClusterLoadBalancer::ClusterLoadState {
 
   // Comparators used for sorting by load.
   bool CompareByUuid(const TabletServerId& a, const TabletServerId& b) {
-    int load_a = GetLoad(a);
-    int load_b = GetLoad(b);
+    double load_a = GetLoad(a);
+    double load_b = GetLoad(b);
     if (load_a == load_b) {
       return a < b;
     } else {
@@ -169,15 +203,75 @@ class ClusterLoadBalancer::ClusterLoadState {
     ClusterLoadState* state_;
   };
 
-  // Get the load for a certain TS.
-  int GetLoad(const TabletServerId& ts_uuid) const {
-    const auto& ts_meta = per_ts_meta_.at(ts_uuid);
-    return ts_meta.starting_tablets.size() + ts_meta.running_tablets.size();
+  // Get the load for a certain TS, the sum of the weights of the tablets it is running or starting.
+  double GetLoad(const TabletServerId& ts_uuid) const {
+    return per_ts_meta_.at(ts_uuid).load;
+  }
+
+  // Get the leader load for a certain TS, the sum of the leader weights of the tablets it leads.
+  double GetLeaderLoad(const TabletServerId& ts_uuid) const {
+    return per_ts_meta_.at(ts_uuid).leader_load;
+  }
+
+  double GetTabletWeight(const TabletId& tablet_id) const {
+    const auto it = per_tablet_meta_.find(tablet_id);
+    return it == per_tablet_meta_.end() ? 1.0 : it->second.weight;
+  }
+
+  double GetLeaderWeight(const TabletId& tablet_id) const {
+    const auto it = per_tablet_meta_.find(tablet_id);
+    return it == per_tablet_meta_.end() ? 1.0 : it->second.leader_weight;
   }
 
-  // Get the load for a certain TS.
-  int GetLeaderLoad(const TabletServerId& ts_uuid) const {
-    return per_ts_meta_.at(ts_uuid).leaders.size();
+  // Compute the weights of the tablets from their size and operation rate relative to the average
+  // over all the tablets analyzed, and the load of the tablet servers from them.
+  void ComputeTabletWeights() {
+    const double size_weight = std::max(FLAGS_load_balancer_tablet_size_weight, 0.0);
+    const double ops_weight = std::max(FLAGS_load_balancer_tablet_ops_weight, 0.0);
+    if (per_tablet_meta_.empty()) {
+      return;
+    }
+
+    double total_size = 0;
+    double total_ops = 0;
+    double total_leader_ops = 0;
+    for (const auto& entry : per_tablet_meta_) {
+      total_size += entry.second.size;
+      total_ops += entry.second.ops_per_sec;
+      total_leader_ops += entry.second.leader_ops_per_sec;
+    }
+    const double num_tablets = per_tablet_meta_.size();
+    const double avg_size = total_size / num_tablets;
+    const double avg_ops = total_ops / num_tablets;
+    const double avg_leader_ops = total_leader_ops / num_tablets;
+    // Tablets of a table with nothing reported are all of average load.
+    auto ratio = [](double value, double avg) { return avg > 0 ? value / avg : 1.0; };
+
+    for (auto& entry : per_tablet_meta_) {
+      auto& tablet_meta = entry.second;
+      tablet_meta.weight =
+          (1.0 + size_weight * ratio(tablet_meta.size, avg_size) +
+           ops_weight * ratio(tablet_meta.ops_per_sec, avg_ops)) /
+          (1.0 + size_weight + ops_weight);
+      tablet_meta.leader_weight =
+          (1.0 + ops_weight * ratio(tablet_meta.leader_ops_per_sec, avg_leader_ops)) /
+          (1.0 + ops_weight);
+    }
+
+    for (auto& entry : per_ts_meta_) {
+      auto& ts_meta = entry.second;
+      ts_meta.load = 0;
+      for (const auto& tablet_id : ts_meta.running_tablets) {
+        ts_meta.load += GetTabletWeight(tablet_id);
+      }
+      for (const auto& tablet_id : ts_meta.starting_tablets) {
+        ts_meta.load += GetTabletWeight(tablet_id);
+      }
+      ts_meta.leader_load = 0;
+      for (const auto& tablet_id : ts_meta.leaders) {
+        ts_meta.leader_load += GetLeaderWeight(tablet_id);
+      }
+    }
   }
 
   void SetBlacklist(const BlacklistPB& blacklist) { blacklist_ = blacklist; }
@@ -211,9 +305,21 @@ class ClusterLoadBalancer::ClusterLoadState {
         return false;
       }
 
+      // Fill load info. Replicas that are catching up report less than the others, so the tablet
+      // is accounted for with the most loaded of them.
+      TabletLoad load;
+      const bool has_load = ts_meta_it->second.descriptor->GetTabletLoad(tablet_id, &load);
+      const double ops_per_sec = load.read_ops_per_sec + load.write_ops_per_sec;
+      if (has_load) {
+        tablet_meta.size =
+            std::max<uint64_t>(tablet_meta.size, load.sst_files_size + load.memtables_size);
+        tablet_meta.ops_per_sec = std::max(tablet_meta.ops_per_sec, ops_per_sec);
+      }
+
       // Fill leader info.
       if (replica.second.role == consensus::RaftPeerPB::LEADER) {
         tablet_meta.leader_uuid = ts_uuid;
+        tablet_meta.leader_ops_per_sec = ops_per_sec;
         ts_meta_it->second.leaders.insert(tablet_id);
       }
 
@@ -457,7 +563,10 @@ class ClusterLoadBalancer::ClusterLoadState {
   }
 
   void AddReplica(const TabletId& tablet_id, const TabletServerId& to_ts) {
-    per_ts_meta_[to_ts].starting_tablets.insert(tablet_id);
+    auto& ts_meta = per_ts_meta_[to_ts];
+    if (ts_meta.starting_tablets.insert(tablet_id).second) {
+      ts_meta.load += GetTabletWeight(tablet_id);
+    }
     ++per_tablet_meta_[tablet_id].starting;
     ++total_starting_;
     tablets_added_.insert(tablet_id);
@@ -465,13 +574,14 @@ class ClusterLoadBalancer::ClusterLoadState {
   }
 
   void RemoveReplica(const TabletId& tablet_id, const TabletServerId& from_ts) {
-    if (per_ts_meta_[from_ts].running_tablets.count(tablet_id)) {
-      per_ts_meta_[from_ts].running_tablets.erase(tablet_id);
+    auto& ts_meta = per_ts_meta_[from_ts];
+    if (ts_meta.running_tablets.erase(tablet_id)) {
+      ts_meta.load -= GetTabletWeight(tablet_id);
       --per_tablet_meta_[tablet_id].running;
       --total_running_;
     }
-    if (per_ts_meta_[from_ts].starting_tablets.count(tablet_id)) {
-      per_ts_meta_[from_ts].starting_tablets.erase(tablet_id);
+    if (ts_meta.starting_tablets.erase(tablet_id)) {
+      ts_meta.load -= GetTabletWeight(tablet_id);
       --per_tablet_meta_[tablet_id].starting;
       --total_starting_;
     }
@@ -498,9 +608,12 @@ class ClusterLoadBalancer::ClusterLoadState {
       const TabletId& tablet_id, const TabletServerId& from_ts, const TabletServerId& to_ts = "") {
     DCHECK_EQ(per_tablet_meta_[tablet_id].leader_uuid, from_ts);
     per_tablet_meta_[tablet_id].leader_uuid = to_ts;
-    per_ts_meta_[from_ts].leaders.erase(tablet_id);
-    if (!to_ts.empty()) {
-      per_ts_meta_[to_ts].leaders.insert(tablet_id);
+    const double leader_weight = GetLeaderWeight(tablet_id);
+    if (per_ts_meta_[from_ts].leaders.erase(tablet_id)) {
+      per_ts_meta_[from_ts].leader_load -= leader_weight;
+    }
+    if (!to_ts.empty() && per_ts_meta_[to_ts].leaders.insert(tablet_id).second) {
+      per_ts_meta_[to_ts].leader_load += leader_weight;
     }
     SortLeaderLoad();
   }
@@ -512,7 +625,8 @@ class ClusterLoadBalancer::ClusterLoadState {
 
   inline bool IsLeaderLoadBelowThreshold(const TabletServerId& ts_uuid) {
       return ((leader_balance_threshold_ > 0) &&
-              (GetLeaderLoad(ts_uuid) <= leader_balance_threshold_));
+              (static_cast<int>(per_ts_meta_.at(ts_uuid).leaders.size()) <=
+                  leader_balance_threshold_));
   }
 
   void AdjustLeaderBalanceThreshold() {
@@ -802,6 +916,9 @@ bool ClusterLoadBalancer::AnalyzeTablets(const TableId& table_uuid) {
     }
   }
 
+  // Now that all the tablets are known, weigh them against each other.
+  state_->ComputeTabletWeights();
+
   // After updating the tablets and tablet servers, adjust the configured threshold if it is too
   // low for the given configuration.
   state_->AdjustLeaderBalanceThreshold();
@@ -948,7 +1065,7 @@ void ClusterLoadBalancer::DumpSortedLoad() const {
   out << "Table load: ";
   for (int left = 0; left <= last_pos; ++left) {
     const TabletServerId& uuid = state_->sorted_load_[left];
-    int load = state_->GetLoad(uuid);
+    double load = state_->GetLoad(uuid);
     out << uuid << ":" << load << " ";
   }
   VLOG(1) << out.str();
@@ -985,7 +1102,7 @@ bool ClusterLoadBalancer::GetLoadToMove(
     for (int right = last_pos; right >= 0; --right) {
       const TabletServerId& low_load_uuid = state_->sorted_load_[left];
       const TabletServerId& high_load_uuid = state_->sorted_load_[right];
-      int load_variance = state_->GetLoad(high_load_uuid) - state_->GetLoad(low_load_uuid);
+      double load_variance = state_->GetLoad(high_load_uuid) - state_->GetLoad(low_load_uuid);
 
       // Check for state change or end conditions.
       if (left == right || load_variance < options_.kMinLoadVarianceToBalance) {
@@ -999,7 +1116,7 @@ bool ClusterLoadBalancer::GetLoadToMove(
       }
 
       // If we don't find a tablet_id to move between these two TSs, advance the state.
-      if (GetTabletToMove(high_load_uuid, low_load_uuid, moving_tablet_id)) {
+      if (GetTabletToMove(high_load_uuid, low_load_uuid, load_variance, moving_tablet_id)) {
         // If we got this far, we have the candidate we want, so fill in the output params and
         // return. The tablet_id is filled in from GetTabletToMove.
         *from_ts = high_load_uuid;
@@ -1038,7 +1155,8 @@ bool ClusterLoadBalancer::SkipLeaderAsVictim(const TabletId& tablet_id) const {
 }
 
 bool ClusterLoadBalancer::GetTabletToMove(
-    const TabletServerId& from_ts, const TabletServerId& to_ts, TabletId* moving_tablet_id) {
+    const TabletServerId& from_ts, const TabletServerId& to_ts, double load_variance,
+    TabletId* moving_tablet_id) {
   const auto& from_ts_meta = state_->per_ts_meta_[from_ts];
   set<TabletId> non_over_replicated_tablets;
   set<TabletId> all_tablets;
@@ -1062,7 +1180,20 @@ bool ClusterLoadBalancer::GetTabletToMove(
 
   bool same_placement = state_->per_ts_meta_[from_ts].descriptor->placement_id() ==
                         state_->per_ts_meta_[to_ts].descriptor->placement_id();
+  bool found = false;
+  double best_distance = 0;
   for (const auto& tablet_id : non_over_replicated_tablets) {
+    // Moving a tablet at least as heavy as the load variance would not make the two TSs any closer
+    // in load. Amongst the others, the best is the one that leaves them evenest, i.e. the one with
+    // weight closest to half the variance.
+    const double weight = state_->GetTabletWeight(tablet_id);
+    if (weight >= load_variance) {
+      continue;
+    }
+    const double distance = std::abs(weight - load_variance / 2);
+    if (found && distance >= best_distance) {
+      continue;
+    }
     const auto& placement_info = GetPlacementByTablet(tablet_id);
     // TODO(bogdan): this should be augmented as well to allow dropping by one replica, if still
     // leaving us with more than the minimum.
@@ -1080,12 +1211,13 @@ bool ClusterLoadBalancer::GetTabletToMove(
     }
     // If we got here, it means we either have no placement, in which case we can pick any TS, or
     // we have placement and it's valid to move across these two tablet servers, so set the tablet
-    // and leave.
+    // as the best candidate so far.
     *moving_tablet_id = tablet_id;
-    return true;
+    best_distance = distance;
+    found = true;
   }
   // If we couldn't select a tablet above, we have to return failure.
-  return false;
+  return found;
 }
 
 bool ClusterLoadBalancer::GetLeaderToMove(
@@ -1122,7 +1254,7 @@ bool ClusterLoadBalancer::GetLeaderToMove(
     for (int right = last_pos; right >= 0; --right) {
       const TabletServerId& low_load_uuid = state_->sorted_leader_load_[left];
       const TabletServerId& high_load_uuid = state_->sorted_leader_load_[right];
-      int load_variance =
+      double load_variance =
           state_->GetLeaderLoad(high_load_uuid) - state_->GetLeaderLoad(low_load_uuid);
 
       // Check for state change or end conditions.
@@ -1144,10 +1276,15 @@ bool ClusterLoadBalancer::GetLeaderToMove(
       const auto& itr = std::inserter(intersection, intersection.begin());
       std::set_intersection(leaders.begin(), leaders.end(), peers.begin(), peers.end(), itr);
 
+      // Move the heaviest of the eligible leaders, as it balances the most load at once.
+      const TabletId* best_tablet_id = nullptr;
+      double best_weight = 0;
       for (const auto& tablet_id : intersection) {
-        *moving_tablet_id = tablet_id;
-        *from_ts = high_load_uuid;
-        *to_ts = low_load_uuid;
+        // Moving a leader at least as heavy as the load variance would not balance anything.
+        const double weight = state_->GetLeaderWeight(tablet_id);
+        if (weight >= load_variance || (best_tablet_id != nullptr && weight <= best_weight)) {
+          continue;
+        }
 
         const auto& per_tablet_meta = state_->per_tablet_meta_;
         const auto tablet_meta_iter = per_tablet_meta.find(tablet_id);
@@ -1159,16 +1296,23 @@ bool ClusterLoadBalancer::GetLeaderToMove(
             const auto time_since_failure = current_time - stepdown_failure_iter->second;
             if (time_since_failure.ToMilliseconds() < FLAGS_min_leader_stepdown_retry_interval_ms) {
               LOG(INFO) << "Cannot move tablet " << tablet_id << " leader from TS "
-                        << *from_ts << " to TS " << *to_ts << " yet: previous attempt with the same"
-                        << " intended leader failed only " << ToString(time_since_failure)
-                        << " ago (less " << "than " << FLAGS_min_leader_stepdown_retry_interval_ms
-                        << "ms).";
+                        << high_load_uuid << " to TS " << low_load_uuid << " yet: previous attempt"
+                        << " with the same intended leader failed only "
+                        << ToString(time_since_failure) << " ago (less " << "than "
+                        << FLAGS_min_leader_stepdown_retry_interval_ms << "ms).";
             }
             continue;
           }
         } else {
-          LOG(WARNING) << "Did not find load balancer metadata for tablet " << *moving_tablet_id;
+          LOG(WARNING) << "Did not find load balancer metadata for tablet " << tablet_id;
         }
+        best_tablet_id = &tablet_id;
+        best_weight = weight;
+      }
+      if (best_tablet_id != nullptr) {
+        *moving_tablet_id = *best_tablet_id;
+        *from_ts = high_load_uuid;
+        *to_ts = low_load_uuid;
         return true;
       }
     }
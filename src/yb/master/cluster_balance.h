@@ -237,8 +237,12 @@ class ClusterLoadBalancer {
   // Returns false otherwise.
   bool GetLoadToMove(TabletId* moving_tablet_id, TabletServerId* from_ts, TabletServerId* to_ts);
 
+  // Pick the tablet to move from from_ts to to_ts, given the difference of load between them.
+  //
+  // Returns true if a tablet could be picked and sets moving_tablet_id, false otherwise.
   bool GetTabletToMove(
-      const TabletServerId& from_ts, const TabletServerId& to_ts, TabletId* moving_tablet_id);
+      const TabletServerId& from_ts, const TabletServerId& to_ts, double load_variance,
+      TabletId* moving_tablet_id);
 
   // Go through sorted_leader_load_ and figure out which leader to rebalance and from which TS
   // that is serving it to which other TS.
@@ -391,6 +391,50 @@ TEST_F(MasterTest, TestRegisterAndHeartbeat) {
   }
 }
 
+TEST_F(MasterTest, TestIncrementalTabletReports) {
+  TSToMasterCommonPB common;
+  common.mutable_ts_instance()->set_permanent_uuid("my-ts-uuid");
+  common.mutable_ts_instance()->set_instance_seqno(1);
+
+  TSRegistrationPB fake_reg;
+  MakeHostPortPB("localhost", 1000, fake_reg.mutable_common()->add_rpc_addresses());
+  MakeHostPortPB("localhost", 2000, fake_reg.mutable_common()->add_http_addresses());
+
+  // Send a tablet report with the given sequence number, and return whether the master
+  // asked for a full tablet report in response.
+  auto send_report = [&](bool is_incremental, int32_t sequence_number, bool register_ts) {
+    TSHeartbeatRequestPB req;
+    TSHeartbeatResponsePB resp;
+    req.mutable_common()->CopyFrom(common);
+    if (register_ts) {
+      req.mutable_registration()->CopyFrom(fake_reg);
+    }
+    TabletReportPB* tr = req.mutable_tablet_report();
+    tr->set_is_incremental(is_incremental);
+    tr->set_sequence_number(sequence_number);
+    EXPECT_OK(proxy_->TSHeartbeat(req, &resp, ResetAndGetController()));
+    EXPECT_FALSE(resp.needs_reregister());
+    return resp.needs_full_tablet_report();
+  };
+
+  // An incremental report before any full report is ignored.
+  ASSERT_TRUE(send_report(true, 0, true /* register_ts */));
+  ASSERT_FALSE(send_report(false, 1, false /* register_ts */));
+  ASSERT_FALSE(send_report(true, 2, false /* register_ts */));
+  ASSERT_FALSE(send_report(true, 3, false /* register_ts */));
+
+  // A report that does not follow the last one makes the master ask for a full report until it
+  // gets one.
+  ASSERT_TRUE(send_report(true, 3, false /* register_ts */));
+  ASSERT_TRUE(send_report(true, 4, false /* register_ts */));
+  ASSERT_FALSE(send_report(false, 5, false /* register_ts */));
+  ASSERT_FALSE(send_report(true, 6, false /* register_ts */));
+
+  // Re-registering requires a full report again.
+  ASSERT_TRUE(send_report(true, 7, true /* register_ts */));
+  ASSERT_FALSE(send_report(false, 0, false /* register_ts */));
+}
+
 Status MasterTest::CreateTable(const TableName& table_name,
                                const Schema& schema,
                                const NamespaceName& namespace_name /* = "" */) {
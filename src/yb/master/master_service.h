@@ -155,6 +155,10 @@ class MasterServiceImpl : public MasterServiceIf,
       const IsLoadBalancedRequestPB* req, IsLoadBalancedResponsePB* resp,
       rpc::RpcContext rpc) override;
 
+  virtual void SplitTablet(
+      const SplitTabletRequestPB* req, SplitTabletResponsePB* resp,
+      rpc::RpcContext rpc) override;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MasterServiceImpl);
 };
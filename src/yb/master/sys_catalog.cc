@@ -111,6 +111,7 @@ SysCatalogTable::SysCatalogTable(Master* master, MetricRegistry* metrics,
       master_(master),
       leader_cb_(std::move(leader_cb)) {
   CHECK_OK(ThreadPoolBuilder("apply").Build(&apply_pool_));
+  CHECK_OK(ThreadPoolBuilder("prepare").Build(&prepare_pool_));
 }
 
 SysCatalogTable::~SysCatalogTable() {
@@ -121,6 +122,7 @@ void SysCatalogTable::Shutdown() {
     tablet_peer_->Shutdown();
   }
   apply_pool_->Shutdown();
+  prepare_pool_->Shutdown();
 }
 
 Status SysCatalogTable::ConvertConfigToMasterAddresses(
@@ -420,6 +422,7 @@ Status SysCatalogTable::GoIntoShellMode() {
 
   tablet_peer_.reset();
   apply_pool_.reset();
+  prepare_pool_.reset();
 
   return Status::OK();
 }
@@ -433,6 +436,7 @@ void SysCatalogTable::SetupTabletPeer(const scoped_refptr<tablet::TabletMetadata
     new TabletPeerClass(metadata,
                         local_peer_pb_,
                         apply_pool_.get(),
+                        prepare_pool_.get(),
                         Bind(&SysCatalogTable::SysCatalogStateChanged,
                              Unretained(this),
                              metadata->tablet_id())));
@@ -212,6 +212,7 @@ class SysCatalogTable {
   MetricRegistry* metric_registry_;
 
   gscoped_ptr<ThreadPool> apply_pool_;
+  gscoped_ptr<ThreadPool> prepare_pool_;
 
   scoped_refptr<tablet::TabletPeer> tablet_peer_;
 
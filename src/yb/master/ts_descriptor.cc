@@ -62,6 +62,7 @@ TSDescriptor::TSDescriptor(std::string perm_id)
       latest_seqno_(-1),
       last_heartbeat_(MonoTime::Now(MonoTime::FINE)),
       has_tablet_report_(false),
+      latest_report_seqno_(-1),
       recent_replica_creations_(0),
       last_replica_creations_decay_(MonoTime::Now(MonoTime::FINE)),
       num_live_replicas_(0) {
@@ -91,6 +92,7 @@ Status TSDescriptor::Register(const NodeInstancePB& instance,
   latest_seqno_ = instance.instance_seqno();
   // After re-registering, make the TS re-report its tablets.
   has_tablet_report_ = false;
+  latest_report_seqno_ = -1;
 
   registration_.reset(new TSRegistrationPB(registration));
   placement_id_ = generate_placement_id(registration.common().cloud_info());
@@ -136,6 +138,41 @@ void TSDescriptor::set_has_tablet_report(bool has_report) {
   has_tablet_report_ = has_report;
 }
 
+bool TSDescriptor::UpdateTabletReportSeqno(const TabletReportPB& report) {
+  std::lock_guard<simple_spinlock> l(lock_);
+  if (report.is_incremental() &&
+      (!has_tablet_report_ || report.sequence_number() <= latest_report_seqno_)) {
+    has_tablet_report_ = false;
+    return false;
+  }
+  latest_report_seqno_ = report.sequence_number();
+  return true;
+}
+
+void TSDescriptor::UpdateTabletLoads(
+    const google::protobuf::RepeatedPtrField<TabletLoadPB>& tablet_loads) {
+  std::unordered_map<std::string, TabletLoad> loads;
+  for (const TabletLoadPB& load_pb : tablet_loads) {
+    TabletLoad& load = loads[load_pb.tablet_id()];
+    load.sst_files_size = load_pb.sst_files_size();
+    load.memtables_size = load_pb.memtables_size();
+    load.read_ops_per_sec = load_pb.read_ops_per_sec();
+    load.write_ops_per_sec = load_pb.write_ops_per_sec();
+  }
+  std::lock_guard<simple_spinlock> l(lock_);
+  tablet_loads_.swap(loads);
+}
+
+bool TSDescriptor::GetTabletLoad(const std::string& tablet_id, TabletLoad* load) const {
+  std::lock_guard<simple_spinlock> l(lock_);
+  auto it = tablet_loads_.find(tablet_id);
+  if (it == tablet_loads_.end()) {
+    return false;
+  }
+  *load = it->second;
+  return true;
+}
+
 void TSDescriptor::DecayRecentReplicaCreationsUnlocked() {
   // In most cases, we won't have any recent replica creations, so
   // we don't need to bother calling the clock, etc.
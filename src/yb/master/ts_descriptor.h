@@ -35,6 +35,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/tserver/tserver_service.proxy.h"
@@ -58,6 +59,8 @@ class TabletServerServiceProxy;
 
 namespace master {
 
+class TabletLoadPB;
+class TabletReportPB;
 class TSRegistrationPB;
 class TSInformationPB;
 
@@ -65,6 +68,14 @@ typedef util::SharedPtrTuple<tserver::TabletServerAdminServiceProxy,
                              tserver::TabletServerServiceProxy,
                              consensus::ConsensusServiceProxy> ProxyTuple;
 
+// The load of a tablet replica, as last reported by the tablet server hosting it.
+struct TabletLoad {
+  uint64_t sst_files_size = 0;
+  uint64_t memtables_size = 0;
+  double read_ops_per_sec = 0;
+  double write_ops_per_sec = 0;
+};
+
 // Master-side view of a single tablet server.
 //
 // Tracks the last heartbeat, status, instance identifier, etc.
@@ -96,6 +107,11 @@ class TSDescriptor {
   bool has_tablet_report() const;
   void set_has_tablet_report(bool has_report);
 
+  // Record the sequence number of a tablet report received from this TS. Returns false if the
+  // report is an incremental one that does not follow the last report received, in which case
+  // the TS has to send a full tablet report.
+  bool UpdateTabletReportSeqno(const TabletReportPB& report);
+
   // Copy the current registration info into the given PB object.
   // A safe copy is returned because the internal Registration object
   // may be mutated at any point if the tablet server re-registers.
@@ -147,6 +163,13 @@ class TSDescriptor {
     return num_live_replicas_;
   }
 
+  // Replace the loads of the tablet replicas of this TS with the ones from its latest heartbeat.
+  void UpdateTabletLoads(const google::protobuf::RepeatedPtrField<TabletLoadPB>& tablet_loads);
+
+  // Get the last reported load of the replica of the given tablet on this TS. Returns false if
+  // none was reported.
+  bool GetTabletLoad(const std::string& tablet_id, TabletLoad* load) const;
+
   // Set of methods to keep track of pending tablet deletes for a tablet server. We use them to
   // avoid assigning more tablets to a tserver that might be potentially unresponsive.
   bool HasTabletDeletePending() const;
@@ -181,6 +204,9 @@ class TSDescriptor {
   // Set to true once this instance has reported all of its tablets.
   bool has_tablet_report_;
 
+  // Sequence number of the last tablet report received from this instance.
+  int32_t latest_report_seqno_;
+
   // The number of times this tablet server has recently been selected to create a
   // tablet replica. This value decays back to 0 over time.
   double recent_replica_creations_;
@@ -197,6 +223,9 @@ class TSDescriptor {
   // Set of tablet uuids for which a delete is pending on this tablet server.
   std::set<std::string> tablets_pending_delete_;
 
+  // The loads of the tablet replicas of this TS, as of its last load report.
+  std::unordered_map<std::string, TabletLoad> tablet_loads_;
+
   DISALLOW_COPY_AND_ASSIGN(TSDescriptor);
 };
 
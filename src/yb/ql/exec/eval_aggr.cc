@@ -0,0 +1,193 @@
+//--------------------------------------------------------------------------------------------------
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+// Aggregate functions are evaluated by the tablet servers over the rows of each tablet. Each
+// tablet returns one row of partial results, which are combined here into the result row.
+//--------------------------------------------------------------------------------------------------
+
+#include "yb/ql/exec/executor.h"
+#include "yb/common/ql_expr.h"
+
+namespace yb {
+namespace ql {
+
+using yb::bfql::TSOpcode;
+
+namespace {
+
+TSOpcode GetAggregateOpcode(const PTExpr::SharedPtr& expr) {
+  return static_cast<TSOpcode>(static_cast<const PTBcall*>(expr.get())->bfopcode());
+}
+
+// The result of SUM and AVG over no rows is zero.
+CHECKED_STATUS SetZero(const DataType datatype, QLValueWithPB *value) {
+  switch (datatype) {
+    case DataType::INT8:
+      value->set_int8_value(0);
+      return Status::OK();
+    case DataType::INT16:
+      value->set_int16_value(0);
+      return Status::OK();
+    case DataType::INT32:
+      value->set_int32_value(0);
+      return Status::OK();
+    case DataType::INT64:
+      value->set_int64_value(0);
+      return Status::OK();
+    case DataType::FLOAT:
+      value->set_float_value(0);
+      return Status::OK();
+    case DataType::DOUBLE:
+      value->set_double_value(0);
+      return Status::OK();
+    default:
+      break;
+  }
+  return STATUS(NotSupported, "Aggregate function is not supported for this datatype");
+}
+
+// AVG is the SUM of its argument divided by the COUNT of it, in the datatype of the argument. The
+// SUM is in the wider datatype of AverageSumDataType(), so the quotient always fits.
+CHECKED_STATUS Divide(const QLValuePB& sum, const int64_t count, const DataType datatype,
+                      QLValueWithPB *result) {
+  switch (datatype) {
+    case DataType::INT8:
+      result->set_int8_value(static_cast<int8_t>(sum.int64_value() / count));
+      return Status::OK();
+    case DataType::INT16:
+      result->set_int16_value(static_cast<int16_t>(sum.int64_value() / count));
+      return Status::OK();
+    case DataType::INT32:
+      result->set_int32_value(static_cast<int32_t>(sum.int64_value() / count));
+      return Status::OK();
+    case DataType::INT64:
+      result->set_int64_value(sum.int64_value() / count);
+      return Status::OK();
+    case DataType::FLOAT:
+      result->set_float_value(static_cast<float>(sum.double_value() / count));
+      return Status::OK();
+    case DataType::DOUBLE:
+      result->set_double_value(sum.double_value() / count);
+      return Status::OK();
+    default:
+      break;
+  }
+  return STATUS(NotSupported, "Aggregate function is not supported for this datatype");
+}
+
+} // namespace
+
+//--------------------------------------------------------------------------------------------------
+
+CHECKED_STATUS Executor::AggregatesToPB(const PTSelectStmt *tnode, QLReadRequestPB *req) {
+  req->set_is_aggregate(true);
+
+  // Tablet servers cannot average their rows with those of other tablets. They return the SUM of
+  // the argument of each AVG instead, in the wider datatype of AverageSumDataType(), and the COUNT
+  // of it as an extra partial result after the selected expressions.
+  const int num_selected_exprs = req->selected_exprs_size();
+  for (int i = 0; i < num_selected_exprs; i++) {
+    const QLBCallPB& tscall = req->selected_exprs(i).tscall();
+    if (static_cast<TSOpcode>(tscall.opcode()) != TSOpcode::kAvg) {
+      continue;
+    }
+    QLTypePB *sum_type_pb = req->mutable_rsrow_desc()->mutable_rscol_descs(i)->mutable_ql_type();
+    sum_type_pb->set_main(AverageSumDataType(sum_type_pb->main()));
+
+    QLBCallPB *count_pb = req->add_selected_exprs()->mutable_tscall();
+    count_pb->set_opcode(static_cast<int32_t>(TSOpcode::kCount));
+    count_pb->mutable_operands()->CopyFrom(req->selected_exprs(i).tscall().operands());
+
+    QLRSColDescPB *rscol_desc_pb = req->mutable_rsrow_desc()->add_rscol_descs();
+    rscol_desc_pb->set_name("count");
+    QLType::Create(DataType::INT64)->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+  }
+  return Status::OK();
+}
+
+CHECKED_STATUS Executor::AggregateResultSets(const PTSelectStmt *tnode) {
+  const MCList<PTExpr::SharedPtr>& exprs = tnode->selected_exprs();
+
+  // Combine the rows of partial results returned by the tablets. Partial results of AVG are SUMs
+  // followed by the COUNTs in the order of the AVGs.
+  std::vector<TSOpcode> partial_opcodes;
+  for (const auto& expr : exprs) {
+    const TSOpcode tsopcode = GetAggregateOpcode(expr);
+    partial_opcodes.push_back(tsopcode == TSOpcode::kAvg ? TSOpcode::kSum : tsopcode);
+  }
+  for (const auto& expr : exprs) {
+    if (GetAggregateOpcode(expr) == TSOpcode::kAvg) {
+      partial_opcodes.push_back(TSOpcode::kCount);
+    }
+  }
+
+  std::vector<QLValuePB> partials(partial_opcodes.size());
+  if (result_ != nullptr) {
+    std::unique_ptr<QLRowBlock> row_block = static_cast<RowsResult&>(*result_).GetRowBlock();
+    for (const QLRow& row : row_block->rows()) {
+      if (row.column_count() != partials.size()) {
+        return STATUS(Corruption, "Unexpected number of partial aggregate results");
+      }
+      for (size_t i = 0; i < partials.size(); i++) {
+        const auto& partial = static_cast<const QLValueWithPB&>(row.column(i)).value();
+        RETURN_NOT_OK(CombineAggregate(partial_opcodes[i], partial, &partials[i]));
+      }
+    }
+  }
+
+  // Compute the result row from the partial results.
+  std::vector<QLValueWithPB> values(exprs.size());
+  size_t column_index = 0;
+  size_t count_index = exprs.size();
+  for (const auto& expr : exprs) {
+    const QLValuePB& partial = partials[column_index];
+    QLValueWithPB *value = &values[column_index];
+    switch (GetAggregateOpcode(expr)) {
+      case TSOpcode::kCount: FALLTHROUGH_INTENDED;
+      case TSOpcode::kSum:
+        if (QLValue::IsNull(partial)) {
+          RETURN_NOT_OK(SetZero(expr->ql_type()->main(), value));
+        } else {
+          value->Assign(partial);
+        }
+        break;
+
+      case TSOpcode::kAvg: {
+        const QLValuePB& count = partials[count_index++];
+        if (QLValue::IsNull(partial) || QLValue::IsNull(count) || count.int64_value() == 0) {
+          RETURN_NOT_OK(SetZero(expr->ql_type()->main(), value));
+        } else {
+          RETURN_NOT_OK(Divide(partial, count.int64_value(), expr->ql_type()->main(), value));
+        }
+        break;
+      }
+
+      default:
+        // MIN and MAX over no rows are null.
+        value->Assign(partial);
+        break;
+    }
+    column_index++;
+  }
+
+  QLRowBlock row_block(Schema(*tnode->selected_schemas(), 0));
+  row_block.Extend().SetColumnValues(values);
+  faststring buffer;
+  row_block.Serialize(QLClient::YQL_CLIENT_CQL, &buffer);
+  result_ = std::make_shared<RowsResult>(tnode->table_name(), tnode->selected_schemas(),
+                                         buffer.ToString());
+  return Status::OK();
+}
+
+}  // namespace ql
+}  // namespace yb
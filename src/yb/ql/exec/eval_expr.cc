@@ -96,6 +96,7 @@ CHECKED_STATUS Executor::PTExprToPB(const PTBindVar *bind_pt, QLExpressionPB *ex
                                                          bind_pt->ql_type(),
                                                          value.get()));
   expr_pb->set_allocated_value(value.release());
+  num_bind_vars_converted_++;
   return Status::OK();
 }
 
@@ -20,6 +20,8 @@
 #ifndef YB_QL_EXEC_EXEC_CONTEXT_H_
 #define YB_QL_EXEC_EXEC_CONTEXT_H_
 
+#include <vector>
+
 #include "yb/ql/ptree/process_context.h"
 #include "yb/ql/util/ql_env.h"
 #include "yb/ql/util/statement_result.h"
@@ -130,9 +132,27 @@ class ExecContext : public ProcessContextBase {
   }
   CHECKED_STATUS ApplyRead(std::shared_ptr<client::YBqlReadOp> op) {
     op_ = op;
+    parallel_reads_.clear();
     return ql_env_->ApplyRead(op);
   }
 
+  // Apply YBClient read operations that scan consecutive tablets in parallel, in partition order.
+  // The first operation is the one of the statement.
+  CHECKED_STATUS ApplyParallelReads(std::vector<std::shared_ptr<client::YBqlReadOp>> ops) {
+    op_ = ops.front();
+    for (const auto& op : ops) {
+      RETURN_NOT_OK(ql_env_->ApplyRead(op));
+    }
+    parallel_reads_ = std::move(ops);
+    return Status::OK();
+  }
+
+  // Access function for the parallel read operations. Empty if the statement was not executed
+  // with parallel reads.
+  const std::vector<std::shared_ptr<client::YBqlReadOp>>& parallel_reads() const {
+    return parallel_reads_;
+  }
+
   // Variants of ProcessContextBase::Error() that report location of statement tnode as the error
   // location.
   using ProcessContextBase::Error;
@@ -150,6 +170,9 @@ class ExecContext : public ProcessContextBase {
   // Read/write operation to execute.
   std::shared_ptr<client::YBqlOp> op_;
 
+  // Read operations scanning consecutive tablets in parallel.
+  std::vector<std::shared_ptr<client::YBqlReadOp>> parallel_reads_;
+
   // Execution start time.
   const MonoTime start_time_;
 
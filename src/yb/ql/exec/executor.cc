@@ -14,13 +14,26 @@
 //--------------------------------------------------------------------------------------------------
 
 #include "yb/ql/exec/executor.h"
+
+#include <algorithm>
+
+#include <gflags/gflags.h>
+
 #include "yb/util/logging.h"
 #include "yb/client/callbacks.h"
 #include "yb/common/partition.h"
 #include "yb/ql/ql_processor.h"
 #include "yb/util/decimal.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/yb_partition.h"
 
+DEFINE_int32(cql_parallel_scan_max_tablets, 4,
+             "Maximum number of tablets a SELECT statement without a full hash key reads in "
+             "parallel once it has read a whole tablet without filling its page. A value of 1 "
+             "or less reads the tablets one at a time.");
+TAG_FLAG(cql_parallel_scan_max_tablets, advanced);
+TAG_FLAG(cql_parallel_scan_max_tablets, runtime);
+
 namespace yb {
 namespace ql {
 
@@ -474,8 +487,9 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
                                            &current_row_count));
   }
 
-  // If the current result hits the request page size already, return the result.
-  if (current_row_count >= exec_context_->params()->page_size()) {
+  // If the current result hits the request page size already, return the result. The rows of
+  // partial aggregate results are not subject to the page size.
+  if (!tnode->is_aggregate() && current_row_count >= exec_context_->params()->page_size()) {
     return Status::OK();
   }
 
@@ -495,6 +509,9 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
 
   // If where clause restrictions guarantee no rows could match, return empty result immediately.
   if (no_results) {
+    if (tnode->is_aggregate()) {
+      return AggregateResultSets(tnode);
+    }
     QLRowBlock empty_row_block(tnode->table()->InternalSchema(), {});
     faststring buffer;
     empty_row_block.Serialize(select_op->request().client(), &buffer);
@@ -514,37 +531,19 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     }
   }
 
-  // Specify selected list by adding the expressions to selected_exprs in read request.
-  QLRSRowDescPB *rsrow_desc_pb = req->mutable_rsrow_desc();
-  for (const auto& expr : tnode->selected_exprs()) {
-    if (expr->opcode() == TreeNodeOpcode::kPTAllColumns) {
-      st = PTExprToPB(static_cast<const PTAllColumns*>(expr.get()), req);
-    } else {
-      st = PTExprToPB(expr, req->add_selected_exprs());
-      if (PREDICT_FALSE(!st.ok())) {
-        return exec_context_->Error(st, ErrorCode::INVALID_ARGUMENTS);
-      }
-
-      // Add the expression metadata (rsrow descriptor).
-      QLRSColDescPB *rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
-      rscol_desc_pb->set_name(expr->QLName());
-      expr->ql_type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
-    }
-  }
-
-  // Setup the column values that need to be read.
-  st = ColumnRefsToPB(tnode, req->mutable_column_refs());
+  // Specify selected list, the column values that need to be read and distinct columns or non.
+  st = SelectedExprsToPB(tnode, req);
   if (PREDICT_FALSE(!st.ok())) {
     return exec_context_->Error(st, ErrorCode::INVALID_ARGUMENTS);
   }
 
-  // Specify distinct columns or non.
-  req->set_distinct(tnode->distinct());
-
   // Default row count limit is the page size less the rows buffered in current result locally.
-  // And we should return paging state when page size limit is hit.
-  req->set_limit(exec_context_->params()->page_size() - current_row_count);
-  req->set_return_paging_state(true);
+  // And we should return paging state when page size limit is hit. Aggregate functions read all
+  // rows and return one row per tablet.
+  if (!tnode->is_aggregate()) {
+    req->set_limit(exec_context_->params()->page_size() - current_row_count);
+    req->set_return_paging_state(true);
+  }
 
   // Check if there is a limit and compute the new limit based on the number of returned rows.
   if (tnode->has_limit()) {
@@ -562,7 +561,8 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     if (limit < 0) {
       return exec_context_->Error("LIMIT value cannot be negative.", ErrorCode::INVALID_ARGUMENTS);
     }
-    if (limit == 0 || paging_params->total_num_rows_read() >= limit) {
+    if (limit == 0 ||
+        (!tnode->is_aggregate() && paging_params->total_num_rows_read() >= limit)) {
       return Status::OK();
     }
 
@@ -570,7 +570,7 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     // the page size limit set from above, set the lower limit and do not return paging state when
     // this limit is hit.
     limit -= paging_params->total_num_rows_read();
-    if (limit < req->limit()) {
+    if (!tnode->is_aggregate() && limit < req->limit()) {
       req->set_limit(limit);
       req->set_return_paging_state(false);
     }
@@ -593,10 +593,106 @@ Status Executor::ExecPTNode(const PTSelectStmt *tnode) {
     select_op->set_yb_consistency_level(exec_context_->params()->yb_consistency_level());
   }
 
+  // If the rows buffered so far come from whole tablets without filling the page, the tablets are
+  // small relative to the page. Read the following tablets in parallel then rather than one round
+  // trip at a time.
+  if (current_result != nullptr && req->hashed_column_values().empty() && !tnode->is_system() &&
+      paging_params->next_row_key().empty() && FLAGS_cql_parallel_scan_max_tablets > 1) {
+    return ApplyParallelReads(table, select_op);
+  }
+
   // Apply the operator.
   return exec_context_->ApplyRead(select_op);
 }
 
+Status Executor::ApplyParallelReads(const shared_ptr<client::YBTable>& table,
+                                    shared_ptr<YBqlReadOp> select_op) {
+  const QLReadRequestPB& req = select_op->request();
+  string partition_key;
+  RETURN_NOT_OK(select_op->GetPartitionKey(&partition_key));
+  const string max_partition_key = req.has_max_hash_code() ?
+      PartitionSchema::EncodeMultiColumnHashValue(static_cast<uint16_t>(req.max_hash_code())) : "";
+
+  // The table's partitions are only a hint of where the tablets following the current one start.
+  // The responses are verified against it when they are merged.
+  const auto& partitions = table->GetPartitions();
+  auto partition = std::upper_bound(partitions.begin(), partitions.end(), partition_key);
+  const size_t max_reads = FLAGS_cql_parallel_scan_max_tablets;
+
+  std::vector<shared_ptr<YBqlReadOp>> ops;
+  ops.push_back(select_op);
+  for (; partition != partitions.end() && ops.size() < max_reads; ++partition) {
+    if (!max_partition_key.empty() && *partition >= max_partition_key) {
+      break;
+    }
+    shared_ptr<YBqlReadOp> op(table->NewQLSelect());
+    QLReadRequestPB* op_req = op->mutable_request();
+    const uint64_t request_id = op_req->request_id();
+    const int64_t query_id = op_req->query_id();
+    op_req->CopyFrom(req);
+    op_req->set_request_id(request_id);
+    op_req->set_query_id(query_id);
+    op_req->clear_paging_state();
+    op_req->mutable_paging_state()->set_next_partition_key(*partition);
+    op->set_yb_consistency_level(select_op->yb_consistency_level());
+    ops.push_back(std::move(op));
+  }
+
+  if (ops.size() == 1) {
+    return exec_context_->ApplyRead(select_op);
+  }
+  return exec_context_->ApplyParallelReads(std::move(ops));
+}
+
+Status Executor::SelectedExprsToPB(const PTSelectStmt *tnode, QLReadRequestPB *req) {
+  // Prepared statements are executed many times, so reuse the part of the request built by the
+  // first execution.
+  const auto read_request_template = tnode->read_request_template();
+  if (read_request_template != nullptr) {
+    req->MergeFrom(*read_request_template);
+    return Status::OK();
+  }
+
+  const size_t num_bind_vars_converted = num_bind_vars_converted_;
+
+  // Specify selected list by adding the expressions to selected_exprs in read request.
+  QLRSRowDescPB *rsrow_desc_pb = req->mutable_rsrow_desc();
+  for (const auto& expr : tnode->selected_exprs()) {
+    if (expr->opcode() == TreeNodeOpcode::kPTAllColumns) {
+      RETURN_NOT_OK(PTExprToPB(static_cast<const PTAllColumns*>(expr.get()), req));
+    } else {
+      RETURN_NOT_OK(PTExprToPB(expr, req->add_selected_exprs()));
+
+      // Add the expression metadata (rsrow descriptor).
+      QLRSColDescPB *rscol_desc_pb = rsrow_desc_pb->add_rscol_descs();
+      rscol_desc_pb->set_name(expr->QLName());
+      expr->ql_type()->ToQLTypePB(rscol_desc_pb->mutable_ql_type());
+    }
+  }
+
+  // Setup the column values that need to be read.
+  RETURN_NOT_OK(ColumnRefsToPB(tnode, req->mutable_column_refs()));
+
+  // Specify distinct columns or non.
+  req->set_distinct(tnode->distinct());
+
+  if (tnode->is_aggregate()) {
+    RETURN_NOT_OK(AggregatesToPB(tnode, req));
+  }
+
+  // Selected expressions that use bind variables have to be converted for every execution.
+  if (num_bind_vars_converted_ == num_bind_vars_converted) {
+    auto new_template = std::make_shared<QLReadRequestPB>();
+    new_template->mutable_selected_exprs()->CopyFrom(req->selected_exprs());
+    new_template->mutable_rsrow_desc()->CopyFrom(req->rsrow_desc());
+    new_template->mutable_column_refs()->CopyFrom(req->column_refs());
+    new_template->set_distinct(req->distinct());
+    new_template->set_is_aggregate(req->is_aggregate());
+    tnode->set_read_request_template(std::move(new_template));
+  }
+  return Status::OK();
+}
+
 //--------------------------------------------------------------------------------------------------
 
 Status Executor::ExecPTNode(const PTInsertStmt *tnode) {
@@ -757,17 +853,22 @@ void Executor::FlushAsyncDone(const Status &s) {
   if (ss.ok()) {
     ss = ProcessAsyncResults();
     if (ss.ok() && exec_context_->tnode()->opcode() == TreeNodeOpcode::kPTSelectStmt) {
+      const auto* select = static_cast<const PTSelectStmt*>(exec_context_->tnode());
       // If there is a paging state, try fetching more rows and buffer locally. ExecPTNode()
       // will ensure we do not exceed the page size.
       if (result_ != nullptr && !static_cast<const RowsResult&>(*result_).paging_state().empty()) {
         ql_env_->Reset();
-        ss = ExecTreeNode(static_cast<const PTSelectStmt*>(exec_context_->tnode()));
+        ss = ExecTreeNode(select);
         if (ss.ok()) {
           if (ql_env_->FlushAsync(&flush_async_cb_)) {
             return;
           }
         }
       }
+      // All tablets have been read. Combine their partial results of aggregate functions.
+      if (ss.ok() && select->is_aggregate()) {
+        ss = AggregateResultSets(select);
+      }
     }
   }
   StatementExecuted(ss);
@@ -825,16 +926,20 @@ Status Executor::ProcessAsyncResults() {
     if (exec_context.tnode() == nullptr) {
       continue; // Skip empty statement.
     }
-    client::YBqlOp* op = exec_context.op().get();
-    ss = ql_env_->GetOpError(op);
-    if (PREDICT_FALSE(!ss.ok())) {
-      // YBOperation returns not-found error when the tablet is not found.
-      const auto error_code =
-          ss.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID;
-      ss = exec_context.Error(ss, error_code);
-    }
-    if (ss.ok()) {
-      ss = ProcessOpResponse(op, &exec_context);
+    if (!exec_context.parallel_reads().empty()) {
+      ss = ProcessParallelReadResponses(&exec_context);
+    } else {
+      client::YBqlOp* op = exec_context.op().get();
+      ss = ql_env_->GetOpError(op);
+      if (PREDICT_FALSE(!ss.ok())) {
+        // YBOperation returns not-found error when the tablet is not found.
+        const auto error_code =
+            ss.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID;
+        ss = exec_context.Error(ss, error_code);
+      }
+      if (ss.ok()) {
+        ss = ProcessOpResponse(op, &exec_context);
+      }
     }
     ss = ProcessStatementStatus(*exec_context.parse_tree(), ss);
     if (PREDICT_FALSE(!ss.ok())) {
@@ -844,6 +949,55 @@ Status Executor::ProcessAsyncResults() {
   return s;
 }
 
+Status Executor::ProcessParallelReadResponses(ExecContext* exec_context) {
+  // Merge the rows in partition order. Stop at the first read that did not finish its tablet, or
+  // that did not end where the next read starts because the tablets have changed. The rows of the
+  // reads after it are discarded and read again in the next round. So are the rows of a read that
+  // would take the page past the row count limit.
+  const auto& ops = exec_context->parallel_reads();
+  const QLReadRequestPB& req = ops.front()->request();
+  int64_t total_num_rows_read = req.paging_state().total_num_rows_read();
+  size_t num_rows = 0;
+  for (size_t i = 0; i < ops.size(); i++) {
+    YBqlReadOp* op = ops[i].get();
+    Status s = ql_env_->GetOpError(op);
+    if (PREDICT_FALSE(!s.ok())) {
+      // YBOperation returns not-found error when the tablet is not found.
+      const auto error_code =
+          s.IsNotFound() ? ErrorCode::TABLET_NOT_FOUND : ErrorCode::SQL_STATEMENT_INVALID;
+      return exec_context->Error(s, error_code);
+    }
+    if (op->response().status() != QLResponsePB::YQL_STATUS_OK) {
+      return ProcessOpResponse(op, exec_context);
+    }
+
+    size_t op_num_rows = 0;
+    if (!op->rows_data().empty()) {
+      RETURN_NOT_OK(QLRowBlock::GetRowCount(req.client(), op->rows_data(), &op_num_rows));
+    }
+    if (i > 0 && req.has_limit() && num_rows + op_num_rows > req.limit()) {
+      break;
+    }
+    num_rows += op_num_rows;
+    total_num_rows_read += op_num_rows;
+
+    // Each read after the first one counts its rows from zero.
+    QLResponsePB* resp = op->mutable_response();
+    if (resp->has_paging_state()) {
+      resp->mutable_paging_state()->set_total_num_rows_read(total_num_rows_read);
+    }
+    RETURN_NOT_OK(ProcessOpResponse(op, exec_context));
+
+    if (i + 1 == ops.size() || !resp->has_paging_state() ||
+        !resp->paging_state().next_row_key().empty() ||
+        resp->paging_state().next_partition_key() !=
+            ops[i + 1]->request().paging_state().next_partition_key()) {
+      break;
+    }
+  }
+  return Status::OK();
+}
+
 Status Executor::AppendResult(const ExecutedResult::SharedPtr& result) {
   if (result == nullptr) {
     return Status::OK();
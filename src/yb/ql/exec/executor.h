@@ -92,6 +92,10 @@ class Executor {
   // Select statement.
   CHECKED_STATUS ExecPTNode(const PTSelectStmt *tnode);
 
+  // Reads the tablets following the one the select op starts from in parallel with it.
+  CHECKED_STATUS ApplyParallelReads(const std::shared_ptr<client::YBTable>& table,
+                                    std::shared_ptr<client::YBqlReadOp> select_op);
+
   // Insert statement.
   CHECKED_STATUS ExecPTNode(const PTInsertStmt *tnode);
 
@@ -119,6 +123,9 @@ class Executor {
   // Process the read/write op response.
   CHECKED_STATUS ProcessOpResponse(client::YBqlOp* op, ExecContext* exec_context);
 
+  // Process the responses of parallel reads and merge their rows in partition order.
+  CHECKED_STATUS ProcessParallelReadResponses(ExecContext* exec_context);
+
   // Process result of FlushAsyncDone.
   CHECKED_STATUS ProcessAsyncResults();
 
@@ -190,6 +197,16 @@ class Executor {
   // Convert column references to protobuf.
   CHECKED_STATUS ColumnRefsToPB(const PTDmlStmt *tnode, QLReferencedColumnsPB *columns_pb);
 
+  // Convert selected expressions, their metadata and the referenced columns of a select statement
+  // to protobuf. Reuses the part of the read request cached in the statement when possible.
+  CHECKED_STATUS SelectedExprsToPB(const PTSelectStmt *tnode, QLReadRequestPB *req);
+
+  // Set up a read request of a select statement of aggregate functions to return partial results.
+  CHECKED_STATUS AggregatesToPB(const PTSelectStmt *tnode, QLReadRequestPB *req);
+
+  // Combine the partial results of aggregate functions read from all tablets into the result row.
+  CHECKED_STATUS AggregateResultSets(const PTSelectStmt *tnode);
+
   // Convert column arguments to protobuf.
   CHECKED_STATUS ColumnArgsToPB(const std::shared_ptr<client::YBTable>& table,
                                 const PTDmlStmt *tnode,
@@ -248,6 +265,10 @@ class Executor {
 
   // FlushAsync callback.
   Callback<void(const Status&)> flush_async_cb_;
+
+  // Number of bind variables converted to protobuf, used to tell whether an expression depends on
+  // the bind variables of the statement.
+  size_t num_bind_vars_converted_ = 0;
 };
 
 }  // namespace ql
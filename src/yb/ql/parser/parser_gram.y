@@ -3323,7 +3323,13 @@ func_application:
     PARSER_UNSUPPORTED(@1);
   }
   | func_name '(' '*' ')' {
-    PARSER_UNSUPPORTED(@1);
+    // COUNT(*) is a call to COUNT without argument.
+    if (strcmp($1->c_str(), "count") != 0) {
+      PARSER_UNSUPPORTED(@1);
+    } else {
+      PTExprListNode::SharedPtr args = MAKE_NODE(@1, PTExprListNode);
+      $$ = MAKE_NODE(@1, PTBcall, $1, args);
+    }
   }
 ;
 
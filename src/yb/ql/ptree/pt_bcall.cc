@@ -135,6 +135,13 @@ CHECKED_STATUS PTBcall::Analyze(SemContext *sem_context) {
     bfopcode_ = static_cast<int32_t>(bfdecl->tsopcode());
   }
 
+  // Aggregate functions are evaluated across rows, so they are only allowed in the selected list.
+  if (is_aggregate() && !sem_context->allowing_aggregate()) {
+    string errmsg = Substitute("Aggregate function $0 is only allowed in the selected list",
+                               name_->c_str());
+    return sem_context->Error(this, errmsg.c_str(), ErrorCode::INVALID_FUNCTION_CALL);
+  }
+
   // Collection operations require special handling during type analysis
   // 1. Casting check is not needed since type conversion between collection types is not allowed
   // 2. Additional type inference is needed for the parameter types of the collections
@@ -257,6 +264,9 @@ CHECKED_STATUS PTBcall::Analyze(SemContext *sem_context) {
           sem_context->expr_expected_ql_type()->main(),
           &result_cast_op_);
       ql_type_ = sem_context->expr_expected_ql_type();
+    } else if (is_aggregate() && QLType::IsNull(pt_result->ql_type()->main())) {
+      // MIN and MAX return the datatype of their argument.
+      ql_type_ = exprs.front()->ql_type();
     } else {
       ql_type_ = pt_result->ql_type();
     }
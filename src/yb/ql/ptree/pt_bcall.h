@@ -61,6 +61,12 @@ class PTBcall : public PTExpr {
     return bfopcode_;
   }
 
+  // Is this a call to an aggregate function?
+  bool is_aggregate() const {
+    return is_server_operator_ &&
+           yb::bfql::IsAggregateOpcode(static_cast<yb::bfql::TSOpcode>(bfopcode_));
+  }
+
   // Access API for cast opcodes.
   const MCVector<yb::bfql::BFOpcode>& cast_ops() const {
     return cast_ops_;
@@ -79,6 +85,10 @@ class PTBcall : public PTExpr {
   virtual CHECKED_STATUS CheckCounterUpdateSupport(SemContext *sem_context) const override;
 
   virtual string QLName() const override {
+    // COUNT(*) is named after the function only.
+    if (args_->node_list().empty() && is_aggregate()) {
+      return name_->c_str();
+    }
     string arg_names;
     for (auto arg : args_->node_list()) {
       if (!arg_names.empty()) {
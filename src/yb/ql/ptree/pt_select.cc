@@ -19,6 +19,7 @@
 
 #include <functional>
 
+#include "yb/ql/ptree/pt_bcall.h"
 #include "yb/ql/ptree/sem_context.h"
 
 namespace yb {
@@ -111,7 +112,10 @@ CHECKED_STATUS PTSelectStmt::Analyze(SemContext *sem_context) {
   // Analyze clauses in select statements and check that references to columns in selected_exprs
   // are valid and used appropriately.
   SemState sem_state(sem_context);
+  sem_state.set_allowing_aggregate(true);
   RETURN_NOT_OK(selected_exprs_->Analyze(sem_context));
+  sem_state.set_allowing_aggregate(false);
+  RETURN_NOT_OK(AnalyzeAggregates(sem_context));
   if (distinct_) {
     RETURN_NOT_OK(AnalyzeDistinctClause(sem_context));
   }
@@ -134,6 +138,40 @@ void PTSelectStmt::PrintSemanticAnalysisResult(SemContext *sem_context) {
 
 //--------------------------------------------------------------------------------------------------
 
+CHECKED_STATUS PTSelectStmt::AnalyzeAggregates(SemContext *sem_context) {
+  size_t aggregate_count = 0;
+  for (const auto& expr : selected_exprs()) {
+    if (expr->expr_op() == ExprOperator::kBcall &&
+        static_cast<const PTBcall*>(expr.get())->is_aggregate()) {
+      aggregate_count++;
+    }
+  }
+  if (aggregate_count == 0) {
+    return Status::OK();
+  }
+
+  // Without GROUP BY, aggregate functions return one row, so there is nothing else to select.
+  if (aggregate_count != selected_exprs().size()) {
+    return sem_context->Error(selected_exprs_,
+                              "Aggregate functions cannot be selected with other expressions",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
+  if (distinct_) {
+    return sem_context->Error(selected_exprs_,
+                              "Aggregate functions cannot be selected with distinct clause",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
+  if (is_system()) {
+    return sem_context->Error(selected_exprs_,
+                              "Aggregate functions are not supported on system tables",
+                              ErrorCode::FEATURE_NOT_SUPPORTED);
+  }
+  is_aggregate_ = true;
+  return Status::OK();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 CHECKED_STATUS PTSelectStmt::AnalyzeDistinctClause(SemContext *sem_context) {
   // Only partition and static columns are allowed to be used with distinct clause.
   int key_count = 0;
@@ -18,6 +18,8 @@
 #ifndef YB_QL_PTREE_PT_SELECT_H_
 #define YB_QL_PTREE_PT_SELECT_H_
 
+#include <memory>
+
 #include "yb/client/client.h"
 
 #include "yb/ql/ptree/list_node.h"
@@ -181,6 +183,7 @@ class PTSelectStmt : public PTDmlStmt {
 
   // Node semantics analysis.
   virtual CHECKED_STATUS Analyze(SemContext *sem_context) override;
+  CHECKED_STATUS AnalyzeAggregates(SemContext *sem_context);
   CHECKED_STATUS AnalyzeDistinctClause(SemContext *sem_context);
   CHECKED_STATUS AnalyzeLimitClause(SemContext *sem_context);
   CHECKED_STATUS ConstructSelectedSchema();
@@ -203,6 +206,11 @@ class PTSelectStmt : public PTDmlStmt {
     return distinct_;
   }
 
+  // Are the selected expressions all aggregate functions?
+  bool is_aggregate() const {
+    return is_aggregate_;
+  }
+
   bool has_limit() const {
     return limit_clause_ != nullptr;
   }
@@ -218,6 +226,17 @@ class PTSelectStmt : public PTDmlStmt {
     return selected_exprs_->node_list();
   }
 
+  // The selected expressions, result row descriptor and referenced columns of the read request,
+  // which do not depend on bind variables. They are built by the first execution of the statement
+  // and reused by the following executions of the prepared statement, possibly in parallel.
+  std::shared_ptr<const QLReadRequestPB> read_request_template() const {
+    return std::atomic_load(&read_request_template_);
+  }
+
+  void set_read_request_template(std::shared_ptr<const QLReadRequestPB> read_request) const {
+    std::atomic_store(&read_request_template_, std::move(read_request));
+  }
+
   // Returns table name.
   virtual client::YBTableName table_name() const override {
     // CQL only allows one table at a time.
@@ -246,6 +265,12 @@ class PTSelectStmt : public PTDmlStmt {
   PTListNode::SharedPtr having_clause_;
   PTListNode::SharedPtr order_by_clause_;
   PTExpr::SharedPtr limit_clause_;
+
+  // Whether the selected expressions are all aggregate functions.
+  bool is_aggregate_ = false;
+
+  // Cached part of the read request, see read_request_template().
+  mutable std::shared_ptr<const QLReadRequestPB> read_request_template_;
 };
 
 }  // namespace ql
@@ -105,6 +105,9 @@ class SemState {
   bool processing_if_clause() const { return processing_if_clause_; }
   void set_processing_if_clause(bool value) { processing_if_clause_ = value; }
 
+  bool allowing_aggregate() const { return allowing_aggregate_; }
+  void set_allowing_aggregate(bool val) { allowing_aggregate_ = val; }
+
  private:
   // Context that owns this SemState.
   SemContext *sem_context_;
@@ -133,6 +136,10 @@ class SemState {
 
   // State variable for set clause.
   bool processing_set_clause_ = false;
+
+  // Predicate for processing the selected list of a SELECT statement, where aggregate functions are
+  // allowed. It is not passed down to the arguments of a function call.
+  bool allowing_aggregate_ = false;
 };
 
 }  // namespace ql
@@ -25,6 +25,8 @@ using std::unique_ptr;
 using std::shared_ptr;
 using strings::Substitute;
 
+DECLARE_int32(cql_parallel_scan_max_tablets);
+
 namespace yb {
 namespace ql {
 
@@ -1080,6 +1082,134 @@ TEST_F(TestQLQuery, TestPagination) {
   EXPECT_EQ(55, sum);
 }
 
+TEST_F(TestQLQuery, TestParallelScan) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  // Create test table and insert 100 different hash keys spread across the tablets.
+  CHECK_OK(processor->Run("CREATE TABLE scan_test (h int, r int, v int, PRIMARY KEY ((h), r));"));
+  for (int i = 1; i <= 100; i++) {
+    CHECK_OK(processor->Run(Substitute("INSERT INTO scan_test (h, r, v) VALUES ($0, 1, $0);", i)));
+  }
+
+  // Reads the given statement with the given number of tablets read in parallel and returns the
+  // values of column h in the order returned.
+  auto scan = [processor](const string& stmt, int max_tablets) {
+    FLAGS_cql_parallel_scan_max_tablets = max_tablets;
+    CHECK_OK(processor->Run(stmt));
+    auto row_block = processor->row_block();
+    std::vector<int32_t> values;
+    for (int i = 0; i < row_block->row_count(); i++) {
+      values.push_back(row_block->row(i).column(0).int32_value());
+    }
+    return values;
+  };
+
+  // Parallel full-table scans should return the same rows in the same partition order as
+  // sequential ones.
+  for (const char* stmt : {"SELECT h FROM scan_test;",
+                            "SELECT h FROM scan_test WHERE token(h) >= -4611686018427387904;",
+                            "SELECT h FROM scan_test WHERE token(h) < 4611686018427387904;",
+                            "SELECT h FROM scan_test LIMIT 37;"}) {
+    const auto expected = scan(stmt, 1);
+    EXPECT_EQ(expected, scan(stmt, 3)) << stmt;
+    EXPECT_EQ(expected, scan(stmt, 8)) << stmt;
+  }
+
+  EXPECT_EQ(100U, scan("SELECT h FROM scan_test;", 8).size());
+  EXPECT_EQ(37U, scan("SELECT h FROM scan_test LIMIT 37;", 8).size());
+  EXPECT_EQ(0U, scan("SELECT h FROM scan_test LIMIT 0;", 8).size());
+}
+
+TEST_F(TestQLQuery, TestAggregateFunctions) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  CHECK_VALID_STMT("CREATE TABLE aggr_test (h int, r int, v int, d double, t text, "
+                   "PRIMARY KEY ((h), r));");
+
+  // Aggregates over an empty table.
+  CHECK_VALID_STMT("SELECT count(*), count(v), sum(v), avg(v), min(v), max(v) FROM aggr_test;");
+  auto row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(0, row_block->row(0).column(0).int64_value());
+  EXPECT_EQ(0, row_block->row(0).column(1).int64_value());
+  EXPECT_EQ(0, row_block->row(0).column(2).int32_value());
+  EXPECT_EQ(0, row_block->row(0).column(3).int32_value());
+  EXPECT_TRUE(row_block->row(0).column(4).IsNull());
+  EXPECT_TRUE(row_block->row(0).column(5).IsNull());
+
+  // Insert rows spread across the tablets. Column v is null in every tenth row.
+  int64_t count_v = 0, sum_v = 0;
+  double sum_d = 0;
+  for (int h = 1; h <= 50; h++) {
+    for (int r = 1; r <= 2; r++) {
+      const int v = h * 10 + r;
+      const double d = v / 4.0;
+      if (h % 10 == 0) {
+        CHECK_VALID_STMT(Substitute("INSERT INTO aggr_test (h, r, d, t) "
+                                    "VALUES ($0, $1, $2, 'x$3');", h, r, d, v));
+      } else {
+        CHECK_VALID_STMT(Substitute("INSERT INTO aggr_test (h, r, v, d, t) "
+                                    "VALUES ($0, $1, $2, $3, 'x$2');", h, r, v, d));
+        count_v++;
+        sum_v += v;
+      }
+      sum_d += d;
+    }
+  }
+
+  CHECK_VALID_STMT("SELECT count(*), count(v), sum(v), avg(v), min(v), max(v), sum(d), avg(d), "
+                   "min(t), max(t) FROM aggr_test;");
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  const QLRow& row = row_block->row(0);
+  EXPECT_EQ(100, row.column(0).int64_value());
+  EXPECT_EQ(count_v, row.column(1).int64_value());
+  EXPECT_EQ(sum_v, row.column(2).int32_value());
+  EXPECT_EQ(sum_v / count_v, row.column(3).int32_value());
+  EXPECT_EQ(11, row.column(4).int32_value());
+  EXPECT_EQ(492, row.column(5).int32_value());
+  EXPECT_DOUBLE_EQ(sum_d, row.column(6).double_value());
+  EXPECT_DOUBLE_EQ(sum_d / 100, row.column(7).double_value());
+  EXPECT_EQ("x101", row.column(8).string_value());
+  EXPECT_EQ("x92", row.column(9).string_value());
+
+  // Aggregates over one partition and with a condition on the regular columns.
+  CHECK_VALID_STMT("SELECT count(*), sum(v) FROM aggr_test WHERE h = 7;");
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(2, row_block->row(0).column(0).int64_value());
+  EXPECT_EQ(71 + 72, row_block->row(0).column(1).int32_value());
+
+  CHECK_VALID_STMT("SELECT count(*) FROM aggr_test WHERE v > 400;");
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(18, row_block->row(0).column(0).int64_value());
+
+  // AVG of an int column does not wrap around when the sum of the column does not fit in an int.
+  CHECK_VALID_STMT("CREATE TABLE aggr_big (h int PRIMARY KEY, v int);");
+  for (int h = 1; h <= 4; h++) {
+    CHECK_VALID_STMT(Substitute("INSERT INTO aggr_big (h, v) VALUES ($0, 2000000000);", h));
+  }
+  CHECK_VALID_STMT("SELECT avg(v) FROM aggr_big;");
+  row_block = processor->row_block();
+  ASSERT_EQ(1, row_block->row_count());
+  EXPECT_EQ(2000000000, row_block->row(0).column(0).int32_value());
+
+  // Aggregates are only allowed as the only selected expressions.
+  CHECK_INVALID_STMT("SELECT h, count(*) FROM aggr_test;");
+  CHECK_INVALID_STMT("SELECT sum(count(v)) FROM aggr_test;");
+  CHECK_INVALID_STMT("SELECT * FROM aggr_test WHERE v = max(v);");
+  CHECK_INVALID_STMT("SELECT DISTINCT count(h) FROM aggr_test;");
+}
+
 TEST_F(TestQLQuery, TestTokenBcall) {
   //------------------------------------------------------------------------------------------------
   // Setting up cluster
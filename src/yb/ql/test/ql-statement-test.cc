@@ -36,6 +36,7 @@ class TestQLStatement : public QLTestBase {
 
   void ExecuteAsyncDone(
       Callback<void(const Status&)> cb, const Status& s, const ExecutedResult::SharedPtr& result) {
+    result_ = result;
     cb.Run(s);
   }
 
@@ -44,6 +45,14 @@ class TestQLStatement : public QLTestBase {
                               Bind(&TestQLStatement::ExecuteAsyncDone, Unretained(this), cb));
   }
 
+  // Returns the rows returned by the last statement executed by ExecuteAsync().
+  std::unique_ptr<QLRowBlock> row_block() const {
+    CHECK(result_ != nullptr && result_->type() == ExecutedResult::Type::ROWS);
+    return std::unique_ptr<QLRowBlock>(static_cast<RowsResult*>(result_.get())->GetRowBlock());
+  }
+
+ private:
+  ExecutedResult::SharedPtr result_;
 };
 
 TEST_F(TestQLStatement, TestExecutePrepareAfterTableDrop) {
@@ -103,5 +112,39 @@ TEST_F(TestQLStatement, TestPKIndices) {
   LOG(INFO) << "Done.";
 }
 
+TEST_F(TestQLStatement, TestExecutePreparedSelectRepeatedly) {
+  // Init the simulated cluster.
+  ASSERT_NO_FATALS(CreateSimulatedCluster());
+
+  // Get a processor.
+  TestQLProcessor *processor = GetQLProcessor();
+
+  // Create test table.
+  EXEC_VALID_STMT("create table t (h1 int primary key, c int);");
+  EXEC_VALID_STMT("insert into t (h1, c) values (1, 10);");
+
+  // Prepare a select statement. Its selected expressions are converted once and reused by the
+  // following executions.
+  Statement stmt(processor->CurrentKeyspace(), "select c, h1 from t where h1 = 1;");
+  CHECK_OK(stmt.Prepare(processor));
+
+  for (int i = 0; i < 3; i++) {
+    EXEC_VALID_STMT(Substitute("update t set c = $0 where h1 = 1;", 10 + i));
+
+    Synchronizer sync;
+    CHECK_OK(ExecuteAsync(&stmt, processor, Bind(&Synchronizer::StatusCB, Unretained(&sync))));
+    CHECK_OK(sync.Wait());
+
+    std::unique_ptr<QLRowBlock> row_block = this->row_block();
+    ASSERT_EQ(row_block->row_count(), 1);
+    const QLRow& row = row_block->row(0);
+    ASSERT_EQ(row.column_count(), 2);
+    EXPECT_EQ(row.column(0).int32_value(), 10 + i);
+    EXPECT_EQ(row.column(1).int32_value(), 1);
+  }
+
+  LOG(INFO) << "Done.";
+}
+
 } // namespace ql
 } // namespace yb
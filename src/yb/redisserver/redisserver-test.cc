@@ -774,6 +774,36 @@ TEST_F(TestRedisService, TestTtl) {
   VerifyCallbacks();
 }
 
+// Clients writing fields of the same hash and set concurrently must not lose updates of the element
+// counts of these collections.
+TEST_F(TestRedisService, TestConcurrentCardinalityUpdates) {
+  constexpr int kNumClients = 4;
+  constexpr int kNumFieldsPerClient = 50;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i != kNumClients; ++i) {
+    threads.emplace_back([this, i] {
+      RedisClient client;
+      client.connect("127.0.0.1", server_port());
+      for (int j = 0; j != kNumFieldsPerClient; ++j) {
+        const string field = yb::Format("field_$0_$1", i, j);
+        // Wait for every command, so that the commands of the clients interleave.
+        client.send({"HSET", "map_key", field, "value"}).sync_commit();
+        client.send({"SADD", "set_key", field}).sync_commit();
+      }
+      client.disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, kNumClients * kNumFieldsPerClient);
+  DoRedisTestInt(__LINE__, {"SCARD", "set_key"}, kNumClients * kNumFieldsPerClient);
+  SyncClient();
+  VerifyCallbacks();
+}
+
 TEST_F(TestRedisService, TestDummyLocal) {
   expected_no_sessions_ = true;
   DoRedisTestBulkString(__LINE__, {"INFO"}, kInfoResponse);
@@ -898,11 +928,13 @@ TEST_F(TestRedisService, TestAdditionalCommands) {
   SyncClient();
   DoRedisTestInt(__LINE__, {"EXISTS", "map_key"}, 1);
   DoRedisTestArray(__LINE__, {"HGETALL", "map_key"}, {"subkey1", "41", "subkey6", "14"});
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, 2);
   DoRedisTestInt(__LINE__, {"DEL", "map_key"}, 1); // Delete the whole map with a del
   SyncClient();
 
   DoRedisTestInt(__LINE__, {"EXISTS", "map_key"}, 0);
   DoRedisTestArray(__LINE__, {"HGETALL", "map_key"}, {});
+  DoRedisTestInt(__LINE__, {"HLEN", "map_key"}, 0);
 
   DoRedisTestInt(__LINE__, {"EXISTS", "set1"}, 0);
   DoRedisTestInt(__LINE__, {"SADD", "set1", "val1"}, 1);
@@ -927,6 +959,7 @@ TEST_F(TestRedisService, TestAdditionalCommands) {
   DoRedisTestInt(__LINE__, {"SREM", "set1", "val1", "val3", "val4"}, 2);
   SyncClient();
   DoRedisTestArray(__LINE__, {"SMEMBERS", "set1"}, {"val2"});
+  DoRedisTestInt(__LINE__, {"SCARD", "set1"}, 1);
 
   // AUTH/CONFIG should be dummy implementations, that respond OK irrespective of the arguments
   DoRedisTestOk(__LINE__, {"AUTH", "foo", "subkey5", "19", "subkey6", "14"});
@@ -2502,18 +2502,21 @@ Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
     WriteContext context;
     InstrumentedMutexLock guard_lock(&mutex_);
 
-    if (cfd->imm()->NumNotFlushed() == 0 && cfd->mem()->IsEmpty()) {
+    if (cfd->imm()->NumNotFlushed() == 0 &&
+        (flush_options.immutable_only || cfd->mem()->IsEmpty())) {
       // Nothing to flush
       return Status::OK();
     }
 
-    WriteThread::Writer w;
-    write_thread_.EnterUnbatched(&w, &mutex_);
+    if (!flush_options.immutable_only) {
+      WriteThread::Writer w;
+      write_thread_.EnterUnbatched(&w, &mutex_);
 
-    // SwitchMemtable() will release and reacquire mutex
-    // during execution
-    s = SwitchMemtable(cfd, &context);
-    write_thread_.ExitUnbatched(&w);
+      // SwitchMemtable() will release and reacquire mutex
+      // during execution
+      s = SwitchMemtable(cfd, &context);
+      write_thread_.ExitUnbatched(&w);
+    }
 
     cfd->imm()->FlushRequested();
 
@@ -2537,6 +2540,11 @@ Status DBImpl::WaitForFlushMemTable(ColumnFamilyData* cfd) {
     if (shutting_down_.load(std::memory_order_acquire)) {
       return STATUS(ShutdownInProgress, "");
     }
+    // Memtables held back by max_flushable_op_id are not flushed until another flush is requested.
+    if (bg_flush_scheduled_ == 0 && unscheduled_flushes_ == 0 &&
+        !cfd->imm()->HasFlushableMemTable(MaxFlushableOpIndex(db_options_))) {
+      return STATUS(Incomplete, "Memtables could not be flushed yet");
+    }
     bg_cv_.Wait();
   }
   if (!bg_error_.ok()) {
@@ -2754,7 +2762,8 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
     // This cfd is already referenced
     auto first_cfd = PopFirstFromFlushQueue();
 
-    if (first_cfd->IsDropped() || !first_cfd->imm()->IsFlushPending()) {
+    if (first_cfd->IsDropped() || !first_cfd->imm()->IsFlushPending() ||
+        !first_cfd->imm()->HasFlushableMemTable(MaxFlushableOpIndex(db_options_))) {
       // can't flush this CF, try next one
       if (first_cfd->Unref()) {
         delete first_cfd;
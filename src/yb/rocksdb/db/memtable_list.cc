@@ -250,13 +250,17 @@ bool MemTableList::IsFlushPending() const {
 }
 
 // Returns the memtables that need to be flushed.
-void MemTableList::PickMemtablesToFlush(autovector<MemTable*>* ret) {
+void MemTableList::PickMemtablesToFlush(autovector<MemTable*>* ret, int64_t max_op_index) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_PICK_MEMTABLES_TO_FLUSH);
   const auto& memlist = current_->memlist_;
   for (auto it = memlist.rbegin(); it != memlist.rend(); ++it) {
     MemTable* m = *it;
     if (!m->flush_in_progress_) {
+      if (m->LastOpId().index > max_op_index) {
+        // Later memtables could not be flushed before this one.
+        break;
+      }
       assert(!m->flush_completed_);
       num_flush_not_started_--;
       if (num_flush_not_started_ == 0) {
@@ -269,6 +273,24 @@ void MemTableList::PickMemtablesToFlush(autovector<MemTable*>* ret) {
   flush_requested_ = false;  // start-flush request is complete
 }
 
+bool MemTableList::HasFlushableMemTable(int64_t max_op_index) const {
+  const auto& memlist = current_->memlist_;
+  for (auto it = memlist.rbegin(); it != memlist.rend(); ++it) {
+    MemTable* m = *it;
+    if (!m->flush_in_progress_) {
+      return m->LastOpId().index <= max_op_index;
+    }
+  }
+  return false;
+}
+
+int64_t MaxFlushableOpIndex(const DBOptions& db_options) {
+  if (!db_options.max_flushable_op_id) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return db_options.max_flushable_op_id().index;
+}
+
 void MemTableList::RollbackMemtableFlush(const autovector<MemTable*>& mems,
                                          uint64_t file_number) {
   AutoThreadOperationStageUpdater stage_updater(
@@ -24,6 +24,7 @@
 #include <vector>
 #include <set>
 #include <deque>
+#include <limits>
 
 #include "yb/rocksdb/db/dbformat.h"
 #include "yb/rocksdb/db/filename.h"
@@ -191,7 +192,14 @@ class MemTableList {
 
   // Returns the earliest memtables that needs to be flushed. The returned
   // memtables are guaranteed to be in the ascending order of created time.
-  void PickMemtablesToFlush(autovector<MemTable*>* mems);
+  // Picking stops at the first memtable whose last op id index exceeds max_op_index.
+  void PickMemtablesToFlush(
+      autovector<MemTable*>* mems,
+      int64_t max_op_index = std::numeric_limits<int64_t>::max());
+
+  // Returns true if the earliest memtable on which flush has not yet started
+  // could be flushed with the given max_op_index.
+  bool HasFlushableMemTable(int64_t max_op_index) const;
 
   // Reset status of the given memtable list back to pending state so that
   // they can get picked up again on the next round of flush.
@@ -250,4 +258,8 @@ class MemTableList {
   size_t current_memory_usage_;
 };
 
+// Returns the max index of the last op id of a memtable that could be flushed, see
+// DBOptions::max_flushable_op_id.
+int64_t MaxFlushableOpIndex(const DBOptions& db_options);
+
 }  // namespace rocksdb
@@ -11,6 +11,7 @@
 // under the License.
 //
 
+#include <atomic>
 #include <memory>
 #include <sstream>
 
@@ -344,6 +345,65 @@ TEST_F(UserOpIdTest, MoveConstructor) {
   ASSERT_EQ(expected_str, WriteBatchToString(b_move_assigned));
 }
 
+// Memtables are flushed only up to the op id returned by max_flushable_op_id, in order.
+TEST_F(UserOpIdTest, MaxFlushableOpId) {
+  const std::string dbname = test::TmpDir() + "/max_flushable_op_id_test";
+  std::atomic<int64_t> max_flushable_index(0);
+  Options options;
+  options.create_if_missing = true;
+  options.max_write_buffer_number = 4;
+  options.max_flushable_op_id = [&max_flushable_index] {
+    return OpId(1, max_flushable_index.load(std::memory_order_acquire));
+  };
+  ASSERT_OK(DestroyDB(dbname, options));
+
+  DB* db_ptr = nullptr;
+  ASSERT_OK(DB::Open(options, dbname, &db_ptr));
+  std::unique_ptr<DB> db(db_ptr);
+  auto write = [&db](int64_t index) {
+    WriteBatch batch;
+    batch.SetUserOpId(OpId(1, index));
+    batch.Put("key" + std::to_string(index), "value");
+    return db->Write(WriteOptions(), &batch);
+  };
+  auto num_entries = [&db](const std::string& property) {
+    uint64_t result = 0;
+    EXPECT_TRUE(db->GetIntProperty(property, &result));
+    return result;
+  };
+
+  ASSERT_OK(write(1));
+  ASSERT_TRUE(db->Flush(FlushOptions()).IsIncomplete());
+  ASSERT_TRUE(db->GetFlushedOpId().empty());
+  ASSERT_EQ(1U, num_entries(DB::Properties::kNumEntriesImmMemTables));
+
+  ASSERT_OK(write(2));
+  ASSERT_TRUE(db->Flush(FlushOptions()).IsIncomplete());
+  ASSERT_EQ(2U, num_entries(DB::Properties::kNumEntriesImmMemTables));
+
+  // Only the memtable with the first operation could be flushed.
+  max_flushable_index = 1;
+  ASSERT_OK(write(3));
+  FlushOptions immutable_only;
+  immutable_only.immutable_only = true;
+  ASSERT_TRUE(db->Flush(immutable_only).IsIncomplete());
+  ASSERT_EQ(OpId(1, 1), db->GetFlushedOpId());
+  ASSERT_EQ(1U, num_entries(DB::Properties::kNumEntriesImmMemTables));
+  ASSERT_EQ(1U, num_entries(DB::Properties::kNumEntriesActiveMemTable));
+
+  max_flushable_index = 3;
+  ASSERT_OK(db->Flush(immutable_only));
+  ASSERT_EQ(OpId(1, 2), db->GetFlushedOpId());
+  ASSERT_EQ(0U, num_entries(DB::Properties::kNumEntriesImmMemTables));
+  ASSERT_EQ(1U, num_entries(DB::Properties::kNumEntriesActiveMemTable));
+
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_EQ(OpId(1, 3), db->GetFlushedOpId());
+
+  db.reset();
+  ASSERT_OK(DestroyDB(dbname, options));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -26,6 +26,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
@@ -35,6 +36,7 @@
 #include "yb/rocksdb/cache.h"
 #include "yb/rocksdb/version.h"
 #include "yb/rocksdb/listener.h"
+#include "yb/rocksdb/types.h"
 #include "yb/util/slice.h"
 #include "yb/rocksdb/universal_compaction.h"
 
@@ -1307,6 +1309,12 @@ struct DBOptions {
 
   // Max file size for compaction. Supported only for level0 of universal style compactions.
   uint64_t max_file_size_for_compaction = std::numeric_limits<uint64_t>::max();
+
+  // Limits the memtables that could be flushed. Memtables are flushed in the order they were
+  // created, and only while the index of their last user op id does not exceed the index of the
+  // returned op id. Memtables that are held back are flushed by a flush requested once they
+  // qualify. Not set means that all memtables could be flushed.
+  std::function<OpId()> max_flushable_op_id;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1524,7 +1532,11 @@ struct FlushOptions {
   // Default: true
   bool wait;
 
-  FlushOptions() : wait(true) {}
+  // If true, the active memtable is not switched, only the immutable memtables are flushed.
+  // Default: false
+  bool immutable_only;
+
+  FlushOptions() : wait(true), immutable_only(false) {}
 };
 
 // Get options based on some guidelines. Now only tune parameter based on
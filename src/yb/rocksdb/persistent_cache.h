@@ -0,0 +1,93 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+// A PersistentCache is a second tier of the block cache, kept on a fast local device such as an
+// SSD. Data blocks that miss the block cache are looked up in it before being read from the table
+// file, and blocks read from the table file are inserted into it. It has internal synchronization
+// and may be safely accessed concurrently from multiple threads.
+
+#ifndef ROCKSDB_INCLUDE_ROCKSDB_PERSISTENT_CACHE_H
+#define ROCKSDB_INCLUDE_ROCKSDB_PERSISTENT_CACHE_H
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "yb/gutil/ref_counted.h"
+#include "yb/rocksdb/status.h"
+#include "yb/util/slice.h"
+
+namespace yb {
+class MetricEntity;
+}
+
+namespace rocksdb {
+
+struct PersistentCacheOptions {
+  // Path of the file that holds the cached blocks. The file is created, or truncated if it already
+  // exists, and preallocated to its full size when the cache is created.
+  std::string path;
+
+  // Size of the file in bytes.
+  uint64_t capacity = 0;
+
+  // Whether blocks are stored as they are in the table files, i.e. compressed if the table is
+  // compressed. Otherwise blocks are stored uncompressed, which takes more space but saves
+  // decompressing them on every hit.
+  bool compressed = true;
+
+  // Maximum total size of the blocks waiting to be written to the file. Blocks inserted while the
+  // writes are this far behind are dropped.
+  uint64_t max_pending_write_bytes = 16 * 1024 * 1024;
+};
+
+class PersistentCache {
+ public:
+  virtual ~PersistentCache() {}
+
+  // Queues a copy of data to be stored under the given key, evicting the oldest blocks to make room
+  // for it. The data is written to the file in the background, and can only be looked up once it
+  // is written. Does nothing if the key is already present. Returns Incomplete if the data is
+  // dropped because too many writes are pending.
+  virtual Status Insert(const Slice& key, const Slice& data) = 0;
+
+  // Waits until the data of all the previous Insert() calls is written.
+  virtual void WaitForPendingWrites() = 0;
+
+  // Looks up the data stored under the given key. Returns NotFound if the key is not present, or
+  // if its data was overwritten while being read.
+  virtual Status Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size) = 0;
+
+  // Whether blocks should be inserted as they are in the table files.
+  virtual bool IsCompressed() const = 0;
+
+  // Returns a new id, used to build cache keys for files that do not have a unique id.
+  virtual uint64_t NewId() = 0;
+
+  virtual uint64_t GetCapacity() const = 0;
+
+  // Total size of the blocks currently stored.
+  virtual uint64_t GetUsage() const = 0;
+
+  virtual void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) = 0;
+};
+
+// Creates a persistent cache that stores blocks in a single preallocated file, used as a ring
+// buffer: once the file is full the oldest blocks are overwritten. The index of the cache is kept
+// in memory, so the contents of the file are not reused after a restart.
+Status NewPersistentCache(const PersistentCacheOptions& options,
+                          std::shared_ptr<PersistentCache>* cache);
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_INCLUDE_ROCKSDB_PERSISTENT_CACHE_H
@@ -203,6 +203,12 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_MULTI_TOUCH_BYTES_READ,
   BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE,
 
+  // Persistent cache, the second tier of the block cache.
+  PERSISTENT_CACHE_HIT,
+  PERSISTENT_CACHE_MISS,
+  PERSISTENT_CACHE_ADD,
+  PERSISTENT_CACHE_ADD_FAILURES,
+
   // End of ticker enum.
   TICKER_ENUM_MAX,
 };
@@ -295,7 +301,11 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {BLOCK_CACHE_MULTI_TOUCH_HIT, "rocksdb.block.cache.multi.touch.hit"},
     {BLOCK_CACHE_MULTI_TOUCH_ADD, "rocksdb.block.cache.multi.touch.add"},
     {BLOCK_CACHE_MULTI_TOUCH_BYTES_READ, "rocksdb.block.cache.multi.touch.bytes.read"},
-    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb.block.cache.multi.touch.bytes.write"}
+    {BLOCK_CACHE_MULTI_TOUCH_BYTES_WRITE, "rocksdb.block.cache.multi.touch.bytes.write"},
+    {PERSISTENT_CACHE_HIT, "rocksdb.persistent.cache.hit"},
+    {PERSISTENT_CACHE_MISS, "rocksdb.persistent.cache.miss"},
+    {PERSISTENT_CACHE_ADD, "rocksdb.persistent.cache.add"},
+    {PERSISTENT_CACHE_ADD_FAILURES, "rocksdb.persistent.cache.add.failures"}
 };
 
 /**
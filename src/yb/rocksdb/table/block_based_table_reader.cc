@@ -35,6 +35,7 @@
 #include "yb/rocksdb/filter_policy.h"
 #include "yb/rocksdb/iterator.h"
 #include "yb/rocksdb/options.h"
+#include "yb/rocksdb/persistent_cache.h"
 #include "yb/rocksdb/statistics.h"
 #include "yb/rocksdb/table.h"
 #include "yb/rocksdb/table_properties.h"
@@ -366,6 +367,9 @@ struct BlockBasedTable::FileReaderWithCachePrefix {
   // Similar prefix, but for compressed blocks cache:
   CacheKeyBuffer compressed_cache_key_prefix;
 
+  // Similar prefix, but for the persistent cache:
+  CacheKeyBuffer persistent_cache_key_prefix;
+
   explicit FileReaderWithCachePrefix(unique_ptr<RandomAccessFileReader>&& _reader) :
       reader(std::move(_reader)) {}
 };
@@ -454,7 +458,8 @@ BlockBasedTable::~BlockBasedTable() {
   delete rep_;
 }
 
-void BlockBasedTable::GenerateCachePrefix(Cache* cc, File* file, CacheKeyBuffer* prefix) {
+template <class CacheType>
+void BlockBasedTable::GenerateCachePrefix(CacheType* cc, File* file, CacheKeyBuffer* prefix) {
   // generate an id from the file
   prefix->size = file->GetUniqueId(prefix->data, kMaxCacheKeyPrefixSize);
 
@@ -480,6 +485,7 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep,
     FileReaderWithCachePrefix* reader_with_cache_prefix) {
   reader_with_cache_prefix->cache_key_prefix.size = 0;
   reader_with_cache_prefix->compressed_cache_key_prefix.size = 0;
+  reader_with_cache_prefix->persistent_cache_key_prefix.size = 0;
   if (rep->table_options.block_cache != nullptr) {
     GenerateCachePrefix(rep->table_options.block_cache.get(),
         reader_with_cache_prefix->reader->file(),
@@ -490,6 +496,11 @@ void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep,
         reader_with_cache_prefix->reader->file(),
         &reader_with_cache_prefix->compressed_cache_key_prefix);
   }
+  if (rep->table_options.persistent_cache != nullptr) {
+    GenerateCachePrefix(rep->table_options.persistent_cache.get(),
+        reader_with_cache_prefix->reader->file(),
+        &reader_with_cache_prefix->persistent_cache_key_prefix);
+  }
 }
 
 BloomFilterAwareFileFilter::BloomFilterAwareFileFilter(
@@ -1226,6 +1237,88 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   }
 }
 
+// Blocks are stored in the persistent cache followed by the byte of their compression type, the
+// same way as they are stored in the file without the checksum of the block trailer.
+Status BlockBasedTable::ReadDataBlock(Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
+                                      std::unique_ptr<Block>* result, bool do_uncompress) {
+  PersistentCache* persistent_cache = rep->table_options.persistent_cache.get();
+  RandomAccessFileReader* reader = rep->data_reader_with_cache_prefix->reader.get();
+  if (persistent_cache == nullptr) {
+    return ReadBlockFromFile(reader, rep->footer, ro, handle, result, rep->ioptions.env,
+                             do_uncompress);
+  }
+
+  Statistics* statistics = rep->ioptions.statistics;
+  const uint32_t format_version = rep->footer.version();
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  Slice key = GetCacheKey(rep->data_reader_with_cache_prefix->persistent_cache_key_prefix, handle,
+                          cache_key);
+
+  BlockContents contents;
+  std::unique_ptr<char[]> data;
+  size_t size = 0;
+  Status s = persistent_cache->Lookup(key, &data, &size);
+  if (s.ok() && size > 0) {
+    RecordTick(statistics, PERSISTENT_CACHE_HIT);
+    const size_t n = size - 1;
+    const auto compression_type = static_cast<CompressionType>(data[n]);
+    if (do_uncompress && compression_type != kNoCompression) {
+      PERF_TIMER_GUARD(block_decompress_time);
+      RETURN_NOT_OK(UncompressBlockContents(data.get(), n, &contents, format_version));
+    } else {
+      contents = BlockContents(std::move(data), n, true /* cachable */, compression_type);
+    }
+    result->reset(new Block(std::move(contents)));
+    return Status::OK();
+  }
+  RecordTick(statistics, PERSISTENT_CACHE_MISS);
+  if (!ro.fill_cache) {
+    return ReadBlockFromFile(reader, rep->footer, ro, handle, result, rep->ioptions.env,
+                             do_uncompress);
+  }
+
+  // Read the block as it is in the file, so that it could be stored in the persistent cache
+  // compressed. Insert() only copies the block, the file is written in the background.
+  RETURN_NOT_OK(ReadBlockContents(reader, rep->footer, ro, handle, &contents, rep->ioptions.env,
+                                  false /* decompression_requested */));
+  const size_t n = contents.data.size();
+  std::unique_ptr<char[]> raw(new char[n + 1]);
+  memcpy(raw.get(), contents.data.data(), n);
+  raw[n] = contents.compression_type;
+
+  BlockContents uncompressed;
+  bool has_uncompressed = false;
+  Slice cached(raw.get(), n + 1);
+  std::unique_ptr<char[]> cached_uncompressed;
+  if (contents.compression_type != kNoCompression &&
+      (do_uncompress || !persistent_cache->IsCompressed())) {
+    PERF_TIMER_GUARD(block_decompress_time);
+    RETURN_NOT_OK(UncompressBlockContents(raw.get(), n, &uncompressed, format_version));
+    has_uncompressed = true;
+    if (!persistent_cache->IsCompressed()) {
+      const size_t uncompressed_size = uncompressed.data.size();
+      cached_uncompressed.reset(new char[uncompressed_size + 1]);
+      memcpy(cached_uncompressed.get(), uncompressed.data.data(), uncompressed_size);
+      cached_uncompressed[uncompressed_size] = kNoCompression;
+      cached = Slice(cached_uncompressed.get(), uncompressed_size + 1);
+    }
+  }
+
+  s = persistent_cache->Insert(key, cached);
+  if (s.ok()) {
+    RecordTick(statistics, PERSISTENT_CACHE_ADD);
+  } else {
+    RecordTick(statistics, PERSISTENT_CACHE_ADD_FAILURES);
+  }
+
+  if (do_uncompress && has_uncompressed) {
+    result->reset(new Block(std::move(uncompressed)));
+  } else {
+    result->reset(new Block(std::move(contents)));
+  }
+  return Status::OK();
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 // If input_iter is null, new a iterator
@@ -1282,9 +1375,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
-        s = ReadBlockFromFile(rep->data_reader_with_cache_prefix->reader.get(),
-            rep->footer, ro, handle, &raw_block, rep->ioptions.env,
-            block_cache_compressed == nullptr);
+        s = ReadDataBlock(rep, ro, handle, &raw_block, block_cache_compressed == nullptr);
       }
 
       if (s.ok()) {
@@ -1307,8 +1398,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
       }
     }
     std::unique_ptr<Block> block_value;
-    s = ReadBlockFromFile(rep->data_reader_with_cache_prefix->reader.get(), rep->footer, ro, handle,
-                          &block_value, rep->ioptions.env);
+    s = ReadDataBlock(rep, ro, handle, &block_value, true /* do_uncompress */);
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -201,6 +201,11 @@ class BlockBasedTable : public TableReader {
       Rep* rep, const ReadOptions& ro, const Slice& index_value,
       BlockIter* input_iter = nullptr);
 
+  // Reads the data block identified by handle from the persistent cache if it is there, otherwise
+  // from the file, inserting it into the persistent cache if ro.fill_cache is set.
+  static Status ReadDataBlock(Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
+                              std::unique_ptr<Block>* result, bool do_uncompress);
+
   // Returns filter block handle for fixed-size bloom filter using filter index and filter key.
   Status GetFixedSizeFilterBlockHandle(const Slice& filter_key,
       BlockHandle* filter_block_handle) const;
@@ -305,8 +310,8 @@ class BlockBasedTable : public TableReader {
   };
 
   // Generate a cache key prefix from the file. Used for both data and metadata files.
-  static void GenerateCachePrefix(Cache* cc, File* file,
-      CacheKeyBuffer* prefix);
+  template <class CacheType>
+  static void GenerateCachePrefix(CacheType* cc, File* file, CacheKeyBuffer* prefix);
 
   static Slice GetCacheKey(const CacheKeyBuffer& cache_key_prefix, const BlockHandle& handle,
       char* cache_key);
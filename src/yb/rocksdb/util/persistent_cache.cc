@@ -0,0 +1,373 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include "yb/rocksdb/persistent_cache.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "yb/rocksdb/util/coding.h"
+#include "yb/rocksdb/util/crc32c.h"
+#include "yb/util/env.h"
+#include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+
+METRIC_DEFINE_counter(server, persistent_cache_inserts,
+                      "Persistent Cache Inserts", yb::MetricUnit::kBlocks,
+                      "Number of blocks inserted in the persistent cache");
+METRIC_DEFINE_counter(server, persistent_cache_evictions,
+                      "Persistent Cache Evictions", yb::MetricUnit::kBlocks,
+                      "Number of blocks overwritten in the persistent cache");
+METRIC_DEFINE_counter(server, persistent_cache_hits,
+                      "Persistent Cache Hits", yb::MetricUnit::kBlocks,
+                      "Number of lookups that found a block in the persistent cache");
+METRIC_DEFINE_counter(server, persistent_cache_misses,
+                      "Persistent Cache Misses", yb::MetricUnit::kBlocks,
+                      "Number of lookups that didn't find a block in the persistent cache");
+METRIC_DEFINE_counter(server, persistent_cache_bytes_written,
+                      "Persistent Cache Bytes Written", yb::MetricUnit::kBytes,
+                      "Number of bytes written to the persistent cache file");
+METRIC_DEFINE_counter(server, persistent_cache_bytes_read,
+                      "Persistent Cache Bytes Read", yb::MetricUnit::kBytes,
+                      "Number of bytes read from the persistent cache file");
+METRIC_DEFINE_gauge_uint64(server, persistent_cache_usage, "Persistent Cache Usage",
+                           yb::MetricUnit::kBytes,
+                           "Size of the blocks stored in the persistent cache");
+
+namespace rocksdb {
+
+namespace {
+
+struct PersistentCacheMetrics {
+  explicit PersistentCacheMetrics(const scoped_refptr<yb::MetricEntity>& entity)
+      : inserts(METRIC_persistent_cache_inserts.Instantiate(entity)),
+        evictions(METRIC_persistent_cache_evictions.Instantiate(entity)),
+        hits(METRIC_persistent_cache_hits.Instantiate(entity)),
+        misses(METRIC_persistent_cache_misses.Instantiate(entity)),
+        bytes_written(METRIC_persistent_cache_bytes_written.Instantiate(entity)),
+        bytes_read(METRIC_persistent_cache_bytes_read.Instantiate(entity)),
+        usage(METRIC_persistent_cache_usage.Instantiate(entity, 0)) {}
+
+  scoped_refptr<yb::Counter> inserts;
+  scoped_refptr<yb::Counter> evictions;
+  scoped_refptr<yb::Counter> hits;
+  scoped_refptr<yb::Counter> misses;
+  scoped_refptr<yb::Counter> bytes_written;
+  scoped_refptr<yb::Counter> bytes_read;
+  scoped_refptr<yb::AtomicGauge<uint64_t>> usage;
+};
+
+// Each entry of the file consists of a header, the key and the data. The header holds the masked
+// crc32c of the key and the data, the size of the key and the size of the data. The key and the
+// checksum allow a lookup to detect that the entry was overwritten while being read.
+constexpr size_t kEntryHeaderSize = 3 * sizeof(uint32_t);
+
+class FilePersistentCache : public PersistentCache {
+ public:
+  explicit FilePersistentCache(const PersistentCacheOptions& options) : options_(options) {}
+
+  ~FilePersistentCache() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    write_cond_.notify_all();
+    written_cond_.notify_all();
+    if (writer_.joinable()) {
+      writer_.join();
+    }
+  }
+
+  Status Open() {
+    yb::RWFileOptions file_options;
+    file_options.mode = yb::Env::CREATE_IF_NON_EXISTING_TRUNCATE;
+    RETURN_NOT_OK(yb::Env::Default()->NewRWFile(file_options, options_.path, &file_));
+    RETURN_NOT_OK(file_->PreAllocate(0, options_.capacity));
+    writer_ = std::thread(&FilePersistentCache::WriterLoop, this);
+    return Status::OK();
+  }
+
+  Status Insert(const Slice& key, const Slice& data) override {
+    const uint64_t entry_size = kEntryHeaderSize + key.size() + data.size();
+    if (entry_size > options_.capacity) {
+      return STATUS(Incomplete, "Block is larger than the persistent cache");
+    }
+
+    PendingWrite write;
+    write.key = key.ToBuffer();
+    write.size = entry_size;
+    write.buffer.reset(new char[entry_size]);
+    uint32_t crc = crc32c::Value(key.cdata(), key.size());
+    crc = crc32c::Extend(crc, data.cdata(), data.size());
+    char* buffer = write.buffer.get();
+    EncodeFixed32(buffer, crc32c::Mask(crc));
+    EncodeFixed32(buffer + sizeof(uint32_t), static_cast<uint32_t>(key.size()));
+    EncodeFixed32(buffer + 2 * sizeof(uint32_t), static_cast<uint32_t>(data.size()));
+    memcpy(buffer + kEntryHeaderSize, key.data(), key.size());
+    memcpy(buffer + kEntryHeaderSize + key.size(), data.data(), data.size());
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (index_.count(write.key) || pending_.count(write.key)) {
+        return Status::OK();
+      }
+      if (pending_bytes_ + entry_size > options_.max_pending_write_bytes) {
+        return STATUS(Incomplete, "Persistent cache write buffer is full");
+      }
+      if (write_offset_ + entry_size > options_.capacity) {
+        write_offset_ = 0;
+      }
+      write.offset = write_offset_;
+      write_offset_ += entry_size;
+      EvictRange(write.offset, write.offset + entry_size);
+      regions_.emplace(write.offset, Region{write.key, entry_size});
+      pending_.insert(write.key);
+      pending_bytes_ += entry_size;
+      write_queue_.push_back(std::move(write));
+    }
+    write_cond_.notify_one();
+    return Status::OK();
+  }
+
+  void WaitForPendingWrites() override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    written_cond_.wait(lock, [this] { return stop_ || pending_bytes_ == 0; });
+  }
+
+  Status Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size) override {
+    Entry entry;
+    // SetMetrics() could replace the metrics concurrently, so a copy taken under the lock is used
+    // once the lock is released.
+    std::shared_ptr<PersistentCacheMetrics> metrics;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      metrics = metrics_;
+      auto it = index_.find(key.ToBuffer());
+      if (it == index_.end()) {
+        if (metrics) {
+          metrics->misses->Increment();
+        }
+        return STATUS(NotFound, "Block not found in the persistent cache");
+      }
+      entry = it->second;
+    }
+
+    std::unique_ptr<char[]> buffer(new char[entry.size]);
+    Slice result;
+    Status s = file_->Read(entry.offset, entry.size, &result,
+                           reinterpret_cast<uint8_t*>(buffer.get()));
+    if (s.ok() && !EntryMatches(result, key)) {
+      s = STATUS(NotFound, "Block was overwritten in the persistent cache");
+    }
+    if (!s.ok()) {
+      if (metrics) {
+        metrics->misses->Increment();
+      }
+      return s;
+    }
+
+    *size = DecodeFixed32(result.cdata() + 2 * sizeof(uint32_t));
+    if (result.cdata() != buffer.get()) {
+      memcpy(buffer.get(), result.cdata(), result.size());
+    }
+    memmove(buffer.get(), buffer.get() + kEntryHeaderSize + key.size(), *size);
+    *data = std::move(buffer);
+    if (metrics) {
+      metrics->hits->Increment();
+      metrics->bytes_read->IncrementBy(entry.size);
+    }
+    return Status::OK();
+  }
+
+  bool IsCompressed() const override {
+    return options_.compressed;
+  }
+
+  uint64_t NewId() override {
+    return last_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  uint64_t GetCapacity() const override {
+    return options_.capacity;
+  }
+
+  uint64_t GetUsage() const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usage_;
+  }
+
+  void SetMetrics(const scoped_refptr<yb::MetricEntity>& entity) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics_ = std::make_shared<PersistentCacheMetrics>(entity);
+  }
+
+ private:
+  struct Entry {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct Region {
+    std::string key;
+    uint64_t size;
+  };
+
+  struct PendingWrite {
+    std::string key;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    std::unique_ptr<char[]> buffer;
+  };
+
+  // Writes the queued entries to the file, so that the readers that insert them do not wait for
+  // the device. Each entry is written without holding the mutex. Its region could be overwritten
+  // by the time the write completes, in which case the entry is not published.
+  void WriterLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      write_cond_.wait(lock, [this] { return stop_ || !write_queue_.empty(); });
+      if (stop_) {
+        return;
+      }
+      PendingWrite write = std::move(write_queue_.front());
+      write_queue_.pop_front();
+
+      lock.unlock();
+      Status s = file_->Write(write.offset, Slice(write.buffer.get(), write.size));
+      lock.lock();
+
+      Publish(write, s);
+      pending_.erase(write.key);
+      pending_bytes_ -= write.size;
+      if (pending_bytes_ == 0) {
+        written_cond_.notify_all();
+      }
+    }
+  }
+
+  // Makes the written entry visible to lookups, unless its region was overwritten.
+  // REQUIRES: mutex_ is held.
+  void Publish(const PendingWrite& write, const Status& status) {
+    auto it = regions_.find(write.offset);
+    if (it == regions_.end() || it->second.key != write.key) {
+      return;
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write to the persistent cache file " << options_.path << ": "
+                   << status.ToString();
+      regions_.erase(it);
+      return;
+    }
+    index_.emplace(write.key, Entry{write.offset, write.size});
+    usage_ += write.size;
+    if (metrics_) {
+      metrics_->inserts->Increment();
+      metrics_->bytes_written->IncrementBy(write.size);
+      metrics_->usage->set_value(usage_);
+    }
+  }
+
+  // Checks that the entry read from the file is the one stored under the key, and was not
+  // overwritten concurrently.
+  static bool EntryMatches(const Slice& entry, const Slice& key) {
+    if (entry.size() < kEntryHeaderSize) {
+      return false;
+    }
+    const char* header = entry.cdata();
+    const uint32_t key_size = DecodeFixed32(header + sizeof(uint32_t));
+    const uint32_t data_size = DecodeFixed32(header + 2 * sizeof(uint32_t));
+    if (key_size != key.size() || kEntryHeaderSize + key_size + data_size != entry.size()) {
+      return false;
+    }
+    const Slice payload(header + kEntryHeaderSize, key_size + data_size);
+    if (memcmp(payload.data(), key.data(), key_size) != 0) {
+      return false;
+    }
+    const uint32_t crc = crc32c::Value(payload.cdata(), payload.size());
+    return crc32c::Unmask(DecodeFixed32(header)) == crc;
+  }
+
+  // Drops the entries stored in [begin, end) of the file, which is about to be overwritten.
+  // REQUIRES: mutex_ is held.
+  void EvictRange(uint64_t begin, uint64_t end) {
+    auto it = regions_.lower_bound(begin);
+    if (it != regions_.begin()) {
+      auto prev = std::prev(it);
+      if (prev->first + prev->second.size > begin) {
+        it = prev;
+      }
+    }
+    while (it != regions_.end() && it->first < end) {
+      auto index_it = index_.find(it->second.key);
+      if (index_it != index_.end() && index_it->second.offset == it->first) {
+        usage_ -= index_it->second.size;
+        index_.erase(index_it);
+        if (metrics_) {
+          metrics_->evictions->Increment();
+          metrics_->usage->set_value(usage_);
+        }
+      }
+      it = regions_.erase(it);
+    }
+  }
+
+  const PersistentCacheOptions options_;
+  gscoped_ptr<yb::RWFile> file_;
+  std::atomic<uint64_t> last_id_{0};
+
+  std::thread writer_;
+
+  mutable std::mutex mutex_;
+  // Signaled when an entry is queued to be written, or on shutdown.
+  std::condition_variable write_cond_;
+  // Signaled when all the queued entries are written, or on shutdown.
+  std::condition_variable written_cond_;
+  bool stop_ = false;
+  // Entries waiting to be written, in the order of insertion.
+  std::deque<PendingWrite> write_queue_;
+  // Total size of the entries queued or being written.
+  uint64_t pending_bytes_ = 0;
+  // Entries that could be looked up, by key.
+  std::unordered_map<std::string, Entry> index_;
+  // Keys of the entries queued or being written.
+  std::unordered_set<std::string> pending_;
+  // Regions of the file that hold entries or are being written, by offset.
+  std::map<uint64_t, Region> regions_;
+  uint64_t write_offset_ = 0;
+  uint64_t usage_ = 0;
+  // Set by SetMetrics(). Only accessed under mutex_.
+  std::shared_ptr<PersistentCacheMetrics> metrics_;
+};
+
+} // namespace
+
+Status NewPersistentCache(const PersistentCacheOptions& options,
+                          std::shared_ptr<PersistentCache>* cache) {
+  if (options.path.empty() || options.capacity == 0) {
+    return STATUS(InvalidArgument, "Persistent cache requires a path and a capacity");
+  }
+  auto result = std::make_shared<FilePersistentCache>(options);
+  RETURN_NOT_OK(result->Open());
+  *cache = std::move(result);
+  return Status::OK();
+}
+
+}  // namespace rocksdb
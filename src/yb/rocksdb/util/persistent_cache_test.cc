@@ -0,0 +1,231 @@
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+
+#include <memory>
+#include <string>
+
+#include "yb/rocksdb/db.h"
+#include "yb/rocksdb/persistent_cache.h"
+#include "yb/rocksdb/statistics.h"
+#include "yb/rocksdb/table.h"
+#include "yb/rocksdb/util/compression.h"
+#include "yb/rocksdb/util/testharness.h"
+#include "yb/util/env.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Size of the header of each entry of the cache file.
+constexpr size_t kEntryHeaderSize = 12;
+constexpr size_t kKeySize = 2;
+constexpr size_t kDataSize = 100;
+constexpr size_t kEntrySize = kEntryHeaderSize + kKeySize + kDataSize;
+
+std::string Data(char c, size_t size = kDataSize) {
+  return std::string(size, c);
+}
+
+} // namespace
+
+class PersistentCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = test::TmpDir() + "/persistent_cache_test";
+  }
+
+  void TearDown() override {
+    cache_.reset();
+    yb::Env::Default()->DeleteFile(path_);
+  }
+
+  void OpenCache(uint64_t capacity, bool compressed = true) {
+    PersistentCacheOptions options;
+    options.path = path_;
+    options.capacity = capacity;
+    options.compressed = compressed;
+    ASSERT_OK(NewPersistentCache(options, &cache_));
+  }
+
+  void Insert(const std::string& key, const std::string& data) {
+    ASSERT_OK(cache_->Insert(key, data));
+    cache_->WaitForPendingWrites();
+  }
+
+  void AssertFound(const std::string& key, const std::string& expected) {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    ASSERT_OK(cache_->Lookup(key, &data, &size));
+    ASSERT_EQ(expected, std::string(data.get(), size));
+  }
+
+  void AssertNotFound(const std::string& key) {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    ASSERT_TRUE(cache_->Lookup(key, &data, &size).IsNotFound());
+  }
+
+  std::string path_;
+  std::shared_ptr<PersistentCache> cache_;
+};
+
+TEST_F(PersistentCacheTest, InsertLookup) {
+  OpenCache(10 * kEntrySize);
+  ASSERT_NO_FATAL_FAILURE(AssertNotFound("k0"));
+  ASSERT_NO_FATAL_FAILURE(Insert("k0", Data('a')));
+  ASSERT_NO_FATAL_FAILURE(AssertFound("k0", Data('a')));
+  ASSERT_EQ(kEntrySize, cache_->GetUsage());
+
+  // Inserting a present key keeps the stored data.
+  ASSERT_NO_FATAL_FAILURE(Insert("k0", Data('b')));
+  ASSERT_NO_FATAL_FAILURE(AssertFound("k0", Data('a')));
+  ASSERT_EQ(kEntrySize, cache_->GetUsage());
+
+  ASSERT_TRUE(cache_->Insert("k1", Data('c', 10 * kEntrySize)).IsIncomplete());
+}
+
+// Once the file is full, new entries are written from its start, over the oldest entries.
+TEST_F(PersistentCacheTest, WrapAround) {
+  OpenCache(3 * kEntrySize);
+  for (char c = '0'; c < '3'; ++c) {
+    ASSERT_NO_FATAL_FAILURE(Insert(std::string("k") + c, Data(c)));
+  }
+  ASSERT_EQ(3 * kEntrySize, cache_->GetUsage());
+
+  ASSERT_NO_FATAL_FAILURE(Insert("k3", Data('3')));
+  ASSERT_NO_FATAL_FAILURE(AssertNotFound("k0"));
+  for (char c = '1'; c < '4'; ++c) {
+    ASSERT_NO_FATAL_FAILURE(AssertFound(std::string("k") + c, Data(c)));
+  }
+  ASSERT_EQ(3 * kEntrySize, cache_->GetUsage());
+}
+
+// An entry larger than the ones it is written over evicts all the entries it overlaps.
+TEST_F(PersistentCacheTest, EvictRange) {
+  OpenCache(3 * kEntrySize);
+  for (char c = '0'; c < '4'; ++c) {
+    ASSERT_NO_FATAL_FAILURE(Insert(std::string("k") + c, Data(c)));
+  }
+
+  // k3 was written at the start of the file, so the large entry follows it and overlaps k1 and k2.
+  const size_t large_data_size = 2 * kDataSize;
+  ASSERT_NO_FATAL_FAILURE(Insert("kl", Data('l', large_data_size)));
+  ASSERT_NO_FATAL_FAILURE(AssertNotFound("k1"));
+  ASSERT_NO_FATAL_FAILURE(AssertNotFound("k2"));
+  ASSERT_NO_FATAL_FAILURE(AssertFound("k3", Data('3')));
+  ASSERT_NO_FATAL_FAILURE(AssertFound("kl", Data('l', large_data_size)));
+  ASSERT_EQ(2 * kEntrySize + kDataSize, cache_->GetUsage());
+}
+
+// An entry whose bytes in the file no longer match its key and checksum is not returned.
+TEST_F(PersistentCacheTest, OverwrittenEntry) {
+  OpenCache(3 * kEntrySize);
+  ASSERT_NO_FATAL_FAILURE(Insert("k0", Data('a')));
+  ASSERT_NO_FATAL_FAILURE(Insert("k1", Data('b')));
+
+  gscoped_ptr<yb::RWFile> file;
+  yb::RWFileOptions file_options;
+  file_options.mode = yb::Env::OPEN_EXISTING;
+  ASSERT_OK(yb::Env::Default()->NewRWFile(file_options, path_, &file));
+  ASSERT_OK(file->Write(kEntryHeaderSize + kKeySize, Data('x', 1)));
+  ASSERT_OK(file->Close());
+
+  ASSERT_NO_FATAL_FAILURE(AssertNotFound("k0"));
+  ASSERT_NO_FATAL_FAILURE(AssertFound("k1", Data('b')));
+}
+
+class PersistentCacheTableTest : public PersistentCacheTest {
+ protected:
+  // Writes a compressed table, reads it three times and returns the usage of the persistent cache.
+  void ReadTable(bool compressed, uint64_t* usage) {
+    ASSERT_NO_FATAL_FAILURE(OpenCache(64 * 1024 * 1024, compressed));
+
+    const std::string dbname = test::TmpDir() + "/persistent_cache_table_test";
+    Options options;
+    options.create_if_missing = true;
+    options.compression = kSnappyCompression;
+    options.statistics = CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    table_options.no_block_cache = true;
+    table_options.persistent_cache = cache_;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    ASSERT_OK(DestroyDB(dbname, options));
+
+    DB* db_ptr = nullptr;
+    ASSERT_OK(DB::Open(options, dbname, &db_ptr));
+    std::unique_ptr<DB> db(db_ptr);
+    const size_t kNumKeys = 1000;
+    for (size_t i = 0; i < kNumKeys; ++i) {
+      ASSERT_OK(db->Put(WriteOptions(), Key(i), Data('a' + i % 26)));
+    }
+    ASSERT_OK(db->Flush(FlushOptions()));
+
+    // Reads that do not fill the caches leave the persistent cache empty.
+    ReadOptions no_fill;
+    no_fill.fill_cache = false;
+    ASSERT_NO_FATAL_FAILURE(ReadKeys(db.get(), no_fill, kNumKeys));
+    cache_->WaitForPendingWrites();
+    ASSERT_EQ(0U, cache_->GetUsage());
+    ASSERT_EQ(0U, options.statistics->getTickerCount(PERSISTENT_CACHE_ADD));
+
+    ASSERT_NO_FATAL_FAILURE(ReadKeys(db.get(), ReadOptions(), kNumKeys));
+    cache_->WaitForPendingWrites();
+    ASSERT_GT(options.statistics->getTickerCount(PERSISTENT_CACHE_ADD), 0U);
+    ASSERT_EQ(0U, options.statistics->getTickerCount(PERSISTENT_CACHE_HIT));
+
+    // Every data block is in the persistent cache now.
+    const uint64_t misses = options.statistics->getTickerCount(PERSISTENT_CACHE_MISS);
+    ASSERT_NO_FATAL_FAILURE(ReadKeys(db.get(), ReadOptions(), kNumKeys));
+    ASSERT_GE(options.statistics->getTickerCount(PERSISTENT_CACHE_HIT), kNumKeys);
+    ASSERT_EQ(misses, options.statistics->getTickerCount(PERSISTENT_CACHE_MISS));
+    *usage = cache_->GetUsage();
+
+    db.reset();
+    ASSERT_OK(DestroyDB(dbname, options));
+  }
+
+  static std::string Key(size_t i) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "key%08zu", i);
+    return buffer;
+  }
+
+  void ReadKeys(DB* db, const ReadOptions& read_options, size_t num_keys) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      std::string value;
+      ASSERT_OK(db->Get(read_options, Key(i), &value));
+      ASSERT_EQ(Data('a' + i % 26), value);
+    }
+  }
+};
+
+// Blocks hit in the persistent cache are read correctly whether they are stored compressed or not.
+TEST_F(PersistentCacheTableTest, CompressedAndUncompressedHits) {
+  if (!Snappy_Supported()) {
+    fprintf(stderr, "skipping test, snappy is not supported\n");
+    return;
+  }
+  uint64_t compressed_usage = 0;
+  ASSERT_NO_FATAL_FAILURE(ReadTable(true /* compressed */, &compressed_usage));
+  cache_.reset();
+  uint64_t uncompressed_usage = 0;
+  ASSERT_NO_FATAL_FAILURE(ReadTable(false /* compressed */, &uncompressed_usage));
+  ASSERT_LT(compressed_usage, uncompressed_usage);
+}
+
+} // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
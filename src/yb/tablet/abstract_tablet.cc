@@ -18,6 +18,17 @@
 namespace yb {
 namespace tablet {
 
+CHECKED_STATUS AbstractTablet::HandleRedisGets(
+    HybridTime timestamp, const std::vector<const RedisReadRequestPB*>& redis_read_requests,
+    std::vector<RedisResponsePB>* responses) {
+  responses->clear();
+  responses->resize(redis_read_requests.size());
+  for (size_t i = 0; i != redis_read_requests.size(); ++i) {
+    RETURN_NOT_OK(HandleRedisReadRequest(timestamp, *redis_read_requests[i], &(*responses)[i]));
+  }
+  return Status::OK();
+}
+
 CHECKED_STATUS AbstractTablet::HandleQLReadRequest(
     HybridTime timestamp, const QLReadRequestPB& ql_read_request, QLResponsePB* response,
     gscoped_ptr<faststring>* rows_data) {
@@ -37,6 +37,12 @@ class AbstractTablet {
       HybridTime timestamp, const RedisReadRequestPB& redis_read_request,
       RedisResponsePB* response) = 0;
 
+  // Executes GET and HGET requests accepted by docdb::RedisReadOperation::IsBatchableGet together.
+  // By default every request is executed separately.
+  virtual CHECKED_STATUS HandleRedisGets(
+      HybridTime timestamp, const std::vector<const RedisReadRequestPB*>& redis_read_requests,
+      std::vector<RedisResponsePB>* responses);
+
   virtual CHECKED_STATUS HandleQLReadRequest(
       HybridTime timestamp, const QLReadRequestPB& ql_read_request, QLResponsePB* response,
       gscoped_ptr<faststring>* rows_data);
@@ -435,39 +435,52 @@ void OperationDriver::ApplyTask() {
   // and end up calling Finalize() while we're still in this code.
   scoped_refptr<OperationDriver> ref(this);
 
-  {
-    gscoped_ptr<CommitMsg> commit_msg;
-    CHECK_OK(operation_->Apply(&commit_msg));
-    if (commit_msg) {
-      commit_msg->mutable_commited_op_id()->CopyFrom(op_id_copy_);
-    }
-    SetResponseHybridTime(operation_->state(), operation_->state()->hybrid_time());
-
-    // If the client requested COMMIT_WAIT as the external consistency mode
-    // calculate the latest that the prepare hybrid_time could be and wait
-    // until now.earliest > prepare_latest. Only after this are the locks
-    // released.
-    if (mutable_state()->external_consistency_mode() == COMMIT_WAIT) {
-      // TODO: only do this on the leader side
-      TRACE("APPLY: Commit Wait.");
-      // If we can't commit wait and have already applied we might have consistency
-      // issues if we still reply to the client that the operation was a success.
-      // On the other hand we don't have rollbacks as of yet thus we can't undo the
-      // the apply either, so we just CHECK_OK for now.
-      CHECK_OK(CommitWait());
-    }
+  gscoped_ptr<CommitMsg> commit_msg;
+  CHECK_OK(operation_->Apply(&commit_msg));
+  if (commit_msg) {
+    commit_msg->mutable_commited_op_id()->CopyFrom(op_id_copy_);
+  }
 
-    operation_->PreCommit();
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    ApplyTaskDone(commit_msg.Pass());
+    return;
+  }
 
-    // We only write the "commit" records to the local log for legacy Kudu tables. We are not
-    // writing these records for RocksDB-based tables.
-    if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
-      TRACE_EVENT1("operation", "AsyncAppendCommit", "operation", this);
-      CHECK_OK(log_->AsyncAppendCommit(commit_msg.Pass(), Bind(DoNothingStatusCB)));
-    }
+  // Changes of key-value tables could be grouped with those of the following committed operations,
+  // so the operation is completed only once they are written to RocksDB.
+  mutable_state()->tablet_peer()->tablet()->RunAfterApplyGroup([ref] {
+    ADOPT_TRACE(ref->trace());
+    ref->ApplyTaskDone(gscoped_ptr<CommitMsg>());
+  });
+}
 
-    Finalize();
+void OperationDriver::ApplyTaskDone(gscoped_ptr<CommitMsg> commit_msg) {
+  SetResponseHybridTime(operation_->state(), operation_->state()->hybrid_time());
+
+  // If the client requested COMMIT_WAIT as the external consistency mode
+  // calculate the latest that the prepare hybrid_time could be and wait
+  // until now.earliest > prepare_latest. Only after this are the locks
+  // released.
+  if (mutable_state()->external_consistency_mode() == COMMIT_WAIT) {
+    // TODO: only do this on the leader side
+    TRACE("APPLY: Commit Wait.");
+    // If we can't commit wait and have already applied we might have consistency
+    // issues if we still reply to the client that the operation was a success.
+    // On the other hand we don't have rollbacks as of yet thus we can't undo the
+    // the apply either, so we just CHECK_OK for now.
+    CHECK_OK(CommitWait());
   }
+
+  operation_->PreCommit();
+
+  // We only write the "commit" records to the local log for legacy Kudu tables. We are not
+  // writing these records for RocksDB-based tables.
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    TRACE_EVENT1("operation", "AsyncAppendCommit", "operation", this);
+    CHECK_OK(log_->AsyncAppendCommit(commit_msg.Pass(), Bind(DoNothingStatusCB)));
+  }
+
+  Finalize();
 }
 
 void OperationDriver::SetResponseHybridTime(OperationState* operation_state,
@@ -234,6 +234,10 @@ class OperationDriver : public RefCountedThreadSafe<OperationDriver>,
   // results from the Apply().
   void ApplyTask();
 
+  // Completes the operation once its changes are applied: sets the response hybrid time, performs
+  // commit wait if requested and finalizes the operation.
+  void ApplyTaskDone(gscoped_ptr<CommitMsg> commit_msg);
+
   // Sleeps until the operation is allowed to commit based on the
   // requested consistency mode.
   CHECKED_STATUS CommitWait();
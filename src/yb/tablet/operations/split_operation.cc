@@ -0,0 +1,94 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#include "yb/tablet/operations/split_operation.h"
+
+#include "yb/consensus/consensus.h"
+#include "yb/tablet/tablet.h"
+#include "yb/tablet/tablet_peer.h"
+#include "yb/util/trace.h"
+
+using namespace std::literals;
+
+namespace yb {
+namespace tablet {
+
+void SplitOperationState::UpdateRequestFromConsensusRound() {
+  request_ = consensus_round()->replicate_msg()->mutable_split_request();
+}
+
+std::string SplitOperationState::ToString() const {
+  return Format("SplitOperationState [hybrid_time=$0, request=$1]",
+                hybrid_time_even_if_unset(),
+                request_ == nullptr ? "(none)"s : request_->ShortDebugString());
+}
+
+consensus::ReplicateMsgPtr SplitOperation::NewReplicateMsg() {
+  auto result = std::make_shared<consensus::ReplicateMsg>();
+  result->set_op_type(consensus::SPLIT_OP);
+  *result->mutable_split_request() = *state()->request();
+  return result;
+}
+
+Status SplitOperation::Prepare() {
+  TRACE("PREPARE SPLIT: Starting");
+  // Operations are prepared in order, so writes prepared after this operation are rejected and
+  // every write prepared before it is applied before the tablet is split.
+  state()->tablet()->SetSplitting(true);
+  return Status::OK();
+}
+
+void SplitOperation::Start() {
+  if (!state()->has_hybrid_time()) {
+    state()->set_hybrid_time(state()->tablet_peer()->clock().Now());
+  }
+}
+
+Status SplitOperation::Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) {
+  TRACE("APPLY SPLIT: Starting");
+  auto* tablet_peer = state()->tablet_peer();
+  auto* tablet_splitter = tablet_peer->tablet_splitter();
+  if (tablet_splitter == nullptr) {
+    LOG(DFATAL) << "Split of tablet " << tablet_peer->tablet_id() << " is not supported";
+  } else {
+    state()->set_raft_config(tablet_peer->consensus()->CommittedConfig());
+    // The operation is committed, so it has to be applied even if the new tablets could not be
+    // created. The failure is reported to the master, which does not complete the split before
+    // the new tablets are running and asks again, at which point the tablet manager retries.
+    Status s = tablet_splitter->ApplyTabletSplit(state());
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to split tablet " << tablet_peer->tablet_id() << ": " << s;
+      state()->completion_callback()->set_error(s);
+    }
+  }
+
+  commit_msg->reset(new consensus::CommitMsg());
+  (*commit_msg)->set_op_type(consensus::SPLIT_OP);
+  return Status::OK();
+}
+
+void SplitOperation::Finish(OperationResult result) {
+  if (result == Operation::ABORTED) {
+    TRACE("SplitOperation: aborted");
+    state()->tablet()->SetSplitting(false);
+  }
+}
+
+std::string SplitOperation::ToString() const {
+  return Format("SplitOperation [state=$0]", state()->ToString());
+}
+
+} // namespace tablet
+} // namespace yb
@@ -0,0 +1,98 @@
+//
+// Copyright (c) YugaByte, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except
+// in compliance with the License.  You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied.  See the License for the specific language governing permissions and limitations
+// under the License.
+//
+//
+
+#ifndef YB_TABLET_OPERATIONS_SPLIT_OPERATION_H
+#define YB_TABLET_OPERATIONS_SPLIT_OPERATION_H
+
+#include "yb/consensus/metadata.pb.h"
+
+#include "yb/tablet/operations/operation.h"
+
+#include "yb/tserver/tserver_admin.pb.h"
+
+namespace yb {
+namespace tablet {
+
+class Tablet;
+class SplitOperationState;
+
+// Creates the tablets that replace a tablet being split. Implemented by the tablet manager of the
+// tablet server.
+class TabletSplitter {
+ public:
+  virtual ~TabletSplitter() {}
+
+  // Creates the two new tablets of the split, starting with the data of the tablet as of the split
+  // operation. This is done both when the operation is applied and when it is replayed during
+  // bootstrap, so new tablets that already exist are left as they are.
+  virtual CHECKED_STATUS ApplyTabletSplit(SplitOperationState* state) = 0;
+};
+
+class SplitOperationState : public OperationState {
+ public:
+  SplitOperationState(TabletPeer* tablet_peer, Tablet* tablet,
+                      const tserver::SplitTabletRequestPB* request = nullptr,
+                      tserver::SplitTabletResponsePB* response = nullptr)
+      : OperationState(tablet_peer), tablet_(tablet), request_(request), response_(response) {}
+
+  const tserver::SplitTabletRequestPB* request() const override { return request_; }
+  tserver::SplitTabletResponsePB* response() override { return response_; }
+
+  Tablet* tablet() const { return tablet_; }
+
+  // The committed Raft configuration of the tablet, which the new tablets start with.
+  const consensus::RaftConfigPB& raft_config() const { return raft_config_; }
+  void set_raft_config(const consensus::RaftConfigPB& raft_config) { raft_config_ = raft_config; }
+
+  std::string ToString() const override;
+
+ private:
+  void UpdateRequestFromConsensusRound() override;
+
+  Tablet* const tablet_;
+  const tserver::SplitTabletRequestPB* request_;
+  tserver::SplitTabletResponsePB* response_;
+  consensus::RaftConfigPB raft_config_;
+};
+
+// Splits a tablet into two new tablets. Once the operation is prepared the tablet rejects reads
+// and writes, and once it is applied every replica of the tablet has tried to create its replicas
+// of the new tablets. A failure to create them is returned to the caller of the operation.
+class SplitOperation : public Operation {
+ public:
+  SplitOperation(std::unique_ptr<SplitOperationState> state, consensus::DriverType type)
+      : Operation(std::move(state), type, Operation::SPLIT_TXN) {}
+
+  SplitOperationState* state() override {
+    return down_cast<SplitOperationState*>(Operation::state());
+  }
+
+  const SplitOperationState* state() const override {
+    return down_cast<const SplitOperationState*>(Operation::state());
+  }
+
+ private:
+  consensus::ReplicateMsgPtr NewReplicateMsg() override;
+  CHECKED_STATUS Prepare() override;
+  void Start() override;
+  CHECKED_STATUS Apply(gscoped_ptr<consensus::CommitMsg>* commit_msg) override;
+  void Finish(OperationResult result) override;
+  std::string ToString() const override;
+};
+
+} // namespace tablet
+} // namespace yb
+
+#endif // YB_TABLET_OPERATIONS_SPLIT_OPERATION_H
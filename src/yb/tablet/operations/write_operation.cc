@@ -103,6 +103,14 @@ Status WriteOperation::Prepare() {
 
   auto* tablet = tablet_peer()->tablet();
 
+  // Writes are prepared in the same order as the split of the tablet, so a write prepared after the
+  // split is rejected here and retried by the client on one of the new tablets.
+  if (type() == consensus::LEADER && tablet->splitting()) {
+    Status s = STATUS_FORMAT(IllegalState, "Tablet $0 has been split", tablet->tablet_id());
+    state()->completion_callback()->set_error(s, TabletServerErrorPB::TABLET_SPLIT);
+    return s;
+  }
+
   Status s = tablet->DecodeWriteOperations(&client_schema, state());
   if (!s.ok()) {
     // TODO: is MISMATCHED_SCHEMA always right here? probably not.
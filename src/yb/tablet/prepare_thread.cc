@@ -14,14 +14,16 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <thread>
 #include <vector>
 
 #include <boost/lockfree/queue.hpp>
 
 #include <gflags/gflags.h>
 
+#include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+#include "yb/util/threadpool.h"
 #include "yb/tablet/prepare_thread.h"
 #include "yb/tablet/operations/operation_driver.h"
 
@@ -39,6 +41,21 @@ DEFINE_int32(max_group_replicate_batch_size, 16,
 DEFINE_int32(prepare_queue_max_size, 100000,
              "Maximum number of transactions waiting in the per-tablet prepare queue.");
 
+DEFINE_int32(prepare_max_ops_per_task, 128,
+             "Maximum number of transactions of a tablet prepared by one task of the shared "
+             "prepare thread pool. Once it is reached, the task yields to other tablets.");
+TAG_FLAG(prepare_max_ops_per_task, advanced);
+
+METRIC_DEFINE_gauge_uint64(tablet, op_prepare_queue_length, "Operation Prepare Queue Length",
+                           yb::MetricUnit::kOperations,
+                           "Number of operations waiting in the prepare queue of the tablet.");
+
+METRIC_DEFINE_histogram(tablet, op_prepare_queue_time, "Operation Prepare Queue Time",
+                        yb::MetricUnit::kMicroseconds,
+                        "Time from the creation of operations to the start of their prepare. "
+                        "High values indicate that the prepare thread pool is saturated.",
+                        10000000, 2);
+
 using std::vector;
 
 namespace yb {
@@ -49,7 +66,9 @@ namespace tablet {
 
 class PrepareThreadImpl {
  public:
-  explicit PrepareThreadImpl(consensus::Consensus* consensus);
+  PrepareThreadImpl(consensus::Consensus* consensus,
+                    ThreadPool* pool,
+                    const scoped_refptr<MetricEntity>& metric_entity);
   ~PrepareThreadImpl();
   CHECKED_STATUS Start();
   void Stop();
@@ -59,65 +78,70 @@ class PrepareThreadImpl {
  private:
   using OperationDrivers = std::vector<OperationDriver*>;
 
-  scoped_refptr<yb::Thread> thread_;
-
   consensus::Consensus* const consensus_;
 
-  // We set this to true to to tell the thread to shut down. No new tasks will be accepted, but
+  ThreadPool* const pool_;
+
+  // We set this to true to tell the queue to shut down. No new tasks will be accepted, but
   // existing tasks will still be processed.
   std::atomic<bool> stop_requested_{false};
 
-  // This is set to true immediately before the thread exits.
-  std::atomic<bool> stopped_{false};
+  // Number of Submit() calls in progress. Stop() waits for them, so that no item is left in the
+  // queue.
+  std::atomic<size_t> active_submits_{0};
 
-  std::atomic<bool> processing_{false};
+  // Whether a task that processes the queue is submitted to the pool. There is at most one such
+  // task at a time, so operations are processed in the order they were submitted.
+  std::atomic<bool> scheduled_{false};
 
   boost::lockfree::queue<OperationDriver*> queue_;
 
-  std::mutex mtx_;
-  std::condition_variable cond_;
-
-  // This mutex/condition combination is used in Stop() in case multiple threads are calling that
-  // function concurrently. One of them will ask the prepare thread to stop and wait for it, and
-  // then will notify other threads that have called Stop(). Using a separate mutex adds a bit of
-  // complexity, but simplifies reasoning about lock ordering, because the PrepareThread mutex
-  // (mtx_) cannot be acquired while holding the ReplicaState (consensus) lock. With a separate
-  // stopping mutex, we have one fewer place where the main PrepareThread mutex can be acquired.
-  std::mutex stop_mtx_;
-  std::condition_variable stop_cond_;
+  // This mutex/condition combination is used by Stop() to wait until the queue is processed and no
+  // task is running. A task only releases the mutex right before returning, so Stop() returns
+  // once the task does not access this object anymore. The mutex is never held while submitting
+  // entries for replication, which acquires the Raft ReplicaState lock, because we submit entries
+  // to the queue under that lock in UpdateReplica.
+  std::mutex idle_mtx_;
+  std::condition_variable idle_cond_;
 
   OperationDrivers leader_side_batch_;
 
   // A temporary buffer of rounds to replicate, used to reduce reallocation.
   consensus::ConsensusRounds rounds_to_replicate_;
 
-  // @return true if it is OK to block and wait for new items to be appended
-  bool can_block() {
-    return !processing_.load(std::memory_order_acquire) && queue_.empty();
+  scoped_refptr<AtomicGauge<uint64_t>> queue_length_;
+  scoped_refptr<Histogram> queue_time_;
+
+  CHECKED_STATUS DoSubmit(OperationDriver* txn_driver);
+
+  // Submits a task that processes the queue, unless there is one already.
+  void ScheduleIfNeeded();
+
+  bool idle() {
+    return !scheduled_.load() && active_submits_.load(std::memory_order_acquire) == 0 &&
+           queue_.empty();
   }
 
   void Run();
   void ProcessItem(OperationDriver* item);
 
   // @return true if at least one item was processed.
-  // @param lock This unique_lock of mtx_ is provided so that we can release it if we need to submit
-  //        a batch for replication. The reason is that ReplicateBatch acquires the Raft
-  //        ReplicaState lock, and we already submit entries to PrepareThread under that lock
-  //        in UpdateReplica. To avoid deadlock, we must never attempt to acquire the ReplicaState
-  //        lock while holding the PrepareThread lock.
-  bool ProcessAndClearLeaderSideBatch(std::unique_lock<std::mutex>* lock = nullptr);
-
-  // A wrapper around ProcessAndClearLeaderSideBatch that assumes we are currently holding the
-  // mutex.
+  bool ProcessAndClearLeaderSideBatch();
 
   void ReplicateSubBatch(OperationDrivers::iterator begin,
-                         OperationDrivers::iterator end,
-                         std::unique_lock<std::mutex>* lock);
+                         OperationDrivers::iterator end);
 };
 
-PrepareThreadImpl::PrepareThreadImpl(consensus::Consensus* consensus)
+PrepareThreadImpl::PrepareThreadImpl(consensus::Consensus* consensus,
+                                     ThreadPool* pool,
+                                     const scoped_refptr<MetricEntity>& metric_entity)
     : consensus_(consensus),
+      pool_(pool),
       queue_(FLAGS_prepare_queue_max_size) {
+  if (metric_entity) {
+    queue_length_ = METRIC_op_prepare_queue_length.Instantiate(metric_entity, 0);
+    queue_time_ = METRIC_op_prepare_queue_time.Instantiate(metric_entity);
+  }
 }
 
 PrepareThreadImpl::~PrepareThreadImpl() {
@@ -125,115 +149,96 @@ PrepareThreadImpl::~PrepareThreadImpl() {
 }
 
 Status PrepareThreadImpl::Start() {
-  return Thread::Create("prepare", "prepare", &PrepareThreadImpl::Run, this, &thread_);
+  if (pool_ == nullptr) {
+    return STATUS(InvalidArgument, "Prepare thread pool is not specified");
+  }
+  return Status::OK();
 }
 
 void PrepareThreadImpl::Stop() {
-  // It is OK if multiple threads call this method at once. At worst, they will all notify the
-  // condition variable and wait.
-  if (stopped_.load(std::memory_order_acquire)) {
-    return;
-  }
+  // It is OK if multiple threads call this method at once, they all wait for the queue to become
+  // idle.
+  stop_requested_.store(true, std::memory_order_release);
 
-  bool expected = false;
-  if (stop_requested_.compare_exchange_strong(expected, true, std::memory_order_release)) {
-    // We need this to unblock waiting for new transactions to arrive. Since nothing has been added,
-    // we'll just go through the loop one more time and exit at the next iteration.
-    processing_.store(true, std::memory_order_release);
-    cond_.notify_one();
-
-    CHECK_OK(ThreadJoiner(thread_.get()).Join());
-
-    // Note: we are using a separate mutex for stopping, different from the main mutex mtx_.
-    std::unique_lock<std::mutex> stop_lock(stop_mtx_);
-    stopped_.store(true, std::memory_order_release);
-    stop_cond_.notify_all();
-  } else {
-    // Note (as above): stop_mtx_ is different from mtx_.
-    std::unique_lock<std::mutex> stop_lock(stop_mtx_);
-    stop_cond_.wait(stop_lock, [this] { return stopped_.load(std::memory_order_acquire); });
-  }
+  std::unique_lock<std::mutex> lock(idle_mtx_);
+  idle_cond_.wait(lock, [this] { return idle(); });
 }
 
 Status PrepareThreadImpl::Submit(OperationDriver* txnd) {
+  active_submits_.fetch_add(1, std::memory_order_acq_rel);
+  Status s = DoSubmit(txnd);
+  if (active_submits_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+      stop_requested_.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(idle_mtx_);
+    idle_cond_.notify_all();
+  }
+  return s;
+}
+
+Status PrepareThreadImpl::DoSubmit(OperationDriver* txnd) {
   if (stop_requested_.load(std::memory_order_acquire)) {
     return STATUS(IllegalState, "Prepare thread is shutting down");
   }
+  // The length is incremented first, so that a task that pops the item right away does not
+  // decrement it below zero.
+  if (queue_length_) {
+    queue_length_->Increment();
+  }
   if (!queue_.bounded_push(txnd)) {
+    if (queue_length_) {
+      queue_length_->Decrement();
+    }
     return STATUS_FORMAT(ServiceUnavailable,
                          "Prepare queue is full (max capacity $0)",
                          FLAGS_prepare_queue_max_size);
   }
 
-  bool old_processing = false;
-  if (processing_.compare_exchange_strong(old_processing, true)) {
-    // processing_ was false and we switched it to true. That means we were in the section between
-    // processing_.store(false, ...) and processing_.store(true, ...) in Run at the time of
-    // the compare_exchange_strong above. In that case there are two options:
-    // - The item we've appended has already been processed at the time of the queue_.empty() check.
-    //   Then the inner loop will break into the the outer loop, where we'll wait for processing_ to
-    //   be true (a no-op) and immediately try to pop another item, which will fail if no other
-    //   items have been appended yet. In that case we'll simply reset processing_ to false and go
-    //   into another iteration of waiting.
-    // - The item we've appended has not yet been processed at that time. Then we'll immediately
-    //   store true into processing_ once again (a no-op since it's already true) and go into
-    //   another iteration of the inner loop, which will process the newly added item.
-    std::unique_lock<std::mutex> lock(mtx_);
-    cond_.notify_one();
-  }
-
-  // In case the compare-and-exchange fails above because processing_ is already true (and we
-  // don't update it or notify the condition), but then processing_ gets immediately changed to
-  // false as we enter the processing_.store(false, ...); ...; processing_.store(true, ...) section
-  // below, there are two options:
-  // - The processing thread has already processed the item we've just added, and the queue is
-  //   empty. Then the processing thread will exit the inner loop and wait on the condition, as
-  //   expected.
-  // - The processing thread has not yet processed the new item, and it is in the queue. Then it
-  //   will go for another iteration of the inner loop and process the new item.
-
+  ScheduleIfNeeded();
   return Status::OK();
 }
 
+void PrepareThreadImpl::ScheduleIfNeeded() {
+  bool expected = false;
+  if (scheduled_.compare_exchange_strong(expected, true)) {
+    // The pool is shut down only after all tablets are, and its queue is unbounded, so the item
+    // that was just added would never be processed if this fails.
+    CHECK_OK(pool_->SubmitFunc(std::bind(&PrepareThreadImpl::Run, this)));
+  }
+}
+
 void PrepareThreadImpl::Run() {
   for (;;) {
-    {
-      // Logic for waiting (most common) and stopping (happens once on tablet shutdown).
-      std::unique_lock<std::mutex> lock(mtx_);
-
-      if (can_block()) {
-        if (stop_requested_.load(std::memory_order_acquire)) {
-          ProcessAndClearLeaderSideBatch(&lock);
-          if (lock.owns_lock()) {
-            VLOG(1) << "Prepare thread's Run() function is exiting";
-
-            // This is the only place this function returns. If that ever changes, we'll need to
-            // move the cleanup logic above so that it gets executed on every return path.
-            return;
-          }
-          // We had to release our mutex before submitting some entries for replication. Go for one
-          // more iteration and come back here next time.
-        } else {
-          // If we end up processing at least one accumulated leader-side item here, we need to
-          // check the can_block() condition again. Otherwise, we don't need to re-check.
-          //
-          // Also, if we no longer own the lock as a result of ProcessAndClearLeaderSideBatch()
-          // having released it, we can't block now so we'll loop around.
-          if ((!ProcessAndClearLeaderSideBatch(&lock) || can_block()) && lock.owns_lock()) {
-            cond_.wait(lock, [this] { return processing_.load(std::memory_order_acquire); });
-          }
-        }
+    int processed = 0;
+    OperationDriver* item = nullptr;
+    while (processed < FLAGS_prepare_max_ops_per_task && queue_.pop(item)) {
+      if (queue_length_) {
+        queue_length_->Decrement();
       }
+      ProcessItem(item);
+      ++processed;
     }
+    ProcessAndClearLeaderSideBatch();
 
-    for (;;) {
-      OperationDriver* item = nullptr;
-      while (queue_.pop(item)) {
-        ProcessItem(item);
+    {
+      std::lock_guard<std::mutex> lock(idle_mtx_);
+      // If an item is added after scheduled_ is reset, the thread that added it submits a new
+      // task. Otherwise we see the item below and keep processing.
+      scheduled_.store(false);
+      if (queue_.empty()) {
+        idle_cond_.notify_all();
+        return;
+      }
+      bool expected = false;
+      if (!scheduled_.compare_exchange_strong(expected, true)) {
+        // Another task was submitted in the meantime.
+        return;
       }
-      processing_.store(false, std::memory_order_release);
-      if (queue_.empty()) break;
-      processing_.store(true, std::memory_order_release);
+    }
+
+    if (processed >= FLAGS_prepare_max_ops_per_task) {
+      // Give other tablets a chance to run.
+      CHECK_OK(pool_->SubmitFunc(std::bind(&PrepareThreadImpl::Run, this)));
+      return;
     }
   }
 }
@@ -241,6 +246,11 @@ void PrepareThreadImpl::Run() {
 void PrepareThreadImpl::ProcessItem(OperationDriver* item) {
   CHECK_NOTNULL(item);
 
+  if (queue_time_) {
+    queue_time_->Increment(
+        MonoTime::Now(MonoTime::FINE).GetDeltaSince(item->start_time()).ToMicroseconds());
+  }
+
   if (item->is_leader_side()) {
     const int64_t bound_term = item->consensus_round()->bound_term();
 
@@ -271,8 +281,7 @@ void PrepareThreadImpl::ProcessItem(OperationDriver* item) {
   }
 }
 
-bool PrepareThreadImpl::ProcessAndClearLeaderSideBatch(std::unique_lock<std::mutex>* lock) {
-  DCHECK(!lock || lock->mutex() == &mtx_);
+bool PrepareThreadImpl::ProcessAndClearLeaderSideBatch() {
   if (leader_side_batch_.empty()) {
     return false;
   }
@@ -295,7 +304,7 @@ bool PrepareThreadImpl::ProcessAndClearLeaderSideBatch(std::unique_lock<std::mut
     if (PREDICT_TRUE(s.ok())) {
       replication_subbatch_end = ++iter;
     } else {
-      ReplicateSubBatch(replication_subbatch_begin, replication_subbatch_end, lock);
+      ReplicateSubBatch(replication_subbatch_begin, replication_subbatch_end);
 
       // Handle failure for this transaction itself.
       txnd->HandleFailure(s);
@@ -306,7 +315,7 @@ bool PrepareThreadImpl::ProcessAndClearLeaderSideBatch(std::unique_lock<std::mut
   }
 
   // Replicate the remaining batch. No-op for an empty batch.
-  ReplicateSubBatch(replication_subbatch_begin, replication_subbatch_end, lock);
+  ReplicateSubBatch(replication_subbatch_begin, replication_subbatch_end);
 
   leader_side_batch_.clear();
   return true;
@@ -314,9 +323,7 @@ bool PrepareThreadImpl::ProcessAndClearLeaderSideBatch(std::unique_lock<std::mut
 
 void PrepareThreadImpl::ReplicateSubBatch(
     OperationDrivers::iterator txnd_begin,
-    OperationDrivers::iterator txnd_end,
-    std::unique_lock<std::mutex>* lock) {
-  DCHECK(!lock || lock->mutex() == &mtx_);
+    OperationDrivers::iterator txnd_end) {
   DCHECK_GE(std::distance(txnd_begin, txnd_end), 0);
   if (txnd_begin == txnd_end) {
     return;
@@ -337,9 +344,6 @@ void PrepareThreadImpl::ReplicateSubBatch(
     rounds_to_replicate_.push_back((*txnd_iter)->consensus_round());
   }
 
-  if (lock && lock->owns_lock()) {
-    lock->unlock();
-  }
   const Status s = consensus_->ReplicateBatch(rounds_to_replicate_);
   rounds_to_replicate_.clear();
 
@@ -358,8 +362,10 @@ void PrepareThreadImpl::ReplicateSubBatch(
 // ------------------------------------------------------------------------------------------------
 // PrepareThread
 
-PrepareThread::PrepareThread(consensus::Consensus* consensus)
-    : impl_(std::make_unique<PrepareThreadImpl>(consensus)) {
+PrepareThread::PrepareThread(consensus::Consensus* consensus,
+                             ThreadPool* pool,
+                             const scoped_refptr<MetricEntity>& metric_entity)
+    : impl_(std::make_unique<PrepareThreadImpl>(consensus, pool, metric_entity)) {
 }
 
 PrepareThread::~PrepareThread() = default;
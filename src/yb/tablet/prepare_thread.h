@@ -16,6 +16,7 @@
 
 #include <gflags/gflags.h>
 
+#include "yb/gutil/ref_counted.h"
 #include "yb/util/status.h"
 
 DECLARE_int32(max_group_replicate_batch_size);
@@ -23,6 +24,9 @@ DECLARE_int32(prepare_queue_max_size);
 
 namespace yb {
 
+class MetricEntity;
+class ThreadPool;
+
 namespace consensus {
 class Consensus;
 }
@@ -33,12 +37,19 @@ class OperationDriver;
 
 class PrepareThreadImpl;
 
-// This is a thread that invokes the "prepare" step on single-shard transactions and, for
+// This is a serial queue that invokes the "prepare" step on single-shard transactions and, for
 // leader-side transactions, submits them for replication to the consensus in batches. This is
 // useful because we have a "fat lock" in the consensus.
+//
+// Operations of a tablet are processed in order by tasks submitted to a thread pool that is shared
+// by all tablets of the server, with at most one task per tablet running at a time. So idle
+// tablets do not hold a prepare thread. They still hold the Raft heartbeater thread of each peer
+// and the log append thread.
 class PrepareThread {
  public:
-  explicit PrepareThread(consensus::Consensus* consensus);
+  PrepareThread(consensus::Consensus* consensus,
+                ThreadPool* pool,
+                const scoped_refptr<MetricEntity>& metric_entity);
   ~PrepareThread();
 
   CHECKED_STATUS Start();
@@ -40,6 +40,7 @@
 #include <memory>
 #include <mutex>
 #include <ostream>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -106,6 +107,8 @@
 #include "yb/util/locks.h"
 #include "yb/util/mem_tracker.h"
 #include "yb/util/metrics.h"
+#include "yb/util/path_util.h"
+#include "yb/util/size_literals.h"
 #include "yb/util/slice.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/string_packer.h"
@@ -132,6 +135,21 @@ DEFINE_double(tablet_bloom_target_fp_rate, 0.01f,
               "required for bloom filters.");
 TAG_FLAG(tablet_bloom_target_fp_rate, advanced);
 
+DEFINE_int32(tablet_apply_group_max_ops, 64,
+             "Maximum number of committed write operations whose changes are written to RocksDB "
+             "by a single write. Values lower than 2 disable grouping of applied operations.");
+TAG_FLAG(tablet_apply_group_max_ops, advanced);
+TAG_FLAG(tablet_apply_group_max_ops, runtime);
+
+DEFINE_int32(rocksdb_max_scheduled_compactions, 2,
+             "Maximum number of tablets whose RocksDB compactions are run at the same time, when "
+             "compactions are scheduled by the maintenance manager. The compactions run on the "
+             "RocksDB background threads, not on the maintenance manager threads.");
+TAG_FLAG(rocksdb_max_scheduled_compactions, advanced);
+TAG_FLAG(rocksdb_max_scheduled_compactions, runtime);
+
+DECLARE_int64(intents_db_write_buffer_size_bytes);
+
 METRIC_DEFINE_entity(tablet);
 METRIC_DEFINE_gauge_size(tablet, memrowset_size, "MemRowSet Memory Usage",
                          yb::MetricUnit::kBytes,
@@ -195,6 +213,23 @@ static CompactionPolicy *CreateCompactionPolicy() {
   return new BudgetedCompactionPolicy(FLAGS_tablet_compaction_budget_mb);
 }
 
+// Returns the range of key hashes covered by the partition of a hash-partitioned QL tablet.
+static docdb::KeyHashRange GetKeyHashRange(const TabletMetadata& metadata) {
+  docdb::KeyHashRange result;
+  if (metadata.table_type() != TableType::YQL_TABLE_TYPE ||
+      metadata.partition_schema().hash_schema() != YBHashSchema::kMultiColumnHash) {
+    return result;
+  }
+  const Partition& partition = metadata.partition();
+  if (!partition.partition_key_start().empty()) {
+    result.begin = PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_start());
+  }
+  if (!partition.partition_key_end().empty()) {
+    result.end = PartitionSchema::DecodeMultiColumnHashValue(partition.partition_key_end());
+  }
+  return result;
+}
+
 ////////////////////////////////////////////////////////////
 // TabletComponents
 ////////////////////////////////////////////////////////////
@@ -203,6 +238,58 @@ TabletComponents::TabletComponents(shared_ptr<MemRowSet> mrs,
                                    shared_ptr<RowSetTree> rs_tree)
     : memrowset(std::move(mrs)), rowsets(std::move(rs_tree)) {}
 
+////////////////////////////////////////////////////////////
+// CompactRocksDBOp
+////////////////////////////////////////////////////////////
+
+namespace {
+
+// Number of tablets whose compactions were started by a CompactRocksDBOp and are not finished yet,
+// in the whole process.
+std::atomic<int> num_compacting_tablets{0};
+
+} // namespace
+
+CompactRocksDBOp::CompactRocksDBOp(Tablet* tablet)
+    : MaintenanceOp(Substitute("CompactRocksDBOp($0)", tablet->tablet_id()),
+                    MaintenanceOp::HIGH_IO_USAGE),
+      tablet_(tablet) {
+}
+
+void CompactRocksDBOp::UpdateStats(MaintenanceOpStats* stats) {
+  tablet_->UpdateRocksDBCompactionStats(stats);
+  if (running() > 0 ||
+      num_compacting_tablets.load(std::memory_order_acquire) >=
+          FLAGS_rocksdb_max_scheduled_compactions) {
+    stats->set_runnable(false);
+  }
+}
+
+bool CompactRocksDBOp::Prepare() {
+  // Prepare() and UpdateStats() are both called from the scheduler thread of the maintenance
+  // manager, so the limit checked by UpdateStats() still holds.
+  num_compacting_tablets.fetch_add(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void CompactRocksDBOp::Perform() {
+  // Once started, the tablet releases its slot when UpdateStats() finds the compactions done.
+  Status s = tablet_->StartRocksDBCompactions();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to start RocksDB compactions on " << tablet_->tablet_id() << ": "
+                 << s.ToString();
+    num_compacting_tablets.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+scoped_refptr<Histogram> CompactRocksDBOp::DurationHistogram() const {
+  return tablet_->metrics()->start_compact_rocksdb_duration;
+}
+
+scoped_refptr<AtomicGauge<uint32_t> > CompactRocksDBOp::RunningGauge() const {
+  return tablet_->metrics()->start_compact_rocksdb_running;
+}
+
 ////////////////////////////////////////////////////////////
 // Tablet
 ////////////////////////////////////////////////////////////
@@ -230,6 +317,7 @@ Tablet::Tablet(
       tablet_options_(tablet_options) {
   CHECK(schema()->has_column_ids());
   compaction_policy_.reset(CreateCompactionPolicy());
+  key_hash_range_ = GetKeyHashRange(*metadata);
 
   if (metric_registry) {
     MetricEntity::AttributeMap attrs;
@@ -249,6 +337,8 @@ Tablet::Tablet(
       });
     }
     metrics_.reset(new TabletMetrics(metric_entity_));
+    shared_lock_manager_.SetMetrics(
+        metrics_->docdb_lock_wait_time, metrics_->docdb_lock_contentions);
     METRIC_memrowset_size.InstantiateFunctionGauge(
             metric_entity_, Bind(&Tablet::MemRowSetSize, Unretained(this)))
         ->AutoDetach(&metric_detacher_);
@@ -259,7 +349,7 @@ Tablet::Tablet(
 
   if (transaction_participant_context) {
     transaction_participant_ = std::make_unique<TransactionParticipant>(
-        transaction_participant_context);
+        transaction_participant_context, tablet_options_.intents_buffer_mem_tracker);
   }
 
   if (transaction_coordinator_context) { // TODO(dtxn) Create coordinator only for status tablets
@@ -301,6 +391,18 @@ Status Tablet::Open() {
   return Status::OK();
 }
 
+class Tablet::RegularDBFlushListener : public rocksdb::EventListener {
+ public:
+  explicit RegularDBFlushListener(Tablet* tablet) : tablet_(tablet) {}
+
+  void OnFlushCompleted(rocksdb::DB* db, const rocksdb::FlushJobInfo& /* info */) override {
+    tablet_->RegularDBFlushed(db->GetFlushedOpId());
+  }
+
+ private:
+  Tablet* const tablet_;
+};
+
 Status Tablet::OpenKeyValueTablet() {
   rocksdb::Options rocksdb_options;
   docdb::InitRocksDBOptions(&rocksdb_options, tablet_id(), rocksdb_statistics_, tablet_options_);
@@ -308,7 +410,7 @@ Status Tablet::OpenKeyValueTablet() {
   // Install the history cleanup handler. Note that TabletRetentionPolicy is going to hold a raw ptr
   // to this tablet. So, we ensure that rocksdb_ is reset before this tablet gets destroyed.
   rocksdb_options.compaction_filter_factory = make_shared<DocDBCompactionFilterFactory>(
-      make_shared<TabletRetentionPolicy>(this));
+      make_shared<TabletRetentionPolicy>(this), key_hash_range_);
 
   const string db_dir = metadata()->rocksdb_dir();
   LOG(INFO) << "Creating RocksDB database in dir " << db_dir;
@@ -322,9 +424,17 @@ Status Tablet::OpenKeyValueTablet() {
                         Substitute("Failed to create RocksDB tablet directory $0",
                                    db_dir));
 
+  const bool has_intents_db =
+      transaction_participant_ && schema()->table_properties().is_transactional();
+  rocksdb::Options regular_options = rocksdb_options;
+  if (has_intents_db) {
+    // Flushes of the intents DB wait for flushes of the regular DB, see IntentsFlushBound().
+    regular_options.listeners.push_back(std::make_shared<RegularDBFlushListener>(this));
+  }
+
   LOG(INFO) << "Opening RocksDB at: " << db_dir;
   rocksdb::DB* db = nullptr;
-  rocksdb::Status rocksdb_open_status = rocksdb::DB::Open(rocksdb_options, db_dir, &db);
+  rocksdb::Status rocksdb_open_status = rocksdb::DB::Open(regular_options, db_dir, &db);
   if (!rocksdb_open_status.ok()) {
     LOG(ERROR) << "Failed to open a RocksDB database in directory " << db_dir << ": "
                << rocksdb_open_status.ToString();
@@ -334,8 +444,95 @@ Status Tablet::OpenKeyValueTablet() {
     return STATUS(IllegalState, rocksdb_open_status.ToString());
   }
   rocksdb_.reset(db);
+  const auto regular_flushed_op_id = rocksdb_->GetFlushedOpId();
+  regular_flushed_index_at_open_ = regular_flushed_op_id.index;
+  last_regular_write_op_id_ = regular_flushed_op_id;
+  last_write_op_id_ = regular_flushed_op_id;
+  {
+    std::lock_guard<simple_spinlock> lock(intents_flush_bound_lock_);
+    intents_flush_bound_ = regular_flushed_op_id;
+  }
   ql_storage_.reset(new docdb::QLRocksDBStorage(rocksdb_.get()));
   LOG(INFO) << "Successfully opened a RocksDB database at " << db_dir;
+
+  if (has_intents_db) {
+    RETURN_NOT_OK(OpenIntentsDB(rocksdb_options));
+  }
+  return Status::OK();
+}
+
+Status Tablet::OpenIntentsDB(const rocksdb::Options& regular_options) {
+  // Intents are deleted once their transaction is applied, so the history cleanup handler of the
+  // regular DB is not needed.
+  rocksdb::Options rocksdb_options = regular_options;
+  rocksdb_options.compaction_filter_factory = nullptr;
+  rocksdb_options.max_flushable_op_id = [this] { return IntentsFlushBound(); };
+  docdb::SetIntentsRocksDBOptions(&rocksdb_options);
+
+  const string db_dir = metadata()->intents_rocksdb_dir();
+  RETURN_NOT_OK_PREPEND(metadata()->fs_manager()->CreateDirIfMissing(db_dir),
+                        Substitute("Failed to create RocksDB intents directory $0", db_dir));
+
+  LOG(INFO) << "Opening intents RocksDB at: " << db_dir;
+  rocksdb::DB* db = nullptr;
+  rocksdb::Status rocksdb_open_status = rocksdb::DB::Open(rocksdb_options, db_dir, &db);
+  if (!rocksdb_open_status.ok()) {
+    LOG(ERROR) << "Failed to open the intents RocksDB database in directory " << db_dir << ": "
+               << rocksdb_open_status.ToString();
+    if (db != nullptr) {
+      delete db;
+    }
+    return STATUS(IllegalState, rocksdb_open_status.ToString());
+  }
+  intents_db_.reset(db);
+  intents_flushed_index_at_open_ = intents_db_->GetFlushedOpId().index;
+  LOG(INFO) << "Successfully opened the intents RocksDB database at " << db_dir;
+  return MigrateIntentsFromRegularDB();
+}
+
+// Intents are copied to the intents DB and flushed before they are removed from the regular DB, so
+// the migration is just repeated if it is interrupted.
+Status Tablet::MigrateIntentsFromRegularDB() {
+  constexpr int kMaxMigrateBatchSize = 1024;
+
+  KeyBytes intent_prefix;
+  intent_prefix.AppendValueType(ValueType::kIntentPrefix);
+  rocksdb::WriteOptions write_options;
+  InitRocksDBWriteOptions(&write_options);
+
+  size_t num_intents = 0;
+  for (rocksdb::DB* db : {intents_db_.get(), rocksdb_.get()}) {
+    auto iter = docdb::CreateRocksDBIterator(rocksdb_.get(),
+                                             docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
+                                             boost::none,
+                                             rocksdb::kDefaultQueryId);
+    WriteBatch batch;
+    for (iter->Seek(intent_prefix.data());
+         iter->Valid() && iter->key().starts_with(intent_prefix.data());
+         iter->Next()) {
+      if (db == intents_db_.get()) {
+        batch.Put(iter->key(), iter->value());
+        ++num_intents;
+      } else {
+        batch.Delete(iter->key());
+      }
+      if (batch.Count() >= kMaxMigrateBatchSize) {
+        RETURN_NOT_OK(db->Write(write_options, &batch));
+        batch.Clear();
+      }
+    }
+    RETURN_NOT_OK(iter->status());
+    if (num_intents == 0) {
+      return Status::OK();
+    }
+    if (batch.Count() != 0) {
+      RETURN_NOT_OK(db->Write(write_options, &batch));
+    }
+    RETURN_NOT_OK(db->Flush(rocksdb::FlushOptions()));
+  }
+
+  LOG(INFO) << "Tablet " << tablet_id() << ": moved " << num_intents
+            << " intent records from the regular DB to the intents DB";
   return Status::OK();
 }
 
@@ -444,10 +641,19 @@ void Tablet::Shutdown() {
     transaction_coordinator_->Shutdown();
   }
 
+  if (intents_db_) {
+    // Lets the intents DB flush everything once the regular DB is flushed on shutdown.
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    AddIntentsFlushBoundUnlocked();
+    AdvanceIntentsFlushBound(rocksdb_->GetFlushedOpId());
+  }
+
   std::lock_guard<rw_spinlock> lock(component_lock_);
   components_ = nullptr;
-  // Shutdown the RocksDB instance for this table, if present.
+  // Shutdown the RocksDB instances for this table, if present. The regular DB goes first, because
+  // the intents DB is flushed only up to what the regular DB flushed.
   rocksdb_.reset();
+  intents_db_.reset();
   state_ = kShutdown;
 
   // In the case of deleting a tablet, we still keep the metadata around after
@@ -792,19 +998,14 @@ void Tablet::ApplyRowOperations(WriteOperationState* operation_state) {
   LOG(FATAL) << "Invalid table type: " << table_type_;
 }
 
-Status Tablet::CreateCheckpoint(const std::string& dir,
-                                google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files) {
-  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
-
-  CHECK(table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE);
-
-  std::lock_guard<std::mutex> lock(create_checkpoint_lock_);
+namespace {
 
+CHECKED_STATUS CreateRocksDBCheckpoint(rocksdb::DB* db, const std::string& dir) {
   rocksdb::Status status;
   std::unique_ptr<rocksdb::Checkpoint> checkpoint;
   {
     rocksdb::Checkpoint* checkpoint_raw_ptr = nullptr;
-    status = rocksdb::Checkpoint::Create(rocksdb_.get(), &checkpoint_raw_ptr);
+    status = rocksdb::Checkpoint::Create(db, &checkpoint_raw_ptr);
     if (!status.ok()) {
       return STATUS(IllegalState, Substitute("Unable to create checkpoint object: $0",
                                              status.ToString()));
@@ -819,22 +1020,64 @@ Status Tablet::CreateCheckpoint(const std::string& dir,
     return STATUS(IllegalState, Substitute("Unable to create checkpoint: $0", status.ToString()));
   }
   LOG(INFO) << "Checkpoint created in " << dir;
+  return Status::OK();
+}
 
-  if (rocksdb_files != nullptr) {
-    vector<rocksdb::Env::FileAttributes> files_attrs;
-    status = rocksdb_->GetEnv()->GetChildrenFileAttributes(dir, &files_attrs);
-    if (!status.ok()) {
-      return STATUS(IllegalState, Substitute("Unable to get RocksDB files in dir $0: $1", dir,
-                                             status.ToString()));
+// Adds the files of the checkpoint in 'dir' to 'rocksdb_files', with names prefixed by 'prefix'.
+CHECKED_STATUS ListCheckpointFiles(
+    rocksdb::Env* env, const std::string& dir, const std::string& prefix,
+    google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files) {
+  vector<rocksdb::Env::FileAttributes> files_attrs;
+  rocksdb::Status status = env->GetChildrenFileAttributes(dir, &files_attrs);
+  if (!status.ok()) {
+    return STATUS(IllegalState, Substitute("Unable to get RocksDB files in dir $0: $1", dir,
+                                           status.ToString()));
+  }
+
+  for (const auto& file_attrs : files_attrs) {
+    if (file_attrs.name == "." || file_attrs.name == ".." || file_attrs.name == kIntentsSubdir) {
+      continue;
     }
+    auto rocksdb_file_pb = rocksdb_files->Add();
+    rocksdb_file_pb->set_name(prefix + file_attrs.name);
+    rocksdb_file_pb->set_size_bytes(file_attrs.size_bytes);
+  }
+  return Status::OK();
+}
 
-    for (const auto& file_attrs : files_attrs) {
-      if (file_attrs.name == "." || file_attrs.name == "..") {
-        continue;
-      }
-      auto rocksdb_file_pb = rocksdb_files->Add();
-      rocksdb_file_pb->set_name(file_attrs.name);
-      rocksdb_file_pb->set_size_bytes(file_attrs.size_bytes);
+} // namespace
+
+Status Tablet::CreateCheckpoint(const std::string& dir,
+                                google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files) {
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  CHECK(table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE);
+
+  std::lock_guard<std::mutex> lock(create_checkpoint_lock_);
+
+  // Writes are blocked while the checkpoint is created, so that the regular and the intents DB
+  // are checkpointed at the same operation. Both DBs are flushed first in the order that keeps
+  // intents from being flushed before the changes they were applied to.
+  std::unique_lock<std::mutex> apply_group_lock(apply_group_mutex_, std::defer_lock);
+  if (intents_db_) {
+    apply_group_lock.lock();
+    WriteApplyGroupUnlocked();
+    FlushRegularThenIntentsUnlocked();
+    WaitForRegularThenIntentsFlush();
+  }
+
+  RETURN_NOT_OK(CreateRocksDBCheckpoint(rocksdb_.get(), dir));
+  if (rocksdb_files != nullptr) {
+    RETURN_NOT_OK(ListCheckpointFiles(rocksdb_->GetEnv(), dir, "", rocksdb_files));
+  }
+
+  if (intents_db_) {
+    const auto intents_dir = JoinPathSegments(dir, kIntentsSubdir);
+    RETURN_NOT_OK(CreateRocksDBCheckpoint(intents_db_.get(), intents_dir));
+    if (rocksdb_files != nullptr) {
+      RETURN_NOT_OK(ListCheckpointFiles(
+          intents_db_->GetEnv(), intents_dir, std::string(kIntentsSubdir) + "/",
+          rocksdb_files));
     }
   }
 
@@ -843,10 +1086,19 @@ Status Tablet::CreateCheckpoint(const std::string& dir,
   return Status::OK();
 }
 
-void AddIntent(const TransactionId& transaction_id,
-               Slice key,
-               Slice value,
-               WriteBatch* rocksdb_write_batch) {
+Status Tablet::CreateSplitCheckpoint(const std::string& dir) {
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    WriteApplyGroupUnlocked();
+  }
+  return CreateCheckpoint(dir);
+}
+
+BufferedIntent& AddIntent(const TransactionId& transaction_id,
+                          Slice key,
+                          Slice value,
+                          WriteBatch* rocksdb_write_batch,
+                          BufferedIntents* buffered_intents) {
   KeyBytes reverse_key;
   AppendTransactionKeyPrefix(transaction_id, &reverse_key);
   int size = 0;
@@ -855,6 +1107,50 @@ void AddIntent(const TransactionId& transaction_id,
 
   rocksdb_write_batch->Put(key, value);
   rocksdb_write_batch->Put(reverse_key.data(), key);
+
+  buffered_intents->emplace_back();
+  auto& result = buffered_intents->back();
+  result.intent_key.assign(key.cdata(), key.size());
+  result.reverse_index_key = reverse_key.data();
+  return result;
+}
+
+// Adds a record with the key, that does not have a hybrid time yet, and the value to the batch.
+void AddRecord(Slice key, Slice value, const DocHybridTime& doc_ht, WriteBatch* write_batch) {
+  std::string patched_key;
+  patched_key.reserve(key.size() + 1 + kMaxBytesPerEncodedHybridTime);
+  patched_key.append(key.cdata(), key.size());
+  patched_key.push_back(static_cast<char>(ValueType::kHybridTime));
+  doc_ht.AppendEncodedInDocDbFormat(&patched_key);
+  write_batch->Put(patched_key, value);
+}
+
+// Fills the batches that apply the buffered intents of a transaction and remove them, like
+// Tablet::PrepareApplyStoredIntents does for intents read from RocksDB.
+void PrepareApplyBufferedIntents(const TransactionApplyData& data,
+                                 BufferedIntents* intents,
+                                 WriteBatch* rocksdb_write_batch,
+                                 WriteBatch* intents_delete_batch) {
+  // Intents are applied in the order of the reverse index, so that intents written to the same key
+  // get the same write ids as when they are read from RocksDB.
+  std::sort(intents->begin(), intents->end(),
+            [](const BufferedIntent& lhs, const BufferedIntent& rhs) {
+    return lhs.reverse_index_key < rhs.reverse_index_key;
+  });
+
+  KeyBytes metadata_key;
+  AppendTransactionKeyPrefix(data.transaction_id, &metadata_key);
+  intents_delete_batch->Delete(metadata_key.data());
+
+  IntraTxnWriteId write_id = 0;
+  for (const auto& intent : *intents) {
+    if (intent.strong) {
+      AddRecord(intent.key, intent.value, DocHybridTime(data.hybrid_time, write_id++),
+                rocksdb_write_batch);
+    }
+    intents_delete_batch->Delete(intent.intent_key);
+    intents_delete_batch->Delete(intent.reverse_index_key);
+  }
 }
 
 void AppendIntentKeySuffix(docdb::IntentType intent_type,
@@ -901,13 +1197,13 @@ void Tablet::PrepareTransactionWriteBatch(
 
   if (put_batch.transaction().has_isolation()) {
     // Store transaction metadata (status tablet, isolation level etc.)
-    transaction_participant()->Add(put_batch.transaction(), rocksdb_write_batch);
+    transaction_participant()->Add(put_batch.transaction(), intents_db(), rocksdb_write_batch);
   }
 
   auto transaction_id = MakeTransactionIdFromBinaryRepresentation(
       put_batch.transaction().transaction_id());
   CHECK_OK(transaction_id);
-  auto isolation_level = transaction_participant()->IsolationLevel(rocksdb_.get(), *transaction_id);
+  auto isolation_level = transaction_participant()->IsolationLevel(intents_db(), *transaction_id);
   auto intent_types = WriteIntentsForIsolationLevel(isolation_level);
 
   // TODO(dtxn) weak & strong intent in one batch
@@ -915,6 +1211,8 @@ void Tablet::PrepareTransactionWriteBatch(
 
   KeyBytes encoded_key;
   std::string value;
+  BufferedIntents buffered_intents;
+  buffered_intents.reserve(put_batch.kv_pairs_size());
 
   IntraTxnWriteId write_id = 0;
 
@@ -950,7 +1248,11 @@ void Tablet::PrepareTransactionWriteBatch(
     value.reserve(1 + transaction_id->size() + kv_pair.value().size());
     AppendTransactionId(*transaction_id, &value);
     value += kv_pair.value();
-    AddIntent(*transaction_id, encoded_key.data(), value, rocksdb_write_batch);
+    auto& buffered_intent = AddIntent(
+        *transaction_id, encoded_key.data(), value, rocksdb_write_batch, &buffered_intents);
+    buffered_intent.strong = true;
+    buffered_intent.key = kv_pair.key();
+    buffered_intent.value = kv_pair.value();
   }
 
   for (const auto& intent : weak_intents) {
@@ -962,8 +1264,10 @@ void Tablet::PrepareTransactionWriteBatch(
     value.clear();
     value.reserve(1 + transaction_id->size());
     AppendTransactionId(*transaction_id, &value);
-    AddIntent(*transaction_id, encoded_key.data(), value, rocksdb_write_batch);
+    AddIntent(*transaction_id, encoded_key.data(), value, rocksdb_write_batch, &buffered_intents);
   }
+
+  transaction_participant()->BufferIntents(*transaction_id, &buffered_intents);
 }
 
 void Tablet::PrepareNonTransactionWriteBatch(
@@ -1015,6 +1319,9 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
                                         rocksdb::WriteBatch* rocksdb_write_batch) {
   // Write batch could be preallocated, here we handle opposite case.
   if (rocksdb_write_batch == nullptr) {
+    if (!put_batch.has_transaction() && AddToApplyGroup(put_batch, op_id, hybrid_time)) {
+      return;
+    }
     WriteBatch write_batch;
     ApplyKeyValueRowOperations(put_batch, op_id, hybrid_time, &write_batch);
     return;
@@ -1025,25 +1332,225 @@ void Tablet::ApplyKeyValueRowOperations(const KeyValueWriteBatchPB& put_batch,
     return;
   }
 
-  rocksdb_write_batch->SetUserOpId(rocksdb::OpId(op_id.term(), op_id.index()));
-
+  rocksdb::DB* db = rocksdb_.get();
   if (put_batch.has_transaction()) {
     PrepareTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
+    db = intents_db();
   } else {
     PrepareNonTransactionWriteBatch(put_batch, hybrid_time, rocksdb_write_batch);
   }
 
+  WriteOperationBatches(op_id, hybrid_time, db, rocksdb_write_batch, nullptr);
+}
+
+void Tablet::WriteOperationBatches(const consensus::OpId& op_id,
+                                   const HybridTime hybrid_time,
+                                   rocksdb::DB* db,
+                                   rocksdb::WriteBatch* write_batch,
+                                   rocksdb::WriteBatch* intents_write_batch) {
+  const rocksdb::OpId rocksdb_op_id(op_id.term(), op_id.index());
+  const bool has_intent_changes = intents_write_batch != nullptr && intents_write_batch->Count();
+
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  // Changes grouped before this operation have to be written first.
+  WriteApplyGroupUnlocked();
+  flush_stats_->AboutToWriteToDb(hybrid_time);
+  if (write_batch->Count()) {
+    write_batch->SetUserOpId(rocksdb_op_id);
+    WriteToRocksDB(db, write_batch, 1);
+  }
+  if (has_intent_changes) {
+    // Intents are removed only once the changes they were applied to are written.
+    intents_write_batch->SetUserOpId(rocksdb_op_id);
+    WriteToRocksDB(intents_db(), intents_write_batch, 0);
+  }
+  if (intents_db_ && (db == intents_db_.get() || has_intent_changes)) {
+    MaybeFlushIntentsUnlocked();
+  }
+}
+
+bool Tablet::AddToApplyGroup(const KeyValueWriteBatchPB& put_batch,
+                             const consensus::OpId& op_id,
+                             const HybridTime hybrid_time) {
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  if (!apply_group_active_) {
+    return false;
+  }
+  if (put_batch.kv_pairs_size() == 0) {
+    return true;
+  }
+
+  // Operations are applied in Raft order, so the batch ends up with the OpId of the last of them.
+  apply_group_batch_.SetUserOpId(rocksdb::OpId(op_id.term(), op_id.index()));
+  PrepareNonTransactionWriteBatch(put_batch, hybrid_time, &apply_group_batch_);
+  flush_stats_->AboutToWriteToDb(hybrid_time);
+  ++apply_group_ops_;
+  if (apply_group_ops_ >= static_cast<size_t>(FLAGS_tablet_apply_group_max_ops)) {
+    WriteApplyGroupUnlocked();
+  }
+  return true;
+}
+
+void Tablet::StartApplyGroup() {
+  if (table_type_ == TableType::KUDU_COLUMNAR_TABLE_TYPE || FLAGS_tablet_apply_group_max_ops < 2) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(apply_group_mutex_);
+  DCHECK(!apply_group_active_);
+  apply_group_active_ = true;
+}
+
+void Tablet::FinishApplyGroup() {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    if (!apply_group_active_) {
+      return;
+    }
+    WriteApplyGroupUnlocked();
+    apply_group_active_ = false;
+    callbacks.swap(apply_group_callbacks_);
+  }
+  for (const auto& callback : callbacks) {
+    callback();
+  }
+}
+
+void Tablet::RunAfterApplyGroup(std::function<void()> callback) {
+  {
+    std::lock_guard<std::mutex> lock(apply_group_mutex_);
+    if (apply_group_active_) {
+      apply_group_callbacks_.push_back(std::move(callback));
+      return;
+    }
+  }
+  callback();
+}
+
+void Tablet::WriteApplyGroupUnlocked() {
+  if (apply_group_ops_ == 0) {
+    return;
+  }
+  WriteToRocksDB(rocksdb_.get(), &apply_group_batch_, apply_group_ops_);
+  apply_group_batch_.Clear();
+  apply_group_ops_ = 0;
+}
+
+void Tablet::WriteToRocksDB(rocksdb::DB* db, rocksdb::WriteBatch* write_batch, size_t num_ops) {
+  // The regular and the intents DB are flushed independently, so operations replayed during
+  // bootstrap could already be persistent in one of them.
+  if (state_ == kBootstrapping && intents_db_) {
+    const int64_t flushed_index = db == intents_db_.get() ? intents_flushed_index_at_open_
+                                                          : regular_flushed_index_at_open_;
+    if (write_batch->UserOpId().index <= flushed_index) {
+      return;
+    }
+  }
+
   // We are using Raft replication index for the RocksDB sequence number for
   // all members of this write batch.
   rocksdb::WriteOptions write_options;
   InitRocksDBWriteOptions(&write_options);
 
-  flush_stats_->AboutToWriteToDb(hybrid_time);
-  auto rocksdb_write_status = rocksdb_->Write(write_options, rocksdb_write_batch);
+  auto rocksdb_write_status = db->Write(write_options, write_batch);
   if (!rocksdb_write_status.ok()) {
-    LOG(FATAL) << "Failed to write a batch with " << rocksdb_write_batch->Count() << " operations"
+    LOG(FATAL) << "Failed to write a batch with " << write_batch->Count() << " operations"
                << " into RocksDB: " << rocksdb_write_status.ToString();
   }
+  if (intents_db_) {
+    const auto op_id = write_batch->UserOpId();
+    if (db == rocksdb_.get() && op_id.index > last_regular_write_op_id_.index) {
+      last_regular_write_op_id_ = op_id;
+    }
+    if (op_id.index > last_write_op_id_.index) {
+      last_write_op_id_ = op_id;
+    }
+  }
+  if (metrics_ && num_ops != 0) {
+    metrics_->ops_per_rocksdb_write->Increment(num_ops);
+  }
+}
+
+bool Tablet::HasUnflushedIntents() const {
+  uint64_t active_entries = 0;
+  uint64_t immutable_entries = 0;
+  intents_db_->GetIntProperty(
+      rocksdb::DB::Properties::kNumEntriesActiveMemTable, &active_entries);
+  intents_db_->GetIntProperty(
+      rocksdb::DB::Properties::kNumEntriesImmMemTables, &immutable_entries);
+  return active_entries + immutable_entries != 0;
+}
+
+void Tablet::FlushRegularThenIntentsUnlocked() {
+  // The intents DB must not persist the removal of intents whose changes could still be lost from
+  // the regular DB memtable on a crash. So its memtables are held back until the regular DB flush
+  // started here, or a later one, covers them.
+  AddIntentsFlushBoundUnlocked();
+  rocksdb::FlushOptions options;
+  options.wait = false;
+  rocksdb_->Flush(options);
+  // The regular DB could have nothing to flush, or be flushed already.
+  AdvanceIntentsFlushBound(rocksdb_->GetFlushedOpId());
+  intents_db_->Flush(options);
+}
+
+void Tablet::WaitForRegularThenIntentsFlush() {
+  rocksdb::FlushOptions options;
+  options.immutable_only = true;
+  rocksdb_->Flush(options);
+  AdvanceIntentsFlushBound(rocksdb_->GetFlushedOpId());
+  intents_db_->Flush(options);
+}
+
+void Tablet::MaybeFlushIntentsUnlocked() {
+  uint64_t memtable_size = 0;
+  intents_db_->GetIntProperty(rocksdb::DB::Properties::kCurSizeActiveMemTable, &memtable_size);
+  if (memtable_size < static_cast<uint64_t>(FLAGS_intents_db_write_buffer_size_bytes)) {
+    return;
+  }
+  {
+    std::lock_guard<simple_spinlock> lock(intents_flush_bound_lock_);
+    if (!pending_intents_flush_bounds_.empty()) {
+      // The flushes started before are still waiting for the regular DB.
+      return;
+    }
+  }
+  FlushRegularThenIntentsUnlocked();
+}
+
+void Tablet::AddIntentsFlushBoundUnlocked() {
+  std::lock_guard<simple_spinlock> lock(intents_flush_bound_lock_);
+  pending_intents_flush_bounds_.emplace_back(last_regular_write_op_id_, last_write_op_id_);
+}
+
+void Tablet::AdvanceIntentsFlushBound(const rocksdb::OpId& regular_flushed_op_id) {
+  std::lock_guard<simple_spinlock> lock(intents_flush_bound_lock_);
+  if (regular_flushed_op_id.index > intents_flush_bound_.index) {
+    intents_flush_bound_ = regular_flushed_op_id;
+  }
+  while (!pending_intents_flush_bounds_.empty() &&
+         pending_intents_flush_bounds_.front().first.index <= regular_flushed_op_id.index) {
+    const auto& op_id = pending_intents_flush_bounds_.front().second;
+    if (op_id.index > intents_flush_bound_.index) {
+      intents_flush_bound_ = op_id;
+    }
+    pending_intents_flush_bounds_.pop_front();
+  }
+}
+
+rocksdb::OpId Tablet::IntentsFlushBound() {
+  std::lock_guard<simple_spinlock> lock(intents_flush_bound_lock_);
+  return intents_flush_bound_;
+}
+
+void Tablet::RegularDBFlushed(const rocksdb::OpId& regular_flushed_op_id) {
+  AdvanceIntentsFlushBound(regular_flushed_op_id);
+  if (intents_db_) {
+    rocksdb::FlushOptions options;
+    options.wait = false;
+    options.immutable_only = true;
+    intents_db_->Flush(options);
+  }
 }
 
 namespace {
@@ -1068,16 +1575,26 @@ Status Tablet::KeyValueBatchFromRedisWriteBatch(
     vector<RedisResponsePB>* responses) {
   GUARD_AGAINST_ROCKSDB_SHUTDOWN;
   vector<unique_ptr<DocOperation>> doc_ops;
-  // Since we take exclusive locks, it's okay to use Now as the read TS for writes.
-  const HybridTime read_hybrid_time = clock_->Now();
   WriteRequestPB batch_request;
   SetupKeyValueBatch(redis_write_request, &batch_request);
   auto* redis_write_batch = batch_request.mutable_redis_write_batch();
 
+  // Operations of the same batch do not see the writes of each other, so keys written by several
+  // of them are marked to let the operations handle that.
+  std::unordered_map<std::string, int> key_writes;
+  for (const auto& redis_request : *redis_write_batch) {
+    ++key_writes[redis_request.key_value().key()];
+  }
+
   doc_ops.reserve(redis_write_batch->size());
   for (size_t i = 0; i < redis_write_batch->size(); i++) {
-    doc_ops.emplace_back(new RedisWriteOperation(
-        redis_write_batch->Mutable(i), read_hybrid_time));
+    auto* redis_request = redis_write_batch->Mutable(i);
+    const bool key_shared = key_writes[redis_request->key_value().key()] > 1;
+    auto* doc_op = new RedisWriteOperation(redis_request);
+    if (key_shared) {
+      doc_op->set_key_shared_in_batch();
+    }
+    doc_ops.emplace_back(doc_op);
   }
   RETURN_NOT_OK(StartDocWriteOperation(
       doc_ops, keys_locked, redis_write_request->mutable_write_batch()));
@@ -1101,6 +1618,16 @@ Status Tablet::HandleRedisReadRequest(HybridTime timestamp,
   return Status::OK();
 }
 
+Status Tablet::HandleRedisGets(
+    HybridTime timestamp, const std::vector<const RedisReadRequestPB*>& redis_read_requests,
+    std::vector<RedisResponsePB>* responses) {
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+  ScopedTabletMetricsTracker metrics_tracker(metrics_->redis_read_latency);
+
+  return docdb::RedisReadOperation::ExecuteGets(
+      rocksdb_.get(), timestamp, redis_read_requests, responses);
+}
+
 Status Tablet::HandleQLReadRequest(
     HybridTime timestamp, const QLReadRequestPB& ql_read_request, QLResponsePB* response,
     gscoped_ptr<faststring>* rows_data) {
@@ -1112,6 +1639,20 @@ Status Tablet::HandleQLReadRequest(
     return Status::OK();
   }
 
+  // A tablet split from another one keeps the rows of its parent until they are compacted away, so
+  // scans that are not limited to one hash key are limited to the hash range of the tablet.
+  if (ql_read_request.hashed_column_values().empty() && !key_hash_range_.IsFull()) {
+    QLReadRequestPB bounded_request(ql_read_request);
+    bounded_request.set_hash_code(std::max<uint32_t>(ql_read_request.hash_code(),
+                                                     key_hash_range_.begin));
+    if (key_hash_range_.end <= std::numeric_limits<uint16_t>::max()) {
+      bounded_request.set_max_hash_code(ql_read_request.has_max_hash_code()
+          ? std::min<uint32_t>(ql_read_request.max_hash_code(), key_hash_range_.end)
+          : key_hash_range_.end);
+    }
+    return AbstractTablet::HandleQLReadRequest(timestamp, bounded_request, response, rows_data);
+  }
+
   return AbstractTablet::HandleQLReadRequest(timestamp, ql_read_request, response, rows_data);
 }
 
@@ -1451,7 +1992,19 @@ Status Tablet::FlushUnlocked(FlushMode mode) {
     // the tablet just got shutdown. Acquire a read lock on component_lock_?
     rocksdb::FlushOptions options;
     options.wait = mode == FlushMode::kSync;
-    rocksdb_->Flush(options);
+    if (intents_db_) {
+      {
+        std::lock_guard<std::mutex> lock(apply_group_mutex_);
+        WriteApplyGroupUnlocked();
+        FlushRegularThenIntentsUnlocked();
+      }
+      // Writes of applied operations continue while the flushes are awaited.
+      if (options.wait) {
+        WaitForRegularThenIntentsFlush();
+      }
+    } else {
+      rocksdb_->Flush(options);
+    }
     return Status::OK();
   }
 
@@ -1494,19 +2047,43 @@ Status Tablet::ImportData(const std::string& source_dir) {
                                    intent_iter->value().ToDebugHexString(), \
                                    transaction_id_slice.ToDebugHexString()))
 
-// We apply intents using by iterating over whole transaction reverse index.
-// Using value of reverse index record we find original intent record and apply it.
-// After that we delete both intent record and reverse index record.
+// Intents of a transaction are usually buffered by the transaction participant, and then applied
+// without reading them from RocksDB. Otherwise we apply intents by iterating over whole
+// transaction reverse index, see PrepareApplyStoredIntents.
 // TODO(dtxn) use separate thread for applying intents.
 // TODO(dtxn) use multiple batches when applying really big transaction.
 Status Tablet::ApplyIntents(const TransactionApplyData& data) {
+  WriteBatch rocksdb_write_batch;
+  // Intents are removed by the same write that applies them, unless they are in a separate DB.
+  WriteBatch intents_write_batch;
+  WriteBatch* intents_delete_batch = intents_db_ ? &intents_write_batch : &rocksdb_write_batch;
+
+  BufferedIntents buffered_intents;
+  if (transaction_participant()->TakeBufferedIntents(data.transaction_id, &buffered_intents)) {
+    PrepareApplyBufferedIntents(
+        data, &buffered_intents, &rocksdb_write_batch, intents_delete_batch);
+  } else {
+    RETURN_NOT_OK(PrepareApplyStoredIntents(data, &rocksdb_write_batch, intents_delete_batch));
+  }
+
+  // data.hybrid_time contains transaction commit time.
+  WriteOperationBatches(data.op_id, data.hybrid_time, rocksdb_.get(), &rocksdb_write_batch,
+                        &intents_write_batch);
+  return Status::OK();
+}
+
+// Using value of reverse index record we find original intent record and apply it.
+// After that we delete both intent record and reverse index record.
+Status Tablet::PrepareApplyStoredIntents(const TransactionApplyData& data,
+                                         WriteBatch* rocksdb_write_batch,
+                                         WriteBatch* intents_delete_batch) {
   auto reverse_index_iter = docdb::CreateRocksDBIterator(
-      rocksdb_.get(),
+      intents_db(),
       docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
       boost::none,
       rocksdb::kDefaultQueryId);
 
-  auto intent_iter = docdb::CreateRocksDBIterator(rocksdb_.get(),
+  auto intent_iter = docdb::CreateRocksDBIterator(intents_db(),
                                                   docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
                                                   boost::none,
                                                   rocksdb::kDefaultQueryId);
@@ -1517,8 +2094,7 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
 
   reverse_index_iter->Seek(txn_reverse_index_prefix.data());
 
-  KeyValueWriteBatchPB put_batch;
-  WriteBatch rocksdb_write_batch;
+  IntraTxnWriteId write_id = 0;
 
   while (reverse_index_iter->Valid()) {
     rocksdb::Slice key_slice(reverse_index_iter->key());
@@ -1554,27 +2130,22 @@ Status Tablet::ApplyIntents(const TransactionApplyData& data) {
                               "wrong transaction id");
           intent_value.remove_prefix(transaction_id_slice.size());
 
-          auto* pair = put_batch.add_kv_pairs();
           // After strip of prefix and suffix intent_key contains just SubDocKey w/o a hybrid time.
-          // Time will be added when writing batch to rocks db.
-          pair->set_key(intent_key.cdata(), intent_key.size());
-          pair->set_value(intent_value.cdata(), intent_value.size());
+          AddRecord(intent_key, intent_value, DocHybridTime(data.hybrid_time, write_id++),
+                    rocksdb_write_batch);
         }
-        rocksdb_write_batch.Delete(intent_iter->key());
+        intents_delete_batch->Delete(intent_iter->key());
       } else {
         LOG(DFATAL) << "Unable to find intent: " << reverse_index_iter->value().ToDebugString()
                     << " for " << reverse_index_iter->key().ToDebugString();
       }
     }
 
-    rocksdb_write_batch.Delete(reverse_index_iter->key());
+    intents_delete_batch->Delete(reverse_index_iter->key());
 
     reverse_index_iter->Next();
   }
 
-  // data.hybrid_time contains transaction commit time.
-  // We don't set transaction field of put_batch, otherwise we would write another bunch of intents.
-  ApplyKeyValueRowOperations(put_batch, data.op_id, data.hybrid_time, &rocksdb_write_batch);
   return Status::OK();
 }
 
@@ -2102,6 +2673,14 @@ void Tablet::GetRowSetsForTests(RowSetVector* out) {
 
 void Tablet::RegisterMaintenanceOps(MaintenanceManager* maint_mgr) {
   if (table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
+    if (tablet_options_.schedule_compactions) {
+      CHECK_EQ(state_, kOpen);
+      DCHECK(maintenance_ops_.empty());
+
+      gscoped_ptr<MaintenanceOp> rocksdb_compact_op(new CompactRocksDBOp(this));
+      maint_mgr->RegisterOp(rocksdb_compact_op.get());
+      maintenance_ops_.push_back(rocksdb_compact_op.release());
+    }
     return;
   }
 
@@ -2126,6 +2705,38 @@ void Tablet::UnregisterMaintenanceOps() {
     op->Unregister();
   }
   STLDeleteElements(&maintenance_ops_);
+
+  // Nothing notices the end of the compactions anymore. RocksDB stops them when it is closed.
+  std::lock_guard<std::mutex> lock(rocksdb_compactions_mutex_);
+  if (rocksdb_compactions_started_) {
+    ReleaseRocksDBCompactionsUnlocked();
+  }
+}
+
+uint64_t Tablet::SstFilesSize() const {
+  uint64_t result = 0;
+  if (rocksdb_) {
+    rocksdb_->GetIntProperty(rocksdb::DB::Properties::kTotalSstFilesSize, &result);
+  }
+  if (intents_db_) {
+    uint64_t intents_size = 0;
+    intents_db_->GetIntProperty(rocksdb::DB::Properties::kTotalSstFilesSize, &intents_size);
+    result += intents_size;
+  }
+  return result;
+}
+
+uint64_t Tablet::MemTablesSize() const {
+  uint64_t result = 0;
+  if (rocksdb_) {
+    rocksdb_->GetIntProperty(rocksdb::DB::Properties::kCurSizeAllMemTables, &result);
+  }
+  if (intents_db_) {
+    uint64_t intents_size = 0;
+    intents_db_->GetIntProperty(rocksdb::DB::Properties::kCurSizeAllMemTables, &intents_size);
+    result += intents_size;
+  }
+  return result;
 }
 
 bool Tablet::HasSSTables() const {
@@ -2137,7 +2748,16 @@ bool Tablet::HasSSTables() const {
 
 yb::OpId Tablet::MaxPersistentOpId() const {
   DCHECK_NE(table_type_, TableType::KUDU_COLUMNAR_TABLE_TYPE);
-  return rocksdb_->GetFlushedOpId();
+  auto result = rocksdb_->GetFlushedOpId();
+  // Until bootstrap is done it is not known whether the operations after the op id flushed to the
+  // intents DB wrote intents, so they have to be replayed.
+  if (intents_db_ && (state_ == kBootstrapping || HasUnflushedIntents())) {
+    auto intents_op_id = intents_db_->GetFlushedOpId();
+    if (intents_op_id.index < result.index) {
+      result = intents_op_id;
+    }
+  }
+  return result;
 }
 
 Status Tablet::FlushMetadata(const RowSetVector& to_remove,
@@ -2389,6 +3009,161 @@ Status Tablet::Compact(CompactFlags flags) {
                              TabletMetadata::kNoMrsFlushed);
 }
 
+namespace {
+
+// Number of checks by the maintenance manager after which the compactions of a tablet whose
+// RocksDB needs a compaction, but does not start any, are finished.
+constexpr int kMaxIdleRocksDBCompactionChecks = 4;
+
+// Score added for a RocksDB instance with so many files that writes to it are throttled.
+constexpr double kWriteStallCompactionScore = 10;
+
+// Maximum score added for small RocksDB instances, so that when the read amplification of several
+// tablets is the same, the compaction that costs the least is run first.
+constexpr double kSmallRocksDBCompactionScore = 0.01;
+
+struct RocksDBCompactionState {
+  bool pending = false;
+  bool running = false;
+  uint64_t num_files = 0;
+};
+
+RocksDBCompactionState GetRocksDBCompactionState(rocksdb::DB* db) {
+  RocksDBCompactionState result;
+  uint64_t value = 0;
+  result.pending =
+      db->GetIntProperty(rocksdb::DB::Properties::kCompactionPending, &value) && value != 0;
+  value = 0;
+  result.running =
+      db->GetIntProperty(rocksdb::DB::Properties::kNumRunningCompactions, &value) && value != 0;
+  // All files are at level 0, since the tablets use universal compaction with a single level.
+  std::string num_files;
+  if (db->GetProperty(rocksdb::DB::Properties::kNumFilesAtLevelPrefix + "0", &num_files)) {
+    result.num_files = std::strtoull(num_files.c_str(), nullptr, 10);
+  }
+  return result;
+}
+
+// Every read of a RocksDB instance looks at each of its files, so the score of a compaction is the
+// number of files relative to the number at which a compaction is needed.
+double RocksDBCompactionScore(rocksdb::DB* db, const RocksDBCompactionState& state) {
+  if (!state.pending) {
+    return 0;
+  }
+  const rocksdb::Options& options = db->GetOptions();
+  double score = static_cast<double>(state.num_files) /
+                 std::max(options.level0_file_num_compaction_trigger, 1);
+  if (options.level0_slowdown_writes_trigger >= 0 &&
+      state.num_files >= static_cast<uint64_t>(options.level0_slowdown_writes_trigger)) {
+    score += kWriteStallCompactionScore;
+  }
+  uint64_t sst_files_size = 0;
+  db->GetIntProperty(rocksdb::DB::Properties::kTotalSstFilesSize, &sst_files_size);
+  score += kSmallRocksDBCompactionScore / (1 + sst_files_size / 1_MB);
+  return score;
+}
+
+} // namespace
+
+void Tablet::UpdateRocksDBCompactionStats(MaintenanceOpStats* stats) {
+  stats->set_runnable(false);
+  stats->set_perf_improvement(0);
+  if (IsShutdownRequested()) {
+    return;
+  }
+  ScopedPendingOperation shutdown_guard(&pending_op_counter_);
+  if (!rocksdb_) {
+    return;
+  }
+
+  double score = 0;
+  bool pending = false;
+  bool running = false;
+  uint64_t num_files = 0;
+  for (rocksdb::DB* db : {rocksdb_.get(), intents_db_.get()}) {
+    if (db == nullptr) {
+      continue;
+    }
+    const auto state = GetRocksDBCompactionState(db);
+    pending = pending || state.pending;
+    running = running || state.running;
+    num_files += state.num_files;
+    score += RocksDBCompactionScore(db, state);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(rocksdb_compactions_mutex_);
+    if (rocksdb_compactions_started_) {
+      // RocksDB keeps starting compactions as long as it needs them, so they are done once it does
+      // not need any more. A RocksDB instance could also need a compaction that it is unable to
+      // pick, e.g. because of --rocksdb_max_file_size_for_compaction, so they are also finished
+      // when nothing runs for a while.
+      idle_rocksdb_compaction_checks_ = running ? 0 : idle_rocksdb_compaction_checks_ + 1;
+      if (!pending && !running) {
+        FinishRocksDBCompactionsUnlocked(0 /* stalled_num_files */);
+      } else if (idle_rocksdb_compaction_checks_ >= kMaxIdleRocksDBCompactionChecks) {
+        FinishRocksDBCompactionsUnlocked(num_files);
+      }
+      return;
+    }
+  }
+
+  // RocksDB did not start any compaction the last time, with the same files.
+  if (score == 0 || num_files == stalled_compaction_num_files_.load(std::memory_order_acquire)) {
+    return;
+  }
+  stats->set_runnable(true);
+  stats->set_perf_improvement(score);
+}
+
+Status Tablet::StartRocksDBCompactions() {
+  GUARD_AGAINST_ROCKSDB_SHUTDOWN;
+
+  std::lock_guard<std::mutex> lock(rocksdb_compactions_mutex_);
+  DCHECK(!rocksdb_compactions_started_);
+  for (rocksdb::DB* db : {rocksdb_.get(), intents_db_.get()}) {
+    if (db == nullptr) {
+      continue;
+    }
+    Status s = db->EnableAutoCompaction({db->DefaultColumnFamily()});
+    if (!s.ok()) {
+      FinishRocksDBCompactionsUnlocked(0 /* stalled_num_files */);
+      return s;
+    }
+  }
+  rocksdb_compactions_started_ = true;
+  idle_rocksdb_compaction_checks_ = 0;
+  rocksdb_compactions_start_time_ = MonoTime::Now(MonoTime::FINE);
+  if (metrics_) {
+    metrics_->compact_rocksdb_running->Increment();
+  }
+  return Status::OK();
+}
+
+void Tablet::FinishRocksDBCompactionsUnlocked(uint64_t stalled_num_files) {
+  stalled_compaction_num_files_.store(stalled_num_files, std::memory_order_release);
+  for (rocksdb::DB* db : {rocksdb_.get(), intents_db_.get()}) {
+    if (db != nullptr) {
+      WARN_NOT_OK(db->SetOptions({{"disable_auto_compactions", "true"}}),
+                  Substitute("Failed to disable RocksDB compactions on $0", tablet_id()));
+    }
+  }
+  if (rocksdb_compactions_started_) {
+    ReleaseRocksDBCompactionsUnlocked();
+  }
+}
+
+void Tablet::ReleaseRocksDBCompactionsUnlocked() {
+  rocksdb_compactions_started_ = false;
+  num_compacting_tablets.fetch_sub(1, std::memory_order_acq_rel);
+  if (metrics_) {
+    metrics_->compact_rocksdb_running->Decrement();
+    metrics_->compact_rocksdb_duration->Increment(
+        MonoTime::Now(MonoTime::FINE).GetDeltaSince(rocksdb_compactions_start_time_)
+            .ToMilliseconds());
+  }
+}
+
 void Tablet::UpdateCompactionStats(MaintenanceOpStats* stats) {
   if (table_type_ != TableType::KUDU_COLUMNAR_TABLE_TYPE) {
     return;
@@ -2548,6 +3323,11 @@ Status Tablet::StartDocWriteOperation(const vector<unique_ptr<DocOperation>> &do
   if (need_read_snapshot) {
     read_txn.reset(new ScopedReadOperation(this));
     hybrid_time = read_txn->GetReadTimestamp();
+  } else if (table_type_ == TableType::REDIS_TABLE_TYPE) {
+    // Redis writes read the current value of their keys. Since we take exclusive locks, it's okay
+    // to use Now as the read TS for writes. It has to be taken after the locks are acquired, so
+    // that it is after the writes of the operations that held them before.
+    hybrid_time = clock_->Now();
   }
   // We expect all read operations for this transaction to be done in ApplyDocWriteOperation.
   // Once read_txn goes out of scope, the read point is deregistered.
@@ -32,6 +32,8 @@
 #ifndef YB_TABLET_TABLET_H_
 #define YB_TABLET_TABLET_H_
 
+#include <deque>
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -172,6 +174,7 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   class FlushCompactCommonHooks;
   class FlushFaultHooks;
   class Iterator;
+  class RegularDBFlushListener;
 
   // Create a new tablet.
   //
@@ -291,6 +294,18 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime hybrid_time,
       rocksdb::WriteBatch* rocksdb_write_batch = nullptr);
 
+  // Starts grouping the changes of applied non-transactional write operations, so that a run of
+  // committed operations is written to RocksDB by a single write.
+  void StartApplyGroup();
+
+  // Writes the changes grouped since StartApplyGroup() to RocksDB and runs the callbacks deferred
+  // by RunAfterApplyGroup() in order.
+  void FinishApplyGroup();
+
+  // Runs 'callback' once the changes applied so far are written to RocksDB. That is right away
+  // unless changes are being grouped, in which case the callback is run by FinishApplyGroup().
+  void RunAfterApplyGroup(std::function<void()> callback);
+
   // Takes a Redis WriteRequestPB as input with its redis_write_batch.
   // Constructs a WriteRequestPB containing a serialized WriteBatch that will be
   // replicated by Raft. (Makes a copy, it is caller's responsibility to deallocate
@@ -307,6 +322,10 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime timestamp, const RedisReadRequestPB& redis_read_request,
       RedisResponsePB* response) override;
 
+  CHECKED_STATUS HandleRedisGets(
+      HybridTime timestamp, const std::vector<const RedisReadRequestPB*>& redis_read_requests,
+      std::vector<RedisResponsePB>* responses) override;
+
   CHECKED_STATUS HandleQLReadRequest(
       HybridTime timestamp, const QLReadRequestPB& ql_read_request, QLResponsePB* response,
       gscoped_ptr<faststring>* rows_data) override;
@@ -336,6 +355,18 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   CHECKED_STATUS CreateCheckpoint(const std::string& dir,
       google::protobuf::RepeatedPtrField<RocksDBFilePB>* rocksdb_files = nullptr);
 
+  // Create a RocksDB checkpoint to be used as the data of a tablet split from this one. Grouped
+  // changes of applied operations are written first, so the checkpoint contains every operation
+  // applied so far.
+  CHECKED_STATUS CreateSplitCheckpoint(const std::string& dir);
+
+  // Whether a split of this tablet has been prepared or applied. Such a tablet rejects writes.
+  bool splitting() const { return splitting_.load(std::memory_order_acquire); }
+  void SetSplitting(bool splitting) { splitting_.store(splitting, std::memory_order_release); }
+
+  // The range of the hashes of the keys served by this tablet.
+  const docdb::KeyHashRange& key_hash_range() const { return key_hash_range_; }
+
   // Create a new row iterator which yields the rows as of the current MVCC
   // state of this tablet.
   // The returned iterator is not initialized.
@@ -403,6 +434,15 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Update the statistics for performing a compaction.
   void UpdateCompactionStats(MaintenanceOpStats* stats);
 
+  // Update the statistics for starting the compactions of the RocksDB instances of the tablet. Also
+  // notices when the compactions started by StartRocksDBCompactions() are done, and disables the
+  // compactions again.
+  void UpdateRocksDBCompactionStats(MaintenanceOpStats* stats);
+
+  // Lets the RocksDB instances of the tablet start the compactions they need, without waiting for
+  // them. Used when compactions are scheduled by the maintenance manager.
+  CHECKED_STATUS StartRocksDBCompactions();
+
   // Returns the exact current size of the MRS, in bytes. A value greater than 0 doesn't imply
   // that the MRS has data, only that it has allocated that amount of memory.
   // This method takes a read lock on component_lock_ and is thread-safe.
@@ -419,6 +459,12 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Estimate the total on-disk size of this tablet, in bytes.
   size_t EstimateOnDiskSize() const;
 
+  // Returns the total size of the SST files of the RocksDB of this tablet, in bytes.
+  uint64_t SstFilesSize() const;
+
+  // Returns the size of the active and unflushed immutable memtables of this tablet, in bytes.
+  uint64_t MemTablesSize() const;
+
   // Get the total size of all the DMS
   size_t DeltaMemStoresSize() const;
 
@@ -533,12 +579,18 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // Returns true if a RocksDB-backed tablet has any SSTables.
   bool HasSSTables() const;
 
-  // Returns the maximum persistent op id from all SSTables in RocksDB.
+  // Returns the maximum persistent op id from all SSTables in RocksDB. When the tablet has an
+  // intents DB with changes that are not flushed yet, or is being bootstrapped, this is the
+  // smaller of the op ids flushed to the regular and to the intents DB.
   yb::OpId MaxPersistentOpId() const;
 
   // Returns the location of the last rocksdb checkpoint. Used for tests only.
   std::string GetLastRocksDBCheckpointDirForTest() { return last_rocksdb_checkpoint_dir_; }
 
+  // Returns the regular and the intents RocksDB databases. Used for tests only.
+  rocksdb::DB* RegularDBForTest() const { return rocksdb_.get(); }
+  rocksdb::DB* IntentsDBForTest() const { return intents_db_.get(); }
+
   // For non-kudu table type fills key-value batch in transaction state request and updates
   // request in state. Due to acquiring locks it can block the thread.
   CHECKED_STATUS AcquireLocksAndPerformDocOperations(WriteOperationState *state);
@@ -732,6 +784,89 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
       HybridTime hybrid_time,
       rocksdb::WriteBatch* rocksdb_write_batch);
 
+  // Adds the changes of a non-transactional write operation to the current apply group. Returns
+  // false if changes are not being grouped.
+  bool AddToApplyGroup(
+      const docdb::KeyValueWriteBatchPB& put_batch,
+      const consensus::OpId& op_id,
+      HybridTime hybrid_time);
+
+  // Writes the changes grouped so far to RocksDB.
+  void WriteApplyGroupUnlocked();
+
+  // Writes the changes of an operation in 'write_batch' to 'db', followed by the removal of
+  // intents in 'intents_write_batch', if any.
+  void WriteOperationBatches(
+      const consensus::OpId& op_id,
+      HybridTime hybrid_time,
+      rocksdb::DB* db,
+      rocksdb::WriteBatch* write_batch,
+      rocksdb::WriteBatch* intents_write_batch);
+
+  // Fills the batches that apply the intents of a transaction and remove them, reading the intents
+  // from RocksDB.
+  CHECKED_STATUS PrepareApplyStoredIntents(
+      const TransactionApplyData& data,
+      rocksdb::WriteBatch* rocksdb_write_batch,
+      rocksdb::WriteBatch* intents_delete_batch);
+
+  // Writes 'write_batch' that holds the changes of 'num_ops' operations to 'db'.
+  void WriteToRocksDB(rocksdb::DB* db, rocksdb::WriteBatch* write_batch, size_t num_ops);
+
+  // Returns the DB that holds the intents of transactions. Tables that are not transactional do
+  // not have a separate intents DB.
+  rocksdb::DB* intents_db() const {
+    return intents_db_ ? intents_db_.get() : rocksdb_.get();
+  }
+
+  CHECKED_STATUS OpenIntentsDB(const rocksdb::Options& regular_options);
+
+  // Moves the intents that tablets created before the intents DB was introduced keep in the
+  // regular DB to the intents DB.
+  CHECKED_STATUS MigrateIntentsFromRegularDB();
+
+  // Whether the intents DB has changes that are not flushed yet.
+  bool HasUnflushedIntents() const;
+
+  // Starts flushes of the regular DB and of the intents DB without waiting for them. Memtables of
+  // the intents DB are flushed only once the changes of all their operations are flushed to the
+  // regular DB, see IntentsFlushBound().
+  // REQUIRES: apply_group_mutex_ is held.
+  void FlushRegularThenIntentsUnlocked();
+
+  // Waits for the flushes started by FlushRegularThenIntentsUnlocked().
+  void WaitForRegularThenIntentsFlush();
+
+  // Disables the compactions started by StartRocksDBCompactions() once they are done.
+  // stalled_num_files is the number of files of a tablet that still needs a compaction RocksDB
+  // did not start, 0 otherwise.
+  // REQUIRES: rocksdb_compactions_mutex_ is held.
+  void FinishRocksDBCompactionsUnlocked(uint64_t stalled_num_files);
+
+  // Lets another tablet start its compactions.
+  // REQUIRES: rocksdb_compactions_mutex_ is held.
+  void ReleaseRocksDBCompactionsUnlocked();
+
+  // Starts flushes of both DBs once the memtable of the intents DB reaches the configured size.
+  // REQUIRES: apply_group_mutex_ is held.
+  void MaybeFlushIntentsUnlocked();
+
+  // Remembers that the intents DB could be flushed up to the last operation written so far, as
+  // soon as the regular DB is flushed up to the last operation that wrote to it.
+  // REQUIRES: apply_group_mutex_ is held.
+  void AddIntentsFlushBoundUnlocked();
+
+  // Advances the bound of the intents DB flushes once the regular DB is flushed up to
+  // regular_flushed_op_id.
+  void AdvanceIntentsFlushBound(const rocksdb::OpId& regular_flushed_op_id);
+
+  // Returns the op id up to which the intents DB could be flushed.
+  rocksdb::OpId IntentsFlushBound();
+
+  // Called once a flush of the regular DB is done, resumes the flushes of the intents DB that
+  // waited for it.
+  void RegularDBFlushed(const rocksdb::OpId& regular_flushed_op_id);
+
   // Lock protecting schema_ and key_schema_.
   //
   // Writers take this lock in shared mode before decoding and projecting
@@ -836,6 +971,30 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
   // RocksDB database for key-value tables.
   std::unique_ptr<rocksdb::DB> rocksdb_;
 
+  // RocksDB database for the intents and the reverse index of transactions, see intents_db().
+  std::unique_ptr<rocksdb::DB> intents_db_;
+
+  // Op indexes flushed to the regular and to the intents DB when they were opened. Operations up
+  // to these indexes are not written again to the respective DB when replayed during bootstrap.
+  int64_t regular_flushed_index_at_open_ = 0;
+  int64_t intents_flushed_index_at_open_ = 0;
+
+  // Last op ids written to the regular DB and to any of the DBs, guarded by apply_group_mutex_.
+  rocksdb::OpId last_regular_write_op_id_;
+  rocksdb::OpId last_write_op_id_;
+
+  // Protects the intents flush bound state below.
+  simple_spinlock intents_flush_bound_lock_;
+
+  // Changes of all operations up to this op id are flushed to the regular DB, so the intents DB
+  // could be flushed up to it.
+  rocksdb::OpId intents_flush_bound_;
+
+  // Pairs of the last op id written to the regular DB and the last op id written to any DB at the
+  // same moment, in the order they were added. Once the regular DB is flushed up to the first op
+  // id of a pair, the intents flush bound advances to its second op id.
+  std::deque<std::pair<rocksdb::OpId, rocksdb::OpId>> pending_intents_flush_bounds_;
+
   std::unique_ptr<common::QLStorageIf> ql_storage_;
 
   // This is for docdb fine-grained locking.
@@ -871,10 +1030,44 @@ class Tablet : public AbstractTablet, public TransactionIntentApplier {
 
   std::atomic<int64_t> last_committed_write_index_{0};
 
+  std::atomic<bool> splitting_{false};
+
+  // Number of RocksDB files of the tablet when its compactions were last finished while RocksDB
+  // still needed a compaction it did not start, 0 otherwise. The tablet is not picked for another
+  // compaction until its files change.
+  std::atomic<uint64_t> stalled_compaction_num_files_{0};
+
+  // Protects the state of the compactions started by StartRocksDBCompactions().
+  std::mutex rocksdb_compactions_mutex_;
+
+  // Whether the compactions started by StartRocksDBCompactions() are not finished yet.
+  bool rocksdb_compactions_started_ = false;
+
+  // Number of consecutive UpdateRocksDBCompactionStats() calls that found a compaction needed but
+  // none running, since the compactions were started.
+  int idle_rocksdb_compaction_checks_ = 0;
+
+  MonoTime rocksdb_compactions_start_time_;
+
+  docdb::KeyHashRange key_hash_range_;
+
   // Remembers he HybridTime of the oldest write that is still not scheduled to
   // be flushed in RocksDB.
   std::shared_ptr<TabletFlushStats> flush_stats_;
 
+  // Protects the apply group state below and serializes writes of applied operations to RocksDB.
+  std::mutex apply_group_mutex_;
+
+  // Whether changes of applied operations are being grouped, see StartApplyGroup().
+  bool apply_group_active_ = false;
+
+  // Changes of the operations grouped so far and the number of these operations.
+  rocksdb::WriteBatch apply_group_batch_;
+  size_t apply_group_ops_ = 0;
+
+  // Callbacks to run once the grouped changes are written.
+  std::vector<std::function<void()>> apply_group_callbacks_;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Tablet);
 };
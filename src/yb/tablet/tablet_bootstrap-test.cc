@@ -41,6 +41,7 @@
 #include "yb/consensus/consensus-test-util.h"
 #include "yb/server/logical_clock.h"
 #include "yb/server/metadata.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet-test-util.h"
 #include "yb/tablet/tablet_metadata.h"
@@ -51,6 +52,8 @@ using std::shared_ptr;
 using std::string;
 using std::vector;
 
+DECLARE_int32(tablet_bootstrap_read_ahead_segments);
+
 namespace yb {
 
 namespace log {
@@ -132,6 +135,7 @@ class BootstrapTest : public LogTestBase {
         log_anchor_registry,
         tablet_options,
         nullptr /* transaction_coordinator_context */};
+    data.tablet_splitter = tablet_splitter_;
     RETURN_NOT_OK(BootstrapTablet(data, tablet, &log_, boot_info));
     return Status::OK();
   }
@@ -176,6 +180,37 @@ class BootstrapTest : public LogTestBase {
       VLOG(1) << result;
     }
   }
+
+  // Appends a committed split of the tablet with the given id.
+  void AppendSplit(const OpId& opid, const string& tablet_id) {
+    auto replicate = std::make_shared<ReplicateMsg>();
+    replicate->set_op_type(consensus::SPLIT_OP);
+    replicate->mutable_id()->CopyFrom(opid);
+    replicate->mutable_committed_op_id()->CopyFrom(opid);
+    replicate->set_hybrid_time(clock_->Now().ToUint64());
+    auto* request = replicate->mutable_split_request();
+    request->set_tablet_id(tablet_id);
+    request->set_new_tablet1_id("new-tablet-1");
+    request->set_new_tablet2_id("new-tablet-2");
+    request->set_split_partition_key(string("\x80\x00", 2));
+    AppendReplicateBatch(replicate);
+  }
+
+  // Records the splits replayed by the bootstrap instead of creating the new tablets.
+  class TestTabletSplitter : public TabletSplitter {
+   public:
+    CHECKED_STATUS ApplyTabletSplit(SplitOperationState* state) override {
+      requests.push_back(*state->request());
+      op_ids.push_back(state->op_id());
+      return status;
+    }
+
+    std::vector<tserver::SplitTabletRequestPB> requests;
+    std::vector<OpId> op_ids;
+    Status status;
+  };
+
+  TabletSplitter* tablet_splitter_ = nullptr;
 };
 
 // Tests a normal bootstrap scenario
@@ -312,6 +347,44 @@ TEST_F(BootstrapTest, TestOperationOverwriting) {
             results[0]);
 }
 
+// Tests that a log spread over more segments than are read ahead of replay is replayed completely
+// and in order.
+TEST_F(BootstrapTest, TestReadAheadSegments) {
+  FLAGS_tablet_bootstrap_read_ahead_segments = 1;
+  BuildLog();
+
+  constexpr int kNumSegments = 5;
+  constexpr int kOpsPerSegment = 3;
+  OpId committed_opid = MakeOpId(0, 0);
+  int index = 1;
+  for (int segment = 0; segment != kNumSegments; ++segment) {
+    if (segment != 0) {
+      ASSERT_OK(RollLog());
+    }
+    for (int i = 0; i != kOpsPerSegment; ++i, ++index) {
+      const OpId opid = MakeOpId(1, index);
+      AppendReplicateBatch(opid, committed_opid,
+                           {TupleForAppend(index, index, "this is a test insert")},
+                           true /* sync */);
+      committed_opid = opid;
+    }
+  }
+
+  ConsensusBootstrapInfo boot_info;
+  shared_ptr<TabletClass> tablet;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+
+  // Every operation but the last one is committed by the operation that follows it.
+  const int num_ops = kNumSegments * kOpsPerSegment;
+  ASSERT_EQ(1, boot_info.orphaned_replicates.size());
+  ASSERT_OPID_EQ(MakeOpId(1, num_ops), boot_info.orphaned_replicates[0]->id());
+  ASSERT_OPID_EQ(MakeOpId(1, num_ops - 1), boot_info.last_committed_id);
+
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(num_ops - 1, results.size());
+}
+
 // Test that we do not crash when a consensus-only operation has a hybrid_time
 // that is higher than a hybrid_time assigned to a write operation that follows
 // it in the log.
@@ -345,5 +418,80 @@ TEST_F(BootstrapTest, TestConsensusOnlyOperationOutOfOrderHybridTime) {
   ASSERT_EQ(1, results.size());
 }
 
+// Tests that a committed split is applied again when it is replayed, so that the new tablets are
+// created if they were not before a restart.
+TEST_F(BootstrapTest, TestReplaySplit) {
+  BuildLog();
+  TestTabletSplitter tablet_splitter;
+  tablet_splitter_ = &tablet_splitter;
+
+  const auto write_op_id = MakeOpId(1, 1);
+  AppendReplicateBatch(write_op_id, write_op_id, {TupleForAppend(1, 1, "foo")});
+  const auto split_op_id = MakeOpId(1, 2);
+  AppendSplit(split_op_id, log::kTestTablet);
+
+  ConsensusBootstrapInfo boot_info;
+  shared_ptr<TabletClass> tablet;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+  ASSERT_EQ(0, boot_info.orphaned_replicates.size());
+  ASSERT_OPID_EQ(split_op_id, boot_info.last_committed_id);
+
+  // The tablet rejects reads and writes, and the split was applied with its log position.
+  ASSERT_TRUE(tablet->splitting());
+  ASSERT_EQ(1, tablet_splitter.requests.size());
+  ASSERT_EQ(log::kTestTablet, tablet_splitter.requests[0].tablet_id());
+  ASSERT_EQ("new-tablet-1", tablet_splitter.requests[0].new_tablet1_id());
+  ASSERT_EQ("new-tablet-2", tablet_splitter.requests[0].new_tablet2_id());
+  ASSERT_OPID_EQ(split_op_id, tablet_splitter.op_ids[0]);
+
+  // The write before the split was replayed.
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(1, results.size());
+}
+
+// Tests that the bootstrap fails when the new tablets of a replayed split can't be created, as the
+// master deletes the split tablet once the new tablets are running.
+TEST_F(BootstrapTest, TestReplaySplitFailure) {
+  BuildLog();
+  TestTabletSplitter tablet_splitter;
+  tablet_splitter.status = STATUS(IOError, "Injected split failure");
+  tablet_splitter_ = &tablet_splitter;
+
+  const auto split_op_id = MakeOpId(1, 1);
+  AppendSplit(split_op_id, log::kTestTablet);
+
+  ConsensusBootstrapInfo boot_info;
+  shared_ptr<TabletClass> tablet;
+  Status s = BootstrapTestTablet(-1, -1, &tablet, &boot_info);
+  ASSERT_TRUE(s.IsIOError()) << s;
+  ASSERT_STR_CONTAINS(s.ToString(), "Injected split failure");
+  ASSERT_EQ(1, tablet_splitter.requests.size());
+}
+
+// Tests that the split of the parent tablet, which starts the log of a tablet created by a split,
+// is not applied again to the new tablet.
+TEST_F(BootstrapTest, TestReplayParentSplit) {
+  BuildLog();
+  TestTabletSplitter tablet_splitter;
+  tablet_splitter_ = &tablet_splitter;
+
+  const auto split_op_id = MakeOpId(1, 1);
+  AppendSplit(split_op_id, "parent-tablet");
+  const auto write_op_id = MakeOpId(1, 2);
+  AppendReplicateBatch(write_op_id, write_op_id, {TupleForAppend(1, 1, "foo")});
+
+  ConsensusBootstrapInfo boot_info;
+  shared_ptr<TabletClass> tablet;
+  ASSERT_OK(BootstrapTestTablet(-1, -1, &tablet, &boot_info));
+  ASSERT_OPID_EQ(write_op_id, boot_info.last_committed_id);
+  ASSERT_FALSE(tablet->splitting());
+  ASSERT_EQ(0, tablet_splitter.requests.size());
+
+  vector<string> results;
+  IterateTabletRows(tablet.get(), &results);
+  ASSERT_EQ(1, results.size());
+}
+
 } // namespace tablet
 } // namespace yb
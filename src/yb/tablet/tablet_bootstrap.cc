@@ -39,13 +39,17 @@
 #include "yb/tablet/tablet.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/fault_injection.h"
 #include "yb/util/flag_tags.h"
+#include "yb/util/metrics.h"
 #include "yb/util/opid.h"
 #include "yb/util/logging.h"
 #include "yb/util/stopwatch.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_bool(skip_remove_old_recovery_dir, false,
             "Skip removing WAL recovery dir after startup. (useful for debugging)");
@@ -57,6 +61,23 @@ DEFINE_double(fault_crash_during_log_replay, 0.0,
               "(For testing only!)");
 TAG_FLAG(fault_crash_during_log_replay, unsafe);
 
+DEFINE_int32(tablet_bootstrap_read_ahead_segments, 2,
+             "Number of log segments that are read and decoded on a separate thread ahead of "
+             "the segment being replayed during tablet bootstrap. 0 disables read-ahead.");
+TAG_FLAG(tablet_bootstrap_read_ahead_segments, advanced);
+TAG_FLAG(tablet_bootstrap_read_ahead_segments, evolving);
+
+METRIC_DEFINE_counter(tablet, log_replay_entries, "Log Replay Entries",
+                      yb::MetricUnit::kEntries,
+                      "Number of log entries replayed during tablet bootstrap.");
+METRIC_DEFINE_counter(tablet, log_replay_bytes, "Log Replay Bytes",
+                      yb::MetricUnit::kBytes,
+                      "Size of the log segments replayed during tablet bootstrap.");
+METRIC_DEFINE_gauge_uint64(tablet, log_replay_bytes_per_second, "Log Replay Throughput",
+                           yb::MetricUnit::kBytes,
+                           "Number of bytes of log replayed per second during the last tablet "
+                           "bootstrap.");
+
 DECLARE_uint64(max_clock_sync_error_usec);
 
 namespace yb {
@@ -84,6 +105,7 @@ using consensus::OpIdToString;
 using consensus::ReplicateMsg;
 using strings::Substitute;
 using tserver::AlterSchemaRequestPB;
+using tserver::SplitTabletRequestPB;
 using tserver::WriteRequestPB;
 
 static string DebugInfo(const string& tablet_id,
@@ -104,6 +126,17 @@ static string DebugInfo(const string& tablet_id,
                     segment_path, debug_str);
 }
 
+namespace {
+
+// Entries of a log segment read ahead of replay.
+struct ReadAheadSegment {
+  log::LogEntries entries;
+  Status read_status;
+  CountDownLatch done{1};
+};
+
+} // namespace
+
 // ============================================================================
 //  Class ReplayState.
 // ============================================================================
@@ -737,6 +770,9 @@ Status TabletBootstrap::HandleOperation(OperationType op_type,
     case consensus::UPDATE_TRANSACTION_OP:
       return PlayUpdateTransactionRequest(replicate, commit);
 
+    case consensus::SPLIT_OP:
+      return PlaySplitRequest(replicate, commit);
+
     // Unexpected cases:
     case consensus::UNKNOWN_OP:
       return STATUS(IllegalState, Substitute("Unsupported commit entry type: $0", op_type));
@@ -868,11 +904,50 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
   // writing.
   RETURN_NOT_OK_PREPEND(OpenNewLog(), "Failed to open new log");
 
+  // Segments are read and decoded on a separate thread, up to
+  // --tablet_bootstrap_read_ahead_segments ahead of the segment being replayed. Replay itself
+  // stays sequential, since entries must be applied to RocksDB in log order.
+  // 'read_ahead' must outlive 'read_pool', whose tasks write into it.
+  std::vector<std::unique_ptr<ReadAheadSegment>> read_ahead(segments.size());
+  gscoped_ptr<ThreadPool> read_pool;
+  const size_t read_ahead_segments = std::max(FLAGS_tablet_bootstrap_read_ahead_segments, 0);
+  if (read_ahead_segments > 0 && segments.size() > 1) {
+    RETURN_NOT_OK(ThreadPoolBuilder("log-replay-read-ahead")
+                  .set_min_threads(0)
+                  .set_max_threads(1)
+                  .Build(&read_pool));
+  }
+  size_t next_to_read = 0;
+  auto read_ahead_up_to = [&](size_t limit) -> Status {
+    for (; next_to_read < std::min(limit, segments.size()); ++next_to_read) {
+      auto* data = (read_ahead[next_to_read] = std::make_unique<ReadAheadSegment>()).get();
+      auto* segment = segments[next_to_read].get();
+      RETURN_NOT_OK(read_pool->SubmitFunc([data, segment]() {
+        data->read_status = segment->ReadEntries(&data->entries);
+        data->done.CountDown();
+      }));
+    }
+    return Status::OK();
+  };
+
+  const MonoTime replay_start = MonoTime::Now(MonoTime::FINE);
+  uint64_t replayed_bytes = 0;
+  uint64_t replayed_entries = 0;
   int segment_count = 0;
-  for (const scoped_refptr<ReadableLogSegment>& segment : segments) {
+  for (size_t segment_idx = 0; segment_idx != segments.size(); ++segment_idx) {
+    const scoped_refptr<ReadableLogSegment>& segment = segments[segment_idx];
     log::LogEntries entries;
-    // TODO: Optimize this to not read the whole thing into memory?
-    Status read_status = segment->ReadEntries(&entries);
+    Status read_status;
+    if (read_pool) {
+      RETURN_NOT_OK(read_ahead_up_to(segment_idx + 1 + read_ahead_segments));
+      std::unique_ptr<ReadAheadSegment> data = std::move(read_ahead[segment_idx]);
+      data->done.Wait();
+      entries.swap(data->entries);
+      read_status = data->read_status;
+    } else {
+      // TODO: Optimize this to not read the whole thing into memory?
+      read_status = segment->ReadEntries(&entries);
+    }
     for (int entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
       Status s = HandleEntry(&state, &entries[entry_idx]);
       if (!s.ok()) {
@@ -900,6 +975,9 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
                                            segment->path()));
     }
 
+    replayed_bytes += segment->file_size();
+    replayed_entries += entries.size();
+
     // TODO: could be more granular here and log during the segments as well,
     // plus give info about number of MB processed, but this is better than
     // nothing.
@@ -911,6 +989,21 @@ Status TabletBootstrap::PlaySegments(ConsensusBootstrapInfo* consensus_info) {
     segment_count++;
   }
 
+  const MonoDelta replay_time = MonoTime::Now(MonoTime::FINE).GetDeltaSince(replay_start);
+  const uint64_t bytes_per_second =
+      replay_time.ToMicroseconds() > 0
+          ? replayed_bytes * MonoTime::kMicrosecondsPerSecond / replay_time.ToMicroseconds()
+          : replayed_bytes;
+  LOG_WITH_PREFIX(INFO) << "Replayed " << replayed_entries << " log entries ("
+                        << replayed_bytes << " bytes) from " << segments.size()
+                        << " segments in " << replay_time.ToString();
+  const auto& metric_entity = tablet_->GetMetricEntity();
+  if (metric_entity) {
+    METRIC_log_replay_entries.Instantiate(metric_entity)->IncrementBy(replayed_entries);
+    METRIC_log_replay_bytes.Instantiate(metric_entity)->IncrementBy(replayed_bytes);
+    METRIC_log_replay_bytes_per_second.Instantiate(metric_entity, 0)->set_value(bytes_per_second);
+  }
+
   // If we have non-applied commits they all must belong to pending operations and
   // they should only pertain to unflushed stores. This is specific to Kudu tables, because we don't
   // use local COMMIT messages in YB tables.
@@ -1090,6 +1183,29 @@ Status TabletBootstrap::PlayAlterSchemaRequest(ReplicateMsg* replicate_msg,
   return commit_msg == nullptr ? Status::OK() : AppendCommitMsg(*commit_msg);
 }
 
+Status TabletBootstrap::PlaySplitRequest(ReplicateMsg* replicate_msg,
+                                         const CommitMsg* commit_msg) {
+  const SplitTabletRequestPB& split_request = replicate_msg->split_request();
+
+  // The log of a tablet created by a split starts with the split operation of its parent, which
+  // has nothing left to do in the new tablet.
+  if (split_request.tablet_id() == tablet_->tablet_id()) {
+    tablet_->SetSplitting(true);
+    if (data_.tablet_splitter != nullptr) {
+      SplitOperationState operation_state(nullptr, tablet_.get(), &split_request);
+      operation_state.mutable_op_id()->CopyFrom(replicate_msg->id());
+      operation_state.set_hybrid_time(HybridTime(replicate_msg->hybrid_time()));
+      operation_state.set_raft_config(cmeta_->committed_config());
+      // The master deletes this tablet once the new tablets are running, so it must not come up
+      // without them.
+      RETURN_NOT_OK_PREPEND(data_.tablet_splitter->ApplyTabletSplit(&operation_state),
+                            "Failed to split tablet");
+    }
+  }
+
+  return commit_msg == nullptr ? Status::OK() : AppendCommitMsg(*commit_msg);
+}
+
 Status TabletBootstrap::PlayChangeConfigRequest(ReplicateMsg* replicate_msg,
                                                 const CommitMsg* commit_msg) {
   ChangeConfigRecordPB* change_config = replicate_msg->mutable_change_config_record();
@@ -219,6 +219,9 @@ class TabletBootstrap {
   Status PlayAlterSchemaRequest(consensus::ReplicateMsg* replicate_msg,
                                 const consensus::CommitMsg* commit_msg);
 
+  Status PlaySplitRequest(consensus::ReplicateMsg* replicate_msg,
+                          const consensus::CommitMsg* commit_msg);
+
   Status PlayChangeConfigRequest(consensus::ReplicateMsg* replicate_msg,
                                  const consensus::CommitMsg* commit_msg);
 
@@ -73,6 +73,7 @@ class Tablet;
 class TabletMetadata;
 class TransactionCoordinatorContext;
 class TransactionParticipantContext;
+class TabletSplitter;
 struct TabletOptions;
 
 // A listener for logging the tablet related statuses as well as
@@ -117,6 +118,8 @@ struct BootstrapTabletData {
   TabletOptions tablet_options;
   TransactionParticipantContext* transaction_participant_context;
   TransactionCoordinatorContext* transaction_coordinator_context;
+  // Creates the new tablets of a split replayed from the log, if any of them is missing.
+  TabletSplitter* tablet_splitter;
 };
 
 // Bootstraps a tablet, initializing it with the provided metadata. If the tablet
@@ -81,6 +81,7 @@ namespace yb {
 namespace tablet {
 
 const int64 kNoDurableMemStore = -1;
+const char* const kIntentsSubdir = "intents";
 
 // ============================================================================
 //  Tablet Metadata
@@ -240,6 +241,18 @@ Status TabletMetadata::DeleteTabletData(TabletDataState delete_type,
     docdb::InitRocksDBOptions(
         &rocksdb_options, tablet_id_, nullptr /* statistics */, tablet_options);
 
+    // The RocksDB of intents lives in a subdirectory of the regular RocksDB, so it is destroyed
+    // first.
+    const auto intents_dir = intents_rocksdb_dir();
+    if (fs_manager_->env()->FileExists(intents_dir)) {
+      LOG(INFO) << "Destroying intents RocksDB at: " << intents_dir;
+      rocksdb::Status status = rocksdb::DestroyDB(intents_dir, rocksdb_options);
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to destroy intents RocksDB at: " << intents_dir << ": "
+                   << status.ToString();
+      }
+    }
+
     LOG(INFO) << "Destroying RocksDB at: " << rocksdb_dir_;
     rocksdb::Status status = rocksdb::DestroyDB(rocksdb_dir_, rocksdb_options);
 
@@ -731,6 +744,10 @@ string TabletMetadata::data_root_dir() const {
   }
 }
 
+string TabletMetadata::intents_rocksdb_dir() const {
+  return JoinPathSegments(rocksdb_dir_, kIntentsSubdir);
+}
+
 string TabletMetadata::wal_root_dir() const {
   if (wal_dir_.empty()) {
     return "";
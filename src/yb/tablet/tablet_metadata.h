@@ -65,6 +65,9 @@ typedef std::unordered_set<int64_t> RowSetMetadataIds;
 
 extern const int64 kNoDurableMemStore;
 
+// Subdirectory of the RocksDB directory of a tablet that holds the RocksDB of transaction intents.
+extern const char* const kIntentsSubdir;
+
 // Manages the "blocks tracking" for the specified tablet.
 //
 // TabletMetadata is owned by the Tablet. As new blocks are written to store
@@ -145,6 +148,8 @@ class TabletMetadata : public RefCountedThreadSafe<TabletMetadata> {
 
   std::string rocksdb_dir() const { return rocksdb_dir_; }
 
+  std::string intents_rocksdb_dir() const;
+
   std::string wal_dir() const { return wal_dir_; }
 
   // Given the data directory of a tablet, returns the data root dir for that tablet.
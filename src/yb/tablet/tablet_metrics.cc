@@ -197,6 +197,16 @@ METRIC_DEFINE_gauge_uint32(tablet, delta_major_compact_rs_running,
   yb::MetricUnit::kMaintenanceOperations,
   "Number of delta major compactions currently running.");
 
+METRIC_DEFINE_gauge_uint32(tablet, compact_rocksdb_running,
+  "RocksDB Compactions Running",
+  yb::MetricUnit::kMaintenanceOperations,
+  "Number of RocksDB compactions started by the maintenance manager currently running.");
+
+METRIC_DEFINE_gauge_uint32(tablet, start_compact_rocksdb_running,
+  "RocksDB Compaction Starts Running",
+  yb::MetricUnit::kMaintenanceOperations,
+  "Number of maintenance operations starting RocksDB compactions currently running.");
+
 METRIC_DEFINE_histogram(tablet, flush_dms_duration,
   "DeltaMemStore Flush Duration",
   yb::MetricUnit::kMilliseconds,
@@ -222,6 +232,35 @@ METRIC_DEFINE_histogram(tablet, delta_major_compact_rs_duration,
   yb::MetricUnit::kSeconds,
   "Seconds spent major delta compacting.", 60000000LU, 2);
 
+METRIC_DEFINE_histogram(tablet, compact_rocksdb_duration,
+  "RocksDB Compaction Duration",
+  yb::MetricUnit::kMilliseconds,
+  "Time spent running the RocksDB compactions started by the maintenance manager.",
+  60000000LU, 2);
+
+METRIC_DEFINE_histogram(tablet, start_compact_rocksdb_duration,
+  "RocksDB Compaction Start Duration",
+  yb::MetricUnit::kMilliseconds,
+  "Time spent by the maintenance manager starting RocksDB compactions.",
+  60000000LU, 2);
+
+METRIC_DEFINE_histogram(tablet, docdb_lock_wait_time,
+  "DocDB Lock Wait Time",
+  yb::MetricUnit::kMicroseconds,
+  "Time spent by write operations waiting for conflicting DocDB locks to be released.",
+  60000000LU, 2);
+
+METRIC_DEFINE_counter(tablet, docdb_lock_contentions,
+  "DocDB Lock Contentions",
+  yb::MetricUnit::kOperations,
+  "Number of times a write operation had to wait for a conflicting DocDB lock.");
+
+METRIC_DEFINE_histogram(tablet, ops_per_rocksdb_write,
+  "Operations per RocksDB Write",
+  yb::MetricUnit::kOperations,
+  "Number of replicated operations whose changes were written to RocksDB by a single write.",
+  10000, 2);
+
 METRIC_DEFINE_counter(tablet, leader_memory_pressure_rejections,
   "Leader Memory Pressure Rejections",
   yb::MetricUnit::kRequests,
@@ -258,6 +297,9 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     MINIT(snapshot_read_inflight_wait_duration),
     MINIT(redis_read_latency),
     MINIT(ql_read_latency),
+    MINIT(docdb_lock_wait_time),
+    MINIT(docdb_lock_contentions),
+    MINIT(ops_per_rocksdb_write),
     MINIT(write_op_duration_client_propagated_consistency),
     MINIT(write_op_duration_commit_wait_consistency),
     GINIT(flush_dms_running),
@@ -265,11 +307,15 @@ TabletMetrics::TabletMetrics(const scoped_refptr<MetricEntity>& entity)
     GINIT(compact_rs_running),
     GINIT(delta_minor_compact_rs_running),
     GINIT(delta_major_compact_rs_running),
+    GINIT(compact_rocksdb_running),
+    GINIT(start_compact_rocksdb_running),
     MINIT(flush_dms_duration),
     MINIT(flush_mrs_duration),
     MINIT(compact_rs_duration),
     MINIT(delta_minor_compact_rs_duration),
     MINIT(delta_major_compact_rs_duration),
+    MINIT(compact_rocksdb_duration),
+    MINIT(start_compact_rocksdb_duration),
     MINIT(leader_memory_pressure_rejections) {
 }
 #undef MINIT
@@ -81,6 +81,9 @@ struct TabletMetrics {
   scoped_refptr<Histogram> snapshot_read_inflight_wait_duration;
   scoped_refptr<Histogram> redis_read_latency;
   scoped_refptr<Histogram> ql_read_latency;
+  scoped_refptr<Histogram> docdb_lock_wait_time;
+  scoped_refptr<Counter> docdb_lock_contentions;
+  scoped_refptr<Histogram> ops_per_rocksdb_write;
   scoped_refptr<Histogram> write_op_duration_client_propagated_consistency;
   scoped_refptr<Histogram> write_op_duration_commit_wait_consistency;
 
@@ -89,12 +92,16 @@ struct TabletMetrics {
   scoped_refptr<AtomicGauge<uint32_t> > compact_rs_running;
   scoped_refptr<AtomicGauge<uint32_t> > delta_minor_compact_rs_running;
   scoped_refptr<AtomicGauge<uint32_t> > delta_major_compact_rs_running;
+  scoped_refptr<AtomicGauge<uint32_t> > compact_rocksdb_running;
+  scoped_refptr<AtomicGauge<uint32_t> > start_compact_rocksdb_running;
 
   scoped_refptr<Histogram> flush_dms_duration;
   scoped_refptr<Histogram> flush_mrs_duration;
   scoped_refptr<Histogram> compact_rs_duration;
   scoped_refptr<Histogram> delta_minor_compact_rs_duration;
   scoped_refptr<Histogram> delta_major_compact_rs_duration;
+  scoped_refptr<Histogram> compact_rocksdb_duration;
+  scoped_refptr<Histogram> start_compact_rocksdb_duration;
 
   scoped_refptr<Counter> leader_memory_pressure_rejections;
 };
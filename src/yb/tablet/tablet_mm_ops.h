@@ -129,6 +129,32 @@ class MajorDeltaCompactionOp : public MaintenanceOp {
   Tablet* const tablet_;
 };
 
+// MaintenanceOp that starts the compactions of the RocksDB instances of a tablet, when compactions
+// are scheduled by the maintenance manager instead of by RocksDB itself. It does not wait for the
+// compactions, so they do not hold a thread of the maintenance manager. The tablet is not runnable
+// again until UpdateStats() finds them done.
+//
+// Its perf_improvement score grows with the number of files that every read of the tablet has to
+// look at, relative to the number at which RocksDB would start a compaction, so the maintenance
+// manager compacts the tablets with the highest read amplification first.
+class CompactRocksDBOp : public MaintenanceOp {
+ public:
+  explicit CompactRocksDBOp(Tablet* tablet);
+
+  virtual void UpdateStats(MaintenanceOpStats* stats) override;
+
+  virtual bool Prepare() override;
+
+  virtual void Perform() override;
+
+  virtual scoped_refptr<Histogram> DurationHistogram() const override;
+
+  virtual scoped_refptr<AtomicGauge<uint32_t> > RunningGauge() const override;
+
+ private:
+  Tablet* const tablet_;
+};
+
 } // namespace tablet
 } // namespace yb
 
@@ -15,15 +15,30 @@
 
 namespace rocksdb {
 class EventListener;
+class PersistentCache;
+class RateLimiter;
 }
 
 namespace yb {
+
+class MemTracker;
+
 namespace tablet {
 
 struct TabletOptions {
   std::shared_ptr<rocksdb::Cache> block_cache;
+  std::shared_ptr<rocksdb::PersistentCache> persistent_cache;
   std::shared_ptr<rocksdb::MemoryMonitor> memory_monitor;
   std::vector<std::shared_ptr<rocksdb::EventListener>> listeners;
+  // Limits the write rate of the flushes and compactions of all tablets together. If not set, each
+  // RocksDB instance gets its own rate limiter.
+  std::shared_ptr<rocksdb::RateLimiter> rate_limiter;
+  // Whether the compactions of the tablets are started by the maintenance manager, which ranks the
+  // tablets that need a compaction, instead of by RocksDB itself.
+  bool schedule_compactions = false;
+  // Tracks the intents kept in memory by the transaction participants of all tablets, and limits
+  // their total size. If not set, each tablet limits the size of its own buffered intents.
+  std::shared_ptr<MemTracker> intents_buffer_mem_tracker;
 };
 
 } // namespace tablet
@@ -30,6 +30,11 @@
 // under the License.
 //
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
@@ -42,6 +47,8 @@
 #include "yb/consensus/log_reader.h"
 #include "yb/consensus/log_util.h"
 #include "yb/consensus/opid_util.h"
+#include "yb/docdb/doc_key.h"
+#include "yb/docdb/value.h"
 #include "yb/gutil/gscoped_ptr.h"
 #include "yb/gutil/macros.h"
 #include "yb/rpc/messenger.h"
@@ -63,6 +70,10 @@
 METRIC_DECLARE_entity(tablet);
 
 DECLARE_int32(log_min_seconds_to_retain);
+DECLARE_int32(tablet_apply_group_max_ops);
+DECLARE_int32(prepare_max_ops_per_task);
+
+METRIC_DECLARE_gauge_uint64(op_prepare_queue_length);
 
 namespace yb {
 namespace tablet {
@@ -111,6 +122,7 @@ class TabletPeerTest : public YBTabletTest,
     table_type_ = YQL_TABLE_TYPE;
 
     ASSERT_OK(ThreadPoolBuilder("apply").Build(&apply_pool_));
+    ASSERT_OK(ThreadPoolBuilder("prepare").Build(&prepare_pool_));
 
     rpc::MessengerBuilder builder(CURRENT_TEST_NAME());
     ASSERT_OK(builder.Build(&messenger_));
@@ -128,6 +140,7 @@ class TabletPeerTest : public YBTabletTest,
       new TabletPeerClass(make_scoped_refptr(tablet()->metadata()),
                           config_peer,
                           apply_pool_.get(),
+                          prepare_pool_.get(),
                           Bind(&TabletPeerTest::TabletPeerStateChangedCallback,
                                Unretained(this),
                                tablet()->tablet_id())));
@@ -180,6 +193,7 @@ class TabletPeerTest : public YBTabletTest,
   void TearDown() override {
     tablet_peer_->Shutdown();
     apply_pool_->Shutdown();
+    prepare_pool_->Shutdown();
     YBTabletTest::TearDown();
   }
 
@@ -259,6 +273,22 @@ class TabletPeerTest : public YBTabletTest,
     return Status::OK();
   }
 
+  // Submits 'operation' for replication, as TabletPeer::SubmitWrite does.
+  Status SubmitWriteOperation(std::unique_ptr<WriteOperation> operation) {
+    RETURN_NOT_OK(tablet()->AcquireLocksAndPerformDocOperations(operation->state()));
+    scoped_refptr<OperationDriver> driver;
+    RETURN_NOT_OK(tablet_peer_->NewLeaderOperationDriver(std::move(operation), &driver));
+    return driver->ExecuteAsync();
+  }
+
+  void StopPrepareThread() {
+    tablet_peer_->prepare_thread_->Stop();
+  }
+
+  uint64_t PrepareQueueLength() {
+    return METRIC_op_prepare_queue_length.Instantiate(metric_entity_, 0)->value();
+  }
+
   // Assert that the Log GC() anchor is earlier than the latest OpId in the Log.
   void AssertLogAnchorEarlierThanLogLatest() {
     int64_t earliest_index = -1;
@@ -271,6 +301,30 @@ class TabletPeerTest : public YBTabletTest,
       << ")";
   }
 
+  // Returns a batch that writes 'value' to a column of the row with key 'key'.
+  KeyValueWriteBatchPB MakeKeyValueWriteBatch(int32_t key, int32_t value) {
+    KeyValueWriteBatchPB put_batch;
+    auto* kv_pair = put_batch.add_kv_pairs();
+    kv_pair->set_key(docdb::SubDocKey(docdb::DocKey({ docdb::PrimitiveValue::Int32(key) }),
+                                      docdb::PrimitiveValue(ColumnId(1)))
+                         .Encode(false /* include_hybrid_time */).data());
+    kv_pair->set_value(docdb::Value(docdb::PrimitiveValue::Int32(value)).Encode());
+    return put_batch;
+  }
+
+  // Applies a non-transactional write of operation 1.'index' to the tablet.
+  void ApplyWrite(int index, rocksdb::WriteBatch* write_batch = nullptr) {
+    tablet()->ApplyKeyValueRowOperations(MakeKeyValueWriteBatch(index, index),
+                                         MakeOpId(1, index),
+                                         HybridTime::FromMicros(1000 + index),
+                                         write_batch);
+  }
+
+  // Number of RocksDB writes done for applied operations.
+  uint64_t NumRocksDBWrites() {
+    return tablet()->metrics()->ops_per_rocksdb_write->TotalCount();
+  }
+
   // We disable automatic log GC. Don't leak those changes.
   google::FlagSaver flag_saver_;
 
@@ -281,6 +335,7 @@ class TabletPeerTest : public YBTabletTest,
   shared_ptr<Messenger> messenger_;
   scoped_refptr<TabletPeer> tablet_peer_;
   gscoped_ptr<ThreadPool> apply_pool_;
+  gscoped_ptr<ThreadPool> prepare_pool_;
   TableType table_type_;
 };
 
@@ -309,6 +364,34 @@ class DelayedApplyOperation : public WriteOperation {
   DISALLOW_COPY_AND_ASSIGN(DelayedApplyOperation);
 };
 
+// An operation that records the order in which operations are prepared.
+class PrepareOrderRecordingOperation : public WriteOperation {
+ public:
+  PrepareOrderRecordingOperation(int id,
+                                 std::mutex* mutex,
+                                 std::vector<int>* prepare_order,
+                                 std::unique_ptr<WriteOperationState> state)
+      : WriteOperation(std::move(state), consensus::LEADER),
+        id_(id),
+        mutex_(DCHECK_NOTNULL(mutex)),
+        prepare_order_(DCHECK_NOTNULL(prepare_order)) {
+  }
+
+  Status Prepare() override {
+    {
+      std::lock_guard<std::mutex> lock(*mutex_);
+      prepare_order_->push_back(id_);
+    }
+    return WriteOperation::Prepare();
+  }
+
+ private:
+  int id_;
+  std::mutex* mutex_;
+  std::vector<int>* prepare_order_;
+  DISALLOW_COPY_AND_ASSIGN(PrepareOrderRecordingOperation);
+};
+
 // Ensure that Log::GC() doesn't delete logs with anchors.
 TEST_P(TabletPeerTest, TestLogAnchorsAndGC) {
   FLAGS_log_min_seconds_to_retain = 0;
@@ -448,6 +531,82 @@ TEST_P(TabletPeerTest, TestActiveOperationPreventsLogGC) {
   ASSERT_EQ(5, segments.size());
 }
 
+// Ensure that a run of committed operations is written to RocksDB by a single write, that
+// callbacks deferred to the end of the run see the write, and that the flushed OpId is the last one
+// of the run.
+TEST_P(TabletPeerTest, TestApplyGroup) {
+  FLAGS_tablet_apply_group_max_ops = 64;
+  const uint64_t initial_writes = NumRocksDBWrites();
+
+  tablet()->StartApplyGroup();
+  for (int index = 1; index <= 3; ++index) {
+    ApplyWrite(index);
+  }
+  uint64_t writes_seen_by_callback = 0;
+  tablet()->RunAfterApplyGroup([this, &writes_seen_by_callback] {
+    writes_seen_by_callback = NumRocksDBWrites();
+  });
+  // Neither the changes nor the callback are run before the end of the run.
+  ASSERT_EQ(initial_writes, NumRocksDBWrites());
+  ASSERT_EQ(0U, writes_seen_by_callback);
+
+  tablet()->FinishApplyGroup();
+  ASSERT_EQ(initial_writes + 1, NumRocksDBWrites());
+  ASSERT_EQ(initial_writes + 1, writes_seen_by_callback);
+  ASSERT_EQ(3U, tablet()->metrics()->ops_per_rocksdb_write->MaxValueForTests());
+
+  ASSERT_OK(tablet()->Flush(tablet::FlushMode::kSync));
+  const auto flushed_op_id = tablet()->MaxPersistentOpId();
+  ASSERT_EQ(1, flushed_op_id.term);
+  ASSERT_EQ(3, flushed_op_id.index);
+
+  // Without a run callbacks are not deferred.
+  bool callback_run = false;
+  tablet()->RunAfterApplyGroup([&callback_run] { callback_run = true; });
+  ASSERT_TRUE(callback_run);
+}
+
+// Ensure that changes grouped before an operation that is not grouped are written before it. This
+// is the path of transactional batches and of intents being applied, which are not grouped.
+TEST_P(TabletPeerTest, TestApplyGroupWrittenBeforeUngroupedOperation) {
+  FLAGS_tablet_apply_group_max_ops = 64;
+  const uint64_t initial_writes = NumRocksDBWrites();
+
+  tablet()->StartApplyGroup();
+  ApplyWrite(1);
+  ApplyWrite(2);
+  ASSERT_EQ(initial_writes, NumRocksDBWrites());
+
+  rocksdb::WriteBatch write_batch;
+  ApplyWrite(3, &write_batch);
+  // The group is written by a write of its own, followed by the write of operation 3.
+  ASSERT_EQ(initial_writes + 2, NumRocksDBWrites());
+  ASSERT_EQ(2U, tablet()->metrics()->ops_per_rocksdb_write->MaxValueForTests());
+
+  ApplyWrite(4);
+  ASSERT_EQ(initial_writes + 2, NumRocksDBWrites());
+  tablet()->FinishApplyGroup();
+  ASSERT_EQ(initial_writes + 3, NumRocksDBWrites());
+
+  ASSERT_OK(tablet()->Flush(tablet::FlushMode::kSync));
+  ASSERT_EQ(4, tablet()->MaxPersistentOpId().index);
+}
+
+// Ensure that a run longer than --tablet_apply_group_max_ops is split into several writes.
+TEST_P(TabletPeerTest, TestApplyGroupMaxOps) {
+  FLAGS_tablet_apply_group_max_ops = 2;
+  const uint64_t initial_writes = NumRocksDBWrites();
+
+  tablet()->StartApplyGroup();
+  for (int index = 1; index <= 5; ++index) {
+    ApplyWrite(index);
+  }
+  ASSERT_EQ(initial_writes + 2, NumRocksDBWrites());
+  tablet()->FinishApplyGroup();
+  ASSERT_EQ(initial_writes + 3, NumRocksDBWrites());
+  ASSERT_EQ(2U, tablet()->metrics()->ops_per_rocksdb_write->MaxValueForTests());
+}
+
 TEST_P(TabletPeerTest, TestGCEmptyLog) {
   ConsensusBootstrapInfo info;
   ASSERT_OK(tablet_peer_->Start(info));
@@ -484,6 +643,92 @@ TEST_P(TabletPeerTest, TestFlushOpsPerfImprovements) {
   stats.Clear();
 }
 
+// Ensure that operations of a tablet are prepared in the order they were submitted, also when the
+// prepare task yields to other tablets after each operation.
+TEST_P(TabletPeerTest, TestPrepareOrderAcrossTasks) {
+  FLAGS_prepare_max_ops_per_task = 1;
+  ConsensusBootstrapInfo info;
+  ASSERT_OK(StartPeer(info));
+
+  constexpr int kNumWrites = 100;
+  std::vector<WriteRequestPB> requests(kNumWrites);
+  std::vector<WriteResponsePB> responses(kNumWrites);
+  CountDownLatch latch(kNumWrites);
+  std::mutex mutex;
+  std::vector<int> prepare_order;
+  for (int i = 0; i != kNumWrites; ++i) {
+    ASSERT_OK(GenerateSequentialInsertRequest(&requests[i]));
+    auto state = std::make_unique<WriteOperationState>(
+        tablet_peer_.get(), &requests[i], &responses[i]);
+    state->set_completion_callback(std::make_unique<LatchWriteCallback>(&latch, &responses[i]));
+    ASSERT_OK(SubmitWriteOperation(std::make_unique<PrepareOrderRecordingOperation>(
+        i, &mutex, &prepare_order, std::move(state))));
+  }
+  latch.Wait();
+
+  for (const auto& response : responses) {
+    ASSERT_FALSE(response.has_error()) << response.DebugString();
+  }
+  ASSERT_EQ(kNumWrites, static_cast<int>(prepare_order.size()));
+  for (int i = 0; i != kNumWrites; ++i) {
+    ASSERT_EQ(i, prepare_order[i]);
+  }
+  ASSERT_EQ(0U, PrepareQueueLength());
+}
+
+// Ensure that every operation submitted while the prepare thread is stopped is either prepared or
+// failed, so that none is left in the queue.
+TEST_P(TabletPeerTest, TestPrepareThreadStopRacesWithSubmit) {
+  FLAGS_prepare_max_ops_per_task = 1;
+  ConsensusBootstrapInfo info;
+  ASSERT_OK(StartPeer(info));
+
+  constexpr int kNumThreads = 4;
+  constexpr int kWritesPerThread = 50;
+  constexpr int kNumWrites = kNumThreads * kWritesPerThread;
+  std::vector<WriteRequestPB> requests(kNumWrites);
+  std::vector<WriteResponsePB> responses(kNumWrites);
+  for (auto& request : requests) {
+    ASSERT_OK(GenerateSequentialInsertRequest(&request));
+  }
+
+  CountDownLatch latch(kNumWrites);
+  std::atomic<int> submitted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kNumThreads; ++t) {
+    threads.emplace_back([this, t, &requests, &responses, &latch, &submitted] {
+      for (int i = t * kWritesPerThread; i != (t + 1) * kWritesPerThread; ++i) {
+        auto state = std::make_unique<WriteOperationState>(
+            tablet_peer_.get(), &requests[i], &responses[i]);
+        state->set_completion_callback(
+            std::make_unique<LatchWriteCallback>(&latch, &responses[i]));
+        CHECK_OK(SubmitWriteOperation(
+            std::make_unique<WriteOperation>(std::move(state), consensus::LEADER)));
+        ++submitted;
+      }
+    });
+  }
+  while (submitted.load() < kNumWrites / 2) {
+    std::this_thread::yield();
+  }
+  StopPrepareThread();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_TRUE(latch.WaitFor(MonoDelta::FromSeconds(30)));
+  int num_failed = 0;
+  for (const auto& response : responses) {
+    if (response.has_error()) {
+      ASSERT_EQ(AppStatusPB::ILLEGAL_STATE, response.error().status().code())
+          << response.DebugString();
+      ++num_failed;
+    }
+  }
+  LOG(INFO) << "Writes failed because the prepare thread was stopped: " << num_failed;
+  ASSERT_EQ(0U, PrepareQueueLength());
+}
+
 INSTANTIATE_TEST_CASE_P(Rocks, TabletPeerTest, ::testing::Values(YQL_TABLE_TYPE));
 
 } // namespace tablet
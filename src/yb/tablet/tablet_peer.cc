@@ -62,6 +62,7 @@
 
 #include "yb/tablet/operations/alter_schema_operation.h"
 #include "yb/tablet/operations/operation_driver.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 
@@ -124,6 +125,7 @@ TabletPeer::TabletPeer(
     const scoped_refptr<TabletMetadata>& meta,
     const consensus::RaftPeerPB& local_peer_pb,
     ThreadPool* apply_pool,
+    ThreadPool* prepare_pool,
     Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk)
   : meta_(meta),
     tablet_id_(meta->tablet_id()),
@@ -131,6 +133,7 @@ TabletPeer::TabletPeer(
     state_(NOT_STARTED),
     status_listener_(new TabletStatusListener(meta)),
     apply_pool_(apply_pool),
+    prepare_pool_(prepare_pool),
     log_anchor_registry_(new LogAnchorRegistry()),
     mark_dirty_clbk_(std::move(mark_dirty_clbk)) {}
 
@@ -148,7 +151,9 @@ Status TabletPeer::Init(const shared_ptr<TabletClass>& tablet,
                         const scoped_refptr<server::Clock>& clock,
                         const shared_ptr<Messenger>& messenger,
                         const scoped_refptr<Log>& log,
-                        const scoped_refptr<MetricEntity>& metric_entity) {
+                        const scoped_refptr<MetricEntity>& metric_entity,
+                        consensus::MultiRaftManager* multi_raft_manager,
+                        TabletSplitter* tablet_splitter) {
 
   DCHECK(tablet) << "A TabletPeer must be provided with a Tablet";
   DCHECK(log) << "A TabletPeer must be provided with a Log";
@@ -161,6 +166,7 @@ Status TabletPeer::Init(const shared_ptr<TabletClass>& tablet,
     clock_ = clock;
     messenger_ = messenger;
     log_ = log;
+    tablet_splitter_ = tablet_splitter;
 
     ConsensusOptions options;
     options.tablet_id = meta_->tablet_id();
@@ -181,9 +187,11 @@ Status TabletPeer::Init(const shared_ptr<TabletClass>& tablet,
                                        log_.get(),
                                        tablet_->mem_tracker(),
                                        mark_dirty_clbk_,
-                                       tablet_->table_type());
+                                       tablet_->table_type(),
+                                       multi_raft_manager);
 
-    prepare_thread_ = std::make_unique<PrepareThread>(consensus_.get());
+    prepare_thread_ = std::make_unique<PrepareThread>(
+        consensus_.get(), prepare_pool_, metric_entity);
   }
 
   RETURN_NOT_OK(prepare_thread_->Start());
@@ -458,6 +466,9 @@ void TabletPeer::GetInFlightOperations(Operation::TraceType trace_type,
         case Operation::UPDATE_TRANSACTION_TXN:
           status_pb.set_operation_type(consensus::UPDATE_TRANSACTION_OP);
           break;
+        case Operation::SPLIT_TXN:
+          status_pb.set_operation_type(consensus::SPLIT_OP);
+          break;
 
         default:
           FATAL_INVALID_ENUM_VALUE(Operation::OperationType, driver->operation_type());
@@ -578,6 +589,12 @@ std::unique_ptr<Operation> TabletPeer::CreateOperation(consensus::ReplicateMsg*
       return std::make_unique<UpdateTxnOperation>(
           std::make_unique<UpdateTxnOperationState>(this), consensus::REPLICA);
 
+    case consensus::SPLIT_OP:
+      DCHECK(replicate_msg->has_split_request()) << "SPLIT_OP replica"
+          " operation must receive a SplitTabletRequestPB";
+      return std::make_unique<SplitOperation>(
+          std::make_unique<SplitOperationState>(this, tablet()), consensus::REPLICA);
+
     case consensus::UNKNOWN_OP: FALLTHROUGH_INTENDED;
     case consensus::NO_OP: FALLTHROUGH_INTENDED;
     case consensus::CHANGE_CONFIG_OP:
@@ -621,6 +638,20 @@ Status TabletPeer::StartReplicaOperation(const scoped_refptr<ConsensusRound>& ro
   return Status::OK();
 }
 
+void TabletPeer::StartApplyGroup() {
+  auto tablet = shared_tablet();
+  if (tablet) {
+    tablet->StartApplyGroup();
+  }
+}
+
+void TabletPeer::FinishApplyGroup() {
+  auto tablet = shared_tablet();
+  if (tablet) {
+    tablet->FinishApplyGroup();
+  }
+}
+
 Status TabletPeer::NewOperationDriver(std::unique_ptr<Operation> operation,
                                       consensus::DriverType type,
                                       scoped_refptr<OperationDriver>* driver) {
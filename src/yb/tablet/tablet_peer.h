@@ -59,6 +59,10 @@ using yb::consensus::StateChangeContext;
 
 namespace yb {
 
+namespace consensus {
+class MultiRaftManager;
+}
+
 namespace log {
 class LogAnchorRegistry;
 }
@@ -76,6 +80,7 @@ class ReplicaOperationDriver;
 class TabletPeer;
 class TabletStatusPB;
 class TabletStatusListener;
+class TabletSplitter;
 class OperationDriver;
 class UpdateTxnOperationState;
 
@@ -93,16 +98,20 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
 
   TabletPeer(const scoped_refptr<TabletMetadata>& meta,
              const consensus::RaftPeerPB& local_peer_pb, ThreadPool* apply_pool,
+             ThreadPool* prepare_pool,
              Callback<void(std::shared_ptr<StateChangeContext> context)> mark_dirty_clbk);
 
   // Initializes the TabletPeer, namely creating the Log and initializing
-  // Consensus.
+  // Consensus. 'tablet_splitter' creates the new tablets when the tablet is split, tablets of
+  // servers that do not support splitting pass nullptr.
   CHECKED_STATUS Init(const std::shared_ptr<TabletClass>& tablet,
                       const client::YBClientPtr& client,
                       const scoped_refptr<server::Clock>& clock,
                       const std::shared_ptr<rpc::Messenger>& messenger,
                       const scoped_refptr<log::Log>& log,
-                      const scoped_refptr<MetricEntity>& metric_entity);
+                      const scoped_refptr<MetricEntity>& metric_entity,
+                      consensus::MultiRaftManager* multi_raft_manager = nullptr,
+                      TabletSplitter* tablet_splitter = nullptr);
 
   // Starts the TabletPeer, making it available for Write()s. If this
   // TabletPeer is part of a consensus configuration this will connect it to other peers
@@ -143,6 +152,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   virtual CHECKED_STATUS StartReplicaOperation(
       const scoped_refptr<consensus::ConsensusRound>& round) override;
 
+  // Used by consensus to group the changes of a run of committed operations.
+  void StartApplyGroup() override;
+  void FinishApplyGroup() override;
+
   consensus::Consensus* consensus() const {
     std::lock_guard<simple_spinlock> lock(lock_);
     return consensus_.get();
@@ -249,6 +262,10 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
     return log_anchor_registry_;
   }
 
+  TabletSplitter* tablet_splitter() const {
+    return tablet_splitter_;
+  }
+
   // Returns the tablet_id of the tablet managed by this TabletPeer.
   // Returns the correct tablet_id even if the underlying tablet is not available
   // yet.
@@ -353,12 +370,17 @@ class TabletPeer : public RefCountedThreadSafe<TabletPeer>,
   // the Tablet server.
   ThreadPool* apply_pool_;
 
+  // Pool shared by the prepare queues of all tablets of the server, injected like apply_pool_.
+  ThreadPool* prepare_pool_;
+
   scoped_refptr<server::Clock> clock_;
 
   client::YBClientPtr client_;
 
   scoped_refptr<log::LogAnchorRegistry> log_anchor_registry_;
 
+  TabletSplitter* tablet_splitter_ = nullptr;
+
   // Function to mark this TabletPeer's tablet as dirty in the TSTabletManager.
   // This function must be called any time the cluster membership or cluster
   // leadership changes. Note that this function is called synchronously on the followers
@@ -15,6 +15,7 @@
 
 #include "yb/tablet/transaction_participant.h"
 
+#include <iterator>
 #include <mutex>
 
 #include <boost/multi_index_container.hpp>
@@ -34,8 +35,20 @@
 
 #include "yb/tserver/tserver_service.pb.h"
 
+#include "yb/util/flag_tags.h"
+#include "yb/util/mem_tracker.h"
 #include "yb/util/monotime.h"
 
+DEFINE_uint64(transaction_intents_buffer_max_bytes, 1024 * 1024,
+              "Maximum size of the intents of a transaction that are kept in memory by a tablet, "
+              "so that they could be applied without reading them from RocksDB.");
+TAG_FLAG(transaction_intents_buffer_max_bytes, advanced);
+
+DEFINE_uint64(transaction_participant_intents_buffer_max_bytes, 64 * 1024 * 1024,
+              "Maximum size of the intents of all transactions that are kept in memory by the "
+              "tablets of a tablet server.");
+TAG_FLAG(transaction_participant_intents_buffer_max_bytes, advanced);
+
 using namespace std::placeholders;
 
 namespace yb {
@@ -45,8 +58,9 @@ namespace {
 
 class RunningTransaction {
  public:
-  explicit RunningTransaction(const TransactionId& id, const TransactionMetadataPB& metadata)
-      : id_(id), metadata_(metadata) {
+  RunningTransaction(const TransactionId& id, const TransactionMetadataPB& metadata,
+                     bool buffer_intents)
+      : id_(id), metadata_(metadata), intents_buffered_(buffer_intents) {
   }
 
   const TransactionId& id() const {
@@ -65,6 +79,32 @@ class RunningTransaction {
     committed_locally_ = true;
   }
 
+  // Whether all intents of the transaction are buffered.
+  bool intents_buffered() const {
+    return intents_buffered_;
+  }
+
+  size_t buffered_intents_size() const {
+    return buffered_intents_size_;
+  }
+
+  void AddBufferedIntents(BufferedIntents* intents, size_t size) {
+    buffered_intents_.reserve(buffered_intents_.size() + intents->size());
+    std::move(intents->begin(), intents->end(), std::back_inserter(buffered_intents_));
+    buffered_intents_size_ += size;
+  }
+
+  void TakeBufferedIntents(BufferedIntents* intents) {
+    intents->swap(buffered_intents_);
+    DropBufferedIntents();
+  }
+
+  void DropBufferedIntents() {
+    BufferedIntents().swap(buffered_intents_);
+    buffered_intents_size_ = 0;
+    intents_buffered_ = false;
+  }
+
   void RequestStatusAt(client::YBClient* client,
                        HybridTime time,
                        RequestTransactionStatusCallback callback,
@@ -75,6 +115,7 @@ class RunningTransaction {
       if (transaction_status) {
         lock->unlock();
         callback(*transaction_status);
+        return;
       }
     }
     bool was_empty = status_waiters_.empty();
@@ -164,6 +205,10 @@ class RunningTransaction {
   TransactionMetadataPB metadata_;
   bool committed_locally_ = false;
 
+  bool intents_buffered_;
+  BufferedIntents buffered_intents_;
+  size_t buffered_intents_size_ = 0;
+
   mutable tserver::TransactionStatus last_known_status_;
   mutable HybridTime last_known_status_hybrid_time_ = HybridTime::kMin;
   mutable std::vector<std::pair<RequestTransactionStatusCallback, HybridTime>> status_waiters_;
@@ -173,11 +218,18 @@ class RunningTransaction {
 
 class TransactionParticipant::Impl {
  public:
-  explicit Impl(TransactionParticipantContext* context)
-      : context_(*context) {}
+  Impl(TransactionParticipantContext* context,
+       std::shared_ptr<MemTracker> intents_buffer_mem_tracker)
+      : context_(*context), intents_buffer_mem_tracker_(std::move(intents_buffer_mem_tracker)) {}
+
+  ~Impl() {
+    if (intents_buffer_mem_tracker_) {
+      intents_buffer_mem_tracker_->Release(buffered_intents_size_);
+    }
+  }
 
   // Adds new running transaction.
-  void Add(const TransactionMetadataPB& data, rocksdb::WriteBatch *write_batch) {
+  void Add(const TransactionMetadataPB& data, rocksdb::DB* db, rocksdb::WriteBatch *write_batch) {
     auto id = MakeTransactionIdFromBinaryRepresentation(data.transaction_id());
     if (!id.ok()) {
       LOG(DFATAL) << "Invalid transaction id: " << id.status().ToString();
@@ -188,8 +240,12 @@ class TransactionParticipant::Impl {
       std::lock_guard<std::mutex> lock(mutex_);
       auto it = transactions_.find(*id);
       if (it == transactions_.end()) {
-        transactions_.emplace(*id, data);
-        store = true;
+        // Intents written before the metadata was stored could be flushed, while the operations
+        // that wrote them are not replayed.
+        if (LoadStoredTransactionUnlocked(db, *id) == transactions_.end()) {
+          transactions_.emplace(*id, data, true /* buffer_intents */);
+          store = true;
+        }
       } else {
         DCHECK_EQ(it->metadata().ShortDebugString(), data.ShortDebugString());
       }
@@ -213,26 +269,47 @@ class TransactionParticipant::Impl {
     std::lock_guard<std::mutex> lock(mutex_);
     auto it = transactions_.find(id);
     if (it == transactions_.end()) {
-      docdb::KeyBytes key;
-      AppendTransactionKeyPrefix(id, &key);
-      auto iter = docdb::CreateRocksDBIterator(db,
-                                               docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
-                                               boost::none,
-                                               rocksdb::kDefaultQueryId);
-      iter->Seek(key.data());
-      if (iter->Valid() && iter->key() == key.data()) {
-        TransactionMetadataPB metadata;
-        if (metadata.ParseFromArray(iter->value().cdata(), iter->value().size())) {
-          it = transactions_.emplace(id, metadata).first;
-        } else {
-          LOG(DFATAL) << "Unable to parse stored metadata: " << iter->value().ToDebugHexString();
-        }
-      }
+      it = LoadStoredTransactionUnlocked(db, id);
     }
     return it != transactions_.end() ? it->metadata().isolation()
                                      : yb::IsolationLevel::NON_TRANSACTIONAL;
   }
 
+  void BufferIntents(const TransactionId& id, BufferedIntents* intents) {
+    size_t size = 0;
+    for (const auto& intent : *intents) {
+      size += intent.size();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transactions_.find(id);
+    if (it == transactions_.end() || !it->intents_buffered()) {
+      return;
+    }
+    if (it->buffered_intents_size() + size > FLAGS_transaction_intents_buffer_max_bytes ||
+        !ConsumeBufferedIntentsSizeUnlocked(size)) {
+      // The transaction spills, its intents will be read from RocksDB when it is applied.
+      DropBufferedIntentsUnlocked(it);
+      return;
+    }
+    transactions_.modify(it, [intents, size](RunningTransaction& transaction) {
+      transaction.AddBufferedIntents(intents, size);
+    });
+  }
+
+  bool TakeBufferedIntents(const TransactionId& id, BufferedIntents* intents) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transactions_.find(id);
+    if (it == transactions_.end() || !it->intents_buffered()) {
+      return false;
+    }
+    ReleaseBufferedIntentsSizeUnlocked(it->buffered_intents_size());
+    transactions_.modify(it, [intents](RunningTransaction& transaction) {
+      transaction.TakeBufferedIntents(intents);
+    });
+    return true;
+  }
+
   void RequestStatusAt(const TransactionId& id,
                        HybridTime time,
                        RequestTransactionStatusCallback callback) {
@@ -243,7 +320,16 @@ class TransactionParticipant::Impl {
       callback(STATUS_FORMAT(NotFound, "Unknown transaction: $1", id));
       return;
     }
-    return it->RequestStatusAt(context_.client().get(), time, std::move(callback), &lock);
+    // Intents of an aborted transaction are never applied, so they are not kept in memory.
+    auto release_if_aborted = [this, id, callback = std::move(callback)](
+        Result<tserver::TransactionStatus> status) {
+      if (status.ok() && *status == tserver::TransactionStatus::ABORTED) {
+        DropBufferedIntents(id);
+      }
+      callback(std::move(status));
+    };
+    return it->RequestStatusAt(
+        context_.client().get(), time, std::move(release_if_aborted), &lock);
   }
 
   CHECKED_STATUS ProcessApply(const TransactionApplyData& data) {
@@ -297,28 +383,103 @@ class TransactionParticipant::Impl {
       >
   > Transactions;
 
+  // Loads the transaction whose metadata is stored in 'db'. Intents written before the
+  // transaction was loaded are not buffered. Returns transactions_.end() if there is no metadata.
+  // REQUIRES: mutex_ is held.
+  Transactions::iterator LoadStoredTransactionUnlocked(rocksdb::DB* db, const TransactionId& id) {
+    docdb::KeyBytes key;
+    AppendTransactionKeyPrefix(id, &key);
+    auto iter = docdb::CreateRocksDBIterator(db,
+                                             docdb::BloomFilterMode::DONT_USE_BLOOM_FILTER,
+                                             boost::none,
+                                             rocksdb::kDefaultQueryId);
+    iter->Seek(key.data());
+    if (!iter->Valid() || iter->key() != key.data()) {
+      return transactions_.end();
+    }
+    TransactionMetadataPB metadata;
+    if (!metadata.ParseFromArray(iter->value().cdata(), iter->value().size())) {
+      LOG(DFATAL) << "Unable to parse stored metadata: " << iter->value().ToDebugHexString();
+      return transactions_.end();
+    }
+    return transactions_.emplace(id, metadata, false /* buffer_intents */).first;
+  }
+
+  void DropBufferedIntents(const TransactionId& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = transactions_.find(id);
+    if (it != transactions_.end() && it->intents_buffered()) {
+      DropBufferedIntentsUnlocked(it);
+    }
+  }
+
+  // REQUIRES: mutex_ is held.
+  void DropBufferedIntentsUnlocked(Transactions::iterator it) {
+    ReleaseBufferedIntentsSizeUnlocked(it->buffered_intents_size());
+    transactions_.modify(it, [](RunningTransaction& transaction) {
+      transaction.DropBufferedIntents();
+    });
+  }
+
+  // Accounts for 'size' more bytes of buffered intents, unless that exceeds the limit.
+  // REQUIRES: mutex_ is held.
+  bool ConsumeBufferedIntentsSizeUnlocked(size_t size) {
+    if (intents_buffer_mem_tracker_) {
+      if (!intents_buffer_mem_tracker_->TryConsume(size)) {
+        return false;
+      }
+    } else if (buffered_intents_size_ + size >
+                   FLAGS_transaction_participant_intents_buffer_max_bytes) {
+      return false;
+    }
+    buffered_intents_size_ += size;
+    return true;
+  }
+
+  // REQUIRES: mutex_ is held.
+  void ReleaseBufferedIntentsSizeUnlocked(size_t size) {
+    buffered_intents_size_ -= size;
+    if (intents_buffer_mem_tracker_) {
+      intents_buffer_mem_tracker_->Release(size);
+    }
+  }
+
   TransactionParticipantContext& context_;
+  std::shared_ptr<MemTracker> intents_buffer_mem_tracker_;
 
   std::mutex mutex_;
   Transactions transactions_;
+  // Total size of the intents buffered by the transactions.
+  size_t buffered_intents_size_ = 0;
 };
 
-TransactionParticipant::TransactionParticipant(TransactionParticipantContext* context)
-    : impl_(new Impl(context)) {
+TransactionParticipant::TransactionParticipant(
+    TransactionParticipantContext* context, std::shared_ptr<MemTracker> intents_buffer_mem_tracker)
+    : impl_(new Impl(context, std::move(intents_buffer_mem_tracker))) {
 }
 
 TransactionParticipant::~TransactionParticipant() {
 }
 
 void TransactionParticipant::Add(const TransactionMetadataPB& data,
+                                 rocksdb::DB* db,
                                  rocksdb::WriteBatch *write_batch) {
-  impl_->Add(data, write_batch);
+  impl_->Add(data, db, write_batch);
 }
 
 IsolationLevel TransactionParticipant::IsolationLevel(rocksdb::DB* db, const TransactionId& id) {
   return impl_->IsolationLevel(db, id);
 }
 
+void TransactionParticipant::BufferIntents(const TransactionId& id, BufferedIntents* intents) {
+  impl_->BufferIntents(id, intents);
+}
+
+bool TransactionParticipant::TakeBufferedIntents(const TransactionId& id,
+                                                 BufferedIntents* intents) {
+  return impl_->TakeBufferedIntents(id, intents);
+}
+
 bool TransactionParticipant::CommittedLocally(const TransactionId& id) {
   return impl_->CommittedLocally(id);
 }
@@ -17,6 +17,8 @@
 #define YB_TABLET_TRANSACTION_PARTICIPANT_H
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "yb/client/client_fwd.h"
 
@@ -40,6 +42,7 @@ class WriteBatch;
 namespace yb {
 
 class HybridTime;
+class MemTracker;
 class TransactionMetadataPB;
 
 namespace docdb {
@@ -64,6 +67,24 @@ struct TransactionApplyData {
   TabletId status_tablet;
 };
 
+// Intent written by a transaction, as kept in memory by the participant.
+struct BufferedIntent {
+  // Key of the intent record and of its reverse index record.
+  std::string intent_key;
+  std::string reverse_index_key;
+  // For strong intents, the key without hybrid time and the value that are written when the
+  // transaction is applied.
+  bool strong = false;
+  std::string key;
+  std::string value;
+
+  size_t size() const {
+    return intent_key.size() + reverse_index_key.size() + key.size() + value.size();
+  }
+};
+
+typedef std::vector<BufferedIntent> BufferedIntents;
+
 // Interface to object that should apply intents in RocksDB when transaction is applying.
 class TransactionIntentApplier {
  public:
@@ -87,14 +108,29 @@ class TransactionParticipantContext {
 // instance per tablet.
 class TransactionParticipant {
  public:
-  explicit TransactionParticipant(TransactionParticipantContext* context);
+  // The size of intents buffered by all participants that share intents_buffer_mem_tracker is
+  // limited by it. Without it, the participant limits the size of its own buffered intents.
+  TransactionParticipant(TransactionParticipantContext* context,
+                         std::shared_ptr<MemTracker> intents_buffer_mem_tracker);
   ~TransactionParticipant();
 
-  // Adds new running transaction.
-  void Add(const TransactionMetadataPB& data, rocksdb::WriteBatch *write_batch);
+  // Adds new running transaction. A transaction whose metadata is already stored in 'db', for
+  // instance because its operations are replayed during bootstrap, does not buffer its intents,
+  // since some of them could be stored in 'db' only.
+  void Add(const TransactionMetadataPB& data, rocksdb::DB* db, rocksdb::WriteBatch *write_batch);
 
   yb::IsolationLevel IsolationLevel(rocksdb::DB* db, const TransactionId& id);
 
+  // Keeps in memory the intents written by a transaction, so that they could be applied without
+  // reading them from RocksDB. Intents are not kept once the transaction, or all transactions of
+  // the server, buffer too much data, or if the transaction was not started by Add(). They are
+  // released once the transaction is known to be aborted.
+  void BufferIntents(const TransactionId& id, BufferedIntents* intents);
+
+  // Moves the intents buffered for the transaction to 'intents'. Returns false if the transaction
+  // has intents that are not buffered, in which case they have to be read from RocksDB.
+  bool TakeBufferedIntents(const TransactionId& id, BufferedIntents* intents);
+
   bool CommittedLocally(const TransactionId& id);
 
   void RequestStatusAt(const TransactionId& id,
@@ -70,6 +70,12 @@ DEFINE_int32(heartbeat_max_failures_before_backoff, 3,
              "rather than retrying.");
 TAG_FLAG(heartbeat_max_failures_before_backoff, advanced);
 
+DEFINE_int32(heartbeat_tablet_load_interval_ms, 10000,
+             "Interval at which the TS reports the load of its tablets to the master in its "
+             "heartbeats.");
+TAG_FLAG(heartbeat_tablet_load_interval_ms, advanced);
+TAG_FLAG(heartbeat_tablet_load_interval_ms, runtime);
+
 using google::protobuf::RepeatedPtrField;
 using yb::HostPortPB;
 using yb::consensus::RaftPeerPB;
@@ -177,6 +183,9 @@ class Heartbeater::Thread {
   // This is tracked so as to back-off heartbeating.
   int consecutive_failed_heartbeats_;
 
+  // The time at which the load of the tablets was last sent to the master.
+  MonoTime last_tablet_load_report_time_;
+
   // Mutex/condition pair to trigger the heartbeater thread
   // to either heartbeat early or exit.
   Mutex mutex_;
@@ -381,6 +390,14 @@ Status Heartbeater::Thread::DoHeartbeat() {
   }
   req.set_num_live_tablets(server_->tablet_manager()->GetNumLiveTablets());
 
+  const MonoTime now = MonoTime::FineNow();
+  if (!last_tablet_load_report_time_.Initialized() || last_hb_response_.needs_reregister() ||
+      now.GetDeltaSince(last_tablet_load_report_time_).ToMilliseconds() >=
+          FLAGS_heartbeat_tablet_load_interval_ms) {
+    server_->tablet_manager()->GenerateTabletLoads(req.mutable_tablet_loads());
+    last_tablet_load_report_time_ = now;
+  }
+
   RpcController rpc;
   rpc.set_timeout(MonoDelta::FromSeconds(10));
 
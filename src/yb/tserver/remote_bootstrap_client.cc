@@ -32,6 +32,9 @@
 
 #include "yb/tserver/remote_bootstrap_client.h"
 
+#include <deque>
+#include <mutex>
+
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
@@ -53,6 +56,7 @@
 #include "yb/tserver/remote_bootstrap.proxy.h"
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/crc.h"
 #include "yb/util/env.h"
 #include "yb/util/env_util.h"
@@ -60,6 +64,7 @@
 #include "yb/util/flag_tags.h"
 #include "yb/util/logging.h"
 #include "yb/util/net/net_util.h"
+#include "yb/util/threadpool.h"
 
 DEFINE_int32(remote_bootstrap_begin_session_timeout_ms, 3000,
              "Tablet server RPC client timeout for BeginRemoteBootstrapSession calls.");
@@ -83,8 +88,24 @@ DEFINE_int32(committed_config_change_role_timeout_sec, 30,
              "timing out. ");
 TAG_FLAG(committed_config_change_role_timeout_sec, hidden);
 
+DEFINE_int32(remote_bootstrap_max_chunks_in_flight, 4,
+             "Maximum number of chunks of a file that a remote bootstrap client requests ahead of "
+             "the chunk it is writing.");
+TAG_FLAG(remote_bootstrap_max_chunks_in_flight, advanced);
+
+DEFINE_int32(remote_bootstrap_max_concurrent_files, 4,
+             "Maximum number of RocksDB files or WAL segments that a remote bootstrap client "
+             "downloads at the same time.");
+TAG_FLAG(remote_bootstrap_max_concurrent_files, advanced);
+
 DECLARE_int32(rpc_max_message_size);
 
+METRIC_DEFINE_counter(server, remote_bootstrap_bytes_fetched,
+                      "Remote Bootstrap Bytes Fetched",
+                      yb::MetricUnit::kBytes,
+                      "Number of bytes of tablet files downloaded by the remote bootstraps of this "
+                      "server.");
+
 DEFINE_double(fault_crash_bootstrap_client_before_changing_role, 0.0,
               "The remote bootstrap client will crash before closing the session with the leader. "
               "Because the session won't be closed successfully, the leader won't issue a "
@@ -193,6 +214,10 @@ Status RemoteBootstrapClient::Start(const string& bootstrap_peer_uuid,
                                     TSTabletManager* ts_manager) {
   CHECK(!started_);
   start_time_micros_ = GetCurrentTimeMicros();
+  if (ts_manager != nullptr) {
+    bytes_fetched_ = METRIC_remote_bootstrap_bytes_fetched.Instantiate(
+        ts_manager->server()->metric_entity());
+  }
 
   Endpoint addr;
   RETURN_NOT_OK(EndpointFromHostPort(bootstrap_peer_addr, &addr));
@@ -362,6 +387,12 @@ Status RemoteBootstrapClient::FetchAll(TabletStatusListener* status_listener) {
   }
 
   RETURN_NOT_OK(DownloadWALs());
+
+  const int64_t elapsed_micros = std::max<int64_t>(GetCurrentTimeMicros() - start_time_micros_, 1);
+  const uint64_t downloaded_bytes = downloaded_bytes_.load();
+  LOG_WITH_PREFIX(INFO) << "Downloaded " << downloaded_bytes << " bytes in "
+                        << elapsed_micros / 1000 << " ms ("
+                        << downloaded_bytes / static_cast<double>(elapsed_micros) << " MB/s)";
   return Status::OK();
 }
 
@@ -531,13 +562,11 @@ Status RemoteBootstrapClient::DownloadWALs() {
   // Download the WAL segments.
   int num_segments = wal_seqnos_.size();
   LOG_WITH_PREFIX(INFO) << "Starting download of " << num_segments << " WAL segments...";
-  uint64_t counter = 0;
-  for (uint64_t seg_seqno : wal_seqnos_) {
+  RETURN_NOT_OK(DownloadFilesConcurrently(num_segments, [this, num_segments](size_t index) {
     UpdateStatusMessage(Substitute("Downloading WAL segment with seq. number $0 ($1/$2)",
-                                   seg_seqno, counter + 1, num_segments));
-    RETURN_NOT_OK(DownloadWAL(seg_seqno));
-    ++counter;
-  }
+                                   wal_seqnos_[index], index + 1, num_segments));
+    return DownloadWAL(wal_seqnos_[index]);
+  }));
 
   downloaded_wal_ = true;
   return Status::OK();
@@ -559,21 +588,40 @@ Status RemoteBootstrapClient::DownloadRocksDBFiles() {
                         Substitute("Failed to create RocksDB tablet directory $0",
                                    rocksdb_dir));
 
+  uint64_t total_size = 0;
   for (auto const& file_pb : new_sb->rocksdb_files()) {
+    total_size += file_pb.size_bytes();
+    // Files of the intents RocksDB are listed relative to the tablet RocksDB directory.
+    if (file_pb.name().find('/') != std::string::npos) {
+      const auto file_dir = DirName(JoinPathSegments(rocksdb_dir, file_pb.name()));
+      RETURN_NOT_OK_PREPEND(meta_->fs_manager()->CreateDirIfMissing(file_dir),
+                            Substitute("Failed to create RocksDB directory $0", file_dir));
+    }
+  }
+  const auto& rocksdb_files = new_sb->rocksdb_files();
+  LOG_WITH_PREFIX(INFO) << "Starting download of " << rocksdb_files.size() << " RocksDB files ("
+                        << total_size << " bytes)...";
+  RETURN_NOT_OK(DownloadFilesConcurrently(
+      rocksdb_files.size(), [this, &rocksdb_dir, &rocksdb_files, total_size](size_t index) {
+    const auto& file_pb = rocksdb_files.Get(index);
     WritableFileOptions opts;
     opts.sync_on_close = true;
     gscoped_ptr<WritableFile> rocksdb_file;
     auto file_path = JoinPathSegments(rocksdb_dir, file_pb.name());
     RETURN_NOT_OK(fs_manager_->env()->NewWritableFile(opts, file_path, &rocksdb_file));
 
+    UpdateStatusMessage(Substitute("Downloading RocksDB file $0 ($1/$2, $3 of $4 bytes done)",
+                                   file_pb.name(), index + 1, rocksdb_files.size(),
+                                   downloaded_bytes_.load(), total_size));
     DataIdPB data_id;
     data_id.set_type(DataIdPB::ROCKSDB_FILE);
     data_id.set_file_name(file_pb.name());
     RETURN_NOT_OK_PREPEND(DownloadFile(data_id, rocksdb_file.get()),
                           Substitute("Unable to download rocksdb file $0",
                                      file_path));
-    VLOG(2) << "Downloading file " << file_path;
-  }
+    VLOG(2) << "Downloaded file " << file_path;
+    return rocksdb_file->Close();
+  }));
   new_superblock_.swap(new_sb);
   downloaded_rocksdb_files_ = true;
   return Status::OK();
@@ -713,39 +761,123 @@ Status RemoteBootstrapClient::DownloadBlock(const BlockId& old_block_id,
   return Status::OK();
 }
 
+Status RemoteBootstrapClient::DownloadFilesConcurrently(
+    size_t num_files, const std::function<Status(size_t)>& download) {
+  if (num_files == 0) {
+    return Status::OK();
+  }
+  gscoped_ptr<ThreadPool> pool;
+  RETURN_NOT_OK(ThreadPoolBuilder("rb-download")
+                    .set_max_threads(std::max(
+                        1, std::min<int>(FLAGS_remote_bootstrap_max_concurrent_files, num_files)))
+                    .Build(&pool));
+
+  std::mutex mutex;
+  Status result;
+  for (size_t index = 0; index < num_files; ++index) {
+    Status s = pool->SubmitFunc([&download, &mutex, &result, index] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!result.ok()) {
+          return;
+        }
+      }
+      Status download_status = download(index);
+      if (!download_status.ok()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.ok()) {
+          result = download_status;
+        }
+      }
+    });
+    if (!s.ok()) {
+      pool->Wait();
+      return s;
+    }
+  }
+  pool->Wait();
+  pool->Shutdown();
+  return result;
+}
+
+namespace {
+
+// A FetchData() call for a chunk of a file, that is in flight while the previous chunks of the file
+// are written.
+struct FetchDataCall {
+  FetchDataRequestPB req;
+  FetchDataResponsePB resp;
+  rpc::RpcController controller;
+  CountDownLatch latch{1};
+};
+
+} // namespace
+
 template<class Appendable>
 Status RemoteBootstrapClient::DownloadFile(const DataIdPB& data_id,
                                            Appendable* appendable) {
+  // Ask for chunks of the size that the remote sends by default: a multiple of the disk sector
+  // size, leaving 4K for message headers. If the remote sends smaller chunks, the following
+  // requests are sent again for chunks of that size.
+  const int64_t kSpareBytes = 4096;
+  const int64_t kDiskSectorSize = 4096;
+  int64_t max_length = std::max(
+      (FLAGS_rpc_max_message_size - kSpareBytes) / kDiskSectorSize * kDiskSectorSize,
+      kDiskSectorSize);
+  const size_t max_chunks_in_flight = std::max(FLAGS_remote_bootstrap_max_chunks_in_flight, 1);
+
+  // The length of the data is only known once the first chunk is received, so chunks are only
+  // requested ahead of the one being written after that.
+  std::deque<std::shared_ptr<FetchDataCall>> calls;
   uint64_t offset = 0;
-  int32_t max_length = FLAGS_rpc_max_message_size - 1024; // Leave 1K for message headers.
-
-  rpc::RpcController controller;
-  controller.set_timeout(MonoDelta::FromMilliseconds(session_idle_timeout_millis_));
-  FetchDataRequestPB req;
-
-  bool done = false;
-  while (!done) {
-    controller.Reset();
-    req.set_session_id(session_id_);
-    req.mutable_data_id()->CopyFrom(data_id);
-    req.set_offset(offset);
-    req.set_max_length(max_length);
-
-    FetchDataResponsePB resp;
-    RETURN_NOT_OK_UNWIND_PREPEND(proxy_->FetchData(req, &resp, &controller),
-                                controller,
-                                "Unable to fetch data from remote");
+  uint64_t request_offset = 0;
+  auto send_request = [this, &data_id, &calls, &request_offset, &max_length] {
+    auto call = std::make_shared<FetchDataCall>();
+    call->controller.set_timeout(MonoDelta::FromMilliseconds(session_idle_timeout_millis_));
+    call->req.set_session_id(session_id_);
+    call->req.mutable_data_id()->CopyFrom(data_id);
+    call->req.set_offset(request_offset);
+    call->req.set_max_length(max_length);
+    request_offset += max_length;
+    // The callback holds the call, so that calls that are dropped after an error can finish.
+    proxy_->FetchDataAsync(call->req, &call->resp, &call->controller,
+                           [call] { call->latch.CountDown(); });
+    calls.push_back(std::move(call));
+  };
+
+  send_request();
+  while (!calls.empty()) {
+    auto call = std::move(calls.front());
+    calls.pop_front();
+    call->latch.Wait();
+    RETURN_NOT_OK_UNWIND_PREPEND(call->controller.status(),
+                                 call->controller,
+                                 "Unable to fetch data from remote");
+    const DataChunkPB& chunk = call->resp.chunk();
     // Sanity-check for corruption.
-    RETURN_NOT_OK_PREPEND(VerifyData(offset, resp.chunk()),
+    RETURN_NOT_OK_PREPEND(VerifyData(offset, chunk),
                           Substitute("Error validating data item $0", data_id.ShortDebugString()));
 
-    // Write the data.
-    RETURN_NOT_OK(appendable->Append(resp.chunk().data()));
+    const uint64_t chunk_size = chunk.data().size();
+    const uint64_t total_data_length = chunk.total_data_length();
+    if (offset + chunk_size < total_data_length && static_cast<int64_t>(chunk_size) < max_length) {
+      // The remote sends smaller chunks than requested, so the chunks already requested do not
+      // follow this one.
+      calls.clear();
+      max_length = chunk_size;
+      request_offset = offset + chunk_size;
+    }
+    while (calls.size() < max_chunks_in_flight && request_offset < total_data_length) {
+      send_request();
+    }
 
-    if (offset + resp.chunk().data().size() == resp.chunk().total_data_length()) {
-      done = true;
+    // Write the data.
+    RETURN_NOT_OK(appendable->Append(chunk.data()));
+    offset += chunk_size;
+    downloaded_bytes_ += chunk_size;
+    if (bytes_fetched_) {
+      bytes_fetched_->IncrementBy(chunk_size);
     }
-    offset += resp.chunk().data().size();
   }
 
   return Status::OK();
@@ -32,6 +32,8 @@
 #ifndef YB_TSERVER_REMOTE_BOOTSTRAP_CLIENT_H
 #define YB_TSERVER_REMOTE_BOOTSTRAP_CLIENT_H
 
+#include <atomic>
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
@@ -43,6 +45,7 @@
 #include "yb/gutil/macros.h"
 #include "yb/gutil/ref_counted.h"
 #include "yb/rpc/rpc_fwd.h"
+#include "yb/util/metrics.h"
 #include "yb/util/status.h"
 
 namespace yb {
@@ -75,8 +78,11 @@ class TSTabletManager;
 // Client class for using remote bootstrap to copy a tablet from another host.
 // This class is not thread-safe.
 //
+// RocksDB files and WAL segments are downloaded by several threads at once, and the chunks of each
+// file are requested ahead of the one being written.
+//
 // TODO:
-// * Parallelize download of blocks and WAL segments.
+// * Parallelize download of blocks.
 //
 class RemoteBootstrapClient {
  public:
@@ -132,6 +138,9 @@ class RemoteBootstrapClient {
  private:
   FRIEND_TEST(RemoteBootstrapRocksDBClientTest, TestBeginEndSession);
   FRIEND_TEST(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFiles);
+  FRIEND_TEST(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFilesInSmallChunks);
+  FRIEND_TEST(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFilesFailure);
+  FRIEND_TEST(RemoteBootstrapRocksDBClientTest, TestDownloadFilesConcurrentlyReturnsFirstError);
 
   // Extract the embedded Status message from the given ErrorStatusPB.
   // The given ErrorStatusPB must extend RemoteBootstrapErrorPB.
@@ -147,7 +156,7 @@ class RemoteBootstrapClient {
   // End the remote bootstrap session.
   CHECKED_STATUS EndRemoteSession();
 
-  // Download all WAL files sequentially.
+  // Download all WAL files, up to FLAGS_remote_bootstrap_max_concurrent_files at a time.
   CHECKED_STATUS DownloadWALs();
 
   // Download a single WAL file.
@@ -191,6 +200,11 @@ class RemoteBootstrapClient {
 
   CHECKED_STATUS DownloadRocksDBFiles();
 
+  // Call 'download' with the index of each of 'num_files' files, from up to
+  // FLAGS_remote_bootstrap_max_concurrent_files threads at a time. Returns the first failure.
+  CHECKED_STATUS DownloadFilesConcurrently(size_t num_files,
+                                           const std::function<Status(size_t)>& download);
+
   CHECKED_STATUS VerifyData(uint64_t offset, const DataChunkPB& resp);
 
   // Return standard log prefix.
@@ -229,6 +243,13 @@ class RemoteBootstrapClient {
 
   int64_t start_time_micros_;
 
+  // Number of bytes of files downloaded by this client so far.
+  std::atomic<uint64_t> downloaded_bytes_{0};
+
+  // Number of bytes downloaded by the remote bootstraps of this server. Not set when the client
+  // is not used by a tablet server.
+  scoped_refptr<Counter> bytes_fetched_;
+
   // We track whether this session succeeded and send this information as part of the
   // EndRemoteBootstrapSessionRequestPB request.
   bool succeeded_;
@@ -12,9 +12,14 @@
 //
 
 #include <algorithm>
+#include <atomic>
 
 #include "yb/tserver/remote_bootstrap_client-test.h"
+#include "yb/util/test_util.h"
 
+DECLARE_int32(remote_bootstrap_max_chunk_size_bytes);
+DECLARE_int32(remote_bootstrap_max_concurrent_files);
+DECLARE_int64(inject_rb_fetch_data_error_from_offset);
 
 using std::shared_ptr;
 
@@ -33,6 +38,40 @@ class RemoteBootstrapRocksDBClientTest : public RemoteBootstrapClientTest {
   void SetUp() override {
     RemoteBootstrapClientTest::SetUp();
   }
+
+  // Verify that the client has the same RocksDB files that the leader has.
+  void VerifyRocksDBFiles() {
+    auto tablet_peer_checkpoint_dir =
+        tablet_peer_->tablet()->GetLastRocksDBCheckpointDirForTest();
+
+    vector<std::string> rocksdb_files;
+    ASSERT_OK(fs_manager_->ListDir(meta_->rocksdb_dir(), &rocksdb_files));
+
+    vector<std::string> tablet_peer_checkpoint_files;
+    ASSERT_OK(tablet_peer_->tablet_metadata()->fs_manager()->ListDir(
+        tablet_peer_checkpoint_dir, &tablet_peer_checkpoint_files));
+
+    ASSERT_EQ(rocksdb_files.size(), tablet_peer_checkpoint_files.size());
+    std::sort(rocksdb_files.begin(), rocksdb_files.end());
+    std::sort(tablet_peer_checkpoint_files.begin(), tablet_peer_checkpoint_files.end());
+    for (int i = 0; i < rocksdb_files.size(); ++i) {
+      auto local_rocksdb_file = rocksdb_files[i];
+      auto tablet_peer_rocksdb_file = tablet_peer_checkpoint_files[i];
+      ASSERT_EQ(local_rocksdb_file, tablet_peer_rocksdb_file);
+
+      if (local_rocksdb_file == "." || local_rocksdb_file == "..") {
+        continue;
+      }
+
+      auto local_rocksdb_file_path = JoinPathSegments(meta_->rocksdb_dir(), local_rocksdb_file);
+      auto tablet_peer_rocksdb_file_path = JoinPathSegments(tablet_peer_checkpoint_dir,
+                                                            tablet_peer_rocksdb_file);
+
+      LOG(INFO) << "Comparing file " << local_rocksdb_file_path
+                << " and file " << tablet_peer_rocksdb_file_path;
+      ASSERT_OK(CompareFileContents(local_rocksdb_file_path, tablet_peer_rocksdb_file_path));
+    }
+  }
 };
 
 // Basic begin / end remote bootstrap session.
@@ -46,36 +85,49 @@ TEST_F(RemoteBootstrapRocksDBClientTest, TestBeginEndSession) {
 TEST_F(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFiles) {
   TabletStatusListener listener(meta_);
   ASSERT_OK(client_->DownloadRocksDBFiles());
-  auto tablet_peer_checkpoint_dir = tablet_peer_->tablet()->GetLastRocksDBCheckpointDirForTest();
-
-  vector<std::string> rocksdb_files;
-  ASSERT_OK(fs_manager_->ListDir(meta_->rocksdb_dir(), &rocksdb_files));
-
-  vector<std::string> tablet_peer_checkpoint_files;
-  ASSERT_OK(tablet_peer_->tablet_metadata()->fs_manager()->ListDir(tablet_peer_checkpoint_dir,
-                                                                   &tablet_peer_checkpoint_files));
-
-  ASSERT_EQ(rocksdb_files.size(), tablet_peer_checkpoint_files.size());
-  std::sort(rocksdb_files.begin(), rocksdb_files.end());
-  std::sort(tablet_peer_checkpoint_files.begin(), tablet_peer_checkpoint_files.end());
-  // Verify that the client has the same files that the leader has.
-  for (int i = 0; i < rocksdb_files.size(); ++i) {
-    auto local_rocksdb_file = rocksdb_files[i];
-    auto tablet_peer_rocksdb_file = tablet_peer_checkpoint_files[i];
-    ASSERT_EQ(local_rocksdb_file, tablet_peer_rocksdb_file);
-
-    if (local_rocksdb_file == "." || local_rocksdb_file == "..") {
-      continue;
-    }
+  ASSERT_NO_FATALS(VerifyRocksDBFiles());
+}
 
-    auto local_rocksdb_file_path = JoinPathSegments(meta_->rocksdb_dir(), local_rocksdb_file);
-    auto tablet_peer_rocksdb_file_path = JoinPathSegments(tablet_peer_checkpoint_dir,
-                                                          tablet_peer_rocksdb_file);
+// The remote sends smaller chunks than the client asks for, so the client has to drop the chunks
+// requested ahead and ask for them again.
+TEST_F(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFilesInSmallChunks) {
+  google::FlagSaver flag_saver;
+  FLAGS_remote_bootstrap_max_chunk_size_bytes = 64;
+  ASSERT_OK(client_->DownloadRocksDBFiles());
+  ASSERT_NO_FATALS(VerifyRocksDBFiles());
+}
 
-    LOG(INFO) << "Comparing file " << local_rocksdb_file_path
-              << " and file " << tablet_peer_rocksdb_file_path;
-    ASSERT_OK(CompareFileContents(local_rocksdb_file_path, tablet_peer_rocksdb_file_path));
-  }
+// A failed chunk fails the download, and the chunks in flight after it do not break a later one.
+TEST_F(RemoteBootstrapRocksDBClientTest, TestDownloadRocksDBFilesFailure) {
+  google::FlagSaver flag_saver;
+  FLAGS_remote_bootstrap_max_chunk_size_bytes = 64;
+  FLAGS_inject_rb_fetch_data_error_from_offset = 128;
+  Status s = client_->DownloadRocksDBFiles();
+  ASSERT_FALSE(s.ok());
+  ASSERT_STR_CONTAINS(s.ToString(), "Injected error");
+
+  FLAGS_inject_rb_fetch_data_error_from_offset = -1;
+  ASSERT_OK(client_->DownloadRocksDBFiles());
+  ASSERT_NO_FATALS(VerifyRocksDBFiles());
+}
+
+// The first failure is returned, and the files not started yet are not downloaded.
+TEST_F(RemoteBootstrapRocksDBClientTest, TestDownloadFilesConcurrentlyReturnsFirstError) {
+  google::FlagSaver flag_saver;
+  FLAGS_remote_bootstrap_max_concurrent_files = 2;
+  const size_t kNumFiles = 8;
+  std::atomic<size_t> num_downloads(0);
+  Status s = client_->DownloadFilesConcurrently(kNumFiles, [&num_downloads](size_t index) {
+    ++num_downloads;
+    if (index == 0) {
+      return STATUS(IOError, "first");
+    }
+    SleepFor(MonoDelta::FromMilliseconds(50));
+    return STATUS(IOError, "later");
+  });
+  ASSERT_TRUE(s.IsIOError()) << s;
+  ASSERT_STR_CONTAINS(s.ToString(), "first");
+  ASSERT_LT(num_downloads.load(), kNumFiles);
 }
 
 } // namespace tserver
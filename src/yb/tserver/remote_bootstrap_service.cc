@@ -40,6 +40,8 @@
 #include <gflags/gflags.h>
 #include <glog/logging.h>
 
+#include "yb/rocksdb/rate_limiter.h"
+
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/log.h"
 #include "yb/fs/fs_manager.h"
@@ -84,6 +86,11 @@ DEFINE_double(fault_crash_on_handle_rb_fetch_data, 0.0,
               "(For testing only!)");
 TAG_FLAG(fault_crash_on_handle_rb_fetch_data, unsafe);
 
+DEFINE_int64(inject_rb_fetch_data_error_from_offset, -1,
+             "Fail RemoteBootstrapService FetchData() RPC calls for data at or after this offset "
+             "of a file. -1 means never. (For testing only!)");
+TAG_FLAG(inject_rb_fetch_data_error_from_offset, unsafe);
+
 DEFINE_uint64(inject_latency_before_change_role_secs, 0,
               "Number of seconds to sleep before we call ChangeRole. "
               "(For testing only!)");
@@ -109,6 +116,17 @@ DEFINE_double(fault_crash_leader_after_changing_role, 0.0,
 TAG_FLAG(fault_crash_leader_after_changing_role, unsafe);
 TAG_FLAG(fault_crash_leader_after_changing_role, hidden);
 
+DEFINE_int64(remote_bootstrap_rate_limit_bytes_per_sec, 0,
+             "Maximum rate at which a tablet server sends the data of tablet files to all the "
+             "remote bootstrap clients it serves. 0 means no limit.");
+TAG_FLAG(remote_bootstrap_rate_limit_bytes_per_sec, advanced);
+
+METRIC_DEFINE_counter(server, remote_bootstrap_bytes_sent,
+                      "Remote Bootstrap Bytes Sent",
+                      yb::MetricUnit::kBytes,
+                      "Number of bytes of tablet files sent to the remote bootstrap clients of "
+                      "this server.");
+
 namespace yb {
 namespace tserver {
 
@@ -138,11 +156,21 @@ RemoteBootstrapServiceImpl::RemoteBootstrapServiceImpl(
       fs_manager_(CHECK_NOTNULL(fs_manager)),
       tablet_peer_lookup_(CHECK_NOTNULL(tablet_peer_lookup)),
       shutdown_latch_(1) {
+  if (FLAGS_remote_bootstrap_rate_limit_bytes_per_sec > 0) {
+    rate_limiter_.reset(
+        rocksdb::NewGenericRateLimiter(FLAGS_remote_bootstrap_rate_limit_bytes_per_sec));
+  }
+  if (metric_entity) {
+    bytes_sent_ = METRIC_remote_bootstrap_bytes_sent.Instantiate(metric_entity);
+  }
   CHECK_OK(Thread::Create("remote-bootstrap", "rb-session-exp",
                           &RemoteBootstrapServiceImpl::EndExpiredSessions, this,
                           &session_expiration_thread_));
 }
 
+RemoteBootstrapServiceImpl::~RemoteBootstrapServiceImpl() {
+}
+
 void RemoteBootstrapServiceImpl::BeginRemoteBootstrapSession(
         const BeginRemoteBootstrapSessionRequestPB* req,
         BeginRemoteBootstrapSessionResponsePB* resp,
@@ -242,6 +270,11 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   MAYBE_FAULT(FLAGS_fault_crash_on_handle_rb_fetch_data);
 
   uint64_t offset = req->offset();
+  if (PREDICT_FALSE(FLAGS_inject_rb_fetch_data_error_from_offset >= 0 &&
+                    static_cast<int64_t>(offset) >= FLAGS_inject_rb_fetch_data_error_from_offset)) {
+    RPC_RETURN_NOT_OK(STATUS_FORMAT(IOError, "Injected error at offset $0", offset),
+                      RemoteBootstrapErrorPB::IO_ERROR, "Unable to read data");
+  }
   int64_t client_maxlen = req->max_length();
 
   const DataIdPB& data_id = req->data_id();
@@ -249,6 +282,10 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   RPC_RETURN_NOT_OK(ValidateFetchRequestDataId(data_id, &error_code, session),
                     error_code, "Invalid DataId");
 
+  // Wait for the rate limit before reading, so that throttled requests do not hold their chunk in
+  // memory. Only the last chunk of a file is shorter than this.
+  ThrottleSend(RemoteBootstrapSession::MaxPieceLength(client_maxlen));
+
   DataChunkPB* data_chunk = resp->mutable_chunk();
   string* data = data_chunk->mutable_data();
   int64_t total_data_length = 0;
@@ -282,9 +319,25 @@ void RemoteBootstrapServiceImpl::FetchData(const FetchDataRequestPB* req,
   uint32_t crc32 = Crc32c(data->data(), data->length());
   data_chunk->set_crc32(crc32);
 
+  if (bytes_sent_) {
+    bytes_sent_->IncrementBy(data->length());
+  }
   context.RespondSuccess();
 }
 
+void RemoteBootstrapServiceImpl::ThrottleSend(int64_t bytes) {
+  if (!rate_limiter_) {
+    return;
+  }
+  // A single request to the rate limiter cannot exceed its burst size.
+  const int64_t max_request = rate_limiter_->GetSingleBurstBytes();
+  while (bytes > 0) {
+    const int64_t request = std::min(bytes, max_request);
+    rate_limiter_->Request(request, rocksdb::Env::IO_HIGH);
+    bytes -= request;
+  }
+}
+
 void RemoteBootstrapServiceImpl::EndRemoteBootstrapSession(
         const EndRemoteBootstrapSessionRequestPB* req,
         EndRemoteBootstrapSessionResponsePB* resp,
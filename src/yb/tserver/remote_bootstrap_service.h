@@ -32,6 +32,7 @@
 #ifndef YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 #define YB_TSERVER_REMOTE_BOOTSTRAP_SERVICE_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -45,6 +46,10 @@
 #include "yb/util/status.h"
 #include "yb/util/thread.h"
 
+namespace rocksdb {
+class RateLimiter;
+} // namespace rocksdb
+
 namespace yb {
 class FsManager;
 
@@ -63,6 +68,8 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
                              TabletPeerLookupIf* tablet_peer_lookup,
                              const scoped_refptr<MetricEntity>& metric_entity);
 
+  ~RemoteBootstrapServiceImpl();
+
   virtual void BeginRemoteBootstrapSession(const BeginRemoteBootstrapSessionRequestPB* req,
                                            BeginRemoteBootstrapSessionResponsePB* resp,
                                            rpc::RpcContext context) override;
@@ -107,6 +114,10 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   // removes them from the map.
   void EndExpiredSessions();
 
+  // Wait until reading and sending the given number of bytes keeps all the sessions under
+  // FLAGS_remote_bootstrap_rate_limit_bytes_per_sec.
+  void ThrottleSend(int64_t bytes);
+
   FsManager* fs_manager_;
   TabletPeerLookupIf* tablet_peer_lookup_;
 
@@ -119,6 +130,13 @@ class RemoteBootstrapServiceImpl : public RemoteBootstrapServiceIf {
   // TODO: this is a hack, replace with some kind of timer impl. See KUDU-286.
   CountDownLatch shutdown_latch_;
   scoped_refptr<Thread> session_expiration_thread_;
+
+  // Limits the rate at which the data of all the sessions is sent. Not set if the rate is not
+  // limited.
+  std::unique_ptr<rocksdb::RateLimiter> rate_limiter_;
+
+  // Number of bytes of tablet files sent to remote bootstrap clients.
+  scoped_refptr<Counter> bytes_sent_;
 };
 
 } // namespace tserver
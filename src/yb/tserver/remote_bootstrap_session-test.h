@@ -95,6 +95,7 @@ class RemoteBootstrapTest : public YBTabletTest {
                             ColumnSchema("val", INT32) }, 1),
                    table_type) {
     CHECK_OK(ThreadPoolBuilder("test-exec").Build(&apply_pool_));
+    CHECK_OK(ThreadPoolBuilder("test-prepare").Build(&prepare_pool_));
   }
 
   virtual void SetUp() override {
@@ -133,6 +134,7 @@ class RemoteBootstrapTest : public YBTabletTest {
         new TabletPeerClass(tablet()->metadata(),
                             config_peer,
                             apply_pool_.get(),
+                            prepare_pool_.get(),
                             Bind(&RemoteBootstrapTest::TabletPeerStateChangedCallback,
                                  Unretained(this),
                                  tablet()->tablet_id())));
@@ -235,6 +237,7 @@ class RemoteBootstrapTest : public YBTabletTest {
   MetricRegistry metric_registry_;
   scoped_refptr<LogAnchorRegistry> log_anchor_registry_;
   gscoped_ptr<ThreadPool> apply_pool_;
+  gscoped_ptr<ThreadPool> prepare_pool_;
   scoped_refptr<TabletPeer> tablet_peer_;
   scoped_refptr<RemoteBootstrapSession> session_;
 };
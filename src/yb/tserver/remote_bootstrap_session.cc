@@ -42,11 +42,18 @@
 #include "yb/gutil/type_traits.h"
 #include "yb/server/metadata.h"
 #include "yb/tablet/tablet_peer.h"
+#include "yb/util/flag_tags.h"
 #include "yb/util/stopwatch.h"
 #include "yb/util/trace.h"
 
 DECLARE_int32(rpc_max_message_size);
 
+DEFINE_int32(remote_bootstrap_max_chunk_size_bytes, 0,
+             "Maximum size of the chunks of data sent to remote bootstrap clients. 0 means the "
+             "largest size that fits into an RPC message. (For testing only!)");
+TAG_FLAG(remote_bootstrap_max_chunk_size_bytes, unsafe);
+TAG_FLAG(remote_bootstrap_max_chunk_size_bytes, hidden);
+
 namespace yb {
 namespace tserver {
 
@@ -269,8 +276,7 @@ const std::string& RemoteBootstrapSession::requestor_uuid() const {
   return requestor_uuid_;
 }
 
-// Determine the length of the data chunk to return to the client.
-static int64_t DetermineReadLength(int64_t bytes_remaining, int64_t requested_len) {
+int64_t RemoteBootstrapSession::MaxPieceLength(int64_t requested_len) {
   // Determine the size of the chunks we want to read.
   // Choose "system max" as a multiple of typical HDD block size (4K) with 4K to
   // spare for other stuff in the message, like headers, other protobufs, etc.
@@ -280,11 +286,19 @@ static int64_t DetermineReadLength(int64_t bytes_remaining, int64_t requested_le
       ((FLAGS_rpc_max_message_size - kSpareBytes) / kDiskSectorSize) * kDiskSectorSize;
   CHECK_GT(system_max_chunk_size, 0) << "rpc_max_message_size is too low to transfer data: "
                                      << FLAGS_rpc_max_message_size;
+  if (FLAGS_remote_bootstrap_max_chunk_size_bytes > 0) {
+    system_max_chunk_size = std::min(system_max_chunk_size,
+                                     FLAGS_remote_bootstrap_max_chunk_size_bytes);
+  }
 
   // The min of the {requested, system} maxes is the effective max.
-  int64_t maxlen = (requested_len > 0) ? std::min<int64_t>(requested_len, system_max_chunk_size) :
-                                        system_max_chunk_size;
-  return std::min(bytes_remaining, maxlen);
+  return (requested_len > 0) ? std::min<int64_t>(requested_len, system_max_chunk_size) :
+                               system_max_chunk_size;
+}
+
+// Determine the length of the data chunk to return to the client.
+static int64_t DetermineReadLength(int64_t bytes_remaining, int64_t requested_len) {
+  return std::min(bytes_remaining, RemoteBootstrapSession::MaxPieceLength(requested_len));
 }
 
 // Calculate the size of the data to return given a maximum client message
@@ -128,6 +128,9 @@ class RemoteBootstrapSession : public RefCountedThreadSafe<RemoteBootstrapSessio
                        std::string* data, int64_t* block_file_size,
                        RemoteBootstrapErrorPB::Code* error_code);
 
+  // The maximum length of the data read by a Get*Piece() call with the given client_maxlen.
+  static int64_t MaxPieceLength(int64_t client_maxlen);
+
   // Get a piece of a log segment.
   // The behavior and params are very similar to GetBlockPiece(), but this one
   // is only for sending WAL segment files.
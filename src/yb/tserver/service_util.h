@@ -33,6 +33,19 @@ void SetupErrorAndRespond(TabletServerErrorPB* error,
                           TabletServerErrorPB::Code code,
                           rpc::RpcContext* context);
 
+// Returns an error, and sets 'error_code', if 'dest_uuid' is not the UUID of this server.
+CHECKED_STATUS CheckUuidMatch(TabletPeerLookupIf* tablet_manager,
+                              const char* method_name,
+                              const std::string& dest_uuid,
+                              TabletServerErrorPB::Code* error_code);
+
+// Looks up the given tablet, ensuring that it both exists and is RUNNING. Returns an error, and
+// sets 'error_code', if it is not.
+CHECKED_STATUS LookupTabletPeer(TabletPeerLookupIf* tablet_manager,
+                                const std::string& tablet_id,
+                                scoped_refptr<tablet::TabletPeer>* peer,
+                                TabletServerErrorPB::Code* error_code);
+
 // Template helpers.
 
 template<class ReqClass, class RespClass>
@@ -53,14 +66,12 @@ bool CheckUuidMatchOrRespond(TabletPeerLookupIf* tablet_manager,
 #endif
     return true;
   }
-  if (PREDICT_FALSE(req->dest_uuid() != local_uuid)) {
-    const Status s = STATUS_SUBSTITUTE(InvalidArgument,
-        "$0: Wrong destination UUID requested. Local UUID: $1. Requested UUID: $2",
-        method_name, local_uuid, req->dest_uuid());
+  TabletServerErrorPB::Code error_code;
+  const Status s = CheckUuidMatch(tablet_manager, method_name, req->dest_uuid(), &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
     LOG(WARNING) << s.ToString() << ": from " << context->requestor_string()
                  << ": " << req->ShortDebugString();
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::WRONG_SERVER_UUID, context);
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
     return false;
   }
   return true;
@@ -102,27 +113,12 @@ bool LookupTabletPeerOrRespond(TabletPeerLookupIf* tablet_manager,
                                RespClass* resp,
                                rpc::RpcContext* context,
                                scoped_refptr<tablet::TabletPeer>* peer) {
-  Status status = tablet_manager->GetTabletPeer(tablet_id, peer);
+  TabletServerErrorPB::Code code;
+  Status status = LookupTabletPeer(tablet_manager, tablet_id, peer, &code);
   if (PREDICT_FALSE(!status.ok())) {
-    TabletServerErrorPB::Code code = status.IsServiceUnavailable() ?
-                                     TabletServerErrorPB::UNKNOWN_ERROR :
-                                     TabletServerErrorPB::TABLET_NOT_FOUND;
     SetupErrorAndRespond(resp->mutable_error(), status, code, context);
     return false;
   }
-
-  // Check RUNNING state.
-  tablet::TabletStatePB state = (*peer)->state();
-  if (PREDICT_FALSE(state != tablet::RUNNING)) {
-    Status s = STATUS(IllegalState, "Tablet not RUNNING",
-                      tablet::TabletStatePB_Name(state));
-    if (state == tablet::FAILED) {
-      s = s.CloneAndAppend((*peer)->error().ToString());
-    }
-    SetupErrorAndRespond(resp->mutable_error(), s,
-                         TabletServerErrorPB::TABLET_NOT_RUNNING, context);
-    return false;
-  }
   return true;
 }
 
@@ -68,6 +68,9 @@ class TabletPeerLookupIf {
 
   virtual CHECKED_STATUS StartRemoteBootstrap(
       const consensus::StartRemoteBootstrapRequestPB& req) = 0;
+
+  // Whether the tablet was deleted from this server after being split.
+  virtual bool IsDeletedSplitTablet(const std::string& tablet_id) const { return false; }
 };
 
 } // namespace tserver
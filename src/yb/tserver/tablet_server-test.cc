@@ -33,6 +33,8 @@
 #include "yb/tserver/tablet_server-test-base.h"
 
 #include "yb/consensus/log-test-base.h"
+#include "yb/consensus/multi_raft_batcher.h"
+#include "yb/consensus/opid_util.h"
 #include "yb/gutil/strings/escaping.h"
 #include "yb/gutil/strings/substitute.h"
 #include "yb/master/master.pb.h"
@@ -69,6 +71,8 @@ DECLARE_int32(metrics_retirement_age_ms);
 DECLARE_string(block_manager);
 DECLARE_string(rpc_bind_addresses);
 DECLARE_bool(disable_clock_sync_error);
+DECLARE_int32(multi_raft_heartbeat_window_ms);
+DECLARE_int32(multi_raft_batch_size);
 
 // Declare these metrics prototypes for simpler unit testing of their behavior.
 METRIC_DECLARE_counter(rows_inserted);
@@ -1632,6 +1636,97 @@ TEST_F(TabletServerTest, TestConcurrentDeleteTablet) {
   ASSERT_EQ(1, num_success);
 }
 
+// Test that the requests of a MultiRaftUpdateConsensus batch are applied to their own tablets, and
+// that each of them gets its own response, in the order of the requests.
+TEST_F(TabletServerTest, TestMultiRaftUpdateConsensus) {
+  const string local_uuid = mini_server_->server()->fs_manager()->uuid();
+  consensus::MultiRaftConsensusRequestPB req;
+  consensus::MultiRaftConsensusResponsePB resp;
+  RpcController rpc;
+
+  auto add_request = [&req, &local_uuid](const string& tablet_id, const string& dest_uuid) {
+    auto* consensus_req = req.add_consensus_request();
+    consensus_req->set_dest_uuid(dest_uuid);
+    consensus_req->set_tablet_id(tablet_id);
+    consensus_req->set_caller_uuid("fake-leader");
+    // The tablet is led by this server in a later term, so the update is rejected by consensus.
+    consensus_req->set_caller_term(0);
+    *consensus_req->mutable_committed_index() = consensus::MinimumOpId();
+  };
+  add_request("NotPresentTabletId", local_uuid);
+  add_request(kTabletId, "WrongUuid");
+  add_request(kTabletId, local_uuid);
+
+  ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &rpc));
+  SCOPED_TRACE(resp.DebugString());
+  ASSERT_EQ(3, resp.consensus_response_size());
+  ASSERT_TRUE(resp.consensus_response(0).has_error());
+  ASSERT_EQ(TabletServerErrorPB::TABLET_NOT_FOUND, resp.consensus_response(0).error().code());
+  ASSERT_TRUE(resp.consensus_response(1).has_error());
+  ASSERT_EQ(TabletServerErrorPB::WRONG_SERVER_UUID, resp.consensus_response(1).error().code());
+  const auto& tablet_resp = resp.consensus_response(2);
+  ASSERT_FALSE(tablet_resp.has_error());
+  ASSERT_EQ(local_uuid, tablet_resp.responder_uuid());
+  ASSERT_EQ(consensus::ConsensusErrorPB::INVALID_TERM, tablet_resp.status().error().code());
+
+  // An empty batch gets an empty response.
+  req.Clear();
+  resp.Clear();
+  rpc.Reset();
+  ASSERT_OK(consensus_proxy_->MultiRaftUpdateConsensus(req, &resp, &rpc));
+  ASSERT_EQ(0, resp.consensus_response_size());
+}
+
+// Test that heartbeats are sent in a batch once it fills up, and that a batch that is still
+// waiting when the messenger shuts down is failed instead of sent.
+TEST_F(TabletServerTest, TestMultiRaftHeartbeatBatcher) {
+  google::FlagSaver saver;
+  FLAGS_multi_raft_heartbeat_window_ms = 60000;
+  FLAGS_multi_raft_batch_size = 2;
+
+  std::shared_ptr<Messenger> messenger;
+  ASSERT_OK(MessengerBuilder("Batcher").Build(&messenger));
+  auto batcher = std::make_shared<consensus::MultiRaftHeartbeatBatcher>(
+      messenger,
+      std::make_unique<consensus::ConsensusServiceProxy>(messenger,
+                                                         mini_server_->bound_rpc_addr()));
+
+  const string local_uuid = mini_server_->server()->fs_manager()->uuid();
+  constexpr int kNumRequests = 3;
+  consensus::ConsensusRequestPB requests[kNumRequests];
+  consensus::ConsensusResponsePB responses[kNumRequests];
+  RpcController controllers[kNumRequests];
+  CountDownLatch full_batch_latch(2);
+  CountDownLatch last_latch(1);
+  for (int i = 0; i != kNumRequests; ++i) {
+    requests[i].set_dest_uuid(local_uuid);
+    requests[i].set_tablet_id(kTabletId);
+    requests[i].set_caller_uuid("fake-leader");
+    requests[i].set_caller_term(0);
+    *requests[i].mutable_committed_index() = consensus::MinimumOpId();
+    auto& latch = i < 2 ? full_batch_latch : last_latch;
+    batcher->AddRequestToBatch(&requests[i], &responses[i], &controllers[i],
+                               [&latch] { latch.CountDown(); });
+  }
+
+  // The first two requests fill a batch, which is sent without waiting for the window.
+  ASSERT_TRUE(full_batch_latch.WaitFor(MonoDelta::FromSeconds(30)));
+  for (int i = 0; i != 2; ++i) {
+    SCOPED_TRACE(responses[i].DebugString());
+    ASSERT_OK(controllers[i].status());
+    ASSERT_FALSE(responses[i].has_error());
+    ASSERT_EQ(local_uuid, responses[i].responder_uuid());
+    ASSERT_EQ(consensus::ConsensusErrorPB::INVALID_TERM, responses[i].status().error().code());
+  }
+  ASSERT_EQ(1U, last_latch.count());
+
+  // The last request is still waiting for the window, the shutdown aborts it.
+  messenger->Shutdown();
+  ASSERT_TRUE(last_latch.WaitFor(MonoDelta::FromSeconds(30)));
+  ASSERT_TRUE(responses[2].has_error());
+  ASSERT_FALSE(responses[2].has_status());
+}
+
 TEST_F(TabletServerTest, TestInsertLatencyMicroBenchmark) {
   METRIC_DEFINE_entity(test);
   METRIC_DEFINE_histogram(test, insert_latency,
@@ -33,6 +33,7 @@
 #include "yb/tserver/tablet_service.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -57,6 +58,7 @@
 #include "yb/tablet/tablet_metrics.h"
 
 #include "yb/tablet/operations/alter_schema_operation.h"
+#include "yb/tablet/operations/split_operation.h"
 #include "yb/tablet/operations/update_txn_operation.h"
 #include "yb/tablet/operations/write_operation.h"
 
@@ -64,6 +66,7 @@
 #include "yb/tserver/tablet_server.h"
 #include "yb/tserver/ts_tablet_manager.h"
 #include "yb/tserver/tserver.pb.h"
+#include "yb/util/countdown_latch.h"
 #include "yb/util/crc.h"
 #include "yb/util/debug/trace_event.h"
 #include "yb/util/faststring.h"
@@ -105,6 +108,30 @@ DEFINE_int32(max_wait_for_safe_time_ms, 5000,
              "Maximum time in milliseconds to wait for the safe time to advance when trying to "
              "scan at the given hybrid_time.");
 
+DEFINE_int32(max_stale_read_bound_time_ms, 0,
+             "If we are allowed to read from followers, this specifies the maximum amount of "
+             "time in milliseconds a follower may lag behind the leader (measured as the time "
+             "since it last accepted an update from the leader) and still serve the read. "
+             "0 means no bound.");
+TAG_FLAG(max_stale_read_bound_time_ms, evolving);
+TAG_FLAG(max_stale_read_bound_time_ms, runtime);
+
+DEFINE_int32(parallel_read_batch_min_size, 8,
+             "Minimum number of entries in a Redis or QL read batch for it to be executed in "
+             "parallel on the read pool. 0 disables parallel execution of read batches.");
+TAG_FLAG(parallel_read_batch_min_size, evolving);
+TAG_FLAG(parallel_read_batch_min_size, runtime);
+
+DEFINE_int32(read_pool_max_threads, 16,
+             "Maximum number of threads used to execute entries of read batches in parallel.");
+TAG_FLAG(read_pool_max_threads, evolving);
+
+DEFINE_int32(multi_raft_update_pool_max_threads, 16,
+             "Maximum number of threads used to apply the consensus updates of a batch of "
+             "heartbeats in parallel. 0 applies them on the RPC thread, one after another.");
+TAG_FLAG(multi_raft_update_pool_max_threads, advanced);
+TAG_FLAG(multi_raft_update_pool_max_threads, evolving);
+
 DEFINE_bool(tserver_noop_read_write, false, "Respond NOOP to read/write.");
 TAG_FLAG(tserver_noop_read_write, unsafe);
 TAG_FLAG(tserver_noop_read_write, hidden);
@@ -123,6 +150,8 @@ using consensus::ConsensusResponsePB;
 using consensus::GetLastOpIdRequestPB;
 using consensus::GetNodeInstanceRequestPB;
 using consensus::GetNodeInstanceResponsePB;
+using consensus::MultiRaftConsensusRequestPB;
+using consensus::MultiRaftConsensusResponsePB;
 using consensus::LeaderStepDownRequestPB;
 using consensus::LeaderStepDownResponsePB;
 using consensus::LeaderLeaseStatus;
@@ -240,6 +269,51 @@ void SetupErrorAndRespond(TabletServerErrorPB* error,
   context->RespondSuccess();
 }
 
+Status CheckUuidMatch(TabletPeerLookupIf* tablet_manager,
+                      const char* method_name,
+                      const std::string& dest_uuid,
+                      TabletServerErrorPB::Code* error_code) {
+  const string& local_uuid = tablet_manager->NodeInstance().permanent_uuid();
+  if (PREDICT_FALSE(dest_uuid != local_uuid)) {
+    *error_code = TabletServerErrorPB::WRONG_SERVER_UUID;
+    return STATUS_SUBSTITUTE(InvalidArgument,
+        "$0: Wrong destination UUID requested. Local UUID: $1. Requested UUID: $2",
+        method_name, local_uuid, dest_uuid);
+  }
+  return Status::OK();
+}
+
+Status LookupTabletPeer(TabletPeerLookupIf* tablet_manager,
+                        const std::string& tablet_id,
+                        scoped_refptr<TabletPeer>* peer,
+                        TabletServerErrorPB::Code* error_code) {
+  Status status = tablet_manager->GetTabletPeer(tablet_id, peer);
+  if (PREDICT_FALSE(!status.ok())) {
+    // Clients that still have the locations of a split tablet look up the tablets that replaced
+    // it and send their operations again.
+    if (status.IsNotFound() && tablet_manager->IsDeletedSplitTablet(tablet_id)) {
+      *error_code = TabletServerErrorPB::TABLET_SPLIT;
+      return STATUS(IllegalState, "Tablet has been split", tablet_id);
+    }
+    *error_code = status.IsServiceUnavailable() ? TabletServerErrorPB::UNKNOWN_ERROR
+                                                : TabletServerErrorPB::TABLET_NOT_FOUND;
+    return status;
+  }
+
+  // Check RUNNING state.
+  tablet::TabletStatePB state = (*peer)->state();
+  if (PREDICT_FALSE(state != tablet::RUNNING)) {
+    Status s = STATUS(IllegalState, "Tablet not RUNNING",
+                      tablet::TabletStatePB_Name(state));
+    if (state == tablet::FAILED) {
+      s = s.CloneAndAppend((*peer)->error().ToString());
+    }
+    *error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+    return s;
+  }
+  return Status::OK();
+}
+
 class WriteOperationCompletionCallback : public OperationCompletionCallback {
  public:
   WriteOperationCompletionCallback(
@@ -264,7 +338,7 @@ class WriteOperationCompletionCallback : public OperationCompletionCallback {
         rowblock->Serialize(ql_write_req.client(), &rows_data);
         int rows_data_sidecar_idx = 0;
         RETURN_UNKNOWN_ERROR_IF_NOT_OK(
-            context_->AddRpcSidecar(RefCntBuffer(rows_data), &rows_data_sidecar_idx),
+            context_->AddRpcSidecar(RefCntBuffer(std::move(rows_data)), &rows_data_sidecar_idx),
             response_,
             context_.get());
         ql_write_resp->set_rows_data_sidecar(rows_data_sidecar_idx);
@@ -475,6 +549,17 @@ static size_t GetMaxBatchSizeBytesHint(const ScanRequestPB* req) {
 TabletServiceImpl::TabletServiceImpl(TabletServerIf* server)
     : TabletServerServiceIf(server->MetricEnt()),
       server_(server) {
+  if (FLAGS_read_pool_max_threads > 0) {
+    CHECK_OK(ThreadPoolBuilder("read")
+                 .set_max_threads(FLAGS_read_pool_max_threads)
+                 .Build(&read_pool_));
+  }
+}
+
+TabletServiceImpl::~TabletServiceImpl() {
+  if (read_pool_) {
+    read_pool_->Shutdown();
+  }
 }
 
 TabletServiceAdminImpl::TabletServiceAdminImpl(TabletServer* server)
@@ -548,6 +633,51 @@ void TabletServiceAdminImpl::AlterSchema(const AlterSchemaRequestPB* req,
       std::move(operation_state), consensus::LEADER));
 }
 
+void TabletServiceAdminImpl::SplitTablet(const SplitTabletRequestPB* req,
+                                         SplitTabletResponsePB* resp,
+                                         rpc::RpcContext context) {
+  if (!CheckUuidMatchOrRespond(server_->tablet_manager(), "SplitTablet", req, resp, &context)) {
+    return;
+  }
+  DVLOG(3) << "Received Split Tablet RPC: " << req->DebugString();
+
+  scoped_refptr<TabletPeer> tablet_peer;
+  if (!LookupTabletPeerOrRespond(server_->tablet_manager(), req->tablet_id(), resp, &context,
+                                 &tablet_peer)) {
+    return;
+  }
+
+  tablet::TabletPtr tablet;
+  TabletServerErrorPB::Code error_code;
+  Status s = GetTabletRef(tablet_peer, &tablet, &error_code);
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, &context);
+    return;
+  }
+
+  // If the split was already started, respond as succeeded only once it has created the new
+  // tablets here. Otherwise the master sends the request again.
+  if (tablet->splitting()) {
+    s = server_->tablet_manager()->CheckTabletSplit(tablet.get(), *req);
+    if (!s.ok()) {
+      SetupErrorAndRespond(resp->mutable_error(), s, TabletServerErrorPB::UNKNOWN_ERROR, &context);
+      return;
+    }
+    context.RespondSuccess();
+    return;
+  }
+
+  auto operation_state = std::make_unique<tablet::SplitOperationState>(
+      tablet_peer.get(), tablet.get(), req, resp);
+
+  operation_state->set_completion_callback(
+      MakeRpcOperationCompletionCallback(std::move(context), resp));
+
+  // Submit the split op. The RPC will be responded to asynchronously.
+  tablet_peer->Submit(std::make_unique<tablet::SplitOperation>(
+      std::move(operation_state), consensus::LEADER));
+}
+
 void TabletServiceImpl::UpdateTransaction(const UpdateTransactionRequestPB* req,
                                           UpdateTransactionResponsePB* resp,
                                           rpc::RpcContext context) {
@@ -834,6 +964,31 @@ Status TabletServiceImpl::CheckPeerIsLeader(const TabletPeer& tablet_peer,
                            "Unknown leader status $0.", static_cast<int>(leader_status));
 }
 
+Status TabletServiceImpl::CheckPeerIsNotTooStale(const TabletPeer& tablet_peer,
+                                                  TabletServerErrorPB::Code* error_code) {
+  const int32_t max_staleness_ms = FLAGS_max_stale_read_bound_time_ms;
+  if (max_staleness_ms <= 0) {
+    return Status::OK();
+  }
+
+  scoped_refptr<consensus::Consensus> consensus = tablet_peer.shared_consensus();
+  // The leader is never stale.
+  if (consensus->leader_status() != Consensus::LeaderStatus::NOT_LEADER) {
+    return Status::OK();
+  }
+
+  const MonoDelta staleness = consensus->TimeSinceLastMessageFromLeader();
+  if (staleness.ToMilliseconds() > max_staleness_ms) {
+    *error_code = TabletServerErrorPB::STALE_FOLLOWER;
+    return STATUS_FORMAT(
+        IllegalState, "Follower $0 of tablet $1 has not heard from the leader for $2, max: $3 ms",
+        tablet_peer.permanent_uuid(), tablet_peer.tablet_id(),
+        staleness == MonoDelta::kMax ? std::string("ever") : staleness.ToString(),
+        max_staleness_ms);
+  }
+  return Status::OK();
+}
+
 Status TabletServiceImpl::CheckPeerIsLeaderAndReady(const TabletPeer& tablet_peer,
                                                     TabletServerErrorPB::Code* error_code) {
   RETURN_NOT_OK(CheckPeerIsReady(tablet_peer, error_code));
@@ -861,10 +1016,12 @@ bool TabletServiceImpl::GetTabletOrRespond(const ReadRequestPB* req,
   // Check for leader only in strong consistency level.
   if (req->consistency_level() == YBConsistencyLevel::STRONG) {
     s = CheckPeerIsLeader(*tablet_peer.get(), &error_code);
-    if (PREDICT_FALSE(!s.ok())) {
-      SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
-      return false;
-    }
+  } else {
+    s = CheckPeerIsNotTooStale(*tablet_peer.get(), &error_code);
+  }
+  if (PREDICT_FALSE(!s.ok())) {
+    SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
+    return false;
   }
 
   shared_ptr<tablet::Tablet> ptr;
@@ -873,6 +1030,16 @@ bool TabletServiceImpl::GetTabletOrRespond(const ReadRequestPB* req,
     SetupErrorAndRespond(resp->mutable_error(), s, error_code, context);
     return false;
   }
+
+  // Once a split has started, the data of the tablet is served by the new tablets. The client
+  // looks them up and sends the read again.
+  if (ptr->splitting()) {
+    SetupErrorAndRespond(resp->mutable_error(),
+                         STATUS_FORMAT(IllegalState, "Tablet $0 has been split", req->tablet_id()),
+                         TabletServerErrorPB::TABLET_SPLIT, context);
+    return false;
+  }
+
   *tablet = ptr;
   return true;
 }
@@ -896,40 +1063,75 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
 
   Status s;
   tablet::ScopedReadOperation read_tx(tablet.get());
+  const HybridTime read_time = read_tx.GetReadTimestamp();
   switch (tablet->table_type()) {
     case TableType::REDIS_TABLE_TYPE: {
-      for (const RedisReadRequestPB& redis_read_req : req->redis_batch()) {
-        RedisResponsePB redis_response;
-        s = tablet->HandleRedisReadRequest(
-            read_tx.GetReadTimestamp(), redis_read_req, &redis_response);
+      const auto& redis_batch = req->redis_batch();
+      std::vector<RedisResponsePB> redis_responses(redis_batch.size());
+      // Several GETs of the batch are read together with a single iterator, the other requests are
+      // executed one by one.
+      std::vector<const RedisReadRequestPB*> gets;
+      std::vector<size_t> get_indexes;
+      std::vector<size_t> other_indexes;
+      for (int i = 0; i != redis_batch.size(); ++i) {
+        if (docdb::RedisReadOperation::IsBatchableGet(redis_batch.Get(i))) {
+          gets.push_back(&redis_batch.Get(i));
+          get_indexes.push_back(i);
+        } else {
+          other_indexes.push_back(i);
+        }
+      }
+      if (gets.size() > 1) {
+        std::vector<RedisResponsePB> get_responses;
+        s = tablet->HandleRedisGets(read_time, gets, &get_responses);
         RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
-        *(resp->add_redis_batch()) = redis_response;
+        for (size_t i = 0; i != get_indexes.size(); ++i) {
+          redis_responses[get_indexes[i]].Swap(&get_responses[i]);
+        }
+      } else {
+        other_indexes.insert(other_indexes.end(), get_indexes.begin(), get_indexes.end());
+      }
+      s = ExecuteReadBatch(other_indexes.size(), [&](size_t i) {
+        const size_t index = other_indexes[i];
+        return tablet->HandleRedisReadRequest(
+            read_time, redis_batch.Get(index), &redis_responses[index]);
+      });
+      RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
+      for (auto& redis_response : redis_responses) {
+        resp->add_redis_batch()->Swap(&redis_response);
       }
       break;
     }
     case TableType::YQL_TABLE_TYPE: {
-      for (const QLReadRequestPB& ql_read_req : req->ql_batch()) {
+      const auto& ql_batch = req->ql_batch();
+      std::vector<QLResponsePB> ql_responses(ql_batch.size());
+      std::vector<gscoped_ptr<faststring>> rows_data(ql_batch.size());
+      const auto& remote_address = context.remote_address();
+      const auto remote_host = remote_address.address().to_string();
+      TRACE("Start HandleQLReadRequest");
+      s = ExecuteReadBatch(ql_batch.size(), [&](size_t i) {
         // Update the remote endpoint.
-        const auto& remote_address = context.remote_address();
+        const QLReadRequestPB& ql_read_req = ql_batch.Get(i);
         HostPortPB *hostPortPB =
             const_cast<QLReadRequestPB&>(ql_read_req).mutable_remote_endpoint();
-        hostPortPB->set_host(remote_address.address().to_string());
+        hostPortPB->set_host(remote_host);
         hostPortPB->set_port(remote_address.port());
 
-        QLResponsePB ql_response;
-        gscoped_ptr<faststring> rows_data;
-        int rows_data_sidecar_idx = 0;
-        TRACE("Start HandleQLReadRequest");
-        s = tablet->HandleQLReadRequest(
-            read_tx.GetReadTimestamp(), ql_read_req, &ql_response, &rows_data);
-        TRACE("Done HandleQLReadRequest");
-        RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
-        if (rows_data.get() != nullptr) {
-          s = context.AddRpcSidecar(RefCntBuffer(*rows_data), &rows_data_sidecar_idx);
+        return tablet->HandleQLReadRequest(read_time, ql_read_req, &ql_responses[i], &rows_data[i]);
+      });
+      TRACE("Done HandleQLReadRequest");
+      RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
+      // Sidecars are attached sequentially, so that responses keep the order of the requests.
+      for (size_t i = 0; i != ql_responses.size(); ++i) {
+        QLResponsePB& ql_response = ql_responses[i];
+        if (rows_data[i].get() != nullptr) {
+          int rows_data_sidecar_idx = 0;
+          s = context.AddRpcSidecar(RefCntBuffer(std::move(*rows_data[i])),
+                                    &rows_data_sidecar_idx);
           RETURN_UNKNOWN_ERROR_IF_NOT_OK(s, resp, &context);
           ql_response.set_rows_data_sidecar(rows_data_sidecar_idx);
         }
-        *(resp->add_ql_batch()) = ql_response;
+        resp->add_ql_batch()->Swap(&ql_response);
       }
       break;
     }
@@ -941,6 +1143,7 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
       LOG(FATAL) << "Unknown table type: " << tablet->table_type();
       break;
   }
+  resp->set_hybrid_time(read_time.ToUint64());
   if (req->include_trace() && Trace::CurrentTrace() != nullptr) {
     resp->set_trace_buffer(Trace::CurrentTrace()->DumpToString(true));
   }
@@ -949,13 +1152,71 @@ void TabletServiceImpl::Read(const ReadRequestPB* req,
   TRACE("Done Read");
 }
 
+Status TabletServiceImpl::ExecuteReadBatch(size_t batch_size,
+                                           const std::function<Status(size_t)>& func) {
+  const size_t min_parallel_size = std::max(FLAGS_parallel_read_batch_min_size, 0);
+  if (!read_pool_ || min_parallel_size == 0 || batch_size < min_parallel_size) {
+    for (size_t i = 0; i != batch_size; ++i) {
+      RETURN_NOT_OK(func(i));
+    }
+    return Status::OK();
+  }
+
+  // Split the batch into chunks of at least min_parallel_size / 2 entries, so that the overhead of
+  // scheduling is amortized over several reads.
+  const size_t max_chunks = static_cast<size_t>(FLAGS_read_pool_max_threads) + 1;
+  const size_t chunk_size = std::max(
+      std::max<size_t>(min_parallel_size / 2, 1), (batch_size + max_chunks - 1) / max_chunks);
+  const size_t num_chunks = (batch_size + chunk_size - 1) / chunk_size;
+
+  std::vector<Status> statuses(num_chunks);
+  auto* trace = Trace::CurrentTrace();
+  auto run_chunk = [&func, &statuses, trace, chunk_size, batch_size](size_t chunk) {
+    ADOPT_TRACE(trace);
+    const size_t end = std::min(batch_size, (chunk + 1) * chunk_size);
+    for (size_t i = chunk * chunk_size; i != end; ++i) {
+      statuses[chunk] = func(i);
+      if (!statuses[chunk].ok()) {
+        break;
+      }
+    }
+  };
+
+  CountDownLatch latch(num_chunks - 1);
+  for (size_t chunk = 1; chunk != num_chunks; ++chunk) {
+    auto task = [&run_chunk, &latch, chunk] {
+      run_chunk(chunk);
+      latch.CountDown();
+    };
+    if (!read_pool_->SubmitFunc(task).ok()) {
+      // The pool is shutting down or overloaded, execute the chunk inline.
+      task();
+    }
+  }
+  run_chunk(0);
+  latch.Wait();
+
+  for (const auto& status : statuses) {
+    RETURN_NOT_OK(status);
+  }
+  return Status::OK();
+}
+
 ConsensusServiceImpl::ConsensusServiceImpl(const scoped_refptr<MetricEntity>& metric_entity,
                                            TabletPeerLookupIf* tablet_manager)
     : ConsensusServiceIf(metric_entity),
       tablet_manager_(tablet_manager) {
+  if (FLAGS_multi_raft_update_pool_max_threads > 0) {
+    CHECK_OK(ThreadPoolBuilder("multi-raft")
+                 .set_max_threads(FLAGS_multi_raft_update_pool_max_threads)
+                 .Build(&multi_raft_update_pool_));
+  }
 }
 
 ConsensusServiceImpl::~ConsensusServiceImpl() {
+  if (multi_raft_update_pool_) {
+    multi_raft_update_pool_->Shutdown();
+  }
 }
 
 void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
@@ -992,6 +1253,81 @@ void ConsensusServiceImpl::UpdateConsensus(const ConsensusRequestPB* req,
   context.RespondSuccess();
 }
 
+namespace {
+
+// The state of a MultiRaftUpdateConsensus call whose updates are applied in parallel.
+struct MultiRaftUpdateState {
+  MultiRaftUpdateState(rpc::RpcContext context_, int num_requests)
+      : context(std::move(context_)), remaining(num_requests) {}
+
+  rpc::RpcContext context;
+  // Number of updates that are not applied yet. The last one to be applied responds to the RPC.
+  std::atomic<int> remaining;
+};
+
+} // namespace
+
+void ConsensusServiceImpl::MultiRaftUpdateConsensus(const MultiRaftConsensusRequestPB* req,
+                                                    MultiRaftConsensusResponsePB* resp,
+                                                    rpc::RpcContext context) {
+  const int num_requests = req->consensus_request_size();
+  DVLOG(3) << "Received batch of " << num_requests << " consensus updates";
+  if (num_requests == 0) {
+    context.RespondSuccess();
+    return;
+  }
+  for (int i = 0; i < num_requests; ++i) {
+    resp->add_consensus_response();
+  }
+
+  // Each tablet is updated separately on the pool, so a tablet that blocks on its consensus lock
+  // does not hold up the heartbeats of the other tablets of the batch.
+  auto state = std::make_shared<MultiRaftUpdateState>(std::move(context), num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    auto update = [this, req, resp, state, i] {
+      // See UpdateConsensus() for why const_cast is used here.
+      UpdateConsensusInBatch(const_cast<ConsensusRequestPB*>(&req->consensus_request(i)),
+                             resp->mutable_consensus_response(i));
+      if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        state->context.RespondSuccess();
+      }
+    };
+    if (!multi_raft_update_pool_ || !multi_raft_update_pool_->SubmitFunc(update).ok()) {
+      update();
+    }
+  }
+}
+
+void ConsensusServiceImpl::UpdateConsensusInBatch(ConsensusRequestPB* req,
+                                                  ConsensusResponsePB* resp) {
+  TabletServerErrorPB::Code error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+  Status s;
+  if (req->has_dest_uuid()) {
+    s = CheckUuidMatch(tablet_manager_, "MultiRaftUpdateConsensus", req->dest_uuid(), &error_code);
+  }
+  scoped_refptr<TabletPeer> tablet_peer;
+  if (s.ok()) {
+    s = LookupTabletPeer(tablet_manager_, req->tablet_id(), &tablet_peer, &error_code);
+  }
+  scoped_refptr<Consensus> consensus;
+  if (s.ok()) {
+    consensus = tablet_peer->shared_consensus();
+    if (PREDICT_FALSE(!consensus)) {
+      error_code = TabletServerErrorPB::TABLET_NOT_RUNNING;
+      s = STATUS(ServiceUnavailable, "Consensus unavailable. Tablet not running");
+    }
+  }
+  if (s.ok()) {
+    error_code = TabletServerErrorPB::UNKNOWN_ERROR;
+    s = consensus->Update(req, resp);
+  }
+  if (PREDICT_FALSE(!s.ok())) {
+    resp->Clear();
+    StatusToPB(s, resp->mutable_error()->mutable_status());
+    resp->mutable_error()->set_code(error_code);
+  }
+}
+
 void ConsensusServiceImpl::RequestConsensusVote(const VoteRequestPB* req,
                                                 VoteResponsePB* resp,
                                                 rpc::RpcContext context) {
@@ -1304,13 +1640,13 @@ void TabletServiceImpl::Scan(const ScanRequestPB* req,
 
     // Add sidecar data to context and record the returned indices.
     int rows_idx;
-    CHECK_OK(context.AddRpcSidecar(RefCntBuffer(rows_data), &rows_idx));
+    CHECK_OK(context.AddRpcSidecar(RefCntBuffer(std::move(rows_data)), &rows_idx));
     resp->mutable_data()->set_rows_sidecar(rows_idx);
 
     // Add indirect data as a sidecar, if applicable.
     if (indirect_data.size() > 0) {
       int indirect_idx;
-      CHECK_OK(context.AddRpcSidecar(RefCntBuffer(indirect_data), &indirect_idx));
+      CHECK_OK(context.AddRpcSidecar(RefCntBuffer(std::move(indirect_data)), &indirect_idx));
       resp->mutable_data()->set_indirect_data_sidecar(indirect_idx);
     }
 
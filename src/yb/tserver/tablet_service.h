@@ -42,6 +42,7 @@
 #include "yb/tserver/tablet_server_interface.h"
 #include "yb/tserver/tserver_admin.service.h"
 #include "yb/tserver/tserver_service.service.h"
+#include "yb/util/threadpool.h"
 
 namespace yb {
 class RowwiseIterator;
@@ -66,6 +67,8 @@ class TabletServiceImpl : public TabletServerServiceIf {
  public:
   explicit TabletServiceImpl(TabletServerIf* server);
 
+  ~TabletServiceImpl();
+
   void Write(const WriteRequestPB* req, WriteResponsePB* resp, rpc::RpcContext context) override;
 
   void Read(const ReadRequestPB* req, ReadResponsePB* resp, rpc::RpcContext context) override;
@@ -147,12 +150,26 @@ class TabletServiceImpl : public TabletServerServiceIf {
   CHECKED_STATUS CheckPeerIsReady(const tablet::TabletPeer& tablet_peer,
                                   TabletServerErrorPB::Code* error_code);
 
+  // Check that a follower serving a non-strong read has heard from the leader recently enough to
+  // satisfy FLAGS_max_stale_read_bound_time_ms. Always succeeds on the leader.
+  CHECKED_STATUS CheckPeerIsNotTooStale(const tablet::TabletPeer& tablet_peer,
+                                        TabletServerErrorPB::Code* error_code);
+
   virtual bool GetTabletOrRespond(const ReadRequestPB* req,
                                   ReadResponsePB* resp,
                                   rpc::RpcContext* context,
                                   std::shared_ptr<tablet::AbstractTablet>* tablet);
 
+  // Invokes 'func' for every index in [0, batch_size). Large batches are split into chunks that
+  // are executed concurrently on read_pool_, with the calling thread processing the first chunk.
+  // Returns the first non-OK status in index order.
+  CHECKED_STATUS ExecuteReadBatch(size_t batch_size, const std::function<Status(size_t)>& func);
+
   TabletServerIf *const server_;
+
+  // Pool used to execute entries of large read batches in parallel. Null if parallel batch
+  // execution is disabled.
+  gscoped_ptr<ThreadPool> read_pool_;
 };
 
 class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
@@ -170,6 +187,10 @@ class TabletServiceAdminImpl : public TabletServerAdminServiceIf {
                            AlterSchemaResponsePB* resp,
                            rpc::RpcContext context) override;
 
+  virtual void SplitTablet(const SplitTabletRequestPB* req,
+                           SplitTabletResponsePB* resp,
+                           rpc::RpcContext context) override;
+
  private:
   TabletServer* server_;
 };
@@ -185,6 +206,10 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                consensus::ConsensusResponsePB *resp,
                                rpc::RpcContext context) override;
 
+  virtual void MultiRaftUpdateConsensus(const consensus::MultiRaftConsensusRequestPB *req,
+                                        consensus::MultiRaftConsensusResponsePB *resp,
+                                        rpc::RpcContext context) override;
+
   virtual void RequestConsensusVote(const consensus::VoteRequestPB* req,
                                     consensus::VoteResponsePB* resp,
                                     rpc::RpcContext context) override;
@@ -222,7 +247,16 @@ class ConsensusServiceImpl : public consensus::ConsensusServiceIf {
                                     rpc::RpcContext context) override;
 
  private:
+  // Applies a single request of a MultiRaftUpdateConsensus batch. Errors are reported in 'resp',
+  // as UpdateConsensus() would report them.
+  void UpdateConsensusInBatch(consensus::ConsensusRequestPB* req,
+                              consensus::ConsensusResponsePB* resp);
+
   TabletPeerLookupIf* tablet_manager_;
+
+  // Pool used to apply the updates of a MultiRaftUpdateConsensus batch in parallel. Null if they
+  // are applied on the RPC thread.
+  gscoped_ptr<ThreadPool> multi_raft_update_pool_;
 };
 
 }  // namespace tserver
@@ -42,12 +42,15 @@
 
 #include <glog/logging.h>
 #include "yb/rocksdb/memory_monitor.h"
+#include "yb/rocksdb/persistent_cache.h"
+#include "yb/rocksdb/rate_limiter.h"
 #include "yb/client/client.h"
 #include "yb/common/wire_protocol.h"
 #include "yb/consensus/consensus_meta.h"
 #include "yb/consensus/log.h"
 #include "yb/consensus/log_anchor_registry.h"
 #include "yb/consensus/metadata.pb.h"
+#include "yb/consensus/multi_raft_batcher.h"
 #include "yb/consensus/opid_util.h"
 #include "yb/consensus/quorum_util.h"
 #include "yb/fs/fs_manager.h"
@@ -60,6 +63,7 @@
 #include "yb/tablet/tablet.pb.h"
 #include "yb/tablet/tablet_bootstrap_if.h"
 #include "yb/tablet/tablet_metadata.h"
+#include "yb/tablet/tablet_metrics.h"
 #include "yb/tablet/tablet_peer.h"
 #include "yb/tablet/tablet_options.h"
 #include "yb/tserver/heartbeater.h"
@@ -146,6 +150,37 @@ DEFINE_int32(db_block_cache_size_percentage, 50,
              "Default percentage of total available memory to use as block cache size, if not "
              "asking for a raw number, through FLAGS_db_block_cache_size_bytes.");
 
+DEFINE_string(db_persistent_cache_path, "",
+              "Path of the file that holds the second tier of the cross-tablet shared RocksDB "
+              "block cache, which should be on a fast local device such as an SSD. Data blocks "
+              "that miss the block cache are looked up there before being read from the SST "
+              "files. Empty disables the persistent cache.");
+TAG_FLAG(db_persistent_cache_path, advanced);
+
+DEFINE_int64(db_persistent_cache_size_bytes, 0,
+             "Size of the file of the persistent block cache (in bytes). The file is "
+             "preallocated to this size on startup. Value of 0 disables the persistent cache.");
+TAG_FLAG(db_persistent_cache_size_bytes, advanced);
+
+DEFINE_bool(db_persistent_cache_compressed, true,
+            "Whether blocks are stored in the persistent block cache as they are in the SST "
+            "files, compressed if the SST files are compressed. Otherwise blocks are stored "
+            "uncompressed, which takes more space but saves decompressing them on every hit.");
+TAG_FLAG(db_persistent_cache_compressed, advanced);
+
+DEFINE_bool(schedule_rocksdb_compactions, false,
+            "Whether the RocksDB compactions of the tablets are started by the maintenance "
+            "manager, which runs first the ones of the tablets with the highest read "
+            "amplification, instead of by each RocksDB instance as soon as it needs one. See "
+            "also --rocksdb_max_scheduled_compactions.");
+TAG_FLAG(schedule_rocksdb_compactions, advanced);
+
+DEFINE_int64(rocksdb_shared_compact_flush_rate_limit_bytes_per_sec, 0,
+             "Write rate limit of the flushes and compactions of all tablets together. Value of "
+             "0 gives each RocksDB instance its own limit, see "
+             "--rocksdb_compact_flush_rate_limit_bytes_per_sec.");
+TAG_FLAG(rocksdb_shared_compact_flush_rate_limit_bytes_per_sec, advanced);
+
 DEFINE_int32(sleep_after_tombstoning_tablet_secs, 0,
              "Whether we sleep in LogAndTombstone after calling DeleteTabletData "
              "(For testing only!)");
@@ -162,6 +197,8 @@ DEFINE_int32(tserver_yb_client_default_timeout_ms, kTServerYbClientDefaultTimeou
              "Default timeout for the YBClient embedded into the tablet server that is used "
              "for distributed transactions.");
 
+DECLARE_uint64(transaction_participant_intents_buffer_max_bytes);
+
 namespace yb {
 namespace tserver {
 
@@ -186,6 +223,24 @@ METRIC_DEFINE_histogram(server, op_apply_run_time, "Operation Apply Run Time",
                         "that operations consist of very large batches.",
                         10000000, 2);
 
+METRIC_DEFINE_histogram(server, prepare_pool_queue_length, "Prepare Pool Queue Length",
+                        MetricUnit::kTasks,
+                        "Number of tablets waiting for a thread of the shared pool to prepare "
+                        "their operations.",
+                        10000, 2);
+
+METRIC_DEFINE_histogram(server, prepare_pool_queue_time, "Prepare Pool Queue Time",
+                        MetricUnit::kMicroseconds,
+                        "Time that tablets spent waiting for a thread of the shared pool to "
+                        "prepare their operations.",
+                        10000000, 2);
+
+METRIC_DEFINE_histogram(server, prepare_pool_run_time, "Prepare Pool Run Time",
+                        MetricUnit::kMicroseconds,
+                        "Time that the shared pool spent preparing and submitting for replication "
+                        "a run of operations of a tablet.",
+                        10000000, 2);
+
 using consensus::ConsensusMetadata;
 using consensus::ConsensusStatePB;
 using consensus::OpId;
@@ -193,6 +248,8 @@ using consensus::RaftConfigPB;
 using consensus::RaftPeerPB;
 using consensus::StartRemoteBootstrapRequestPB;
 using log::Log;
+using log::LogEntryPB;
+using log::LogOptions;
 using master::ReportedTabletPB;
 using master::TabletReportPB;
 using std::shared_ptr;
@@ -260,6 +317,15 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
   apply_pool_->SetRunTimeMicrosHistogram(
       METRIC_op_apply_run_time.Instantiate(server_->metric_entity()));
 
+  // Prepare queues of all tablets share this pool, instead of a thread per tablet.
+  CHECK_OK(ThreadPoolBuilder("prepare").Build(&prepare_pool_));
+  prepare_pool_->SetQueueLengthHistogram(
+      METRIC_prepare_pool_queue_length.Instantiate(server_->metric_entity()));
+  prepare_pool_->SetQueueTimeMicrosHistogram(
+      METRIC_prepare_pool_queue_time.Instantiate(server_->metric_entity()));
+  prepare_pool_->SetRunTimeMicrosHistogram(
+      METRIC_prepare_pool_run_time.Instantiate(server_->metric_entity()));
+
   {
     // TODO(dtxn): make this client initialization asynchronous and don't delay tserver startup.
     client::YBClientBuilder client_builder;
@@ -291,6 +357,31 @@ TSTabletManager::TSTabletManager(FsManager* fs_manager,
     tablet_options_.block_cache->SetMetrics(server_->metric_entity());
   }
 
+  if (!FLAGS_db_persistent_cache_path.empty() && FLAGS_db_persistent_cache_size_bytes > 0) {
+    rocksdb::PersistentCacheOptions persistent_cache_options;
+    persistent_cache_options.path = FLAGS_db_persistent_cache_path;
+    persistent_cache_options.capacity = FLAGS_db_persistent_cache_size_bytes;
+    persistent_cache_options.compressed = FLAGS_db_persistent_cache_compressed;
+    Status s = rocksdb::NewPersistentCache(persistent_cache_options,
+                                           &tablet_options_.persistent_cache);
+    if (s.ok()) {
+      tablet_options_.persistent_cache->SetMetrics(server_->metric_entity());
+    } else {
+      LOG(WARNING) << "Failed to create persistent block cache at "
+                   << FLAGS_db_persistent_cache_path << ": " << s.ToString();
+    }
+  }
+
+  tablet_options_.schedule_compactions = FLAGS_schedule_rocksdb_compactions;
+  tablet_options_.intents_buffer_mem_tracker = MemTracker::CreateTracker(
+      static_cast<int64_t>(FLAGS_transaction_participant_intents_buffer_max_bytes),
+      "IntentsBuffer",
+      server_->mem_tracker());
+  if (FLAGS_rocksdb_shared_compact_flush_rate_limit_bytes_per_sec > 0) {
+    tablet_options_.rate_limiter.reset(rocksdb::NewGenericRateLimiter(
+        FLAGS_rocksdb_shared_compact_flush_rate_limit_bytes_per_sec));
+  }
+
   // Calculate memstore_size_bytes
   bool should_count_memory = FLAGS_global_memstore_size_percentage > 0;
   CHECK(FLAGS_global_memstore_size_percentage > 0 && FLAGS_global_memstore_size_percentage <= 100)
@@ -337,6 +428,8 @@ Status TSTabletManager::Init() {
                 .set_max_threads(max_bootstrap_threads)
                 .Build(&open_tablet_pool_));
 
+  multi_raft_manager_ = std::make_unique<consensus::MultiRaftManager>(server_->messenger());
+
   // Search for tablets in the metadata dir.
   vector<string> tablet_ids;
   RETURN_NOT_OK(fs_manager_->ListTabletIds(&tablet_ids));
@@ -501,6 +594,171 @@ string LogPrefix(const string& tablet_id, const string& uuid) {
   return "T " + tablet_id + " P " + uuid + ": ";
 }
 
+Status TSTabletManager::ApplyTabletSplit(tablet::SplitOperationState* state) {
+  const auto& request = *state->request();
+  const auto& partition = state->tablet()->metadata()->partition();
+  Status s = CreateSplitTablet(state, request.new_tablet1_id(),
+                               partition.partition_key_start(),
+                               request.split_partition_key());
+  if (s.ok()) {
+    s = CreateSplitTablet(state, request.new_tablet2_id(),
+                          request.split_partition_key(),
+                          partition.partition_key_end());
+  }
+
+  std::lock_guard<rw_spinlock> lock(lock_);
+  if (s.ok()) {
+    failed_tablet_splits_.erase(request.tablet_id());
+    return Status::OK();
+  }
+  // Keep what is needed to retry the split when the master asks for it again.
+  auto& failed_split = failed_tablet_splits_[request.tablet_id()];
+  failed_split.request = request;
+  failed_split.op_id = state->op_id();
+  failed_split.hybrid_time = state->hybrid_time();
+  failed_split.raft_config = state->raft_config();
+  return s;
+}
+
+Status TSTabletManager::CheckTabletSplit(tablet::Tablet* tablet,
+                                         const SplitTabletRequestPB& request) {
+  FailedTabletSplit failed_split;
+  {
+    boost::shared_lock<rw_spinlock> shared_lock(lock_);
+    scoped_refptr<TabletPeer> junk;
+    if (LookupTabletUnlocked(request.new_tablet1_id(), &junk) &&
+        LookupTabletUnlocked(request.new_tablet2_id(), &junk)) {
+      return Status::OK();
+    }
+    auto it = failed_tablet_splits_.find(request.tablet_id());
+    if (it == failed_tablet_splits_.end()) {
+      return STATUS_FORMAT(IllegalState, "Split of tablet $0 is not applied yet",
+                           request.tablet_id());
+    }
+    failed_split = it->second;
+  }
+
+  LOG(INFO) << LogPrefix(request.tablet_id(), fs_manager_->uuid()) << "Retrying tablet split";
+  tablet::SplitOperationState state(nullptr, tablet, &failed_split.request);
+  state.mutable_op_id()->CopyFrom(failed_split.op_id);
+  state.set_hybrid_time(failed_split.hybrid_time);
+  state.set_raft_config(failed_split.raft_config);
+  return ApplyTabletSplit(&state);
+}
+
+Status TSTabletManager::CreateSplitTablet(tablet::SplitOperationState* state,
+                                          const string& tablet_id,
+                                          const string& partition_key_start,
+                                          const string& partition_key_end) {
+  scoped_refptr<TransitionInProgressDeleter> deleter;
+  {
+    std::lock_guard<rw_spinlock> lock(lock_);
+    scoped_refptr<TabletPeer> junk;
+    if (LookupTabletUnlocked(tablet_id, &junk) ||
+        fs_manager_->env()->FileExists(fs_manager_->GetTabletMetadataPath(tablet_id))) {
+      // The split was already applied before a restart, or the tablet has been remotely
+      // bootstrapped from its leader.
+      LOG(INFO) << LogPrefix(tablet_id, fs_manager_->uuid()) << "Split tablet already exists";
+      return Status::OK();
+    }
+    RETURN_NOT_OK(StartTabletStateTransitionUnlocked(tablet_id, "splitting tablet", &deleter));
+  }
+
+  const auto& parent_meta = *state->tablet()->metadata();
+  PartitionPB partition_pb;
+  parent_meta.partition().ToPB(&partition_pb);
+  partition_pb.set_partition_key_start(partition_key_start);
+  partition_pb.set_partition_key_end(partition_key_end);
+  Partition partition;
+  Partition::FromPB(partition_pb, &partition);
+
+  // The tablet is created in the copying state, so that it is tombstoned on startup if the server
+  // crashes before all of its data is in place.
+  scoped_refptr<TabletMetadata> meta;
+  string data_root_dir;
+  string wal_root_dir;
+  GetAndRegisterDataAndWalDir(fs_manager_, parent_meta.table_id(), tablet_id,
+                              parent_meta.table_type(), &data_root_dir, &wal_root_dir);
+  Status create_status = TabletMetadata::CreateNew(fs_manager_,
+                                                   parent_meta.table_id(),
+                                                   tablet_id,
+                                                   parent_meta.table_name(),
+                                                   parent_meta.table_type(),
+                                                   parent_meta.schema(),
+                                                   parent_meta.partition_schema(),
+                                                   partition,
+                                                   TABLET_DATA_COPYING,
+                                                   &meta,
+                                                   data_root_dir,
+                                                   wal_root_dir);
+  if (!create_status.ok()) {
+    UnregisterDataWalDir(parent_meta.table_id(), tablet_id, parent_meta.table_type(),
+                         data_root_dir, wal_root_dir);
+  }
+  RETURN_NOT_OK_PREPEND(create_status, "Couldn't create split tablet metadata");
+
+  Status data_status = CreateSplitTabletData(state, meta);
+  if (!data_status.ok()) {
+    // Remove what was created so far, so that the split can be retried.
+    const string kLogPrefix = LogPrefix(tablet_id, fs_manager_->uuid());
+    WARN_NOT_OK(meta->DeleteTabletData(TABLET_DATA_DELETED, boost::none),
+                kLogPrefix + "Couldn't delete split tablet data");
+    WARN_NOT_OK(Log::DeleteOnDiskData(fs_manager_, tablet_id, meta->wal_dir()),
+                kLogPrefix + "Couldn't delete split tablet log");
+    WARN_NOT_OK(ConsensusMetadata::DeleteOnDiskData(fs_manager_, tablet_id),
+                kLogPrefix + "Couldn't delete split tablet consensus metadata");
+    WARN_NOT_OK(meta->DeleteSuperBlock(), kLogPrefix + "Couldn't delete split tablet metadata");
+    UnregisterDataWalDir(parent_meta.table_id(), tablet_id, parent_meta.table_type(),
+                         data_root_dir, wal_root_dir);
+    return data_status;
+  }
+
+  meta->set_tablet_data_state(TABLET_DATA_READY);
+  RETURN_NOT_OK(meta->Flush());
+  LOG(INFO) << LogPrefix(tablet_id, fs_manager_->uuid()) << "Created tablet split from "
+            << parent_meta.tablet_id() << " with partition " << partition_pb.ShortDebugString();
+
+  CreateAndRegisterTabletPeer(meta, NEW_PEER);
+  return open_tablet_pool_->SubmitFunc(
+      std::bind(&TSTabletManager::OpenTablet, this, meta, deleter));
+}
+
+Status TSTabletManager::CreateSplitTabletData(tablet::SplitOperationState* state,
+                                              const scoped_refptr<TabletMetadata>& meta) {
+  const string& tablet_id = meta->tablet_id();
+  RETURN_NOT_OK_PREPEND(state->tablet()->CreateSplitCheckpoint(meta->rocksdb_dir()),
+                        "Couldn't create split tablet data");
+
+  // The new tablet starts in the term of the split operation, with the configuration of the split
+  // tablet.
+  const auto& op_id = state->op_id();
+  gscoped_ptr<ConsensusMetadata> cmeta;
+  RETURN_NOT_OK_PREPEND(ConsensusMetadata::Create(fs_manager_, tablet_id, fs_manager_->uuid(),
+                                                  state->raft_config(), op_id.term(), &cmeta),
+                        "Unable to create new ConsensusMeta for tablet " + tablet_id);
+
+  // The log of the new tablet starts with the committed split operation, so that the indexes of
+  // its operations follow the ones of the split tablet that are flushed to its data.
+  {
+    scoped_refptr<Log> log;
+    RETURN_NOT_OK(Log::Open(LogOptions(), fs_manager_, tablet_id, meta->wal_dir(),
+                            meta->schema(), meta->schema_version(),
+                            scoped_refptr<MetricEntity>(), &log));
+    LogEntryPB entry;
+    entry.set_type(log::REPLICATE);
+    auto* replicate = entry.mutable_replicate();
+    replicate->mutable_id()->CopyFrom(op_id);
+    replicate->mutable_committed_op_id()->CopyFrom(op_id);
+    replicate->set_hybrid_time(state->hybrid_time().ToUint64());
+    replicate->set_op_type(consensus::SPLIT_OP);
+    *replicate->mutable_split_request() = *state->request();
+    Status append_status = log->Append(&entry);
+    RETURN_NOT_OK(log->Close());
+    RETURN_NOT_OK_PREPEND(append_status, "Couldn't write split tablet log");
+  }
+  return Status::OK();
+}
+
 Status CheckLeaderTermNotLower(
     const string& tablet_id,
     const string& uuid,
@@ -676,6 +934,7 @@ scoped_refptr<TabletPeer> TSTabletManager::CreateAndRegisterTabletPeer(
       new TabletPeerClass(meta,
                           local_peer_pb_,
                           apply_pool_.get(),
+                          prepare_pool_.get(),
                           Bind(&TSTabletManager::ApplyChange,
                                Unretained(this),
                                meta->tablet_id())));
@@ -746,6 +1005,7 @@ Status TSTabletManager::DeleteTablet(
   }
 
   scoped_refptr<TabletMetadata> meta = tablet_peer->tablet_metadata();
+  const bool split = tablet_peer->tablet() != nullptr && tablet_peer->tablet()->splitting();
   tablet_peer->Shutdown();
 
   boost::optional<OpId> opt_last_logged_opid;
@@ -775,6 +1035,10 @@ Status TSTabletManager::DeleteTablet(
     std::lock_guard<rw_spinlock> lock(lock_);
     RETURN_NOT_OK(CheckRunningUnlocked(error_code));
     CHECK_EQ(1, tablet_map_.erase(tablet_id)) << tablet_id;
+    if (split) {
+      deleted_split_tablets_.insert(tablet_id);
+      failed_tablet_splits_.erase(tablet_id);
+    }
     UnregisterDataWalDir(meta->table_id(),
                          tablet_id,
                          meta->table_type(),
@@ -859,7 +1123,8 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
         tablet_peer->log_anchor_registry(),
         tablet_options_,
         tablet_peer.get(),
-        tablet_peer.get()};
+        tablet_peer.get(),
+        this /* tablet_splitter */};
     s = BootstrapTablet(data, &tablet, &log, &bootstrap_info);
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to bootstrap: "
@@ -877,7 +1142,9 @@ void TSTabletManager::OpenTablet(const scoped_refptr<TabletMetadata>& meta,
                            scoped_refptr<server::Clock>(server_->clock()),
                            server_->messenger(),
                            log,
-                           tablet->GetMetricEntity());
+                           tablet->GetMetricEntity(),
+                           multi_raft_manager_.get(),
+                           this /* tablet_splitter */);
 
     if (!s.ok()) {
       LOG(ERROR) << kLogPrefix << "Tablet failed to init: "
@@ -950,8 +1217,9 @@ void TSTabletManager::Shutdown() {
     peer->Shutdown();
   }
 
-  // Shut down the apply pool.
+  // Shut down the apply and prepare pools.
   apply_pool_->Shutdown();
+  prepare_pool_->Shutdown();
 
   {
     std::lock_guard<rw_spinlock> l(lock_);
@@ -1013,6 +1281,11 @@ Status TSTabletManager::GetTabletPeer(const string& tablet_id,
   return Status::OK();
 }
 
+bool TSTabletManager::IsDeletedSplitTablet(const std::string& tablet_id) const {
+  boost::shared_lock<rw_spinlock> shared_lock(lock_);
+  return deleted_split_tablets_.count(tablet_id) != 0;
+}
+
 const NodeInstancePB& TSTabletManager::NodeInstance() const {
   return server_->instance_pb();
 }
@@ -1054,6 +1327,48 @@ int TSTabletManager::GetNumLiveTablets() const {
   return count;
 }
 
+void TSTabletManager::GenerateTabletLoads(
+    google::protobuf::RepeatedPtrField<master::TabletLoadPB>* tablet_loads) {
+  vector<scoped_refptr<TabletPeer>> peers;
+  GetTabletPeers(&peers);
+
+  const MonoTime now = MonoTime::FineNow();
+  const double elapsed_secs = last_tablet_loads_time_.Initialized() ?
+      now.GetDeltaSince(last_tablet_loads_time_).ToSeconds() : 0;
+  std::unordered_map<std::string, TabletOpCounts> op_counts;
+  for (const scoped_refptr<TabletPeer>& peer : peers) {
+    shared_ptr<TabletClass> tablet = peer->shared_tablet();
+    if (peer->state() != tablet::RUNNING || !tablet) {
+      continue;
+    }
+    master::TabletLoadPB* load = tablet_loads->Add();
+    load->set_tablet_id(peer->tablet_id());
+    load->set_sst_files_size(tablet->SstFilesSize());
+    load->set_memtables_size(tablet->MemTablesSize());
+
+    const tablet::TabletMetrics* metrics = tablet->metrics();
+    if (metrics == nullptr) {
+      continue;
+    }
+    const TabletOpCounts counts = {
+      metrics->ql_read_latency->TotalCount() + metrics->redis_read_latency->TotalCount(),
+      metrics->write_op_duration_client_propagated_consistency->TotalCount() +
+          metrics->write_op_duration_commit_wait_consistency->TotalCount()
+    };
+    op_counts.emplace(peer->tablet_id(), counts);
+
+    // The counts start over when the tablet is reopened.
+    auto it = last_tablet_op_counts_.find(peer->tablet_id());
+    if (elapsed_secs > 0 && it != last_tablet_op_counts_.end() &&
+        counts.reads >= it->second.reads && counts.writes >= it->second.writes) {
+      load->set_read_ops_per_sec((counts.reads - it->second.reads) / elapsed_secs);
+      load->set_write_ops_per_sec((counts.writes - it->second.writes) / elapsed_secs);
+    }
+  }
+  last_tablet_op_counts_.swap(op_counts);
+  last_tablet_loads_time_ = now;
+}
+
 void TSTabletManager::MarkDirtyUnlocked(const std::string& tablet_id,
                                         std::shared_ptr<consensus::StateChangeContext> context) {
   TabletReportState* state = FindOrNull(dirty_tablets_, tablet_id);
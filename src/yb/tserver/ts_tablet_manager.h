@@ -54,9 +54,11 @@
 #include "yb/tserver/tserver_admin.pb.h"
 #include "yb/util/locks.h"
 #include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
 #include "yb/util/status.h"
 #include "yb/util/threadpool.h"
 #include "yb/tablet/tablet_options.h"
+#include "yb/tablet/operations/split_operation.h"
 
 namespace yb {
 
@@ -68,11 +70,13 @@ class Schema;
 class BackgroundTask;
 
 namespace consensus {
+class MultiRaftManager;
 class RaftConfigPB;
 } // namespace consensus
 
 namespace master {
 class ReportedTabletPB;
+class TabletLoadPB;
 class TabletReportPB;
 } // namespace master
 
@@ -123,7 +127,7 @@ class TransitionInProgressDeleter;
 // TODO: will also be responsible for keeping the local metadata about
 // which tablets are hosted on this server persistent on disk, as well
 // as re-opening all the tablets at startup, etc.
-class TSTabletManager : public tserver::TabletPeerLookupIf {
+class TSTabletManager : public tserver::TabletPeerLookupIf, public tablet::TabletSplitter {
  public:
   // Construct the tablet manager.
   // 'fs_manager' must remain valid until this object is destructed.
@@ -165,6 +169,17 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
     consensus::RaftConfigPB config,
     scoped_refptr<tablet::TabletPeer> *tablet_peer);
 
+  // Create the two tablets that replace the tablet being split by the given operation, register
+  // them and open them. New tablets that already exist on this server are skipped.
+  CHECKED_STATUS ApplyTabletSplit(tablet::SplitOperationState* state) override;
+
+  // Check that the split of the given tablet, which has already been started, has created both new
+  // tablets on this server. A split whose new tablets could not be created when it was applied is
+  // retried. Returns IllegalState if the split operation has not been applied yet.
+  CHECKED_STATUS CheckTabletSplit(tablet::Tablet* tablet, const SplitTabletRequestPB& request);
+
+  bool IsDeletedSplitTablet(const std::string& tablet_id) const override;
+
   // Delete the specified tablet.
   // 'delete_type' must be one of TABLET_DATA_DELETED or TABLET_DATA_TOMBSTONED
   // or else returns Status::IllegalArgument.
@@ -220,6 +235,11 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // tablets which have not changed since the acknowledged report.
   void MarkTabletReportAcknowledged(const master::TabletReportPB& report);
 
+  // Generate the load of the running tablets, with the rates of operations computed since the
+  // previous call. This is not safe to call from multiple threads at the same time.
+  void GenerateTabletLoads(
+      google::protobuf::RepeatedPtrField<master::TabletLoadPB>* tablet_loads);
+
   // Get all of the tablets currently hosted on this server.
   void GetTabletPeers(std::vector<scoped_refptr<tablet::TabletPeer> >* tablet_peers) const;
 
@@ -304,6 +324,17 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // transition by some other operation.
   // On success, returns OK and populates 'deleter' with an object that removes
   // the map entry on destruction.
+  // Create the replica of a tablet split from another one, starting with a checkpoint of the data
+  // of the split tablet and a log that contains the split operation.
+  CHECKED_STATUS CreateSplitTablet(tablet::SplitOperationState* state,
+                                   const std::string& tablet_id,
+                                   const std::string& partition_key_start,
+                                   const std::string& partition_key_end);
+
+  // Write the data, consensus metadata and log of a new tablet of a split.
+  CHECKED_STATUS CreateSplitTabletData(tablet::SplitOperationState* state,
+                                       const scoped_refptr<tablet::TabletMetadata>& meta);
+
   CHECKED_STATUS StartTabletStateTransitionUnlocked(const std::string& tablet_id,
                                             const std::string& reason,
                                             scoped_refptr<TransitionInProgressDeleter>* deleter);
@@ -418,6 +449,28 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Next tablet report seqno.
   int32_t next_report_seq_;
 
+  // Split operations that were applied without creating both new tablets, keyed by the id of the
+  // split tablet. Protected by lock_.
+  struct FailedTabletSplit {
+    SplitTabletRequestPB request;
+    consensus::OpId op_id;
+    HybridTime hybrid_time;
+    consensus::RaftConfigPB raft_config;
+  };
+  std::unordered_map<std::string, FailedTabletSplit> failed_tablet_splits_;
+
+  // Ids of the tablets deleted after being split since this server started. Protected by lock_.
+  std::unordered_set<std::string> deleted_split_tablets_;
+
+  // The numbers of read and write operations served by each tablet as of the last call to
+  // GenerateTabletLoads(), and the time of that call.
+  struct TabletOpCounts {
+    uint64_t reads;
+    uint64_t writes;
+  };
+  std::unordered_map<std::string, TabletOpCounts> last_tablet_op_counts_;
+  MonoTime last_tablet_loads_time_;
+
   MetricRegistry* metric_registry_;
 
   TSTabletManagerStatePB state_;
@@ -428,6 +481,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
   // Thread pool for apply transactions, shared between all tablets.
   gscoped_ptr<ThreadPool> apply_pool_;
 
+  // Thread pool shared by the prepare queues of the tablets, see tablet::PrepareThread.
+  gscoped_ptr<ThreadPool> prepare_pool_;
+
   // Used for scheduling flushes
   std::unique_ptr<BackgroundTask> background_task_;
 
@@ -436,6 +492,9 @@ class TSTabletManager : public tserver::TabletPeerLookupIf {
 
   client::YBClientPtr client_;
 
+  // Batches Raft heartbeats of all tablets sent to the same tablet server.
+  std::unique_ptr<consensus::MultiRaftManager> multi_raft_manager_;
+
   DISALLOW_COPY_AND_ASSIGN(TSTabletManager);
 };
 
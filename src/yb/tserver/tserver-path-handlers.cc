@@ -563,20 +563,38 @@ void TabletServerPathHandlers::HandleMaintenanceManagerPage(const Webserver::Web
   }
   *output << "</table>\n";
 
+  // List the runnable operations first, by decreasing perf improvement, which is the order in
+  // which operations that don't free memory or logs, such as compactions, are scheduled.
+  std::vector<const MaintenanceManagerStatusPB_MaintenanceOpPB*> waiting_ops;
+  for (int i = 0; i < ops_count; i++) {
+    const MaintenanceManagerStatusPB_MaintenanceOpPB& op_pb = pb.registered_operations(i);
+    if (op_pb.running() == 0) {
+      waiting_ops.push_back(&op_pb);
+    }
+  }
+  std::stable_sort(waiting_ops.begin(), waiting_ops.end(),
+                   [](const MaintenanceManagerStatusPB_MaintenanceOpPB* lhs,
+                      const MaintenanceManagerStatusPB_MaintenanceOpPB* rhs) {
+    if (lhs->runnable() != rhs->runnable()) {
+      return lhs->runnable();
+    }
+    return lhs->perf_improvement() > rhs->perf_improvement();
+  });
+
   *output << "<h3>Non-running operations</h3>\n";
+  if (pb.has_best_op()) {
+    *output << "<p>Next operation: " << EscapeForHtmlToString(pb.best_op().name()) << "</p>\n";
+  }
   *output << "<table class='table table-striped'>\n";
   *output << "  <tr><th>Name</th><th>Runnable</th><th>RAM anchored</th>\n"
           << "       <th>Logs retained</th><th>Perf</th></tr>\n";
-  for (int i = 0; i < ops_count; i++) {
-    MaintenanceManagerStatusPB_MaintenanceOpPB op_pb = pb.registered_operations(i);
-    if (op_pb.running() == 0) {
-      *output << Substitute("<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td></tr>\n",
-                            EscapeForHtmlToString(op_pb.name()),
-                            op_pb.runnable(),
-                            HumanReadableNumBytes::ToString(op_pb.ram_anchored_bytes()),
-                            HumanReadableNumBytes::ToString(op_pb.logs_retained_bytes()),
-                            op_pb.perf_improvement());
-    }
+  for (const MaintenanceManagerStatusPB_MaintenanceOpPB* op_pb : waiting_ops) {
+    *output << Substitute("<tr><td>$0</td><td>$1</td><td>$2</td><td>$3</td><td>$4</td></tr>\n",
+                          EscapeForHtmlToString(op_pb->name()),
+                          op_pb->runnable(),
+                          HumanReadableNumBytes::ToString(op_pb->ram_anchored_bytes()),
+                          HumanReadableNumBytes::ToString(op_pb->logs_retained_bytes()),
+                          op_pb->perf_improvement());
   }
   *output << "</table>\n";
 }
@@ -49,6 +49,13 @@ Status ServerOperator() {
   return STATUS(RuntimeError, "Only tablet servers can execute this builtin call");
 }
 
+// ServerOperator that takes no argument and has a return value.
+template<typename PTypePtr, typename RTypePtr>
+Status ServerOperator(RTypePtr result) {
+  LOG(ERROR) << "Only tablet servers can execute this builtin call";
+  return STATUS(RuntimeError, "Only tablet servers can execute this builtin call");
+}
+
 // ServerOperator that takes 1 argument and has a return value.
 template<typename PTypePtr, typename RTypePtr>
 Status ServerOperator(PTypePtr arg1, RTypePtr result) {
@@ -213,30 +213,32 @@ const vector<BFDecl> kBFDirectory = {
 
   // Aggregate functions.
   // - Have TSERVER_OPCODE to instruct tablet server how to execute these calls.
+  // - COUNT without argument is COUNT(*).
   // - SUM and AVG only take numeric arguments.
   // - MIN and MAX can take arguments of any types.
-  { "ServerOperator", "count", INT64, {ANYTYPE}, TSOpcode::kCount, false },
-
-  { "ServerOperator", "sum", INT8, {INT8}, TSOpcode::kSum, false },
-  { "ServerOperator", "sum", INT16, {INT16}, TSOpcode::kSum, false },
-  { "ServerOperator", "sum", INT32, {INT32}, TSOpcode::kSum, false },
-  { "ServerOperator", "sum", INT64, {INT64}, TSOpcode::kSum, false },
-  { "ServerOperator", "sum", FLOAT, {FLOAT}, TSOpcode::kSum, false },
-  { "ServerOperator", "sum", DOUBLE, {DOUBLE}, TSOpcode::kSum, false },
+  { "ServerOperator", "count", INT64, {}, TSOpcode::kCount },
+  { "ServerOperator", "count", INT64, {ANYTYPE}, TSOpcode::kCount },
+
+  { "ServerOperator", "sum", INT8, {INT8}, TSOpcode::kSum },
+  { "ServerOperator", "sum", INT16, {INT16}, TSOpcode::kSum },
+  { "ServerOperator", "sum", INT32, {INT32}, TSOpcode::kSum },
+  { "ServerOperator", "sum", INT64, {INT64}, TSOpcode::kSum },
+  { "ServerOperator", "sum", FLOAT, {FLOAT}, TSOpcode::kSum },
+  { "ServerOperator", "sum", DOUBLE, {DOUBLE}, TSOpcode::kSum },
   { "ServerOperator", "sum", VARINT, {VARINT}, TSOpcode::kSum, false },
   { "ServerOperator", "sum", DECIMAL, {DECIMAL}, TSOpcode::kSum, false },
 
-  { "ServerOperator", "avg", INT8, {INT8}, TSOpcode::kAvg, false },
-  { "ServerOperator", "avg", INT16, {INT16}, TSOpcode::kAvg, false },
-  { "ServerOperator", "avg", INT32, {INT32}, TSOpcode::kAvg, false },
-  { "ServerOperator", "avg", INT64, {INT64}, TSOpcode::kAvg, false },
-  { "ServerOperator", "avg", FLOAT, {FLOAT}, TSOpcode::kAvg, false },
-  { "ServerOperator", "avg", DOUBLE, {DOUBLE}, TSOpcode::kAvg, false },
+  { "ServerOperator", "avg", INT8, {INT8}, TSOpcode::kAvg },
+  { "ServerOperator", "avg", INT16, {INT16}, TSOpcode::kAvg },
+  { "ServerOperator", "avg", INT32, {INT32}, TSOpcode::kAvg },
+  { "ServerOperator", "avg", INT64, {INT64}, TSOpcode::kAvg },
+  { "ServerOperator", "avg", FLOAT, {FLOAT}, TSOpcode::kAvg },
+  { "ServerOperator", "avg", DOUBLE, {DOUBLE}, TSOpcode::kAvg },
   { "ServerOperator", "avg", VARINT, {VARINT}, TSOpcode::kAvg, false },
   { "ServerOperator", "avg", DECIMAL, {DECIMAL}, TSOpcode::kAvg, false },
 
-  { "ServerOperator", "min", ANYTYPE, {ANYTYPE}, TSOpcode::kMin, false },
-  { "ServerOperator", "max", ANYTYPE, {ANYTYPE}, TSOpcode::kMax, false },
+  { "ServerOperator", "min", ANYTYPE, {ANYTYPE}, TSOpcode::kMin },
+  { "ServerOperator", "max", ANYTYPE, {ANYTYPE}, TSOpcode::kMax },
 };
 
 } // namespace bfql
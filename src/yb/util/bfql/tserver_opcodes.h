@@ -32,6 +32,12 @@ enum class TSOpcode : int32_t {
   kMax,
 };
 
+// Is the opcode one of an aggregate function, which is evaluated across rows?
+inline bool IsAggregateOpcode(TSOpcode tsopcode) {
+  return tsopcode == TSOpcode::kCount || tsopcode == TSOpcode::kSum ||
+         tsopcode == TSOpcode::kAvg || tsopcode == TSOpcode::kMin || tsopcode == TSOpcode::kMax;
+}
+
 } // namespace bfql
 } // namespace yb
 
@@ -34,8 +34,6 @@
 
 #include <glog/logging.h>
 
-#include "yb/gutil/gscoped_ptr.h"
-
 namespace yb {
 
 void faststring::GrowByAtLeast(size_t count) {
@@ -53,18 +51,18 @@ void faststring::GrowByAtLeast(size_t count) {
 
 void faststring::GrowArray(size_t newcapacity) {
   DCHECK_GE(newcapacity, capacity_);
-  gscoped_array<uint8_t> newdata(new uint8_t[newcapacity]);
+  uint8_t* newdata = AllocateHeapArray(newcapacity);
   if (len_ > 0) {
-    memcpy(&newdata[0], &data_[0], len_);
+    memcpy(newdata, &data_[0], len_);
   }
   capacity_ = newcapacity;
   if (data_ != initial_data_) {
-    delete[] data_;
+    FreeHeapArray(data_);
   } else {
     ASAN_POISON_MEMORY_REGION(initial_data_, arraysize(initial_data_));
   }
 
-  data_ = newdata.release();
+  data_ = newdata;
   ASAN_POISON_MEMORY_REGION(data_ + len_, capacity_ - len_);
 }
 
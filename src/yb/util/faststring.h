@@ -37,6 +37,7 @@
 #include "yb/gutil/dynamic_annotations.h"
 #include "yb/gutil/macros.h"
 #include "yb/gutil/strings/fastmem.h"
+#include "yb/util/ref_cnt_buffer.h"
 
 namespace yb {
 
@@ -57,7 +58,7 @@ class faststring {
       len_(0),
       capacity_(kInitialCapacity) {
     if (capacity > capacity_) {
-      data_ = new uint8_t[capacity];
+      data_ = AllocateHeapArray(capacity);
       capacity_ = capacity;
     }
     ASAN_POISON_MEMORY_REGION(data_, capacity_);
@@ -66,7 +67,7 @@ class faststring {
   ~faststring() {
     ASAN_UNPOISON_MEMORY_REGION(initial_data_, arraysize(initial_data_));
     if (data_ != initial_data_) {
-      delete[] data_;
+      FreeHeapArray(data_);
     }
   }
 
@@ -96,10 +97,12 @@ class faststring {
   //
   // NOTE: the data pointer returned by release() is not necessarily the pointer
   uint8_t *release() WARN_UNUSED_RESULT {
-    uint8_t *ret = data_;
-    if (ret == initial_data_) {
-      ret = new uint8_t[len_];
-      memcpy(ret, data_, len_);
+    // The heap array is allocated together with a RefCntBuffer header, so it cannot be handed out
+    // to be deleted by the caller.
+    uint8_t *ret = new uint8_t[len_];
+    memcpy(ret, data_, len_);
+    if (data_ != initial_data_) {
+      FreeHeapArray(data_);
     }
     len_ = 0;
     capacity_ = kInitialCapacity;
@@ -236,6 +239,17 @@ class faststring {
   }
 
  private:
+  friend class RefCntBuffer;
+
+  // Heap arrays are allocated with room for a RefCntBuffer header in front of the data, so that
+  // RefCntBuffer(faststring&&) could take over the array without copying it.
+  static uint8_t* AllocateHeapArray(size_t capacity) {
+    return static_cast<uint8_t*>(RefCntBuffer::AllocateStorage(capacity));
+  }
+
+  static void FreeHeapArray(uint8_t* data) {
+    RefCntBuffer::FreeStorage(data);
+  }
 
   // If necessary, expand the buffer to fit at least 'count' more bytes.
   // If the array has to be grown, it is grown by at least 50%.
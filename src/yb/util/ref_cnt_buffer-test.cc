@@ -24,6 +24,7 @@
 
 #include <gtest/gtest.h>
 
+#include "yb/util/faststring.h"
 #include "yb/util/ref_cnt_buffer.h"
 
 #include "yb/util/test_util.h"
@@ -90,6 +91,35 @@ TEST_F(RefCntBufferTest, TestVector) {
   }
 }
 
+// Test taking over the storage of faststring.
+TEST_F(RefCntBufferTest, TestFromFaststring) {
+  unsigned int seed = SeedRandom();
+  for (auto i = 1000; i--;) {
+    size_t size = rand_r(&seed) % (kSizeLimit + 1); // Zero size is also allowed
+    faststring str;
+    for (size_t index = 0; index != size; ++index) {
+      str.push_back(static_cast<char>(index));
+    }
+    const uint8_t* old_data = str.data();
+    bool inline_storage = str.capacity() == faststring().capacity();
+
+    RefCntBuffer buffer(std::move(str));
+    ASSERT_EQ(size, buffer.size());
+    ASSERT_TRUE(str.empty());
+    if (!inline_storage) {
+      // Storage should be reused without copying.
+      ASSERT_EQ(old_data, buffer.udata());
+    }
+    for (size_t index = 0; index != size; ++index) {
+      ASSERT_EQ(static_cast<char>(index), buffer.begin()[index]);
+    }
+
+    // The string should still be usable after its storage was taken over.
+    str.append("test");
+    ASSERT_EQ("test", str.ToString());
+  }
+}
+
 namespace {
 
 const size_t kInitialBuffers = 1000;
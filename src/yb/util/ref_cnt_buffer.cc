@@ -17,6 +17,7 @@
 
 #include "yb/util/ref_cnt_buffer.h"
 
+#include "yb/gutil/dynamic_annotations.h"
 #include "yb/util/faststring.h"
 
 namespace yb {
@@ -44,6 +45,33 @@ RefCntBuffer::RefCntBuffer(const faststring& string)
     : RefCntBuffer(string.data(), string.size()) {
 }
 
+RefCntBuffer::RefCntBuffer(faststring&& string) {
+  if (string.data_ == string.initial_data_) {
+    data_ = static_cast<char*>(malloc(string.len_ + kHeaderSize));
+    CHECK(data_ != nullptr);
+    memcpy(data(), string.data_, string.len_);
+  } else {
+    ASAN_UNPOISON_MEMORY_REGION(string.data_, string.capacity_);
+    data_ = static_cast<char*>(static_cast<void*>(string.data_)) - kHeaderSize;
+    string.data_ = string.initial_data_;
+    string.capacity_ = faststring::kInitialCapacity;
+  }
+  size_reference() = string.len_;
+  new (&counter_reference()) CounterType(1);
+  string.len_ = 0;
+  ASAN_POISON_MEMORY_REGION(string.data_, string.capacity_);
+}
+
+void* RefCntBuffer::AllocateStorage(size_t capacity) {
+  char* storage = static_cast<char*>(malloc(capacity + kHeaderSize));
+  CHECK(storage != nullptr);
+  return storage + kHeaderSize;
+}
+
+void RefCntBuffer::FreeStorage(void* data) {
+  free(static_cast<char*>(data) - kHeaderSize);
+}
+
 RefCntBuffer::~RefCntBuffer() {
   Reset();
 }
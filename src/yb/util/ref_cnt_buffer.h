@@ -44,6 +44,10 @@ class RefCntBuffer {
 
   explicit RefCntBuffer(const faststring& string);
 
+  // Takes over the heap array of 'string' without copying it, leaving 'string' empty.
+  // Short strings that still use the inline storage of faststring are copied.
+  explicit RefCntBuffer(faststring&& string);
+
   RefCntBuffer(const RefCntBuffer& rhs) noexcept;
   RefCntBuffer(RefCntBuffer&& rhs) noexcept;
 
@@ -99,6 +103,15 @@ class RefCntBuffer {
   }
 
  private:
+  friend class faststring;
+
+  // Allocates storage for 'capacity' bytes of data preceded by the buffer header. Returns pointer
+  // to the data.
+  static void* AllocateStorage(size_t capacity);
+
+  // Releases storage returned by AllocateStorage.
+  static void FreeStorage(void* data);
+
   void DoReset(char* data);
 
   // Using ptrdiff_t since it matches register size and is signed.
@@ -112,6 +125,8 @@ class RefCntBuffer {
     return *static_cast<CounterType*>(static_cast<void*>(data_));
   }
 
+  static constexpr size_t kHeaderSize = sizeof(CounterType) + sizeof(size_t);
+
   char *data_;
 };
 
@@ -17,6 +17,7 @@
 #include <stack>
 #include <thread>
 
+#include "yb/util/metrics.h"
 #include "yb/util/shared_lock_manager.h"
 #include "yb/util/test_macros.h"
 #include "yb/util/test_util.h"
@@ -26,6 +27,12 @@ using std::vector;
 using std::stack;
 using std::thread;
 
+METRIC_DEFINE_entity(test_entity);
+METRIC_DEFINE_histogram(test_entity, lock_wait_time, "lock wait time",
+                        yb::MetricUnit::kMicroseconds, "test lock wait time", 1000000, 2);
+METRIC_DEFINE_counter(test_entity, lock_contentions, "lock contentions",
+                      yb::MetricUnit::kOperations, "test lock contentions");
+
 namespace yb {
 namespace util {
 
@@ -258,5 +265,40 @@ TEST_F(SharedLockManagerTest, RandomLockUnlockManyThreadsTest) {
   Run(2, 8);
 }
 
+TEST_F(SharedLockManagerTest, ContentionMetrics) {
+  MetricRegistry registry;
+  auto entity = METRIC_ENTITY_test_entity.Instantiate(&registry, "test entity");
+  auto wait_time = METRIC_lock_wait_time.Instantiate(entity);
+  auto contentions = METRIC_lock_contentions.Instantiate(entity);
+
+  SharedLockManager lm;
+  lm.SetMetrics(wait_time, contentions);
+
+  // Non-conflicting locks do not wait.
+  lm.Lock("a", LockType::SR_READ_WEAK);
+  lm.Lock("a", LockType::SR_READ_WEAK);
+  lm.Lock("b", LockType::SI_WRITE_STRONG);
+  ASSERT_EQ(0, contentions->value());
+
+  std::atomic<bool> locked(false);
+  thread waiter([&lm, &locked] {
+    lm.Lock("b", LockType::SI_WRITE_STRONG);
+    locked = true;
+    lm.Unlock("b", LockType::SI_WRITE_STRONG);
+  });
+  SleepFor(MonoDelta::FromMilliseconds(100));
+  ASSERT_FALSE(locked);
+  lm.Unlock("b", LockType::SI_WRITE_STRONG);
+  waiter.join();
+  ASSERT_TRUE(locked);
+
+  ASSERT_EQ(1, contentions->value());
+  ASSERT_EQ(1, wait_time->TotalCount());
+  ASSERT_GE(wait_time->MaxValueForTests(), 100000);
+
+  lm.Unlock("a", LockType::SR_READ_WEAK);
+  lm.Unlock("a", LockType::SR_READ_WEAK);
+}
+
 } // namespace util
 } // namespace yb
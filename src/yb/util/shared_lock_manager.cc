@@ -13,13 +13,24 @@
 
 #include "yb/util/shared_lock_manager.h"
 
+#include <functional>
 #include <vector>
 
 #include <boost/range/adaptor/reversed.hpp>
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include "yb/util/bytes_formatter.h"
 #include "yb/util/enums.h"
+#include "yb/util/flag_tags.h"
+#include "yb/util/logging.h"
+#include "yb/util/metrics.h"
+#include "yb/util/monotime.h"
+
+DEFINE_int32(shared_lock_manager_hot_key_log_threshold_ms, 100,
+             "Log a sample of keys for which acquiring a DocDB lock took longer than this many "
+             "milliseconds. Negative value disables logging.");
+TAG_FLAG(shared_lock_manager_hot_key_log_threshold_ms, runtime);
 
 using std::string;
 using yb::util::to_underlying;
@@ -122,15 +133,30 @@ bool SharedLockManager::VerifyState(LockState state) {
   return true;
 }
 
-void SharedLockManager::LockEntry::Lock(LockType lock_type) {
+SharedLockManager::SharedLockManager() {}
+
+SharedLockManager::~SharedLockManager() {}
+
+void SharedLockManager::SetMetrics(scoped_refptr<Histogram> wait_time,
+                                   scoped_refptr<Counter> contentions) {
+  wait_time_ = std::move(wait_time);
+  contentions_ = std::move(contentions);
+}
+
+MonoDelta SharedLockManager::LockEntry::Lock(LockType lock_type) {
   // TODO(bojanserafimov): Implement CAS fast path. Only wait when CAS fails.
   int type_idx = static_cast<int>(lock_type);
+  MonoTime wait_start;
   std::unique_lock<std::mutex> lock(mutex);
   while ((state & CONFLICTS[type_idx]) != 0) {
+    if (!wait_start) {
+      wait_start = MonoTime::FineNow();
+    }
     cond_var.wait(lock);
   }
   num_holding[type_idx]++;
   state |= (1 << type_idx);
+  return wait_start ? MonoTime::FineNow().GetDeltaSince(wait_start) : MonoDelta();
 }
 
 void SharedLockManager::LockEntry::Unlock(LockType lock_type) {
@@ -153,12 +179,30 @@ void SharedLockManager::LockEntry::Unlock(LockType lock_type) {
   }
 }
 
+SharedLockManager::Shard& SharedLockManager::ShardForKey(const std::string& key) {
+  return shards_[std::hash<std::string>()(key) % kNumShards];
+}
+
 void SharedLockManager::Lock(const LockBatch& batch) {
   std::vector<SharedLockManager::LockEntry*> reserved = Reserve(batch);
   size_t idx = 0;
   for (const auto& item : batch) {
     VLOG(4) << "Locking " << ToString(item.second) << ": " << FormatBytesAsStr(item.first);
-    reserved[idx]->Lock(item.second);
+    const auto wait_time = reserved[idx]->Lock(item.second);
+    if (PREDICT_FALSE(wait_time.Initialized())) {
+      if (wait_time_) {
+        wait_time_->Increment(wait_time.ToMicroseconds());
+      }
+      if (contentions_) {
+        contentions_->Increment();
+      }
+      const auto threshold_ms = FLAGS_shared_lock_manager_hot_key_log_threshold_ms;
+      if (threshold_ms >= 0 && wait_time.ToMilliseconds() >= threshold_ms) {
+        YB_LOG_EVERY_N_SECS(INFO, 10)
+            << "Hot key sample: waited " << wait_time.ToString() << " to lock "
+            << ToString(item.second) << ": " << FormatBytesAsStr(item.first) << THROTTLE_MSG;
+      }
+    }
     idx++;
   }
 }
@@ -166,32 +210,31 @@ void SharedLockManager::Lock(const LockBatch& batch) {
 std::vector<SharedLockManager::LockEntry*> SharedLockManager::Reserve(const LockBatch& batch) {
   std::vector<SharedLockManager::LockEntry*> reserved;
   reserved.reserve(batch.size());
-  {
-    std::lock_guard<std::mutex> lock(global_mutex_);
-    for (const auto& item : batch) {
-      auto it = locks_.emplace(item.first, std::make_unique<LockEntry>()).first;
-      it->second->num_using++;
-      reserved.push_back(&*it->second);
+  for (const auto& item : batch) {
+    auto& shard = ShardForKey(item.first);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.locks.find(item.first);
+    if (it == shard.locks.end()) {
+      it = shard.locks.emplace(item.first, std::make_unique<LockEntry>()).first;
     }
+    it->second->num_using++;
+    reserved.push_back(it->second.get());
   }
   return reserved;
 }
 
 void SharedLockManager::Unlock(const LockBatch& batch) {
-  std::lock_guard<std::mutex> lock(global_mutex_);
   for (const auto& item : boost::adaptors::reverse(batch)) {
     VLOG(4) << "Unlocking " << ToString(item.second) << ": " << FormatBytesAsStr(item.first);
-    locks_[item.first]->Unlock(item.second);
-  }
-  Cleanup(batch);
-}
-
-void SharedLockManager::Cleanup(const LockBatch& batch) {
-  for (const auto& item : batch) {
-    auto it = locks_.find(item.first);
-    it->second->num_using--;
-    if (it->second->num_using == 0) {
-      locks_.erase(it);
+    auto& shard = ShardForKey(item.first);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.locks.find(item.first);
+    DCHECK(it != shard.locks.end()) << "Unlocking key that is not locked: "
+                                    << FormatBytesAsStr(item.first);
+    it->second->Unlock(item.second);
+    // Update refcount and maybe collect garbage.
+    if (--it->second->num_using == 0) {
+      shard.locks.erase(it);
     }
   }
 }
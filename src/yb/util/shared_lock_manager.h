@@ -14,17 +14,25 @@
 #ifndef YB_UTIL_SHARED_LOCK_MANAGER_H_
 #define YB_UTIL_SHARED_LOCK_MANAGER_H_
 
+#include <array>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "yb/gutil/ref_counted.h"
 #include "yb/gutil/spinlock.h"
 #include "yb/util/shared_lock_manager_fwd.h"
 #include "yb/util/cross_thread_mutex.h"
+#include "yb/util/monotime.h"
 
 namespace yb {
+
+class Counter;
+class Histogram;
+
 namespace util {
 
 const char* ToString(LockType lock_type);
@@ -35,8 +43,18 @@ const char* ToString(LockType lock_type);
 // - Multiple SR_READ_STRONG and SR_READ_WEAK
 // - Multiple SR_WRITE_STRONG and SR_WRITE_WEAK
 // - Multiple SI_WRITE_WEAK, SR_READ_WEAK, and SR_WRITE_WEAK
+//
+// Lock entries are distributed over kNumShards independently locked maps by the hash of their key,
+// so that concurrent batches on unrelated keys do not contend on a single global mutex.
 class SharedLockManager {
  public:
+  SharedLockManager();
+  ~SharedLockManager();
+
+  // Sets metrics used to report lock contention. Should be called before the lock manager is used.
+  // wait_time receives the time in microseconds spent waiting for a conflicting lock to be released,
+  // and contentions is incremented every time such a wait happens.
+  void SetMetrics(scoped_refptr<Histogram> wait_time, scoped_refptr<Counter> contentions);
 
   // Attempt to lock the key with certain type. The call may be blocked waiting for other
   // locks to be released. If LockEntry doesn't exist, it creates a LockEntry.
@@ -68,14 +86,16 @@ class SharedLockManager {
 
     std::condition_variable cond_var;
 
-    // Refcounting for garbage collection. Can only be used while the global lock is held.
+    // Refcounting for garbage collection. Can only be used while the shard lock is held.
     size_t num_using = 0;
 
     // Number of holders for each type
     size_t num_holding[NUM_LOCK_TYPES] {0};
     LockState state = 0;
 
-    void Lock(LockType lock_type);
+    // Returns the time spent waiting if the lock could not be acquired immediately, or an
+    // uninitialized MonoDelta otherwise. The clock is only read when we have to wait.
+    MonoDelta Lock(LockType lock_type);
 
     void Unlock(LockType lock_type);
 
@@ -83,19 +103,27 @@ class SharedLockManager {
 
   typedef std::unordered_map<std::string, std::unique_ptr<LockEntry>> LockEntryMap;
 
-  // Make sure the entries exist in the locks_ map and return pointers so we can access
-  // them without holding the global lock. Returns a vector with pointers in the same order
+  struct Shard {
+    // Should be taken only for very short duration, with no blocking wait.
+    std::mutex mutex;
+
+    // Can only be modified if the shard mutex is held.
+    LockEntryMap locks;
+  };
+
+  static constexpr size_t kNumShards = 16;
+
+  Shard& ShardForKey(const std::string& key);
+
+  // Make sure the entries exist in the shard maps and return pointers so we can access
+  // them without holding the shard locks. Returns a vector with pointers in the same order
   // as the keys in the batch.
   std::vector<LockEntry*> Reserve(const LockBatch& batch);
 
-  // Update refcounts and maybe collect garbage.
-  void Cleanup(const LockBatch& batch);
-
-  // The global mutex should be taken only for very short duration, with no blocking wait.
-  std::mutex global_mutex_;
+  std::array<Shard, kNumShards> shards_;
 
-  // Can only be modified if the global mutex is held.
-  LockEntryMap locks_;
+  scoped_refptr<Histogram> wait_time_;
+  scoped_refptr<Counter> contentions_;
 };
 
 }  // namespace util